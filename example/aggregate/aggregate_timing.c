@@ -0,0 +1,168 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Measure the rate of small messages to the nearest few processes on
+ * either side in a periodic one-dimensional decomposition.  We compare
+ * one Isend per message with the aggregation layer, with and without
+ * routing through the node communicators. */
+
+#include <sc_aggregate.h>
+#include <sc_options.h>
+
+static void
+aggregate_count (sc_aggregate_t * agg, int source, const void *data,
+                 size_t bytes, void *user)
+{
+  ++*(long *) user;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 mpisize, mpirank;
+  int                 width, bytes, num_messages, flush_bytes;
+  int                 i, m, q, s, id, num_peers, route;
+  int                *peers;
+  long                received;
+  char               *sendbuf, *recvbuf;
+  double              elapsed, result;
+  sc_MPI_Request     *requests;
+  sc_aggregate_t     *agg;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'w', "width", &width, 2,
+                      "Number of neighbors on either side");
+  sc_options_add_int (opt, 'b', "bytes", &bytes, 16, "Bytes per message");
+  sc_options_add_int (opt, 'm', "messages", &num_messages, 1000,
+                      "Messages to every neighbor");
+  sc_options_add_int (opt, 'f', "flush-bytes", &flush_bytes, 1 << 16,
+                      "Size threshold of the aggregation buffers");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || width < 0 || bytes < 0 || num_messages <= 0 ||
+      flush_bytes < 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* the periodic neighbors other than ourselves */
+  peers = SC_ALLOC (int, mpisize);
+  num_peers = 0;
+  for (q = 0; q < mpisize; ++q) {
+    s = (q - mpirank + mpisize) % mpisize;
+    if (q != mpirank && (s <= width || s >= mpisize - width)) {
+      peers[num_peers++] = q;
+    }
+  }
+  sendbuf = SC_ALLOC_ZERO (char, bytes);
+
+  /* one message at a time, with all receives posted in advance */
+  recvbuf = SC_ALLOC (char, (size_t) num_peers * num_messages * bytes);
+  requests = SC_ALLOC (sc_MPI_Request, 2 * num_peers * num_messages);
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  elapsed = -sc_MPI_Wtime ();
+  for (i = 0; i < num_peers; ++i) {
+    for (m = 0; m < num_messages; ++m) {
+      mpiret = sc_MPI_Irecv (recvbuf + ((size_t) i * num_messages + m) *
+                             bytes, bytes, sc_MPI_BYTE, peers[i],
+                             SC_TAG_FIRST, sc_MPI_COMM_WORLD,
+                             requests + i * num_messages + m);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  for (m = 0; m < num_messages; ++m) {
+    for (i = 0; i < num_peers; ++i) {
+      mpiret = sc_MPI_Isend (sendbuf, bytes, sc_MPI_BYTE, peers[i],
+                             SC_TAG_FIRST, sc_MPI_COMM_WORLD,
+                             requests + (num_peers + i) * num_messages + m);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  mpiret = sc_MPI_Waitall (2 * num_peers * num_messages, requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  elapsed += sc_MPI_Wtime ();
+  mpiret = sc_MPI_Allreduce (&elapsed, &result, 1, sc_MPI_DOUBLE,
+                             sc_MPI_MAX, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  SC_GLOBAL_STATISTICSF ("Isend per message %g messages per second\n",
+                         num_peers * num_messages / result);
+  SC_FREE (requests);
+  SC_FREE (recvbuf);
+
+  for (route = 0; route < 2; ++route) {
+    received = 0;
+    agg = sc_aggregate_new (sc_MPI_COMM_WORLD, (size_t) flush_bytes, -1.,
+                            route);
+    id = sc_aggregate_register (agg, aggregate_count, &received);
+    mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    for (m = 0; m < num_messages; ++m) {
+      for (i = 0; i < num_peers; ++i) {
+        sc_aggregate_send (agg, peers[i], id, sendbuf, (size_t) bytes);
+      }
+      if (m % 64 == 0) {
+        sc_aggregate_poll (agg);
+      }
+    }
+    sc_aggregate_complete (agg);
+    elapsed += sc_MPI_Wtime ();
+    SC_CHECK_ABORT (received == (long) num_peers * num_messages,
+                    "Aggregated messages");
+    mpiret = sc_MPI_Allreduce (&elapsed, &result, 1, sc_MPI_DOUBLE,
+                               sc_MPI_MAX, sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    SC_GLOBAL_STATISTICSF ("Aggregated%s %g messages per second"
+                           " in %ld buffers\n", route ? " and routed" : "",
+                           num_peers * num_messages / result,
+                           agg->num_buffers);
+    sc_aggregate_destroy (agg);
+  }
+
+  SC_FREE (sendbuf);
+  SC_FREE (peers);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
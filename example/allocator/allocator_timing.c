@@ -0,0 +1,159 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Time scans of a large array whose memory comes from different
+ * allocators: sc_malloc, transparent huge pages, a bump arena, and shmem.
+ * The sequential scan is limited by memory bandwidth.  The random scan
+ * reads one element from every 4 KiB page in a random order, so nearly
+ * every access misses the TLB unless the array lies in huge pages. */
+
+#include <sc_arena.h>
+#include <sc_options.h>
+#include <sc_shmem.h>
+
+#define ALLOCATOR_NUM 4
+
+static const char  *allocator_names[ALLOCATOR_NUM] =
+  { "malloc", "hugepage", "arena", "shmem" };
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 megabytes, repeat, r, k, shared;
+  size_t              zi, zj, swap, num_elems, num_pages, page_elems;
+  size_t             *pages;
+  double              elapsed, sum, sum_first;
+  double             *data;
+  sc_allocator_t     *allocators[ALLOCATOR_NUM];
+  sc_arena_t         *arena;
+  sc_array_t          a;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'm', "megabytes", &megabytes, 1 << 10,
+                      "Size of the array in MiB");
+  sc_options_add_int (opt, 'r', "repeat", &repeat, 5,
+                      "Number of scans of each kind");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || megabytes <= 0 || repeat <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  num_elems = ((size_t) megabytes << 20) / sizeof (double);
+  page_elems = 4096 / sizeof (double);
+  num_pages = num_elems / page_elems;
+
+  /* visit every page once in a random order */
+  pages = SC_ALLOC (size_t, num_pages);
+  for (zi = 0; zi < num_pages; ++zi) {
+    pages[zi] = zi;
+  }
+  srand (19);
+  for (zi = num_pages - 1; zi > 0; --zi) {
+    zj = (size_t) rand () % (zi + 1);
+    swap = pages[zi];
+    pages[zi] = pages[zj];
+    pages[zj] = swap;
+  }
+
+  arena = sc_arena_new (0);
+  allocators[0] = NULL;
+  allocators[1] = sc_allocator_hugepage ();
+  allocators[2] = sc_arena_allocator (arena);
+  allocators[3] = sc_shmem_allocator_new (sc_MPI_COMM_WORLD);
+
+  sum_first = 0.;
+  for (k = 0; k < ALLOCATOR_NUM; ++k) {
+    /* the first touch maps the pages, shmem is filled by one writer */
+    sc_array_init_allocator (&a, sizeof (double), allocators[k]);
+    elapsed = -sc_MPI_Wtime ();
+    sc_array_resize (&a, num_elems);
+    data = (double *) a.array;
+    shared = allocators[k] != NULL && allocators[k]->shared;
+    if (!shared || sc_shmem_write_start (data, sc_MPI_COMM_WORLD)) {
+      for (zi = 0; zi < num_elems; ++zi) {
+        data[zi] = (double) (zi % 1000);
+      }
+    }
+    if (shared) {
+      sc_shmem_write_end (data, sc_MPI_COMM_WORLD);
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("%s allocate and fill %g ns per element\n",
+                           allocator_names[k], 1e9 * elapsed / num_elems);
+
+    sum = 0.;
+    elapsed = -sc_MPI_Wtime ();
+    for (r = 0; r < repeat; ++r) {
+      for (zi = 0; zi < num_elems; ++zi) {
+        sum += data[zi];
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("%s sequential scan %g ns per element\n",
+                           allocator_names[k],
+                           1e9 * elapsed / ((double) repeat * num_elems));
+
+    elapsed = -sc_MPI_Wtime ();
+    for (r = 0; r < repeat; ++r) {
+      for (zi = 0; zi < num_pages; ++zi) {
+        sum += data[pages[zi] * page_elems + (size_t) r % page_elems];
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("%s random page scan %g ns per access\n",
+                           allocator_names[k],
+                           1e9 * elapsed / ((double) repeat * num_pages));
+
+    /* all allocators must see the same data */
+    if (k == 0) {
+      sum_first = sum;
+    }
+    SC_CHECK_ABORT (sum == sum_first, "Scans disagree");
+    sc_array_reset (&a);
+  }
+
+  sc_shmem_allocator_destroy (allocators[3]);
+  sc_arena_destroy (arena);
+  SC_FREE (pages);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
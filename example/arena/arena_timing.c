@@ -0,0 +1,182 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Time phases of short-lived allocations that are all freed at the end of
+ * the phase, as they occur in one step of a simulation or a search.  The
+ * blocks are taken from sc_malloc and freed one by one, or taken from an
+ * arena and given back at once by releasing to a mark.  The same is done
+ * for a set of temporary arrays that grow by pushing elements. */
+
+#include <sc_arena.h>
+#include <sc_options.h>
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 num_phases, num_blocks, max_size, num_arrays;
+  int                 num_pushes;
+  int                 p, i, k;
+  size_t             *sizes;
+  double              elapsed, sum_malloc, sum_arena;
+  char              **blocks;
+  sc_array_t         *arrays;
+  sc_arena_mark_t     mark;
+  sc_arena_t         *arena;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'p', "phases", &num_phases, 100,
+                      "Number of phases");
+  sc_options_add_int (opt, 'b', "blocks", &num_blocks, 10000,
+                      "Number of blocks allocated per phase");
+  sc_options_add_int (opt, 's', "max-size", &max_size, 256,
+                      "Maximum size of a block in bytes");
+  sc_options_add_int (opt, 'a', "arrays", &num_arrays, 100,
+                      "Number of temporary arrays per phase");
+  sc_options_add_int (opt, 'n', "pushes", &num_pushes, 1000,
+                      "Number of elements pushed to each array");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || num_phases <= 0 || num_blocks <= 0 ||
+      max_size <= 0 || num_arrays <= 0 || num_pushes <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* both variants see the same sequence of block sizes */
+  sizes = SC_ALLOC (size_t, num_blocks);
+  srand (17);
+  for (i = 0; i < num_blocks; ++i) {
+    sizes[i] = 1 + (size_t) rand () % (size_t) max_size;
+  }
+  blocks = SC_ALLOC (char *, num_blocks);
+  arena = sc_arena_new (0);
+
+  sum_malloc = 0.;
+  elapsed = -sc_MPI_Wtime ();
+  for (p = 0; p < num_phases; ++p) {
+    for (i = 0; i < num_blocks; ++i) {
+      blocks[i] = (char *) sc_malloc (sc_package_id, sizes[i]);
+      blocks[i][0] = (char) i;
+    }
+    for (i = 0; i < num_blocks; ++i) {
+      sum_malloc += blocks[i][0];
+      sc_free (sc_package_id, blocks[i]);
+    }
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Malloc and free %g ns per block\n",
+                         1e9 * elapsed / ((double) num_phases * num_blocks));
+
+  sum_arena = 0.;
+  elapsed = -sc_MPI_Wtime ();
+  for (p = 0; p < num_phases; ++p) {
+    sc_arena_mark (arena, &mark);
+    for (i = 0; i < num_blocks; ++i) {
+      blocks[i] = (char *) sc_arena_alloc (arena, sizes[i]);
+      blocks[i][0] = (char) i;
+    }
+    for (i = 0; i < num_blocks; ++i) {
+      sum_arena += blocks[i][0];
+    }
+    sc_arena_release (arena, &mark);
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Arena allocate and release %g ns per block\n",
+                         1e9 * elapsed / ((double) num_phases * num_blocks));
+  SC_GLOBAL_STATISTICSF ("Arena high water %lld bytes, %lld reserved now\n",
+                         (long long) arena->high_water,
+                         (long long) sc_arena_memory_used (arena));
+  SC_CHECK_ABORT (sum_malloc == sum_arena, "Block contents disagree");
+
+  /* fill the arrays one after the other and keep them to the phase end */
+  arrays = SC_ALLOC (sc_array_t, num_arrays);
+  sum_malloc = 0.;
+  elapsed = -sc_MPI_Wtime ();
+  for (p = 0; p < num_phases; ++p) {
+    for (k = 0; k < num_arrays; ++k) {
+      sc_array_init (&arrays[k], sizeof (double));
+      for (i = 0; i < num_pushes; ++i) {
+        *(double *) sc_array_push (&arrays[k]) = (double) i;
+      }
+    }
+    for (k = 0; k < num_arrays; ++k) {
+      sum_malloc += *(double *) sc_array_index_int (&arrays[k], p %
+                                                    num_pushes);
+      sc_array_reset (&arrays[k]);
+    }
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Array push with malloc %g ns per element\n",
+                         1e9 * elapsed /
+                         ((double) num_phases * num_arrays * num_pushes));
+
+  sum_arena = 0.;
+  elapsed = -sc_MPI_Wtime ();
+  for (p = 0; p < num_phases; ++p) {
+    sc_arena_mark (arena, &mark);
+    for (k = 0; k < num_arrays; ++k) {
+      sc_array_init_allocator (&arrays[k], sizeof (double),
+                               sc_arena_allocator (arena));
+      for (i = 0; i < num_pushes; ++i) {
+        *(double *) sc_array_push (&arrays[k]) = (double) i;
+      }
+    }
+    for (k = 0; k < num_arrays; ++k) {
+      sum_arena += *(double *) sc_array_index_int (&arrays[k], p %
+                                                   num_pushes);
+    }
+    sc_arena_release (arena, &mark);
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Array push with arena %g ns per element\n",
+                         1e9 * elapsed /
+                         ((double) num_phases * num_arrays * num_pushes));
+  SC_GLOBAL_STATISTICSF ("Arena high water %lld bytes, %lld reserved now\n",
+                         (long long) arena->high_water,
+                         (long long) sc_arena_memory_used (arena));
+  SC_CHECK_ABORT (sum_malloc == sum_arena, "Array contents disagree");
+
+  SC_FREE (arrays);
+  sc_arena_destroy (arena);
+  SC_FREE (blocks);
+  SC_FREE (sizes);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,252 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the B+-tree with the AVL tree for an ordered set of integers.
+ * We time random insertions, lookups, access by rank, a traversal in
+ * order, and building the tree from a sorted array incrementally and in
+ * bulk.  For the AVL tree, we also time splitting and joining, and
+ * allocating its nodes from a memory pool. */
+
+#include <sc_avl.h>
+#include <sc_bptree.h>
+#include <sc_options.h>
+
+static int
+bptree_compare (const void *v1, const void *v2)
+{
+  const int64_t       i1 = *(const int64_t *) v1;
+  const int64_t       i2 = *(const int64_t *) v2;
+
+  return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
+}
+
+static void
+bptree_sum (void *item, void *data)
+{
+  *(int64_t *) data += *(int64_t *) item;
+}
+
+static void
+bptree_report (const char *operation, const char *container, double seconds,
+               int count)
+{
+  SC_GLOBAL_STATISTICSF ("%s %s %g ns per item\n", container, operation,
+                         1e9 * seconds / count);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 count, i, j;
+  int64_t            *values, sum_avl, sum_bptree;
+  size_t             *order, swap;
+  double              seconds;
+  void               *found;
+  avl_tree_t         *avl, right;
+  sc_bptree_t        *bptree;
+  sc_mempool_t       *pool;
+  sc_array_t         *sorted;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'n', "count", &count, 1000000,
+                      "Number of items in the set");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || count <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* the values are 0, 2, 4, ... and we insert them in random order */
+  srand (11);
+  values = SC_ALLOC (int64_t, count);
+  order = SC_ALLOC (size_t, count);
+  sorted = sc_array_new_size (sizeof (void *), (size_t) count);
+  for (i = 0; i < count; ++i) {
+    values[i] = 2 * (int64_t) i;
+    *(void **) sc_array_index_int (sorted, i) = values + i;
+    order[i] = (size_t) i;
+  }
+  for (i = count - 1; i > 0; --i) {
+    j = rand () % (i + 1);
+    swap = order[i];
+    order[i] = order[j];
+    order[j] = swap;
+  }
+
+  /* random insertions */
+  seconds = -sc_MPI_Wtime ();
+  avl = avl_alloc_tree (bptree_compare, NULL);
+  for (i = 0; i < count; ++i) {
+    avl_insert (avl, values + order[i]);
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("insert", "avl", seconds, count);
+
+  seconds = -sc_MPI_Wtime ();
+  bptree = sc_bptree_new (bptree_compare);
+  for (i = 0; i < count; ++i) {
+    sc_bptree_insert (bptree, values + order[i], NULL);
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("insert", "bptree", seconds, count);
+
+  /* random lookups */
+  seconds = -sc_MPI_Wtime ();
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (avl_search (avl, values + order[i]) != NULL, "Search");
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("search", "avl", seconds, count);
+
+  seconds = -sc_MPI_Wtime ();
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (sc_bptree_lookup (bptree, values + order[i], &found),
+                    "Lookup");
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("search", "bptree", seconds, count);
+
+  /* random access by rank */
+  seconds = -sc_MPI_Wtime ();
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (avl_at (avl, (unsigned) order[i])->item ==
+                    values + order[i], "At");
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("at", "avl", seconds, count);
+
+  seconds = -sc_MPI_Wtime ();
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (sc_bptree_at (bptree, order[i]) == values + order[i],
+                    "At");
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("at", "bptree", seconds, count);
+
+  /* traversal in order */
+  sum_avl = sum_bptree = 0;
+  seconds = -sc_MPI_Wtime ();
+  avl_foreach (avl, bptree_sum, &sum_avl);
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("foreach", "avl", seconds, count);
+
+  seconds = -sc_MPI_Wtime ();
+  sc_bptree_foreach (bptree, bptree_sum, &sum_bptree);
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("foreach", "bptree", seconds, count);
+  SC_CHECK_ABORT (sum_avl == sum_bptree, "Sum");
+
+  SC_GLOBAL_STATISTICSF ("Memory avl %llu bptree %llu bytes\n",
+                         (unsigned long long) (sizeof (avl_tree_t) +
+                                               count * sizeof (avl_node_t)),
+                         (unsigned long long)
+                         sc_bptree_memory_used (bptree));
+
+  /* random removals */
+  seconds = -sc_MPI_Wtime ();
+  for (i = 0; i < count; ++i) {
+    avl_delete (avl, values + order[i]);
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("delete", "avl", seconds, count);
+
+  seconds = -sc_MPI_Wtime ();
+  for (i = 0; i < count; ++i) {
+    sc_bptree_remove (bptree, values + order[i], NULL);
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("delete", "bptree", seconds, count);
+  avl_free_tree (avl);
+  sc_bptree_destroy (bptree);
+
+  /* building from a sorted array */
+  seconds = -sc_MPI_Wtime ();
+  avl = avl_alloc_tree (bptree_compare, NULL);
+  for (i = 0; i < count; ++i) {
+    avl_insert (avl, values + i);
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("sorted insert", "avl", seconds, count);
+  avl_free_tree (avl);
+
+  pool = sc_mempool_new (sizeof (avl_node_t));
+  seconds = -sc_MPI_Wtime ();
+  avl = avl_alloc_tree (bptree_compare, NULL);
+  avl_set_allocator (avl, pool);
+  for (i = 0; i < count; ++i) {
+    avl_insert (avl, values + i);
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("sorted insert from pool", "avl", seconds, count);
+  avl_free_tree (avl);
+
+  seconds = -sc_MPI_Wtime ();
+  avl = avl_alloc_tree (bptree_compare, NULL);
+  avl_set_allocator (avl, pool);
+  avl_from_array (avl, sorted);
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("bulk load from pool", "avl", seconds, count);
+
+  /* split at a random key and join again */
+  seconds = -sc_MPI_Wtime ();
+  for (i = 0; i < count; ++i) {
+    avl_split (avl, values + order[i], &right);
+    avl_join (avl, &right);
+  }
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("split and join", "avl", seconds, count);
+  SC_CHECK_ABORT (avl_count (avl) == (unsigned) count, "Split and join");
+
+  seconds = -sc_MPI_Wtime ();
+  bptree = sc_bptree_new (bptree_compare);
+  sc_bptree_bulk_load (bptree, sorted);
+  seconds += sc_MPI_Wtime ();
+  bptree_report ("bulk load", "bptree", seconds, count);
+  SC_CHECK_ABORT (bptree->elem_count == (size_t) count, "Bulk load");
+
+  avl_free_tree (avl);
+  sc_mempool_destroy (pool);
+  sc_bptree_destroy (bptree);
+  sc_array_destroy (sorted);
+  SC_FREE (order);
+  SC_FREE (values);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
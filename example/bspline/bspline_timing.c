@@ -0,0 +1,224 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the run times of different B-spline evaluation methods. */
+
+#include <sc_bspline.h>
+#include <sc_options.h>
+
+typedef struct timing_data
+{
+  sc_bspline_t       *bs;
+  sc_bspline_poly_t  *poly;
+  int                 repetitions;
+  size_t              num_t;
+  const double       *t;
+  double             *result;
+}
+timing_data_t;
+
+/** Return the minimum run time over all repetitions. */
+static double
+timing_pointwise (timing_data_t * td, int order)
+{
+  int                 r;
+  size_t              zz;
+  double              elapsed, emin;
+
+  emin = -1.;
+  for (r = 0; r < td->repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    for (zz = 0; zz < td->num_t; ++zz) {
+      sc_bspline_derivative_n (td->bs, order, td->t[zz],
+                               td->result + td->bs->d * zz);
+    }
+    elapsed += sc_MPI_Wtime ();
+    emin = (emin < 0. || elapsed < emin) ? elapsed : emin;
+  }
+
+  return emin;
+}
+
+/** Return the minimum run time over all repetitions. */
+static double
+timing_batch (timing_data_t * td, int order)
+{
+  int                 r;
+  double              elapsed, emin;
+
+  emin = -1.;
+  for (r = 0; r < td->repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    sc_bspline_derivative_n_batch (td->bs, order, td->num_t, td->t,
+                                   td->result);
+    elapsed += sc_MPI_Wtime ();
+    emin = (emin < 0. || elapsed < emin) ? elapsed : emin;
+  }
+
+  return emin;
+}
+
+/** Return the minimum run time over all repetitions. */
+static double
+timing_poly (timing_data_t * td, int order)
+{
+  int                 r;
+  size_t              zz;
+  double              elapsed, emin;
+
+  emin = -1.;
+  for (r = 0; r < td->repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    for (zz = 0; zz < td->num_t; ++zz) {
+      sc_bspline_poly_derivative_n (td->poly, order, td->t[zz],
+                                    td->result + td->bs->d * zz);
+    }
+    elapsed += sc_MPI_Wtime ();
+    emin = (emin < 0. || elapsed < emin) ? elapsed : emin;
+  }
+
+  return emin;
+}
+
+/** Return the minimum run time over all repetitions. */
+static double
+timing_poly_batch (timing_data_t * td, int order)
+{
+  int                 r;
+  double              elapsed, emin;
+
+  emin = -1.;
+  for (r = 0; r < td->repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    sc_bspline_poly_derivative_n_batch (td->poly, order, td->num_t, td->t,
+                                        td->result);
+    elapsed += sc_MPI_Wtime ();
+    emin = (emin < 0. || elapsed < emin) ? elapsed : emin;
+  }
+
+  return emin;
+}
+
+static void
+timing_run (timing_data_t * td, const char *name)
+{
+  int                 order;
+
+  for (order = 0; order <= SC_MIN (td->bs->n, 1); ++order) {
+    SC_GLOBAL_STATISTICSF ("%s degree %d order %d de Boor %g batch %g"
+                           " poly %g poly batch %g\n",
+                           name, td->bs->n, order,
+                           timing_pointwise (td, order),
+                           timing_batch (td, order),
+                           timing_poly (td, order),
+                           timing_poly_batch (td, order));
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 nmin, nmax, d, p, num_t, repetitions;
+  int                 i, k, n;
+  double              econv;
+  double             *t;
+  sc_dmatrix_t       *points;
+  sc_options_t       *opt;
+  timing_data_t       td;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'm', "min-degree", &nmin, 1,
+                      "Minimum polynomial degree");
+  sc_options_add_int (opt, 'n', "max-degree", &nmax, 5,
+                      "Maximum polynomial degree");
+  sc_options_add_int (opt, 'd', "dimension", &d, 3, "Dimension of points");
+  sc_options_add_int (opt, 'p', "points", &p, 1000,
+                      "Number of control points");
+  sc_options_add_int (opt, 'N', "num-evals", &num_t, 1000000,
+                      "Number of evaluations");
+  sc_options_add_int (opt, 'R', "repetitions", &repetitions, 5,
+                      "Number of repetitions for timing");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || nmin < 0 || nmax < nmin || d <= 0 || p <= nmax || num_t <= 0 ||
+      repetitions <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  srand (17);
+  points = sc_dmatrix_new (p, d);
+  for (i = 0; i < p; ++i) {
+    for (k = 0; k < d; ++k) {
+      points->e[i][k] = rand () / (double) RAND_MAX;
+    }
+  }
+  td.repetitions = repetitions;
+  td.num_t = (size_t) num_t;
+  td.t = t = SC_ALLOC (double, num_t);
+  td.result = SC_ALLOC (double, num_t * d);
+
+  for (n = nmin; n <= nmax; ++n) {
+    td.bs = sc_bspline_new (n, points, NULL, NULL);
+    econv = -sc_MPI_Wtime ();
+    td.poly = sc_bspline_poly_new (td.bs);
+    econv += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Degree %d conversion to polynomials %g\n",
+                           n, econv);
+
+    for (i = 0; i < num_t; ++i) {
+      t[i] = i / (double) (num_t - 1 > 0 ? num_t - 1 : 1);
+    }
+    timing_run (&td, "Sorted");
+
+    for (i = 0; i < num_t; ++i) {
+      t[i] = rand () / (double) RAND_MAX;
+    }
+    timing_run (&td, "Unsorted");
+
+    sc_bspline_poly_destroy (td.poly);
+    sc_bspline_destroy (td.bs);
+  }
+
+  SC_FREE (t);
+  SC_FREE (td.result);
+  sc_dmatrix_destroy (points);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,214 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Time a halo exchange in a periodic one-dimensional decomposition where
+ * every process talks to the nearest few processes on either side.  We
+ * compare hand-coded Irecv/Isend/Waitall in every step with a persistent
+ * exchange plan and a neighborhood collective plan.  Then we overlap the
+ * exchange with some dummy computation using the split begin/end calls. */
+
+#include <sc_exchange.h>
+#include <sc_options.h>
+
+/** A stand-in for the work on the interior of the domain. */
+static double
+exchange_compute (double *work, int length)
+{
+  int                 i;
+  double              sum = 0.;
+
+  for (i = 0; i < length; ++i) {
+    work[i] = .5 * work[i] + 1.;
+    sum += work[i];
+  }
+  return sum;
+}
+
+static double
+exchange_max (double value)
+{
+  int                 mpiret;
+  double              result;
+
+  mpiret = sc_MPI_Allreduce (&value, &result, 1, sc_MPI_DOUBLE, sc_MPI_MAX,
+                             sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  return result;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 mpisize, mpirank;
+  int                 width, bytes, steps, work_length;
+  int                 i, q, s, num_receivers;
+  int                *receivers;
+  size_t             *sizes;
+  char               *sendbuf, *recvbuf;
+  double              elapsed, sum, *work;
+  sc_MPI_Request     *requests;
+  sc_exchange_method_t method;
+  sc_exchange_t      *ex;
+  sc_options_t       *opt;
+  const char         *names[SC_EXCHANGE_METHOD_LAST] =
+    { "persistent", "neighbor" };
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'w', "width", &width, 2,
+                      "Number of neighbors on either side");
+  sc_options_add_int (opt, 'b', "bytes", &bytes, 4096,
+                      "Bytes per halo message");
+  sc_options_add_int (opt, 's', "steps", &steps, 1000,
+                      "Number of exchanges");
+  sc_options_add_int (opt, 'c', "compute", &work_length, 1 << 16,
+                      "Interior work per step for the overlap");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || width < 0 || bytes < 0 || steps <= 0 ||
+      work_length < 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* the periodic neighbors other than ourselves in ascending order */
+  receivers = SC_ALLOC (int, mpisize);
+  sizes = SC_ALLOC (size_t, mpisize);
+  num_receivers = 0;
+  for (q = 0; q < mpisize; ++q) {
+    s = (q - mpirank + mpisize) % mpisize;
+    if (q != mpirank && (s <= width || s >= mpisize - width)) {
+      receivers[num_receivers] = q;
+      sizes[num_receivers++] = (size_t) bytes;
+    }
+  }
+  work = SC_ALLOC_ZERO (double, work_length);
+  sum = 0.;
+
+  /* the symmetric pattern is its own sender list */
+  sendbuf = SC_ALLOC_ZERO (char, num_receivers * (size_t) bytes);
+  recvbuf = SC_ALLOC (char, num_receivers * (size_t) bytes);
+  requests = SC_ALLOC (sc_MPI_Request, 2 * num_receivers);
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  elapsed = -sc_MPI_Wtime ();
+  for (s = 0; s < steps; ++s) {
+    for (i = 0; i < num_receivers; ++i) {
+      mpiret = sc_MPI_Irecv (recvbuf + i * (size_t) bytes, bytes,
+                             sc_MPI_BYTE, receivers[i], SC_TAG_FIRST,
+                             sc_MPI_COMM_WORLD, requests + i);
+      SC_CHECK_MPI (mpiret);
+    }
+    for (i = 0; i < num_receivers; ++i) {
+      mpiret = sc_MPI_Isend (sendbuf + i * (size_t) bytes, bytes,
+                             sc_MPI_BYTE, receivers[i], SC_TAG_FIRST,
+                             sc_MPI_COMM_WORLD,
+                             requests + num_receivers + i);
+      SC_CHECK_MPI (mpiret);
+    }
+    mpiret = sc_MPI_Waitall (2 * num_receivers, requests,
+                             sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  elapsed += sc_MPI_Wtime ();
+  elapsed = exchange_max (elapsed);
+  SC_GLOBAL_STATISTICSF ("Exchange hand-coded %g us per step\n",
+                         1e6 * elapsed / steps);
+  SC_FREE (requests);
+  SC_FREE (sendbuf);
+  SC_FREE (recvbuf);
+
+  for (method = SC_EXCHANGE_PERSISTENT; method < SC_EXCHANGE_METHOD_LAST;
+       ++method) {
+    ex = sc_exchange_new (sc_MPI_COMM_WORLD, num_receivers, receivers,
+                          sizes, num_receivers, receivers, sizes, method);
+    if (ex->method != method) {
+      SC_GLOBAL_PRODUCTIONF ("Method %s not available\n", names[method]);
+      sc_exchange_destroy (ex);
+      continue;
+    }
+
+    mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    for (s = 0; s < steps; ++s) {
+      sc_exchange_execute (ex, NULL, NULL, NULL);
+    }
+    elapsed += sc_MPI_Wtime ();
+    elapsed = exchange_max (elapsed);
+    SC_GLOBAL_STATISTICSF ("Exchange %s %g us per step\n", names[method],
+                           1e6 * elapsed / steps);
+
+    /* compute after the exchange and while it is in flight */
+    mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    for (s = 0; s < steps; ++s) {
+      sc_exchange_execute (ex, NULL, NULL, NULL);
+      sum += exchange_compute (work, work_length);
+    }
+    elapsed += sc_MPI_Wtime ();
+    elapsed = exchange_max (elapsed);
+    SC_GLOBAL_STATISTICSF ("Exchange %s then compute %g us per step\n",
+                           names[method], 1e6 * elapsed / steps);
+
+    mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    for (s = 0; s < steps; ++s) {
+      sc_exchange_begin (ex, NULL, NULL);
+      sum += exchange_compute (work, work_length);
+      sc_exchange_end (ex, NULL, NULL);
+    }
+    elapsed += sc_MPI_Wtime ();
+    elapsed = exchange_max (elapsed);
+    SC_GLOBAL_STATISTICSF ("Exchange %s overlapped %g us per step\n",
+                           names[method], 1e6 * elapsed / steps);
+    sc_exchange_destroy (ex);
+  }
+  SC_GLOBAL_VERBOSEF ("Checksum %g\n", sum);
+
+  SC_FREE (work);
+  SC_FREE (receivers);
+  SC_FREE (sizes);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the lookup of parameters in a key-value container by string
+ * with the lookup by prehashed keys.  The keys are prehashed from the
+ * strings used to create the entries, or from copies of them, in which
+ * case every successful lookup still compares the strings once.
+ * We run the comparison for the hash and the flat storage and time the
+ * iteration through all entries as well. */
+
+#include <sc_keyvalue.h>
+#include <sc_options.h>
+
+#define KEYVALUE_NAME_LENGTH 32
+
+/** Add the value of a double entry to a sum. */
+static int
+keyvalue_sum (const char *key, const sc_keyvalue_entry_type_t type,
+              void *entry, const void *u)
+{
+  *(double *) u += *(double *) entry;
+  return 1;
+}
+
+/** Iterate through all entries and return nanoseconds per entry. */
+static double
+keyvalue_time_foreach (sc_keyvalue_t * kv, int num_keys, int num_lookups,
+                       int repetitions, double *sum)
+{
+  int                 r, i;
+  double              elapsed, best;
+
+  best = -1.;
+  *sum = 0.;
+  for (r = 0; r < repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    for (i = 0; i < num_lookups; i += num_keys) {
+      sc_keyvalue_foreach (kv, keyvalue_sum, sum);
+    }
+    elapsed += sc_MPI_Wtime ();
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+
+  return num_lookups > 0 ? 1e9 * best / num_lookups : 0.;
+}
+
+/** Look up all keys repeatedly and return nanoseconds per lookup. */
+static double
+keyvalue_time (sc_keyvalue_t * kv, int mode, int num_keys, int num_lookups,
+               int repetitions, const char *copies,
+               sc_keyvalue_key_t * keys, sc_keyvalue_key_t * copy_keys,
+               double *sum)
+{
+  int                 r, i, k;
+  double              elapsed, best;
+
+  best = -1.;
+  *sum = 0.;
+  for (r = 0; r < repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    for (i = 0; i < num_lookups; ++i) {
+      k = i % num_keys;
+      switch (mode) {
+      case 0:
+        *sum += sc_keyvalue_get_double (kv, copies +
+                                        k * KEYVALUE_NAME_LENGTH, 0.);
+        break;
+      case 1:
+        *sum += sc_keyvalue_get_double_key (kv, keys + k, 0.);
+        break;
+      default:
+        *sum += sc_keyvalue_get_double_key (kv, copy_keys + k, 0.);
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+
+  return num_lookups > 0 ? 1e9 * best / num_lookups : 0.;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 num_keys, num_lookups, repetitions;
+  int                 k, mode, storage;
+  double              ns, sum, expected;
+  char               *names, *copies;
+  const char         *labels[3] =
+    { "string", "prehashed key", "prehashed copy" };
+  const char         *storages[2] = { "hash", "flat" };
+  sc_keyvalue_key_t  *keys, *copy_keys;
+  sc_keyvalue_t      *kv;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'k', "num-keys", &num_keys, 32,
+                      "Number of entries in the container");
+  sc_options_add_int (opt, 'N', "num-lookups", &num_lookups, 1000000,
+                      "Number of lookups per repetition");
+  sc_options_add_int (opt, 'r', "repetitions", &repetitions, 5,
+                      "Number of repetitions, we report the fastest");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || num_keys <= 0 || num_lookups < 0 ||
+      repetitions <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* parameter names of typical length and their copies */
+  names = SC_ALLOC (char, num_keys * KEYVALUE_NAME_LENGTH);
+  copies = SC_ALLOC (char, num_keys * KEYVALUE_NAME_LENGTH);
+  keys = SC_ALLOC (sc_keyvalue_key_t, num_keys);
+  copy_keys = SC_ALLOC (sc_keyvalue_key_t, num_keys);
+  for (k = 0; k < num_keys; ++k) {
+    snprintf (names + k * KEYVALUE_NAME_LENGTH, KEYVALUE_NAME_LENGTH,
+              "solver_parameter_%d", k);
+    strcpy (copies + k * KEYVALUE_NAME_LENGTH,
+            names + k * KEYVALUE_NAME_LENGTH);
+    sc_keyvalue_key_init (keys + k, names + k * KEYVALUE_NAME_LENGTH);
+    sc_keyvalue_key_init (copy_keys + k, copies + k * KEYVALUE_NAME_LENGTH);
+  }
+
+  /* every lookup must find its value */
+  expected = 0.;
+  for (k = 0; k < num_lookups; ++k) {
+    expected += k % num_keys;
+  }
+  for (storage = 0; storage < 2; ++storage) {
+    kv = sc_keyvalue_new_storage (storage == 0 ? SC_KEYVALUE_STORAGE_HASH :
+                                  SC_KEYVALUE_STORAGE_FLAT);
+    for (k = 0; k < num_keys; ++k) {
+      sc_keyvalue_set_double (kv, names + k * KEYVALUE_NAME_LENGTH, k);
+    }
+    SC_GLOBAL_STATISTICSF ("Storage %s memory %llu bytes\n",
+                           storages[storage], (unsigned long long)
+                           sc_keyvalue_memory_used (kv));
+    for (mode = 0; mode < 3; ++mode) {
+      ns = keyvalue_time (kv, mode, num_keys, num_lookups, repetitions,
+                          copies, keys, copy_keys, &sum);
+      SC_CHECK_ABORT (sum == repetitions * expected, "Lookup result");
+      SC_GLOBAL_STATISTICSF ("Storage %s lookup by %s %g ns\n",
+                             storages[storage], labels[mode], ns);
+    }
+    ns = keyvalue_time_foreach (kv, num_keys, num_lookups, repetitions,
+                                &sum);
+    SC_GLOBAL_STATISTICSF ("Storage %s iteration %g ns per entry\n",
+                           storages[storage], ns);
+    sc_keyvalue_destroy (kv);
+  }
+
+  SC_FREE (copy_keys);
+  SC_FREE (keys);
+  SC_FREE (copies);
+  SC_FREE (names);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,152 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Measure the cost of log calls that write nothing: those below the
+ * runtime threshold of their package and those held back by a rate limit.
+ * For comparison we time formatting the same message into a buffer, which
+ * is what a suppressed call costs if the threshold is checked too late. */
+
+#include <sc_options.h>
+
+static int          timing_package_id = -1;
+static long         timing_written = 0;
+
+/** A log handler that only counts the messages. */
+static void
+timing_log_handler (FILE * log_stream, const char *filename, int lineno,
+                    int package, int category, int priority, const char *msg)
+{
+  ++timing_written;
+}
+
+/** Time a loop of log calls and return nanoseconds per call. */
+static double
+timing_calls (int mode, int num_calls, int repetitions)
+{
+  int                 r, i;
+  double              elapsed, best;
+  char                buffer[BUFSIZ];
+
+  best = -1.;
+  for (r = 0; r < repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    switch (mode) {
+    case 0:
+      for (i = 0; i < num_calls; ++i) {
+        SC_GEN_LOGF (timing_package_id, SC_LC_NORMAL, SC_LP_PRODUCTION,
+                     "Iteration %d value %g name %s\n", i, i * .5, "timing");
+      }
+      break;
+    case 1:
+      for (i = 0; i < num_calls; ++i) {
+        sc_logf (__FILE__, __LINE__, timing_package_id, SC_LC_NORMAL,
+                 SC_LP_PRODUCTION, "Iteration %d value %g name %s\n",
+                 i, i * .5, "timing");
+      }
+      break;
+    case 2:
+      for (i = 0; i < num_calls; ++i) {
+        snprintf (buffer, BUFSIZ, "Iteration %d value %g name %s\n",
+                  i, i * .5, "timing");
+      }
+      break;
+    default:
+      for (i = 0; i < num_calls; ++i) {
+        SC_GEN_LOGF (timing_package_id, SC_LC_NORMAL, SC_LP_ESSENTIAL,
+                     "Iteration %d value %g name %s\n", i, i * .5, "timing");
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+
+  return num_calls > 0 ? 1e9 * best / num_calls : 0.;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 num_calls, repetitions;
+  double              ns;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'N', "num-calls", &num_calls, 1000000,
+                      "Number of log calls per repetition");
+  sc_options_add_int (opt, 'r', "repetitions", &repetitions, 5,
+                      "Number of repetitions, we report the fastest");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || num_calls < 0 || repetitions <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* messages of priority PRODUCTION are below this package's threshold */
+  timing_package_id = sc_package_register (timing_log_handler,
+                                           SC_LP_ESSENTIAL, "timing",
+                                           "Log timing");
+
+  ns = timing_calls (0, num_calls, repetitions);
+  SC_GLOBAL_STATISTICSF ("Suppressed by threshold in macro %g ns\n", ns);
+  ns = timing_calls (1, num_calls, repetitions);
+  SC_GLOBAL_STATISTICSF ("Suppressed by threshold in sc_logf %g ns\n", ns);
+  ns = timing_calls (2, num_calls, repetitions);
+  SC_GLOBAL_STATISTICSF ("Formatting the message alone %g ns\n", ns);
+  ns = timing_calls (3, num_calls, repetitions);
+  SC_GLOBAL_STATISTICSF ("Written to a counting handler %g ns\n", ns);
+  SC_CHECK_ABORT (timing_written == (long) num_calls * repetitions,
+                  "Written message count");
+
+  /* the threshold passes, but one message per hour gets through */
+  sc_package_set_log_rate (timing_package_id, SC_LC_NORMAL, 3600.);
+  timing_written = 0;
+  ns = timing_calls (3, num_calls, repetitions);
+  SC_GLOBAL_STATISTICSF ("Suppressed by rate limit %g ns\n", ns);
+  SC_CHECK_ABORT (timing_written == (num_calls > 0),
+                  "Rate limited message count");
+
+  /* reports the messages suppressed by the rate limit */
+  sc_package_unregister (timing_package_id);
+  SC_CHECK_ABORT (timing_written ==
+                  1 + ((long) num_calls * repetitions > 1),
+                  "Rate limit report count");
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
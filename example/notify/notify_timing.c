@@ -0,0 +1,135 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Time the sparse exchange of variable-size payloads to random receivers.
+ * We compare the nonblocking consensus in sc_notify_payloadv with the
+ * approach of calling sc_notify followed by rounds of sizes and data. */
+
+#include <sc_notify.h>
+#include <sc_options.h>
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 mpisize, mpirank;
+  int                 num_receivers, max_bytes, repetitions;
+  int                 i, k, r, method;
+  double              elapsed, best, result;
+  sc_array_t          receivers, payloads, senders, recv_payloads;
+  sc_array_t         *payload;
+  sc_options_t       *opt;
+  const char         *names[2] = { "nonblocking consensus",
+    "notify then sizes and data"
+  };
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'k', "num-receivers", &num_receivers, 8,
+                      "Number of random receivers per process");
+  sc_options_add_int (opt, 'b', "max-bytes", &max_bytes, 1024,
+                      "Maximum payload size in bytes");
+  sc_options_add_int (opt, 'r', "repetitions", &repetitions, 100,
+                      "Number of repetitions, we report the fastest");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || num_receivers < 0 || max_bytes <= 0 ||
+      repetitions <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* distinct random receivers in ascending order */
+  srand (mpirank + 1);
+  sc_array_init (&receivers, sizeof (int));
+  for (i = 0; i < mpisize; ++i) {
+    if (rand () % mpisize < num_receivers) {
+      *(int *) sc_array_push (&receivers) = i;
+    }
+  }
+  sc_array_init_size (&payloads, sizeof (sc_array_t), receivers.elem_count);
+  for (i = 0; i < (int) receivers.elem_count; ++i) {
+    payload = (sc_array_t *) sc_array_index_int (&payloads, i);
+    sc_array_init_size (payload, 1, (size_t) (1 + rand () % max_bytes));
+    memset (payload->array, i, payload->elem_count);
+  }
+  sc_array_init (&senders, sizeof (int));
+  sc_array_init (&recv_payloads, sizeof (sc_array_t));
+
+  for (method = 0; method < 2; ++method) {
+    best = -1.;
+    for (r = 0; r < repetitions; ++r) {
+      mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+      SC_CHECK_MPI (mpiret);
+      elapsed = -sc_MPI_Wtime ();
+      if (method == 0) {
+        mpiret = sc_notify_payloadv (&receivers, &payloads, &senders,
+                                     &recv_payloads, 1, sc_MPI_COMM_WORLD);
+      }
+      else {
+        mpiret = sc_notify_payloadv_rounds (&receivers, &payloads, &senders,
+                                            &recv_payloads, 1,
+                                            sc_MPI_COMM_WORLD);
+      }
+      SC_CHECK_MPI (mpiret);
+      elapsed += sc_MPI_Wtime ();
+      for (k = 0; k < (int) recv_payloads.elem_count; ++k) {
+        sc_array_reset ((sc_array_t *) sc_array_index_int (&recv_payloads,
+                                                           k));
+      }
+      mpiret = sc_MPI_Allreduce (&elapsed, &result, 1, sc_MPI_DOUBLE,
+                                 sc_MPI_MAX, sc_MPI_COMM_WORLD);
+      SC_CHECK_MPI (mpiret);
+      best = (r == 0 || result < best) ? result : best;
+    }
+    SC_GLOBAL_STATISTICSF ("Payloads by %s %g us\n", names[method],
+                           1e6 * best);
+  }
+
+  for (i = 0; i < (int) payloads.elem_count; ++i) {
+    sc_array_reset ((sc_array_t *) sc_array_index_int (&payloads, i));
+  }
+  sc_array_reset (&payloads);
+  sc_array_reset (&receivers);
+  sc_array_reset (&senders);
+  sc_array_reset (&recv_payloads);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
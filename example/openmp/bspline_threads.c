@@ -0,0 +1,162 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Measure how the evaluation of a single shared B-spline scales with the
+ * number of threads.  Every thread uses its own sc_bspline_eval_t. */
+
+#include <sc_bspline.h>
+#include <sc_options.h>
+#include <omp.h>
+
+/** Evaluate the spline at all parameters and return the minimum time. */
+static double
+bspline_threads_time (const sc_bspline_t * bs, sc_bspline_eval_t ** evs,
+                      int n_threads, int batch, int repetitions,
+                      int num_t, const double *t, double *result)
+{
+  int                 r;
+  double              elapsed, tmin;
+
+  tmin = -1.;
+  for (r = 0; r < repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+#pragma omp parallel num_threads (n_threads)
+    {
+      const int           tid = omp_get_thread_num ();
+      int                 j, begin, end;
+
+      if (batch) {
+        begin = (int) (((long) num_t * tid) / n_threads);
+        end = (int) (((long) num_t * (tid + 1)) / n_threads);
+        sc_bspline_derivative_n_batch_r (bs, evs[tid], 0, end - begin,
+                                         t + begin, result + begin * bs->d);
+      }
+      else {
+#pragma omp for schedule (static)
+        for (j = 0; j < num_t; ++j) {
+          sc_bspline_evaluate_r (bs, evs[tid], t[j], result + j * bs->d);
+        }
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    if (tmin < 0. || elapsed < tmin) {
+      tmin = elapsed;
+    }
+  }
+
+  return tmin;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 n, d, p, num_t, repetitions, max_threads;
+  int                 i, k, n_threads, batch;
+  double             *t, *result;
+  double              tone[2], tnow;
+  sc_dmatrix_t       *points;
+  sc_bspline_t       *bs;
+  sc_bspline_eval_t **evs;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'n', "degree", &n, 3, "Polynomial degree");
+  sc_options_add_int (opt, 'd', "dimension", &d, 3, "Dimension of points");
+  sc_options_add_int (opt, 'p', "points", &p, 1000,
+                      "Number of control points");
+  sc_options_add_int (opt, 'N', "num-evals", &num_t, 1 << 20,
+                      "Number of evaluations");
+  sc_options_add_int (opt, 'R', "repetitions", &repetitions, 5,
+                      "Number of repetitions");
+  sc_options_add_int (opt, 'T', "max-threads", &max_threads,
+                      omp_get_max_threads (), "Maximum number of threads");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || n < 0 || d <= 0 || p <= n || num_t <= 0 ||
+      repetitions <= 0 || max_threads <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* one spline shared by all threads */
+  points = sc_dmatrix_new (p, d);
+  for (i = 0; i < p; ++i) {
+    for (k = 0; k < d; ++k) {
+      points->e[i][k] = rand () / (double) RAND_MAX;
+    }
+  }
+  bs = sc_bspline_new (n, points, NULL, NULL);
+
+  t = SC_ALLOC (double, num_t);
+  for (i = 0; i < num_t; ++i) {
+    t[i] = i / (double) (num_t - 1);
+  }
+  result = SC_ALLOC (double, (size_t) num_t * d);
+  evs = SC_ALLOC (sc_bspline_eval_t *, max_threads);
+  for (i = 0; i < max_threads; ++i) {
+    evs[i] = sc_bspline_eval_new (bs);
+  }
+
+  tone[0] = tone[1] = 0.;
+  for (n_threads = 1;; n_threads = SC_MIN (2 * n_threads, max_threads)) {
+    for (batch = 0; batch < 2; ++batch) {
+      tnow = bspline_threads_time (bs, evs, n_threads, batch, repetitions,
+                                   num_t, t, result);
+      if (n_threads == 1) {
+        tone[batch] = tnow;
+      }
+      SC_GLOBAL_STATISTICSF ("%s threads %d time %g speedup %g\n",
+                             batch ? "Batch" : "Pointwise", n_threads,
+                             tnow, tone[batch] / tnow);
+    }
+    if (n_threads == max_threads) {
+      break;
+    }
+  }
+
+  for (i = 0; i < max_threads; ++i) {
+    sc_bspline_eval_destroy (evs[i]);
+  }
+  SC_FREE (evs);
+  SC_FREE (result);
+  SC_FREE (t);
+  sc_bspline_destroy (bs);
+  sc_dmatrix_destroy (points);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
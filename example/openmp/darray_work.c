@@ -0,0 +1,142 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Measure the memory bandwidth of per-thread workspace blocks.
+ * To place the threads on distinct sockets, pin them through the OpenMP
+ * runtime, for example with OMP_PROC_BIND=spread OMP_PLACES=cores. */
+
+#include <sc_dmatrix.h>
+#include <sc_options.h>
+#include <omp.h>
+
+/** Sweep over all blocks of the calling thread and return the bytes moved. */
+static double
+darray_work_sweep (sc_darray_work_t * work, int thread, int n_sweeps)
+{
+  const int           n_blocks = sc_darray_work_get_blockcount (work);
+  const int           n_entries = sc_darray_work_get_blocksize (work);
+  int                 r, b, i;
+  double             *workd;
+
+  for (r = 0; r < n_sweeps; ++r) {
+    for (b = 0; b < n_blocks; ++b) {
+      workd = sc_darray_work_get (work, thread, b);
+      for (i = 0; i < n_entries; ++i) {
+        workd[i] = .5 * workd[i] + 1.;
+      }
+    }
+  }
+
+  /* every entry is read and written once per sweep */
+  return 2. * sizeof (double) * n_sweeps * n_blocks * n_entries;
+}
+
+/** Run the sweeps on all threads and report bandwidth and placement. */
+static void
+darray_work_run (sc_darray_work_t * work, int n_threads, int n_sweeps,
+                 const char *name)
+{
+  int                 t, node;
+  double              elapsed, bytes;
+
+  bytes = 0.;
+  elapsed = -sc_MPI_Wtime ();
+#pragma omp parallel num_threads (n_threads) reduction (+:bytes)
+  {
+    bytes += darray_work_sweep (work, omp_get_thread_num (), n_sweeps);
+  }
+  elapsed += sc_MPI_Wtime ();
+
+  SC_GLOBAL_STATISTICSF ("%s: %g s, %g GB/s\n", name, elapsed,
+                         bytes / elapsed * 1.e-9);
+  for (t = 0; t < n_threads; ++t) {
+    node = sc_darray_work_get_numa_node (work, t);
+    SC_GLOBAL_VERBOSEF ("%s: thread %d memory on NUMA node %d\n",
+                        name, t, node);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 n_threads, n_blocks, n_entries, n_sweeps;
+  int                 t;
+  sc_darray_work_t   *work;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'T', "num-threads", &n_threads,
+                      omp_get_max_threads (), "Number of threads");
+  sc_options_add_int (opt, 'B', "num-blocks", &n_blocks, 8,
+                      "Number of blocks per thread");
+  sc_options_add_int (opt, 'N', "num-entries", &n_entries, 1 << 18,
+                      "Number of entries per block");
+  sc_options_add_int (opt, 'S', "num-sweeps", &n_sweeps, 20,
+                      "Number of sweeps over all blocks");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || n_threads <= 0 || n_blocks <= 0 ||
+      n_entries <= 0 || n_sweeps <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+  if (omp_get_proc_bind () == omp_proc_bind_false) {
+    SC_GLOBAL_PRODUCTION ("Threads are not pinned; "
+                          "consider setting OMP_PROC_BIND\n");
+  }
+
+  /* the allocating thread touches all memory */
+  work = sc_darray_work_new (n_threads, n_blocks, n_entries, 64);
+  for (t = 0; t < n_threads; ++t) {
+    sc_darray_work_first_touch (work, t);
+  }
+  darray_work_run (work, n_threads, n_sweeps, "Serial first touch");
+  sc_darray_work_destroy (work);
+
+  /* every thread touches its own pages */
+  work = sc_darray_work_new_numa (n_threads, n_blocks, n_entries, 64);
+#pragma omp parallel num_threads (n_threads)
+  {
+    sc_darray_work_first_touch (work, omp_get_thread_num ());
+  }
+  darray_work_run (work, n_threads, n_sweeps, "Parallel first touch");
+  sc_darray_work_destroy (work);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Time the overlap of large halo messages with computation.  Many MPI
+ * implementations send large messages by a rendezvous protocol that only
+ * moves forward inside MPI calls, so begin/compute/end alone may not
+ * overlap at all.  We compare the exchange followed by the computation,
+ * the plain split exchange, the split exchange with calls to
+ * sc_mpi_progress between chunks of the computation, and the split
+ * exchange driven by the background progress thread. */
+
+#include <sc_exchange.h>
+#include <sc_options.h>
+
+typedef enum progress_mode
+{
+  PROGRESS_SEQUENTIAL,
+  PROGRESS_SPLIT,
+  PROGRESS_MANUAL,
+  PROGRESS_THREAD,
+  PROGRESS_MODE_LAST
+}
+progress_mode_t;
+
+/** A stand-in for the work on the interior of the domain. */
+static double
+progress_compute (double *work, int length)
+{
+  int                 i;
+  double              sum = 0.;
+
+  for (i = 0; i < length; ++i) {
+    work[i] = .5 * work[i] + 1.;
+    sum += work[i];
+  }
+  return sum;
+}
+
+static double
+progress_max (double value)
+{
+  int                 mpiret;
+  double              result;
+
+  mpiret = sc_MPI_Allreduce (&value, &result, 1, sc_MPI_DOUBLE, sc_MPI_MAX,
+                             sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  return result;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 mpisize, mpirank, provided;
+  int                 width, bytes, steps, work_length, chunks;
+  int                 c, chunk, q, s, num_receivers;
+  int                *receivers;
+  size_t             *sizes;
+  double              elapsed, sum, interval, *work;
+  progress_mode_t     mode;
+  sc_exchange_t      *ex;
+  sc_options_t       *opt;
+  const char         *names[PROGRESS_MODE_LAST] =
+    { "sequential", "split", "manual progress", "progress thread" };
+
+  mpiret = sc_MPI_Init_thread (&argc, &argv, sc_MPI_THREAD_MULTIPLE,
+                               &provided);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'w', "width", &width, 1,
+                      "Number of neighbors on either side");
+  sc_options_add_int (opt, 'b', "bytes", &bytes, 1 << 22,
+                      "Bytes per halo message");
+  sc_options_add_int (opt, 's', "steps", &steps, 20,
+                      "Number of exchanges");
+  sc_options_add_int (opt, 'c', "compute", &work_length, 1 << 22,
+                      "Interior work per step");
+  sc_options_add_int (opt, 'k', "chunks", &chunks, 64,
+                      "Number of pieces of work between progress calls");
+  sc_options_add_double (opt, 'i', "interval", &interval, 1e-5,
+                         "Sleep time of the progress thread in seconds");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || width < 0 || bytes < 0 || steps <= 0 ||
+      work_length < 0 || chunks <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* the periodic neighbors other than ourselves in ascending order */
+  receivers = SC_ALLOC (int, mpisize);
+  sizes = SC_ALLOC (size_t, mpisize);
+  num_receivers = 0;
+  for (q = 0; q < mpisize; ++q) {
+    s = (q - mpirank + mpisize) % mpisize;
+    if (q != mpirank && (s <= width || s >= mpisize - width)) {
+      receivers[num_receivers] = q;
+      sizes[num_receivers++] = (size_t) bytes;
+    }
+  }
+  work = SC_ALLOC_ZERO (double, work_length);
+  chunk = (work_length + chunks - 1) / chunks;
+  sum = 0.;
+
+  /* the symmetric pattern is its own sender list */
+  ex = sc_exchange_new (sc_MPI_COMM_WORLD, num_receivers, receivers,
+                        sizes, num_receivers, receivers, sizes,
+                        SC_EXCHANGE_PERSISTENT);
+
+  /* the computation alone is the lower bound for perfect overlap */
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  elapsed = -sc_MPI_Wtime ();
+  for (s = 0; s < steps; ++s) {
+    sum += progress_compute (work, work_length);
+  }
+  elapsed += sc_MPI_Wtime ();
+  elapsed = progress_max (elapsed);
+  SC_GLOBAL_STATISTICSF ("Compute only %g us per step\n",
+                         1e6 * elapsed / steps);
+
+  for (mode = PROGRESS_SEQUENTIAL; mode < PROGRESS_MODE_LAST; ++mode) {
+    if (mode == PROGRESS_THREAD &&
+        !sc_mpi_progress_thread_start (interval)) {
+      SC_GLOBAL_PRODUCTION ("Progress thread not available\n");
+      continue;
+    }
+
+    mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    for (s = 0; s < steps; ++s) {
+      if (mode == PROGRESS_SEQUENTIAL) {
+        sc_exchange_execute (ex, NULL, NULL, NULL);
+        sum += progress_compute (work, work_length);
+        continue;
+      }
+      sc_exchange_begin (ex, NULL, NULL);
+      for (c = 0; c < work_length; c += chunk) {
+        sum += progress_compute (work + c, SC_MIN (chunk, work_length - c));
+        if (mode == PROGRESS_MANUAL) {
+          sc_mpi_progress ();
+        }
+      }
+      sc_exchange_end (ex, NULL, NULL);
+    }
+    elapsed += sc_MPI_Wtime ();
+    elapsed = progress_max (elapsed);
+    SC_GLOBAL_STATISTICSF ("Exchange %s %g us per step\n", names[mode],
+                           1e6 * elapsed / steps);
+
+    if (mode == PROGRESS_THREAD) {
+      sc_mpi_progress_thread_stop ();
+    }
+  }
+  SC_GLOBAL_VERBOSEF ("Checksum %g\n", sum);
+
+  sc_exchange_destroy (ex);
+  SC_FREE (work);
+  SC_FREE (receivers);
+  SC_FREE (sizes);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
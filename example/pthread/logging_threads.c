@@ -0,0 +1,188 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the throughput of the default log handler, which flushes the
+ * stream after every message, with the buffered log handler. */
+
+#include <pthread.h>
+#include <sc_options.h>
+
+typedef struct logging_thread
+{
+  pthread_t           thread;
+  int                 id;
+  int                 num_messages;
+}
+logging_thread_t;
+
+static void        *
+logging_thread_run (void *v)
+{
+  logging_thread_t   *lt = (logging_thread_t *) v;
+  int                 i;
+
+  for (i = 0; i < lt->num_messages; ++i) {
+    SC_PRODUCTIONF ("Message %d of thread %d\n", i, lt->id);
+  }
+
+  return v;
+}
+
+/** Log from several threads at once and return the elapsed time. */
+static double
+logging_threads_time (int num_threads, int num_messages)
+{
+  int                 i, pth;
+  double              elapsed;
+  logging_thread_t   *lt;
+
+  lt = SC_ALLOC (logging_thread_t, num_threads);
+  elapsed = -sc_MPI_Wtime ();
+  for (i = 0; i < num_threads; ++i) {
+    lt[i].id = i;
+    lt[i].num_messages = num_messages;
+    pth = pthread_create (&lt[i].thread, NULL, logging_thread_run, lt + i);
+    SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+  }
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_join (lt[i].thread, NULL);
+    SC_CHECK_ABORT (pth == 0, "Fail in pthread_join");
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_FREE (lt);
+
+  return elapsed;
+}
+
+/** Count the lines of a file. */
+static long
+logging_count_lines (const char *filename)
+{
+  int                 c;
+  long                lines;
+  FILE               *file;
+
+  file = fopen (filename, "rb");
+  SC_CHECK_ABORTF (file != NULL, "Open %s", filename);
+  lines = 0;
+  while ((c = fgetc (file)) != EOF) {
+    lines += (c == '\n');
+  }
+  fclose (file);
+
+  return lines;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, mpithr, rank;
+  int                 first_arg;
+  int                 max_threads, num_messages, buffer_size;
+  int                 num_threads, async;
+  long                lines;
+  double              interval, elapsed;
+  const char         *prefix;
+  char                filename[BUFSIZ];
+  FILE               *file;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init_thread (&argc, &argv, sc_MPI_THREAD_MULTIPLE, &mpithr);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'T', "max-threads", &max_threads, 4,
+                      "Maximum number of threads");
+  sc_options_add_int (opt, 'N', "num-messages", &num_messages, 100000,
+                      "Number of messages per thread");
+  sc_options_add_int (opt, 'b', "buffer-size", &buffer_size, 0,
+                      "Buffer size per thread in bytes (0 for default)");
+  sc_options_add_double (opt, 'i', "interval", &interval, .1,
+                         "Seconds between background writes");
+  sc_options_add_string (opt, 'f', "prefix", &prefix, "sc_logging_threads",
+                         "Prefix of the log files");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || max_threads <= 0 || num_messages < 0 ||
+      buffer_size < 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+  if (mpithr < sc_MPI_THREAD_MULTIPLE) {
+    SC_GLOBAL_PRODUCTIONF ("MPI thread support is only %d\n", mpithr);
+  }
+
+  for (num_threads = 1;; num_threads = SC_MIN (2 * num_threads,
+                                               max_threads)) {
+    for (async = 0; async < 2; ++async) {
+      snprintf (filename, BUFSIZ, "%s_%s_%d", prefix,
+                async ? "async" : "sync", num_threads);
+      if (async) {
+        elapsed = -sc_MPI_Wtime ();
+        sc_log_async_begin (filename, (size_t) buffer_size, interval);
+        elapsed += logging_threads_time (num_threads, num_messages);
+        sc_log_async_end ();
+        elapsed += sc_MPI_Wtime ();
+      }
+      else {
+        /* the default handler writing to a file of its own */
+        snprintf (filename + strlen (filename), BUFSIZ - strlen (filename),
+                  ".%d.log", rank);
+        file = fopen (filename, "wb");
+        SC_CHECK_ABORTF (file != NULL, "Open %s", filename);
+        sc_set_log_defaults (file, NULL, SC_LP_DEFAULT);
+        elapsed = logging_threads_time (num_threads, num_messages);
+        sc_set_log_defaults (NULL, NULL, SC_LP_DEFAULT);
+        fclose (file);
+      }
+      if (async) {
+        snprintf (filename + strlen (filename), BUFSIZ - strlen (filename),
+                  ".%d.log", rank);
+      }
+      lines = logging_count_lines (filename);
+      SC_CHECK_ABORTF (lines == (long) num_threads * num_messages,
+                       "Lines in %s: %ld", filename, lines);
+      SC_GLOBAL_STATISTICSF ("%s threads %d messages/s %g\n",
+                             async ? "Buffered" : "Default", num_threads,
+                             num_threads * (double) num_messages / elapsed);
+    }
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the cost of sharing one reference counter between threads with
+ * the atomic functions and with the plain functions behind a mutex.  Every
+ * thread takes and drops a reference in a tight loop, which is the worst
+ * case of contention on a shared read-only object. */
+
+#include <pthread.h>
+#include <sc_options.h>
+#include <sc_refcount.h>
+
+typedef struct refcount_shared
+{
+  sc_refcount_t       rc;
+  pthread_mutex_t     mutex;
+  int                 use_atomic;
+  int                 num_iterations;
+}
+refcount_shared_t;
+
+static void        *
+refcount_thread_run (void *v)
+{
+  refcount_shared_t  *rs = (refcount_shared_t *) v;
+  int                 i, last;
+
+  for (i = 0; i < rs->num_iterations; ++i) {
+    if (rs->use_atomic) {
+      sc_refcount_ref_atomic (&rs->rc);
+      last = sc_refcount_unref_atomic (&rs->rc);
+    }
+    else {
+      pthread_mutex_lock (&rs->mutex);
+      sc_refcount_ref (&rs->rc);
+      last = sc_refcount_unref (&rs->rc);
+      pthread_mutex_unlock (&rs->mutex);
+    }
+    SC_CHECK_ABORT (!last, "Reference count dropped to zero");
+  }
+
+  return NULL;
+}
+
+/** Run the threads on one counter and return the elapsed time. */
+static double
+refcount_threads_time (refcount_shared_t * rs, int num_threads)
+{
+  int                 i, pth;
+  double              elapsed;
+  pthread_t          *threads;
+
+  threads = SC_ALLOC (pthread_t, num_threads);
+  elapsed = -sc_MPI_Wtime ();
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_create (threads + i, NULL, refcount_thread_run, rs);
+    SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+  }
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_join (threads[i], NULL);
+    SC_CHECK_ABORT (pth == 0, "Fail in pthread_join");
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_FREE (threads);
+
+  return elapsed;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 max_threads, num_threads;
+  double              elapsed;
+  refcount_shared_t   rs;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'T', "max-threads", &max_threads, 8,
+                      "Maximum number of threads");
+  sc_options_add_int (opt, 'N', "num-iterations", &rs.num_iterations,
+                      1000000, "Number of ref/unref pairs per thread");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || max_threads <= 0 || rs.num_iterations < 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* the main thread holds the reference that keeps the object alive */
+  pthread_mutex_init (&rs.mutex, NULL);
+  sc_refcount_init (&rs.rc, sc_package_id);
+  for (num_threads = 1;; num_threads = SC_MIN (2 * num_threads,
+                                               max_threads)) {
+    for (rs.use_atomic = 0; rs.use_atomic < 2; ++rs.use_atomic) {
+      elapsed = refcount_threads_time (&rs, num_threads);
+      SC_CHECK_ABORT (sc_refcount_is_last (&rs.rc), "Lost references");
+      SC_GLOBAL_STATISTICSF ("%s threads %d ns per pair %g\n",
+                             rs.use_atomic ? "Atomic" : "Mutex",
+                             num_threads, 1e9 * elapsed /
+                             ((double) num_threads * rs.num_iterations));
+    }
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+  SC_CHECK_ABORT (sc_refcount_unref_atomic (&rs.rc), "Final unref");
+  pthread_mutex_destroy (&rs.mutex);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the throughput of handing out unique integers to many threads
+ * with the original mempool-based counter behind a mutex and with the
+ * lock-free bitmap counter.  Every thread holds a batch of values and
+ * repeatedly releases and adds them. */
+
+#include <pthread.h>
+#include <sc_options.h>
+#include <sc_unique_counter.h>
+
+typedef struct unique_shared
+{
+  sc_unique_counter_t *uc;
+  sc_unique_counter_atomic_t *ua;
+  pthread_mutex_t     mutex;
+  int                 batch;
+  int                 rounds;
+}
+unique_shared_t;
+
+static void        *
+unique_thread_run (void *v)
+{
+  unique_shared_t    *us = (unique_shared_t *) v;
+  int                 j, r;
+  int               **pointers = NULL;
+  int                *values = NULL;
+
+  if (us->ua != NULL) {
+    values = SC_ALLOC (int, us->batch);
+  }
+  else {
+    pointers = SC_ALLOC (int *, us->batch);
+  }
+  for (r = 0; r < us->rounds; ++r) {
+    for (j = 0; j < us->batch; ++j) {
+      if (us->ua != NULL) {
+        values[j] = sc_unique_counter_atomic_add (us->ua);
+      }
+      else {
+        pthread_mutex_lock (&us->mutex);
+        pointers[j] = sc_unique_counter_add (us->uc);
+        pthread_mutex_unlock (&us->mutex);
+      }
+    }
+    for (j = 0; j < us->batch; ++j) {
+      if (us->ua != NULL) {
+        sc_unique_counter_atomic_release (us->ua, values[j]);
+      }
+      else {
+        pthread_mutex_lock (&us->mutex);
+        sc_unique_counter_release (us->uc, pointers[j]);
+        pthread_mutex_unlock (&us->mutex);
+      }
+    }
+  }
+  SC_FREE (values);
+  SC_FREE (pointers);
+
+  return NULL;
+}
+
+/** Run the threads on one factory and return the elapsed time. */
+static double
+unique_threads_time (unique_shared_t * us, int num_threads)
+{
+  int                 i, pth;
+  double              elapsed;
+  pthread_t          *threads;
+
+  threads = SC_ALLOC (pthread_t, num_threads);
+  elapsed = -sc_MPI_Wtime ();
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_create (threads + i, NULL, unique_thread_run, us);
+    SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+  }
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_join (threads[i], NULL);
+    SC_CHECK_ABORT (pth == 0, "Fail in pthread_join");
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_FREE (threads);
+
+  return elapsed;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 max_threads, num_threads, use_atomic;
+  double              elapsed;
+  unique_shared_t     us;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'T', "max-threads", &max_threads, 8,
+                      "Maximum number of threads");
+  sc_options_add_int (opt, 'B', "batch", &us.batch, 64,
+                      "Number of values held by a thread");
+  sc_options_add_int (opt, 'R', "rounds", &us.rounds, 10000,
+                      "Number of times a batch is added and released");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || max_threads <= 0 || us.batch <= 0 ||
+      us.rounds < 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  pthread_mutex_init (&us.mutex, NULL);
+  for (num_threads = 1;; num_threads = SC_MIN (2 * num_threads,
+                                               max_threads)) {
+    for (use_atomic = 0; use_atomic < 2; ++use_atomic) {
+      us.uc = use_atomic ? NULL : sc_unique_counter_new (0);
+      us.ua = use_atomic ? sc_unique_counter_atomic_new (0) : NULL;
+      elapsed = unique_threads_time (&us, num_threads);
+      SC_GLOBAL_STATISTICSF ("%s threads %d ns per add and release %g\n",
+                             use_atomic ? "Atomic" : "Mutex", num_threads,
+                             1e9 * elapsed / ((double) num_threads *
+                                              us.batch * us.rounds));
+      if (use_atomic) {
+        sc_unique_counter_atomic_destroy (us.ua);
+      }
+      else {
+        sc_unique_counter_destroy (us.uc);
+      }
+    }
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+  pthread_mutex_destroy (&us.mutex);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
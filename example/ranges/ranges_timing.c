@@ -0,0 +1,209 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the dense computation of communication ranges with the sparse
+ * and the bitmap variants for a large virtual number of processes and
+ * few peers.  The dense time includes filling the array of processes.
+ * Then we time sc_ranges_adaptive with sc_ranges_decode against
+ * sc_ranges_adaptive_sparse on the actual communicator. */
+
+#include <sc_options.h>
+#include <sc_ranges.h>
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 num_procs, num_peers, num_ranges, repetitions;
+  int                 r, j, k, rank, size, nwin, maxwin;
+  int                 first_peer, last_peer, num_receivers, num_senders;
+  int                *procs, *peers, *ranges, *global_ranges;
+  int                *receiver_ranks, *sender_ranks;
+  uint64_t           *bitmap;
+  double              elapsed, dense, sparse, bitmapped;
+  sc_array_t         *receivers, *senders;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &size);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'P', "num-procs", &num_procs, 100000,
+                      "Virtual number of processes");
+  sc_options_add_int (opt, 'k', "num-peers", &num_peers, 64,
+                      "Number of random peers");
+  sc_options_add_int (opt, 'n', "num-ranges", &num_ranges, 25,
+                      "Maximum number of ranges");
+  sc_options_add_int (opt, 'r', "repetitions", &repetitions, 20,
+                      "Number of repetitions, we report the fastest");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || num_procs <= 0 || num_peers < 0 ||
+      num_peers > num_procs || num_ranges <= 0 || repetitions <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* a sorted list of distinct random peers */
+  srand (17);
+  procs = SC_ALLOC_ZERO (int, num_procs);
+  peers = SC_ALLOC (int, num_procs);
+  ranges = SC_ALLOC (int, 2 * num_ranges);
+  bitmap = SC_ALLOC_ZERO (uint64_t, (num_procs + 63) / 64);
+  for (k = 0; k < num_peers;) {
+    j = rand () % num_procs;
+    if (!procs[j]) {
+      procs[j] = 1;
+      ++k;
+    }
+  }
+  for (j = k = 0; j < num_procs; ++j) {
+    if (procs[j]) {
+      peers[k++] = j;
+      bitmap[j / 64] |= (uint64_t) 1 << (j % 64);
+    }
+  }
+
+  nwin = 0;
+  dense = sparse = bitmapped = -1.;
+  for (r = 0; r < repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    memset (procs, 0, num_procs * sizeof (int));
+    first_peer = num_procs;
+    last_peer = -1;
+    for (k = 0; k < num_peers; ++k) {
+      j = peers[k];
+      procs[j] = 1;
+      if (j != 0) {
+        first_peer = SC_MIN (first_peer, j);
+        last_peer = SC_MAX (last_peer, j);
+      }
+    }
+    nwin = sc_ranges_compute (sc_package_id, num_procs, procs, 0,
+                              first_peer, last_peer, num_ranges, ranges);
+    elapsed += sc_MPI_Wtime ();
+    dense = (r == 0 || elapsed < dense) ? elapsed : dense;
+
+    elapsed = -sc_MPI_Wtime ();
+    k = sc_ranges_compute_sparse (sc_package_id, num_procs, num_peers,
+                                  peers, 0, num_ranges, ranges);
+    elapsed += sc_MPI_Wtime ();
+    sparse = (r == 0 || elapsed < sparse) ? elapsed : sparse;
+    SC_CHECK_ABORT (k == nwin, "Sparse ranges");
+
+    elapsed = -sc_MPI_Wtime ();
+    k = sc_ranges_compute_bitmap (sc_package_id, num_procs, bitmap, 0,
+                                  num_ranges, ranges);
+    elapsed += sc_MPI_Wtime ();
+    bitmapped = (r == 0 || elapsed < bitmapped) ? elapsed : bitmapped;
+    SC_CHECK_ABORT (k == nwin, "Bitmap ranges");
+  }
+  SC_GLOBAL_STATISTICSF ("Compute %d ranges dense %g us sparse %g us"
+                         " bitmap %g us\n", nwin, 1e6 * dense,
+                         1e6 * sparse, 1e6 * bitmapped);
+  SC_FREE (procs);
+  SC_FREE (peers);
+  SC_FREE (bitmap);
+
+  /* neighbors at a small random distance on the actual communicator */
+  procs = SC_ALLOC_ZERO (int, size);
+  peers = SC_ALLOC (int, size);
+  for (k = 0; k < SC_MIN (num_peers, size); ++k) {
+    j = (rank + 1 + rand () % 16) % size;
+    procs[j] = (j != rank);
+  }
+  first_peer = size;
+  last_peer = -1;
+  for (j = k = 0; j < size; ++j) {
+    if (procs[j]) {
+      peers[k++] = j;
+      first_peer = SC_MIN (first_peer, j);
+      last_peer = SC_MAX (last_peer, j);
+    }
+  }
+  num_peers = k;
+  receiver_ranks = SC_ALLOC (int, size);
+  sender_ranks = SC_ALLOC (int, size);
+  receivers = sc_array_new (sizeof (int));
+  senders = sc_array_new (sizeof (int));
+
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  dense = -sc_MPI_Wtime ();
+  j = first_peer;
+  k = last_peer;
+  sc_ranges_adaptive (sc_package_id, sc_MPI_COMM_WORLD, procs, &j, &k,
+                      num_ranges, ranges, &global_ranges);
+  maxwin = k;
+  sc_ranges_decode (size, rank, maxwin, global_ranges,
+                    &num_receivers, receiver_ranks,
+                    &num_senders, sender_ranks);
+  dense += sc_MPI_Wtime ();
+  SC_FREE (global_ranges);
+
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  sparse = -sc_MPI_Wtime ();
+  sc_ranges_adaptive_sparse (sc_package_id, sc_MPI_COMM_WORLD, num_peers,
+                             peers, num_ranges, ranges, receivers, senders);
+  sparse += sc_MPI_Wtime ();
+  SC_CHECK_ABORT ((size_t) num_receivers == receivers->elem_count &&
+                  (size_t) num_senders == senders->elem_count,
+                  "Adaptive ranges");
+
+  mpiret = sc_MPI_Allreduce (&dense, &elapsed, 1, sc_MPI_DOUBLE, sc_MPI_MAX,
+                             sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  dense = elapsed;
+  mpiret = sc_MPI_Allreduce (&sparse, &elapsed, 1, sc_MPI_DOUBLE,
+                             sc_MPI_MAX, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  sparse = elapsed;
+  SC_GLOBAL_STATISTICSF ("Adaptive ranges and decode %g us sparse %g us\n",
+                         1e6 * dense, 1e6 * sparse);
+
+  sc_array_destroy (receivers);
+  sc_array_destroy (senders);
+  SC_FREE (receiver_ranks);
+  SC_FREE (sender_ranks);
+  SC_FREE (procs);
+  SC_FREE (peers);
+  SC_FREE (ranges);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
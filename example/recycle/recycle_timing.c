@@ -0,0 +1,203 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Time the churn of insertion and removal and the iteration over live
+ * objects in a recycle array and a slot array.  The recycle array does
+ * not know its holes, so every object carries a flag that is tested while
+ * scanning all slots.  The slot array skips free slots by its bitmap and
+ * may be compacted, after which the live objects are dense. */
+
+#include <sc_containers.h>
+#include <sc_options.h>
+
+typedef struct recycle_object
+{
+  double              value;
+  int                 valid;
+}
+recycle_object_t;
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 num_objects, num_churn, repeat, percent, r;
+  size_t              zi, zk, span, *positions;
+  double              elapsed, sum_recycle, sum_slot, sum_dense;
+  recycle_object_t   *obj;
+  sc_recycle_array_t  ra;
+  sc_slot_array_t     sa;
+  sc_array_t         *newindices;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'n', "num-objects", &num_objects, 1 << 20,
+                      "Number of objects inserted initially");
+  sc_options_add_int (opt, 'c', "churn", &num_churn, 1 << 20,
+                      "Number of removals followed by insertions");
+  sc_options_add_int (opt, 'r', "repeat", &repeat, 10,
+                      "Number of iterations over the live objects");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || num_objects <= 0 || num_churn < 0 ||
+      repeat <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* both arrays reuse the one hole made by every removal, so they see
+   * the same random positions and end up with identical contents */
+  positions = SC_ALLOC (size_t, num_churn);
+  srand (11);
+  for (zk = 0; zk < (size_t) num_churn; ++zk) {
+    positions[zk] = (size_t) rand () % (size_t) num_objects;
+  }
+
+  sc_recycle_array_init (&ra, sizeof (recycle_object_t));
+  sc_slot_array_init (&sa, sizeof (recycle_object_t));
+  newindices = sc_array_new (sizeof (size_t));
+  for (percent = 50; percent >= 1; percent /= 5) {
+    /* fill both arrays and churn them: remove an object, insert another */
+    elapsed = -sc_MPI_Wtime ();
+    for (zi = 0; zi < (size_t) num_objects; ++zi) {
+      obj = (recycle_object_t *) sc_recycle_array_insert (&ra, NULL);
+      obj->value = (double) zi;
+      obj->valid = 1;
+    }
+    for (zk = 0; zk < (size_t) num_churn; ++zk) {
+      obj = (recycle_object_t *) sc_array_index (&ra.a, positions[zk]);
+      if (obj->valid) {
+        obj = (recycle_object_t *)
+          sc_recycle_array_remove (&ra, positions[zk]);
+        obj->valid = 0;
+        obj = (recycle_object_t *) sc_recycle_array_insert (&ra, NULL);
+        obj->value = (double) zk;
+        obj->valid = 1;
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Recycle array fill and churn %g ns per op\n",
+                           1e9 * elapsed / (num_objects + 2. * num_churn));
+
+    elapsed = -sc_MPI_Wtime ();
+    for (zi = 0; zi < (size_t) num_objects; ++zi) {
+      obj = (recycle_object_t *) sc_slot_array_insert (&sa, NULL);
+      obj->value = (double) zi;
+      obj->valid = 1;
+    }
+    for (zk = 0; zk < (size_t) num_churn; ++zk) {
+      if (sc_slot_array_is_live (&sa, positions[zk])) {
+        sc_slot_array_remove (&sa, positions[zk]);
+        obj = (recycle_object_t *) sc_slot_array_insert (&sa, NULL);
+        obj->value = (double) zk;
+        obj->valid = 1;
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Slot array fill and churn %g ns per op\n",
+                           1e9 * elapsed / (num_objects + 2. * num_churn));
+
+    /* remove all but the given percentage of objects at random */
+    srand (13);
+    for (zi = 0; zi < (size_t) num_objects; ++zi) {
+      if (rand () % 100 >= percent) {
+        obj = (recycle_object_t *) sc_recycle_array_remove (&ra, zi);
+        obj->valid = 0;
+        sc_slot_array_remove (&sa, zi);
+      }
+    }
+    span = sa.a.elem_count;
+    SC_GLOBAL_STATISTICSF ("Live %lld of %lld slots\n",
+                           (long long) sa.elem_count, (long long) span);
+
+    /* sum the live objects by scanning, skipping, and dense */
+    sum_recycle = sum_slot = sum_dense = 0.;
+    elapsed = -sc_MPI_Wtime ();
+    for (r = 0; r < repeat; ++r) {
+      for (zi = 0; zi < ra.a.elem_count; ++zi) {
+        obj = (recycle_object_t *) sc_array_index (&ra.a, zi);
+        if (obj->valid) {
+          sum_recycle += obj->value;
+        }
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Recycle array scan %g ns per live object\n",
+                           1e9 * elapsed / ((double) repeat * ra.elem_count));
+
+    elapsed = -sc_MPI_Wtime ();
+    for (r = 0; r < repeat; ++r) {
+      for (zi = sc_slot_array_next (&sa, 0); zi < sa.a.elem_count;
+           zi = sc_slot_array_next (&sa, zi + 1)) {
+        obj = (recycle_object_t *) sc_array_index (&sa.a, zi);
+        sum_slot += obj->value;
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Slot array iterate %g ns per live object\n",
+                           1e9 * elapsed / ((double) repeat * sa.elem_count));
+
+    elapsed = -sc_MPI_Wtime ();
+    sc_slot_array_compact (&sa, newindices);
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Slot array compact %g ns per slot\n",
+                           1e9 * elapsed / span);
+
+    elapsed = -sc_MPI_Wtime ();
+    for (r = 0; r < repeat; ++r) {
+      for (zi = 0; zi < sa.a.elem_count; ++zi) {
+        obj = (recycle_object_t *) sc_array_index (&sa.a, zi);
+        sum_dense += obj->value;
+      }
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Compacted iterate %g ns per live object\n",
+                           1e9 * elapsed / ((double) repeat * sa.elem_count));
+    SC_CHECK_ABORT (sum_recycle == sum_slot && sum_slot == sum_dense,
+                    "Iterations disagree");
+
+    /* both arrays differ in which slots they reuse, so start over */
+    sc_recycle_array_reset (&ra);
+    sc_slot_array_reset (&sa);
+  }
+  sc_recycle_array_reset (&ra);
+  sc_array_destroy (newindices);
+  SC_FREE (positions);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
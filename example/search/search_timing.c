@@ -0,0 +1,223 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the lower bound searches in a sorted array of offsets, as they
+ * occur in partition arrays, for random targets.  We time the bisection
+ * with a guess, the comparator based range search, the branchless search,
+ * the Eytzinger index, and the batched search of sorted targets.
+ * Finally we time the owner lookup of the partition index. */
+
+#include <sc_options.h>
+#include <sc_search.h>
+#include <sc_sort.h>
+
+static int
+search_int64_compare_range (const void *v1, const void *v2)
+{
+  const int64_t       i1 = *(int64_t *) v1;
+  const int64_t       i2 = *(int64_t *) v2;
+
+  return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
+}
+
+/** Run one search method and return nanoseconds per search. */
+static double
+search_time (int method, const int64_t * array, size_t nmemb,
+             const sc_search_index_t * index,
+             const sc_search_partition_t * part, const int64_t * targets,
+             size_t num_targets, size_t * bounds, int *owners,
+             int repetitions)
+{
+  int                 r;
+  size_t              i;
+  double              elapsed, best;
+  ssize_t             pos;
+
+  best = -1.;
+  for (r = 0; r < repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    switch (method) {
+    case 0:
+      for (i = 0; i < num_targets; ++i) {
+        pos = sc_search_lower_bound64 (targets[i], array, nmemb, nmemb / 2);
+        bounds[i] = pos < 0 ? nmemb : (size_t) pos;
+      }
+      break;
+    case 1:
+      /* the owner k with array[k] <= target < array[k + 1] */
+      for (i = 0; i < num_targets; ++i) {
+        bounds[i] = sc_bsearch_range (targets + i, array, nmemb - 1,
+                                      sizeof (int64_t),
+                                      search_int64_compare_range);
+      }
+      break;
+    case 2:
+      for (i = 0; i < num_targets; ++i) {
+        bounds[i] = sc_search_lower_bound_int64 (targets[i], array, nmemb);
+      }
+      break;
+    case 3:
+      for (i = 0; i < num_targets; ++i) {
+        bounds[i] = sc_search_index_lower_bound (index, targets[i]);
+      }
+      break;
+    case 4:
+      sc_search_lower_bound_int64_batch (array, nmemb, targets,
+                                         num_targets, bounds);
+      break;
+    default:
+      sc_search_partition_owners (part, targets, num_targets, owners);
+    }
+    elapsed += sc_MPI_Wtime ();
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+
+  return num_targets > 0 ? 1e9 * best / num_targets : 0.;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 nmemb, num_targets, repetitions, method;
+  size_t              i;
+  double              ns, seconds;
+  int64_t            *array, *targets, *sorted;
+  size_t             *bounds, *reference;
+  int                *owners;
+  const char         *names[6] = { "bisection with guess", "bsearch range",
+    "branchless", "Eytzinger index", "batch of sorted targets",
+    "partition index"
+  };
+  sc_search_index_t  *index;
+  sc_search_partition_t *part;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'n', "nmemb", &nmemb, 1 << 20,
+                      "Number of entries in the sorted array");
+  sc_options_add_int (opt, 'N', "num-targets", &num_targets, 1 << 20,
+                      "Number of targets to search");
+  sc_options_add_int (opt, 'r', "repetitions", &repetitions, 5,
+                      "Number of repetitions, we report the fastest");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || nmemb < 2 || num_targets < 0 ||
+      repetitions <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* offsets of a partition with random counts */
+  srand (17);
+  array = SC_ALLOC (int64_t, nmemb);
+  array[0] = 0;
+  for (i = 1; i < (size_t) nmemb; ++i) {
+    array[i] = array[i - 1] + rand () % 1000;
+  }
+  targets = SC_ALLOC (int64_t, num_targets);
+  sorted = SC_ALLOC (int64_t, num_targets);
+  for (i = 0; i < (size_t) num_targets; ++i) {
+    targets[i] = sorted[i] = (int64_t) ((double) rand () /
+                                        ((double) RAND_MAX + 1.) *
+                                        array[nmemb - 1]);
+  }
+  qsort (sorted, (size_t) num_targets, sizeof (int64_t), sc_int64_compare);
+  bounds = SC_ALLOC (size_t, num_targets);
+  reference = SC_ALLOC (size_t, num_targets);
+  owners = SC_ALLOC (int, num_targets);
+
+  seconds = -sc_MPI_Wtime ();
+  index = sc_search_index_new (array, (size_t) nmemb);
+  seconds += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Build Eytzinger index %g ns per entry\n",
+                         1e9 * seconds / nmemb);
+
+  /* the array holds the offsets of nmemb - 1 processes */
+  seconds = -sc_MPI_Wtime ();
+  part = sc_search_partition_new (array, nmemb - 1);
+  seconds += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Build partition index %g ns per entry"
+                         " with maximum span %d\n",
+                         1e9 * seconds / nmemb, part->max_span);
+
+  for (method = 0; method < 6; ++method) {
+    ns = search_time (method, array, (size_t) nmemb, index, part,
+                      method == 4 ? sorted : targets, (size_t) num_targets,
+                      bounds, owners, repetitions);
+    SC_GLOBAL_STATISTICSF ("Search by %s %g ns\n", names[method], ns);
+    if (method == 5) {
+      for (i = 0; i < (size_t) num_targets; ++i) {
+        SC_CHECK_ABORT (array[owners[i]] <= targets[i] &&
+                        targets[i] < array[owners[i] + 1], "Owner result");
+      }
+      continue;
+    }
+
+    /* verify the results against the branchless search */
+    for (i = 0; i < (size_t) num_targets; ++i) {
+      reference[i] = sc_search_lower_bound_int64
+        ((method == 4 ? sorted : targets)[i], array, (size_t) nmemb);
+      if (method == 1) {
+        /* convert the lower bound into the owner position */
+        if (reference[i] == (size_t) nmemb ||
+            array[reference[i]] > targets[i]) {
+          --reference[i];
+        }
+        while (reference[i] + 1 < (size_t) nmemb &&
+               array[reference[i] + 1] <= targets[i]) {
+          ++reference[i];
+        }
+        if (reference[i] + 1 == (size_t) nmemb) {
+          reference[i] = (size_t) nmemb - 1;
+        }
+      }
+      SC_CHECK_ABORTF (bounds[i] == reference[i], "Method %d result", method);
+    }
+  }
+
+  sc_search_partition_destroy (part);
+  sc_search_index_destroy (index);
+  SC_FREE (owners);
+  SC_FREE (reference);
+  SC_FREE (bounds);
+  SC_FREE (sorted);
+  SC_FREE (targets);
+  SC_FREE (array);
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Convert the binary trace files written between sc_trace_open and
+ * sc_trace_close into a JSON document for a timeline viewer. */
+
+#include <sc_options.h>
+#include <sc_trace.h>
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, rank;
+  int                 first_arg, retval;
+  const char         *output;
+  FILE               *out;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_string (opt, 'o', "output", &output, "sc_trace.json",
+                         "JSON output file");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg < 0 || first_arg == argc) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt,
+                            "<trace files>");
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* the conversion is serial */
+  retval = 0;
+  if (rank == 0) {
+    out = fopen (output, "w");
+    SC_CHECK_ABORTF (out != NULL, "Open %s", output);
+    retval = sc_trace_convert_json (argc - first_arg,
+                                    (const char **) argv + first_arg, out);
+    SC_CHECK_ABORT (!fclose (out), "Close output");
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return retval ? EXIT_FAILURE : EXIT_SUCCESS;
+}
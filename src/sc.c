@@ -22,6 +22,7 @@
 */
 
 #include <sc_private.h>
+#include <sc_trace.h>
 
 #ifdef SC_HAVE_SIGNAL_H
 #include <signal.h>
@@ -42,6 +43,9 @@ typedef void        (*sc_sig_t) (int);
 #include <errno.h>
 
 #ifdef SC_ENABLE_PTHREAD
+#ifdef SC_HAVE_TIME_H
+#include <time.h>
+#endif
 #include <pthread.h>
 #endif
 
@@ -51,6 +55,7 @@ typedef struct sc_package
   sc_log_handler_t    log_handler;
   int                 log_threshold;
   int                 log_indent;
+  double              log_rate[2];
   int                 malloc_count;
   int                 free_count;
   int                 rc_active;
@@ -63,12 +68,46 @@ typedef struct sc_package
 }
 sc_package_t;
 
-/** The only log handler that comes with libsc. */
+/** The default log handler that comes with libsc. */
 static void         sc_log_handler (FILE * log_stream,
                                     const char *filename, int lineno,
                                     int package, int category, int priority,
                                     const char *msg);
 
+/** The buffered log handler installed by sc_log_async_begin. */
+static void         sc_log_async_handler (FILE * log_stream,
+                                          const char *filename, int lineno,
+                                          int package, int category,
+                                          int priority, const char *msg);
+
+/** A buffer of formatted log messages owned by one thread. */
+typedef struct sc_log_buffer
+{
+  size_t              used;
+  char               *data;
+  struct sc_log_buffer *next;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_t     mutex;
+#endif
+}
+sc_log_buffer_t;
+
+/** A log statement whose messages are limited in rate. */
+typedef struct sc_log_site
+{
+  const char         *filename;
+  int                 lineno;
+  int                 package;
+  int                 category;
+  int                 priority;
+  long                suppressed;
+  double              last;
+}
+sc_log_site_t;
+
+/** The number of log statements whose rates are tracked at once. */
+#define SC_LOG_SITES 256
+
 /* *INDENT-OFF* */
 const int sc_log2_lookup_table[256] =
 { -1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
@@ -94,10 +133,17 @@ int                 sc_package_id = -1;
 FILE               *sc_trace_file = NULL;
 int                 sc_trace_prio = SC_LP_STATISTICS;
 
+static int          sc_log_threshold_single = SC_LP_THRESHOLD;
+static int         *sc_log_threshold_storage = NULL;
+const int          *sc_log_thresholds = &sc_log_threshold_single;
+int                 sc_log_num_thresholds = 1;
+int                 sc_log_global_muted = 0;
+
 static int          default_malloc_count = 0;
 static int          default_free_count = 0;
 static int          default_rc_active = 0;
 static int          default_abort_mismatch = 1;
+static double       default_log_rate[2] = { 0., 0. };
 
 static int          sc_identifier = -1;
 static sc_MPI_Comm  sc_mpicomm = sc_MPI_COMM_NULL;
@@ -116,6 +162,17 @@ static sc_sig_t     system_usr2_handler = NULL;
 
 static int          sc_print_backtrace = 0;
 
+static int          sc_log_async_active = 0;
+static FILE        *sc_log_async_stream = NULL;
+static int          sc_log_async_stream_owned = 0;
+static size_t       sc_log_async_size = 0;
+static char        *sc_log_async_spare = NULL;
+static sc_log_buffer_t *sc_log_async_buffers = NULL;
+static sc_log_handler_t sc_log_async_previous = NULL;
+
+static int          sc_log_rate_active = 0;
+static sc_log_site_t sc_log_sites[SC_LOG_SITES];
+
 static int          sc_num_packages = 0;
 static int          sc_num_packages_alloc = 0;
 static sc_package_t *sc_packages = NULL;
@@ -124,6 +181,16 @@ static sc_package_t *sc_packages = NULL;
 
 static pthread_mutex_t sc_default_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t sc_error_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t sc_log_rate_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* the asynchronous log mutex protects the buffer list and the stream */
+static pthread_mutex_t sc_log_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sc_log_async_cond = PTHREAD_COND_INITIALIZER;
+static pthread_key_t sc_log_async_key;
+static pthread_t    sc_log_async_thread;
+static int          sc_log_async_threaded = 0;
+static int          sc_log_async_stop = 0;
+static double       sc_log_async_interval = 0.;
 
 static void
 sc_check_abort_thread (int condition, int package, const char *message)
@@ -295,6 +362,223 @@ sc_log_handler (FILE * log_stream, const char *filename, int lineno,
   fflush (log_stream);
 }
 
+/** Format a log message with the same prefix as sc_log_handler.
+ * \return          The length of the message as by snprintf.
+ */
+static int
+sc_log_async_format (char *out, size_t size,
+                     const char *filename, int lineno,
+                     int package, int category, int priority,
+                     const char *msg)
+{
+  int                 wp = 0, wi = 0;
+  int                 lindent = 0;
+  int                 len;
+  size_t              pos, msglen;
+
+  if (package != -1) {
+    if (!sc_package_is_registered (package))
+      package = -1;
+    else {
+      wp = 1;
+      lindent = sc_packages[package].log_indent;
+    }
+  }
+  wi = (category == SC_LC_NORMAL && sc_identifier >= 0);
+
+  len = 0;
+  if (wp && wi) {
+    len = snprintf (out, size, "[%s %d] %*s", sc_packages[package].name,
+                    sc_identifier, lindent, "");
+  }
+  else if (wp) {
+    len = snprintf (out, size, "[%s] %*s", sc_packages[package].name,
+                    lindent, "");
+  }
+  else if (wi) {
+    len = snprintf (out, size, "[%d] ", sc_identifier);
+  }
+  if (len < 0) {
+    return len;
+  }
+  pos = (size_t) len;
+
+  if (priority == SC_LP_TRACE) {
+    char                bn[BUFSIZ], *bp;
+
+    snprintf (bn, BUFSIZ, "%s", filename);
+    bp = basename (bn);
+    len = snprintf (out + SC_MIN (pos, size), size - SC_MIN (pos, size),
+                    "%s:%d ", bp, lineno);
+    if (len < 0) {
+      return len;
+    }
+    pos += (size_t) len;
+  }
+
+  msglen = strlen (msg);
+  if (pos + msglen < size) {
+    memcpy (out + pos, msg, msglen + 1);
+  }
+  return (int) (pos + msglen);
+}
+
+/** Write all buffers to the stream.
+ * With pthreads, the caller must hold sc_log_async_mutex.
+ */
+static void
+sc_log_async_drain (void)
+{
+  char               *data;
+  size_t              used;
+  sc_log_buffer_t    *buf;
+
+  for (buf = sc_log_async_buffers; buf != NULL; buf = buf->next) {
+    /* swap the buffer for the spare one to hold its lock only briefly */
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_lock (&buf->mutex);
+#endif
+    data = buf->data;
+    used = buf->used;
+    buf->data = sc_log_async_spare;
+    buf->used = 0;
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_unlock (&buf->mutex);
+#endif
+    sc_log_async_spare = data;
+    if (used > 0) {
+      fwrite (data, 1, used, sc_log_async_stream);
+    }
+  }
+  fflush (sc_log_async_stream);
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+/** The background thread writes the buffers at regular intervals. */
+static void        *
+sc_log_async_run (void *v)
+{
+  struct timespec     ts;
+  double              wakeup;
+
+  pthread_mutex_lock (&sc_log_async_mutex);
+  while (!sc_log_async_stop) {
+#ifdef SC_HAVE_CLOCK_GETTIME
+    clock_gettime (CLOCK_REALTIME, &ts);
+    wakeup = ts.tv_sec + 1.e-9 * ts.tv_nsec + sc_log_async_interval;
+#else
+    wakeup = (double) time (NULL) + SC_MAX (sc_log_async_interval, 1.);
+#endif
+    ts.tv_sec = (time_t) wakeup;
+    ts.tv_nsec = (long) ((wakeup - (double) ts.tv_sec) * 1.e9);
+    pthread_cond_timedwait (&sc_log_async_cond, &sc_log_async_mutex, &ts);
+    sc_log_async_drain ();
+  }
+  pthread_mutex_unlock (&sc_log_async_mutex);
+
+  return v;
+}
+
+#endif /* SC_ENABLE_PTHREAD */
+
+/** Return the buffer of the calling thread and create it if necessary. */
+static sc_log_buffer_t *
+sc_log_async_buffer (void)
+{
+  sc_log_buffer_t    *buf;
+
+#ifdef SC_ENABLE_PTHREAD
+  buf = (sc_log_buffer_t *) pthread_getspecific (sc_log_async_key);
+#else
+  buf = sc_log_async_buffers;
+#endif
+  if (buf == NULL) {
+    buf = SC_ALLOC (sc_log_buffer_t, 1);
+    buf->used = 0;
+    buf->data = SC_ALLOC (char, sc_log_async_size);
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_init (&buf->mutex, NULL);
+    pthread_setspecific (sc_log_async_key, buf);
+    pthread_mutex_lock (&sc_log_async_mutex);
+#endif
+    buf->next = sc_log_async_buffers;
+    sc_log_async_buffers = buf;
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_unlock (&sc_log_async_mutex);
+#endif
+  }
+
+  return buf;
+}
+
+static void
+sc_log_async_handler (FILE * log_stream, const char *filename, int lineno,
+                      int package, int category, int priority,
+                      const char *msg)
+{
+  int                 len;
+  char               *big;
+  sc_log_buffer_t    *buf;
+
+  if (log_stream == sc_trace_file) {
+    /* the trace file is written unbuffered as before */
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_lock (&sc_log_async_mutex);
+#endif
+    sc_log_handler (log_stream, filename, lineno,
+                    package, category, priority, msg);
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_unlock (&sc_log_async_mutex);
+#endif
+    return;
+  }
+
+  buf = sc_log_async_buffer ();
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&buf->mutex);
+#endif
+  len = sc_log_async_format (buf->data + buf->used,
+                             sc_log_async_size - buf->used, filename, lineno,
+                             package, category, priority, msg);
+  if (len >= 0 && (size_t) len < sc_log_async_size - buf->used) {
+    buf->used += (size_t) len;
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_unlock (&buf->mutex);
+#endif
+    return;
+  }
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&buf->mutex);
+#endif
+  if (len < 0) {
+    return;
+  }
+
+  /* the message does not fit: write everything and try again */
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_log_async_mutex);
+#endif
+  sc_log_async_drain ();
+  if ((size_t) len < sc_log_async_size) {
+    /* the buffer of this thread is empty now and only we write to it */
+    sc_log_async_format (buf->data, sc_log_async_size, filename, lineno,
+                         package, category, priority, msg);
+    buf->used = (size_t) len;
+  }
+  else {
+    big = SC_ALLOC (char, len + 1);
+    sc_log_async_format (big, len + 1, filename, lineno,
+                         package, category, priority, msg);
+    fwrite (big, 1, (size_t) len, sc_log_async_stream);
+    fflush (sc_log_async_stream);
+    SC_FREE (big);
+  }
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_log_async_mutex);
+#endif
+}
+
 static int         *
 sc_malloc_count (int package)
 {
@@ -764,6 +1048,170 @@ sc_double_compare (const void *v1, const void *v2)
   return d1 < d2 ? -1 : d1 > d2 ? 1 : 0;
 }
 
+/** Recompute the thresholds queried by sc_log_enabled.
+ * This function must be called whenever a package or default threshold,
+ * the package registry or the identifier of this process changes.
+ */
+static void
+sc_log_update_thresholds (void)
+{
+  int                 i;
+  sc_package_t       *p;
+
+  sc_log_global_muted = (sc_identifier > 0);
+  sc_log_threshold_single = sc_default_log_threshold;
+  if (sc_num_packages_alloc == 0) {
+    free (sc_log_threshold_storage);
+    sc_log_threshold_storage = NULL;
+    sc_log_thresholds = &sc_log_threshold_single;
+    sc_log_num_thresholds = 1;
+    return;
+  }
+
+  if (sc_log_num_thresholds < sc_num_packages_alloc + 1 ||
+      sc_log_threshold_storage == NULL) {
+    sc_log_threshold_storage =
+      (int *) realloc (sc_log_threshold_storage,
+                       (sc_num_packages_alloc + 1) * sizeof (int));
+    SC_CHECK_ABORT (sc_log_threshold_storage != NULL,
+                    "Failed to allocate memory");
+  }
+  sc_log_threshold_storage[0] = sc_default_log_threshold;
+  for (i = 0; i < sc_num_packages_alloc; ++i) {
+    p = sc_packages + i;
+    sc_log_threshold_storage[i + 1] =
+      (!p->is_registered || p->log_threshold == SC_LP_DEFAULT) ?
+      sc_default_log_threshold : p->log_threshold;
+  }
+  sc_log_thresholds = sc_log_threshold_storage;
+  sc_log_num_thresholds = sc_num_packages_alloc + 1;
+}
+
+/** Return the rate limit interval of a package and category. */
+static double
+sc_log_rate_interval (int package, int category)
+{
+  double             *log_rate;
+
+  if (package != -1 && !sc_package_is_registered (package)) {
+    package = -1;
+  }
+  log_rate = package == -1 ? default_log_rate :
+    sc_packages[package].log_rate;
+
+  return log_rate[category == SC_LC_GLOBAL ? 0 : 1];
+}
+
+static void         sc_log_dispatch (const char *filename, int lineno,
+                                     int package, int category,
+                                     int priority, const char *msg);
+
+/** Report the number of suppressed messages of a log statement. */
+static void
+sc_log_rate_report (const sc_log_site_t * site)
+{
+  char                buffer[BUFSIZ];
+
+  SC_ASSERT (site->suppressed > 0);
+  snprintf (buffer, BUFSIZ, "Suppressed %ld messages from %s:%d\n",
+            site->suppressed, site->filename, site->lineno);
+  sc_log_dispatch (site->filename, site->lineno, site->package,
+                   site->category, site->priority, buffer);
+}
+
+/** Decide whether a rate limited log statement may write its message.
+ * \return                 True if the message is to be written.
+ */
+static int
+sc_log_rate_pass (const char *filename, int lineno,
+                  int package, int category, int priority)
+{
+  int                 pass;
+  size_t              hash;
+  double              interval, now;
+  sc_log_site_t      *site, pending;
+
+  if (!sc_log_rate_active) {
+    return 1;
+  }
+  interval = sc_log_rate_interval (package, category);
+  if (interval <= 0.) {
+    return 1;
+  }
+
+  hash = ((size_t) filename >> 3) ^ ((size_t) lineno * 2654435761U) ^
+    ((size_t) (package + 1) << 7) ^ (size_t) category;
+  now = sc_MPI_Wtime ();
+  pending.suppressed = 0;
+
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_log_rate_mutex);
+#endif
+  site = sc_log_sites + (hash % SC_LOG_SITES);
+  if (site->filename != filename || site->lineno != lineno ||
+      site->package != package || site->category != category) {
+    /* a new statement evicts the previous one from the table */
+    pending = *site;
+    site->filename = filename;
+    site->lineno = lineno;
+    site->package = package;
+    site->category = category;
+    site->suppressed = 0;
+    site->last = now;
+    pass = 1;
+  }
+  else if (now - site->last < interval) {
+    ++site->suppressed;
+    pass = 0;
+  }
+  else {
+    pending = *site;
+    site->suppressed = 0;
+    site->last = now;
+    pass = 1;
+  }
+  site->priority = priority;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_log_rate_mutex);
+#endif
+
+  if (pending.suppressed > 0) {
+    sc_log_rate_report (&pending);
+  }
+  return pass;
+}
+
+/** Report and forget the suppressed messages of a package.
+ * \param [in] package     Package id, or -2 to select all packages.
+ */
+static void
+sc_log_rate_flush (int package)
+{
+  int                 i;
+  sc_log_site_t      *site, pending;
+
+  for (i = 0; i < SC_LOG_SITES; ++i) {
+    site = sc_log_sites + i;
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_lock (&sc_log_rate_mutex);
+#endif
+    pending = *site;
+    if (site->filename != NULL &&
+        (package == -2 || site->package == package)) {
+      memset (site, 0, sizeof (sc_log_site_t));
+    }
+    else {
+      pending.suppressed = 0;
+    }
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_unlock (&sc_log_rate_mutex);
+#endif
+    if (pending.suppressed > 0) {
+      sc_log_rate_report (&pending);
+    }
+  }
+}
+
 void
 sc_set_log_defaults (FILE * log_stream,
                      sc_log_handler_t log_handler, int log_threshold)
@@ -778,15 +1226,51 @@ sc_set_log_defaults (FILE * log_stream,
                log_threshold <= SC_LP_SILENT);
     sc_default_log_threshold = log_threshold;
   }
+  sc_log_update_thresholds ();
 
   sc_log_stream = log_stream;
 }
 
+void
+sc_package_set_log_rate (int package_id, int category, double interval)
+{
+  double             *log_rate;
+
+  SC_CHECK_ABORT (package_id == -1 || sc_package_is_registered (package_id),
+                  "Package id is not registered");
+  SC_CHECK_ABORT (category == SC_LC_NORMAL || category == SC_LC_GLOBAL,
+                  "Invalid log category");
+
+  /* report what has been suppressed under the previous interval */
+  sc_log_rate_flush (package_id);
+
+  log_rate = package_id == -1 ? default_log_rate :
+    sc_packages[package_id].log_rate;
+  log_rate[category == SC_LC_GLOBAL ? 0 : 1] = SC_MAX (interval, 0.);
+  if (interval > 0.) {
+    sc_log_rate_active = 1;
+  }
+}
+
 void
 sc_log (const char *filename, int lineno,
         int package, int category, int priority, const char *msg)
+{
+  if (!sc_log_enabled (package, category, priority) ||
+      !sc_log_rate_pass (filename, lineno, package, category, priority)) {
+    return;
+  }
+  sc_log_dispatch (filename, lineno, package, category, priority, msg);
+}
+
+static void
+sc_log_dispatch (const char *filename, int lineno,
+                 int package, int category, int priority, const char *msg)
 {
   int                 log_threshold;
+#ifdef SC_ENABLE_PTHREAD
+  int                 locked;
+#endif
   sc_log_handler_t    log_handler;
   sc_package_t       *p;
 
@@ -812,9 +1296,14 @@ sc_log (const char *filename, int lineno,
     return;
   if (category == SC_LC_GLOBAL && sc_identifier > 0)
     return;
+  if (sc_trace_logging)
+    sc_trace_log (filename, lineno, package, category, priority);
 
 #ifdef SC_ENABLE_PTHREAD
-  sc_package_lock (package);
+  /* the buffered log handler does its own locking */
+  locked = (log_handler != sc_log_async_handler);
+  if (locked)
+    sc_package_lock (package);
 #endif
   if (sc_trace_file != NULL && priority >= sc_trace_prio)
     log_handler (sc_trace_file, filename, lineno,
@@ -824,7 +1313,8 @@ sc_log (const char *filename, int lineno,
     log_handler (sc_log_stream != NULL ? sc_log_stream : stdout,
                  filename, lineno, package, category, priority, msg);
 #ifdef SC_ENABLE_PTHREAD
-  sc_package_unlock (package);
+  if (locked)
+    sc_package_unlock (package);
 #endif
 }
 
@@ -844,15 +1334,139 @@ sc_logv (const char *filename, int lineno,
          int package, int category, int priority, const char *fmt, va_list ap)
 {
   char                buffer[BUFSIZ];
+#ifdef SC_ENABLE_PTHREAD
+  const int           locked = !sc_log_async_active;
+#endif
+
+  /* decide before formatting the message */
+  if (!sc_log_enabled (package, category, priority) ||
+      !sc_log_rate_pass (filename, lineno, package, category, priority)) {
+    return;
+  }
 
 #ifdef SC_ENABLE_PTHREAD
-  sc_package_lock (package);
+  if (locked)
+    sc_package_lock (package);
 #endif
   vsnprintf (buffer, BUFSIZ, fmt, ap);
 #ifdef SC_ENABLE_PTHREAD
-  sc_package_unlock (package);
+  if (locked)
+    sc_package_unlock (package);
+#endif
+  sc_log_dispatch (filename, lineno, package, category, priority, buffer);
+}
+
+void
+sc_log_async_begin (const char *filename, size_t buffer_size,
+                    double drain_interval)
+{
+  char                buffer[BUFSIZ];
+
+  SC_CHECK_ABORT (!sc_log_async_active, "Buffered logging already active");
+
+  if (filename != NULL) {
+    if (sc_identifier >= 0) {
+      snprintf (buffer, BUFSIZ, "%s.%d.log", filename, sc_identifier);
+    }
+    else {
+      snprintf (buffer, BUFSIZ, "%s.log", filename);
+    }
+    sc_log_async_stream = fopen (buffer, "wb");
+    SC_CHECK_ABORTF (sc_log_async_stream != NULL, "Log file open %s",
+                     buffer);
+    sc_log_async_stream_owned = 1;
+  }
+  else {
+    sc_log_async_stream = sc_log_stream != NULL ? sc_log_stream : stdout;
+    sc_log_async_stream_owned = 0;
+  }
+  sc_log_async_size = buffer_size > 0 ? buffer_size : (size_t) (1 << 16);
+  sc_log_async_spare = SC_ALLOC (char, sc_log_async_size);
+  sc_log_async_buffers = NULL;
+
+#ifdef SC_ENABLE_PTHREAD
+  {
+    int                 pth;
+
+    pth = pthread_key_create (&sc_log_async_key, NULL);
+    SC_CHECK_ABORT (pth == 0, "Fail in pthread_key_create");
+    sc_log_async_stop = 0;
+    sc_log_async_interval = drain_interval;
+    sc_log_async_threaded = 0;
+    if (drain_interval > 0.) {
+      pth = pthread_create (&sc_log_async_thread, NULL,
+                            sc_log_async_run, NULL);
+      SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+      sc_log_async_threaded = 1;
+    }
+  }
+#endif
+
+  sc_log_async_previous = sc_default_log_handler;
+  sc_default_log_handler = sc_log_async_handler;
+  sc_log_async_active = 1;
+}
+
+void
+sc_log_async_flush (void)
+{
+  if (!sc_log_async_active) {
+    return;
+  }
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_log_async_mutex);
+#endif
+  sc_log_async_drain ();
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_log_async_mutex);
 #endif
-  sc_log (filename, lineno, package, category, priority, buffer);
+}
+
+void
+sc_log_async_end (void)
+{
+  int                 retval;
+  sc_log_buffer_t    *buf;
+
+  if (!sc_log_async_active) {
+    return;
+  }
+
+  /* new messages use the previous handler from now on */
+  sc_default_log_handler = sc_log_async_previous;
+  sc_log_async_active = 0;
+
+#ifdef SC_ENABLE_PTHREAD
+  if (sc_log_async_threaded) {
+    pthread_mutex_lock (&sc_log_async_mutex);
+    sc_log_async_stop = 1;
+    pthread_cond_signal (&sc_log_async_cond);
+    pthread_mutex_unlock (&sc_log_async_mutex);
+    retval = pthread_join (sc_log_async_thread, NULL);
+    SC_CHECK_ABORT (retval == 0, "Fail in pthread_join");
+    sc_log_async_threaded = 0;
+  }
+  pthread_key_delete (sc_log_async_key);
+#endif
+  sc_log_async_drain ();
+
+  while ((buf = sc_log_async_buffers) != NULL) {
+    sc_log_async_buffers = buf->next;
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_destroy (&buf->mutex);
+#endif
+    SC_FREE (buf->data);
+    SC_FREE (buf);
+  }
+  SC_FREE (sc_log_async_spare);
+  sc_log_async_spare = NULL;
+
+  if (sc_log_async_stream_owned) {
+    retval = fclose (sc_log_async_stream);
+    SC_CHECK_ABORT (!retval, "Log file close");
+  }
+  sc_log_async_stream = NULL;
+  sc_log_async_stream_owned = 0;
 }
 
 void
@@ -1056,6 +1670,7 @@ sc_package_register (sc_log_handler_t log_handler, int log_threshold,
       p->log_handler = NULL;
       p->log_threshold = SC_LP_SILENT;
       p->log_indent = 0;
+      p->log_rate[0] = p->log_rate[1] = 0.;
       p->malloc_count = 0;
       p->free_count = 0;
       p->rc_active = 0;
@@ -1068,6 +1683,7 @@ sc_package_register (sc_log_handler_t log_handler, int log_threshold,
   new_package->log_handler = log_handler;
   new_package->log_threshold = log_threshold;
   new_package->log_indent = 0;
+  new_package->log_rate[0] = new_package->log_rate[1] = 0.;
   new_package->malloc_count = 0;
   new_package->free_count = 0;
   new_package->rc_active = 0;
@@ -1082,6 +1698,7 @@ sc_package_register (sc_log_handler_t log_handler, int log_threshold,
   ++sc_num_packages;
   SC_ASSERT (sc_num_packages <= sc_num_packages_alloc);
   SC_ASSERT (0 <= new_package_id && new_package_id < sc_num_packages);
+  sc_log_update_thresholds ();
 
   return new_package_id;
 }
@@ -1109,6 +1726,7 @@ sc_package_set_verbosity (int package_id, int log_priority)
 
   p = sc_packages + package_id;
   p->log_threshold = log_priority;
+  sc_log_update_thresholds ();
 }
 
 void
@@ -1121,6 +1739,7 @@ sc_package_unregister (int package_id)
 
   SC_CHECK_ABORT (sc_package_is_registered (package_id),
                   "Package not registered");
+  sc_log_rate_flush (package_id);
   sc_memory_check (package_id);
 
   p = sc_packages + package_id;
@@ -1134,8 +1753,10 @@ sc_package_unregister (int package_id)
   SC_CHECK_ABORTF (i == 0, "Mutex destroy failed for package %s", p->name);
 #endif
   p->name = p->full = NULL;
+  p->log_rate[0] = p->log_rate[1] = 0.;
 
   --sc_num_packages;
+  sc_log_update_thresholds ();
 }
 
 void
@@ -1179,6 +1800,8 @@ sc_init (sc_MPI_Comm mpicomm,
     SC_CHECK_MPI (mpiret);
   }
 
+  sc_log_update_thresholds ();
+
   sc_set_signal_handler (catch_signals);
   sc_package_id = sc_package_register (log_handler, log_threshold,
                                        "libsc", "The SC Library");
@@ -1250,6 +1873,21 @@ sc_init (sc_MPI_Comm mpicomm,
   SC_GLOBAL_PRODUCTIONF ("%-*s %s\n", w, "FLIBS", SC_FLIBS);
 #endif
 
+#ifdef SC_ENABLE_MPI
+  if (mpicomm != sc_MPI_COMM_NULL) {
+    static const char  *levels[4] =
+      { "single", "funneled", "serialized", "multiple" };
+    int                 level, il;
+
+    /* the MPI constants are ordered but not necessarily 0 to 3 */
+    level = sc_mpi_thread_level ();
+    il = level == sc_MPI_THREAD_MULTIPLE ? 3 :
+      level == sc_MPI_THREAD_SERIALIZED ? 2 :
+      level == sc_MPI_THREAD_FUNNELED ? 1 : 0;
+    SC_GLOBAL_STATISTICSF ("MPI thread level: %s\n", levels[il]);
+  }
+#endif
+
 #if defined(SC_ENABLE_MPI) && defined(SC_ENABLE_MPICOMMSHARED)
   if (mpicomm != MPI_COMM_NULL) {
     int                 mpiret;
@@ -1280,6 +1918,12 @@ sc_finalize (void)
   int                 i;
   int                 retval;
 
+  /* write suppressed and buffered log messages before the memory check */
+  sc_log_rate_flush (-2);
+  sc_log_async_end ();
+  sc_mpi_progress_thread_stop ();
+  sc_trace_close ();
+
 #if defined(SC_ENABLE_MPI) && defined(SC_ENABLE_MPICOMMSHARED)
   sc_mpi_comm_detach_node_comms (sc_mpicomm);
 #endif
@@ -1295,12 +1939,15 @@ sc_finalize (void)
   free (sc_packages);
   sc_packages = NULL;
   sc_num_packages_alloc = 0;
+  default_log_rate[0] = default_log_rate[1] = 0.;
+  sc_log_rate_active = 0;
 
   sc_set_signal_handler (0);
   sc_mpicomm = sc_MPI_COMM_NULL;
 
   sc_print_backtrace = 0;
   sc_identifier = -1;
+  sc_log_update_thresholds ();
 
   /* close trace file */
   if (sc_trace_file != NULL) {
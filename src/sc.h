@@ -131,6 +131,11 @@ extern int          sc_package_id;
 extern FILE        *sc_trace_file;
 extern int          sc_trace_prio;
 
+/* runtime log thresholds maintained by libsc (see sc_log_enabled) */
+extern const int   *sc_log_thresholds;
+extern int          sc_log_num_thresholds;
+extern int          sc_log_global_muted;
+
 /* define math constants if necessary */
 #ifndef M_E
 #define M_E 2.7182818284590452354       /* e */
@@ -369,9 +374,34 @@ void                SC_CHECK_ABORTF (int success, const char *fmt, ...)
 #endif
 #endif
 
+/** Query cheaply whether a log message would be written anywhere.
+ * The log macros call this function before evaluating their arguments,
+ * such that a suppressed message is never formatted.
+ * \param [in] package     Package id, unregistered ones use the default.
+ * \param [in] category    SC_LC_NORMAL or SC_LC_GLOBAL.
+ * \param [in] priority    Log priority of the message.
+ * \return                 True if the priority reaches the runtime
+ *                         threshold of the package or the priority of an
+ *                         open trace file, and the category is printed on
+ *                         this process.
+ */
+static inline int
+sc_log_enabled (int package, int category, int priority)
+{
+  const int           index =
+    (package >= 0 && package + 1 < sc_log_num_thresholds) ? package + 1 : 0;
+
+  if (category == SC_LC_GLOBAL && sc_log_global_muted) {
+    return 0;
+  }
+  return priority >= sc_log_thresholds[index] ||
+    (sc_trace_file != NULL && priority >= sc_trace_prio);
+}
+
 /* generic log macros */
 #define SC_GEN_LOG(package,category,priority,s)                         \
-  ((priority) < SC_LP_THRESHOLD ? (void) 0 :                            \
+  ((priority) < SC_LP_THRESHOLD ||                                      \
+   !sc_log_enabled ((package), (category), (priority)) ? (void) 0 :     \
    sc_log (__FILE__, __LINE__, (package), (category), (priority), (s)))
 #define SC_GLOBAL_LOG(p,s) SC_GEN_LOG (sc_package_id, SC_LC_GLOBAL, (p), (s))
 #define SC_LOG(p,s) SC_GEN_LOG (sc_package_id, SC_LC_NORMAL, (p), (s))
@@ -384,7 +414,8 @@ void                SC_LOGF (int priority, const char *fmt, ...)
   __attribute__ ((format (printf, 2, 3)));
 #ifndef __cplusplus
 #define SC_GEN_LOGF(package,category,priority,fmt,...)                  \
-  ((priority) < SC_LP_THRESHOLD ? (void) 0 :                            \
+  ((priority) < SC_LP_THRESHOLD ||                                      \
+   !sc_log_enabled ((package), (category), (priority)) ? (void) 0 :     \
    sc_logf (__FILE__, __LINE__, (package), (category), (priority),      \
             (fmt), __VA_ARGS__))
 #define SC_GLOBAL_LOGF(p,fmt,...)                                       \
@@ -519,6 +550,41 @@ void                sc_set_log_defaults (FILE * log_stream,
                                          sc_log_handler_t log_handler,
                                          int log_thresold);
 
+/** Replace the default log handler by a buffered one.
+ * Each thread formats its messages into a buffer of its own.  The buffers
+ * are written in large chunks when they are full, by a background thread
+ * at regular intervals, by \ref sc_log_async_flush and finally by
+ * \ref sc_log_async_end, which \ref sc_finalize calls if necessary.
+ * The messages of one thread stay in order, while those of different
+ * threads are interleaved in chunks.  Trace file output is not buffered.
+ * Must be called after sc_init to know the rank of this process.
+ * \param [in] filename      If not NULL, each process writes to its own
+ *                           file filename.<rank>.log, or filename.log if
+ *                           sc_init was called without a communicator.
+ *                           Otherwise we use the stream set by
+ *                           sc_set_log_defaults or stdout.
+ * \param [in] buffer_size   Size of each thread's buffer in bytes,
+ *                           or 0 for a default of 64 KiB.
+ * \param [in] drain_interval Seconds between writes by a background
+ *                           thread.  The thread is only started if libsc
+ *                           is configured with pthreads and this value is
+ *                           positive.
+ */
+void                sc_log_async_begin (const char *filename,
+                                        size_t buffer_size,
+                                        double drain_interval);
+
+/** Write all buffered log messages.
+ * Does nothing if \ref sc_log_async_begin has not been called.
+ */
+void                sc_log_async_flush (void);
+
+/** Write all buffered log messages and restore the previous log handler.
+ * No other thread may log while this function is running.
+ * Does nothing if \ref sc_log_async_begin has not been called.
+ */
+void                sc_log_async_end (void);
+
 /** Controls the default SC abort behavior.
  * \param [in] abort_handler Set default SC above handler (NULL selects
  *                           builtin).  ***This function should not return!***
@@ -624,6 +690,21 @@ void                sc_package_unlock (int package_id);
 void                sc_package_set_verbosity (int package_id,
                                               int log_priority);
 
+/** Limit the rate of log messages of a package and category.
+ * A log statement, identified by its file and line, writes at most one
+ * message per interval.  Further calls within the interval are counted
+ * without formatting their message.  The count is reported with the next
+ * message of the statement, or when the package is unregistered.
+ * Identical statements on different lines are limited independently.
+ * \param [in] package_id       Either -1 for the default package or
+ *                              the identifier of a registered package.
+ * \param [in] category         SC_LC_NORMAL or SC_LC_GLOBAL.
+ * \param [in] interval         Minimum time in seconds between two
+ *                              messages of a statement, 0 to disable.
+ */
+void                sc_package_set_log_rate (int package_id, int category,
+                                             double interval);
+
 /** Set the unregister behavior of sc_package_unregister().
  *
  * \param[in] package_id    Must be -1 for the default package or
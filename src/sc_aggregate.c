@@ -0,0 +1,430 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_aggregate.h>
+
+#if defined SC_ENABLE_MPI && defined MPI_VERSION && MPI_VERSION >= 3
+#define SC_AGGREGATE_HAVE_NBX
+#endif
+
+/** Every message in a buffer starts with this header and its data is
+ * padded to a multiple of the header size. */
+typedef struct sc_aggregate_header
+{
+  int                 source, dest;
+  int                 handler, bytes;
+}
+sc_aggregate_header_t;
+
+typedef struct sc_aggregate_entry
+{
+  sc_aggregate_handler_t handler;
+  void               *user;
+}
+sc_aggregate_entry_t;
+
+#define SC_AGGREGATE_PAD(b) \
+  (((b) + sizeof (sc_aggregate_header_t) - 1) & \
+   ~(sizeof (sc_aggregate_header_t) - 1))
+
+/** Append a message to the buffer of a rank. */
+static void
+sc_aggregate_append (sc_aggregate_t * agg, int hop,
+                     const sc_aggregate_header_t * header, const void *data)
+{
+  size_t              offset;
+  sc_array_t         *buffer = agg->buffers + hop;
+
+  if (!agg->listed[hop]) {
+    agg->listed[hop] = 1;
+    *(int *) sc_array_push (&agg->nonempty) = hop;
+  }
+  offset = buffer->elem_count;
+  sc_array_resize (buffer, offset + sizeof (sc_aggregate_header_t) +
+                   SC_AGGREGATE_PAD ((size_t) header->bytes));
+  memcpy (buffer->array + offset, header, sizeof (sc_aggregate_header_t));
+  if (header->bytes > 0) {
+    memcpy (buffer->array + offset + sizeof (sc_aggregate_header_t), data,
+            (size_t) header->bytes);
+  }
+}
+
+/** Deliver or forward the messages in a received buffer.
+ * \return              The number of messages handled.
+ */
+static int
+sc_aggregate_process (sc_aggregate_t * agg, const char *data, size_t bytes)
+{
+  int                 num_handled = 0;
+  size_t              pos;
+  sc_aggregate_header_t header;
+  sc_aggregate_entry_t *entry;
+
+  for (pos = 0; pos < bytes;
+       pos += sizeof (header) + SC_AGGREGATE_PAD ((size_t) header.bytes)) {
+    memcpy (&header, data + pos, sizeof (header));
+    SC_ASSERT (0 <= header.dest && header.dest < agg->mpisize);
+    if (header.dest != agg->mpirank) {
+      sc_aggregate_append (agg, agg->next_hop[header.dest], &header,
+                           data + pos + sizeof (header));
+      ++agg->num_forwarded;
+      continue;
+    }
+    SC_ASSERT (0 <= header.handler &&
+               header.handler < (int) agg->handlers.elem_count);
+    entry = (sc_aggregate_entry_t *)
+      sc_array_index_int (&agg->handlers, header.handler);
+    entry->handler (agg, header.source, data + pos + sizeof (header),
+                    (size_t) header.bytes, entry->user);
+    ++num_handled;
+  }
+  agg->num_delivered += num_handled;
+  return num_handled;
+}
+
+/** Send the buffer of one rank, or deliver it if it is our own.
+ * \return              The number of messages handled.
+ */
+static int
+sc_aggregate_flush_hop (sc_aggregate_t * agg, int hop)
+{
+  int                 num_handled;
+  sc_array_t          data;
+
+  if (agg->buffers[hop].elem_count == 0) {
+    return 0;
+  }
+
+  /* the handlers may append to the buffer again */
+  data = agg->buffers[hop];
+  sc_array_init (agg->buffers + hop, 1);
+  if (hop == agg->mpirank) {
+    num_handled = sc_aggregate_process (agg, data.array, data.elem_count);
+    sc_array_reset (&data);
+    return num_handled;
+  }
+
+#ifdef SC_AGGREGATE_HAVE_NBX
+  {
+    int                 mpiret;
+
+    /* synchronous sends tell us when the buffer has been received */
+    SC_ASSERT (data.elem_count <= (size_t) INT_MAX);
+    *(sc_array_t *) sc_array_push (&agg->in_flight) = data;
+    mpiret = MPI_Issend (data.array, (int) data.elem_count, MPI_BYTE, hop,
+                         SC_TAG_AGGREGATE, agg->mpicomm,
+                         (MPI_Request *) sc_array_push (&agg->requests));
+    SC_CHECK_MPI (mpiret);
+    ++agg->num_buffers;
+  }
+#else
+  SC_ABORT_NOT_REACHED ();
+#endif
+  return 0;
+}
+
+#ifdef SC_AGGREGATE_HAVE_NBX
+
+/** Receive and process all buffers that have arrived.
+ * \return              The number of messages handled.
+ */
+static int
+sc_aggregate_receive (sc_aggregate_t * agg)
+{
+  int                 mpiret;
+  int                 flag, count, num_handled = 0;
+  MPI_Status          status;
+
+  for (;;) {
+    mpiret = MPI_Iprobe (MPI_ANY_SOURCE, SC_TAG_AGGREGATE, agg->mpicomm,
+                         &flag, &status);
+    SC_CHECK_MPI (mpiret);
+    if (!flag) {
+      return num_handled;
+    }
+    mpiret = MPI_Get_count (&status, MPI_BYTE, &count);
+    SC_CHECK_MPI (mpiret);
+    sc_array_resize (&agg->recv_buffer, (size_t) count);
+    mpiret = MPI_Recv (agg->recv_buffer.array, count, MPI_BYTE,
+                       status.MPI_SOURCE, SC_TAG_AGGREGATE, agg->mpicomm,
+                       MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    num_handled += sc_aggregate_process (agg, agg->recv_buffer.array,
+                                         (size_t) count);
+  }
+}
+
+/** Free the buffers whose sends have completed. */
+static void
+sc_aggregate_release (sc_aggregate_t * agg)
+{
+  int                 mpiret;
+  int                 flag;
+  size_t              i, j;
+  MPI_Request        *request;
+
+  for (i = j = 0; i < agg->requests.elem_count; ++i) {
+    request = (MPI_Request *) sc_array_index (&agg->requests, i);
+    mpiret = MPI_Test (request, &flag, MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    if (flag) {
+      sc_array_reset ((sc_array_t *) sc_array_index (&agg->in_flight, i));
+    }
+    else {
+      *(MPI_Request *) sc_array_index (&agg->requests, j) = *request;
+      *(sc_array_t *) sc_array_index (&agg->in_flight, j) =
+        *(sc_array_t *) sc_array_index (&agg->in_flight, i);
+      ++j;
+    }
+  }
+  sc_array_resize (&agg->requests, j);
+  sc_array_resize (&agg->in_flight, j);
+}
+
+#endif /* SC_AGGREGATE_HAVE_NBX */
+
+sc_aggregate_t     *
+sc_aggregate_new (sc_MPI_Comm mpicomm, size_t flush_bytes,
+                  double flush_seconds, int route_nodes)
+{
+  int                 mpiret;
+  int                 i, local[2], *ids, *hop_of_node;
+  sc_MPI_Comm         intranode, internode;
+  sc_aggregate_t     *agg;
+
+  agg = SC_ALLOC_ZERO (sc_aggregate_t, 1);
+  mpiret = sc_MPI_Comm_dup (mpicomm, &agg->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (agg->mpicomm, &agg->mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (agg->mpicomm, &agg->mpirank);
+  SC_CHECK_MPI (mpiret);
+#ifndef SC_AGGREGATE_HAVE_NBX
+  SC_CHECK_ABORT (agg->mpisize == 1,
+                  "Message aggregation on many processes requires MPI 3");
+#endif
+  agg->flush_bytes = flush_bytes;
+  agg->flush_seconds = flush_seconds;
+  agg->last_flush = sc_MPI_Wtime ();
+
+  sc_array_init (&agg->handlers, sizeof (sc_aggregate_entry_t));
+  agg->buffers = SC_ALLOC (sc_array_t, agg->mpisize);
+  for (i = 0; i < agg->mpisize; ++i) {
+    sc_array_init (agg->buffers + i, 1);
+  }
+  agg->listed = SC_ALLOC_ZERO (char, agg->mpisize);
+  sc_array_init (&agg->nonempty, sizeof (int));
+  sc_array_init (&agg->requests, sizeof (sc_MPI_Request));
+  sc_array_init (&agg->in_flight, sizeof (sc_array_t));
+  sc_array_init (&agg->recv_buffer, 1);
+
+  /* every process sends to or through itself by default */
+  agg->next_hop = SC_ALLOC (int, agg->mpisize);
+  for (i = 0; i < agg->mpisize; ++i) {
+    agg->next_hop[i] = i;
+  }
+  agg->num_phases = 1;
+  if (!route_nodes) {
+    return agg;
+  }
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL) {
+    return agg;
+  }
+
+  /* identify a node by the lowest rank on it */
+  agg->num_phases = 2;
+  mpiret = sc_MPI_Comm_rank (intranode, &local[1]);
+  SC_CHECK_MPI (mpiret);
+  local[0] = agg->mpirank;
+  mpiret = sc_MPI_Bcast (local, 1, sc_MPI_INT, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+  ids = SC_ALLOC (int, 2 * agg->mpisize);
+  mpiret = sc_MPI_Allgather (local, 2, sc_MPI_INT, ids, 2, sc_MPI_INT,
+                             agg->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* go through the process on the other node of the same local rank */
+  hop_of_node = SC_ALLOC (int, agg->mpisize);
+  for (i = 0; i < agg->mpisize; ++i) {
+    hop_of_node[i] = -1;
+  }
+  for (i = 0; i < agg->mpisize; ++i) {
+    if (ids[2 * i + 1] == local[1]) {
+      hop_of_node[ids[2 * i]] = i;
+    }
+  }
+  for (i = 0; i < agg->mpisize; ++i) {
+    if (ids[2 * i] != local[0] && hop_of_node[ids[2 * i]] >= 0) {
+      agg->next_hop[i] = hop_of_node[ids[2 * i]];
+    }
+  }
+  SC_FREE (hop_of_node);
+  SC_FREE (ids);
+  return agg;
+}
+
+void
+sc_aggregate_destroy (sc_aggregate_t * agg)
+{
+  int                 mpiret;
+  int                 i;
+
+  SC_ASSERT (!agg->completing);
+  SC_ASSERT (agg->requests.elem_count == 0);
+
+  for (i = 0; i < agg->mpisize; ++i) {
+    SC_ASSERT (agg->buffers[i].elem_count == 0);
+    sc_array_reset (agg->buffers + i);
+  }
+  SC_FREE (agg->buffers);
+  SC_FREE (agg->listed);
+  SC_FREE (agg->next_hop);
+  sc_array_reset (&agg->handlers);
+  sc_array_reset (&agg->nonempty);
+  sc_array_reset (&agg->requests);
+  sc_array_reset (&agg->in_flight);
+  sc_array_reset (&agg->recv_buffer);
+
+  mpiret = sc_MPI_Comm_free (&agg->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (agg);
+}
+
+int
+sc_aggregate_register (sc_aggregate_t * agg, sc_aggregate_handler_t handler,
+                       void *user)
+{
+  sc_aggregate_entry_t *entry;
+
+  entry = (sc_aggregate_entry_t *) sc_array_push (&agg->handlers);
+  entry->handler = handler;
+  entry->user = user;
+
+  return (int) agg->handlers.elem_count - 1;
+}
+
+void
+sc_aggregate_send (sc_aggregate_t * agg, int dest, int handler,
+                   const void *data, size_t bytes)
+{
+  int                 hop;
+  sc_aggregate_header_t header;
+
+  SC_ASSERT (0 <= dest && dest < agg->mpisize);
+  SC_ASSERT (0 <= handler && handler < (int) agg->handlers.elem_count);
+  SC_ASSERT (bytes <= (size_t) INT_MAX);
+
+  header.source = agg->mpirank;
+  header.dest = dest;
+  header.handler = handler;
+  header.bytes = (int) bytes;
+  hop = agg->next_hop[dest];
+  sc_aggregate_append (agg, hop, &header, data);
+  ++agg->num_sent;
+
+  /* messages to ourselves wait for the next poll */
+  if (!agg->completing && hop != agg->mpirank &&
+      agg->buffers[hop].elem_count >= agg->flush_bytes) {
+    sc_aggregate_flush_hop (agg, hop);
+  }
+}
+
+int
+sc_aggregate_flush (sc_aggregate_t * agg)
+{
+  int                 hop, num_handled = 0;
+  size_t              i;
+
+  /* the list may grow while we deliver to ourselves */
+  for (i = 0; i < agg->nonempty.elem_count; ++i) {
+    hop = *(int *) sc_array_index (&agg->nonempty, i);
+    agg->listed[hop] = 0;
+    num_handled += sc_aggregate_flush_hop (agg, hop);
+  }
+  sc_array_truncate (&agg->nonempty);
+  agg->last_flush = sc_MPI_Wtime ();
+
+  return num_handled;
+}
+
+int
+sc_aggregate_poll (sc_aggregate_t * agg)
+{
+  int                 num_handled = 0;
+
+#ifdef SC_AGGREGATE_HAVE_NBX
+  num_handled += sc_aggregate_receive (agg);
+  sc_aggregate_release (agg);
+#endif
+  if (agg->flush_seconds >= 0. &&
+      sc_MPI_Wtime () - agg->last_flush >= agg->flush_seconds) {
+    num_handled += sc_aggregate_flush (agg);
+  }
+  else {
+    num_handled += sc_aggregate_flush_hop (agg, agg->mpirank);
+  }
+  return num_handled;
+}
+
+int
+sc_aggregate_complete (sc_aggregate_t * agg)
+{
+  int                 phase, num_handled = 0;
+
+  SC_ASSERT (!agg->completing);
+  agg->completing = 1;
+
+  /* forwarded messages are held back to the second phase */
+  for (phase = 0; phase < agg->num_phases; ++phase) {
+    num_handled += sc_aggregate_flush (agg);
+#ifdef SC_AGGREGATE_HAVE_NBX
+    if (agg->mpisize > 1) {
+      int                 mpiret;
+      int                 done, barrier_active;
+      MPI_Request         barrier;
+
+      /* nonblocking consensus on all buffers having been received */
+      barrier_active = done = 0;
+      while (!done) {
+        num_handled += sc_aggregate_receive (agg);
+        if (!barrier_active) {
+          sc_aggregate_release (agg);
+          if (agg->requests.elem_count == 0) {
+            mpiret = MPI_Ibarrier (agg->mpicomm, &barrier);
+            SC_CHECK_MPI (mpiret);
+            barrier_active = 1;
+          }
+        }
+        else {
+          mpiret = MPI_Test (&barrier, &done, MPI_STATUS_IGNORE);
+          SC_CHECK_MPI (mpiret);
+        }
+      }
+    }
+#endif
+  }
+
+  agg->completing = 0;
+  return num_handled;
+}
@@ -0,0 +1,169 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_aggregate.h
+ * Aggregation of many small messages into few large ones.
+ *
+ * Sending one MPI message per item is dominated by latency when the items
+ * are small.  Here every message is appended to a buffer for its
+ * destination, and a buffer is sent when it exceeds a size threshold, when
+ * a time threshold has passed since the last flush, or on an explicit
+ * flush.  On the receiving side, every message is passed to a handler
+ * function registered in advance, in the style of active messages.
+ *
+ * Optionally, messages are routed through the node communicators of
+ * \ref sc_mpi_comm_attach_node_comms.  A message to another node is first
+ * sent to the process on that node with the same rank within its node,
+ * which forwards it to its final destination.  Thus each process only
+ * exchanges buffers with its own node and one process on every other
+ * node, and the buffers become larger.
+ *
+ * Received messages are only processed in \ref sc_aggregate_poll and in
+ * the collective \ref sc_aggregate_complete, which returns when all
+ * messages sent before it have been delivered.  This requires MPI 3 when
+ * running on more than one process.
+ */
+
+#ifndef SC_AGGREGATE_H
+#define SC_AGGREGATE_H
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** The aggregation context. */
+typedef struct sc_aggregate sc_aggregate_t;
+
+/** Process one message on its destination process.
+ * The handler may send further messages, but it must not poll.
+ * \param [in] agg      The aggregation context.
+ * \param [in] source   The rank that sent the message.
+ * \param [in] data     The message, aligned to 8 bytes.  It is only valid
+ *                      during the call.
+ * \param [in] bytes    The size of the message.
+ * \param [in] user     The pointer passed to \ref sc_aggregate_register.
+ */
+typedef void        (*sc_aggregate_handler_t) (sc_aggregate_t * agg,
+                                               int source, const void *data,
+                                               size_t bytes, void *user);
+
+/** The aggregation context.  All members are read-only. */
+struct sc_aggregate
+{
+  sc_MPI_Comm         mpicomm;          /**< Private duplicate. */
+  int                 mpisize;          /**< Size of mpicomm. */
+  int                 mpirank;          /**< Rank in mpicomm. */
+  size_t              flush_bytes;      /**< Size threshold of a buffer. */
+  double              flush_seconds;    /**< Time threshold or negative. */
+  double              last_flush;       /**< Time of the last flush. */
+  int                *next_hop;         /**< Array [mpisize] of the rank
+                                             to send to for every final
+                                             destination. */
+  int                 num_phases;       /**< Two if routed, else one. */
+  sc_array_t          handlers;         /**< Registered handlers. */
+  sc_array_t         *buffers;          /**< Array [mpisize] of buffers. */
+  char               *listed;           /**< Array [mpisize]: Is the
+                                             rank in nonempty? */
+  sc_array_t          nonempty;         /**< Ranks with buffered data. */
+  sc_array_t          requests;         /**< Requests of buffers in flight. */
+  sc_array_t          in_flight;        /**< Buffers in flight. */
+  sc_array_t          recv_buffer;      /**< Reused for receiving. */
+  int                 completing;       /**< Inside sc_aggregate_complete. */
+  long                num_sent;         /**< Messages sent. */
+  long                num_delivered;    /**< Messages handled here. */
+  long                num_forwarded;    /**< Messages forwarded. */
+  long                num_buffers;      /**< Buffers sent with MPI. */
+};
+
+/** Create an aggregation context.  This function is collective.
+ * \param [in] mpicomm          The communicator is duplicated.
+ * \param [in] flush_bytes      A buffer is sent once it holds this many
+ *                              bytes.  Zero sends every message at once.
+ * \param [in] flush_seconds    All buffers are sent by \ref
+ *                              sc_aggregate_poll if this much time has
+ *                              passed since the last flush.  Negative
+ *                              to disable.
+ * \param [in] route_nodes      If true and node communicators are
+ *                              attached to mpicomm, route messages to
+ *                              other nodes through one process per node.
+ * \return                      The context, to be destroyed with
+ *                              \ref sc_aggregate_destroy.
+ */
+sc_aggregate_t     *sc_aggregate_new (sc_MPI_Comm mpicomm,
+                                      size_t flush_bytes,
+                                      double flush_seconds,
+                                      int route_nodes);
+
+/** Destroy an aggregation context.  This function is collective.
+ * \param [in,out] agg  No messages may be buffered or in flight, which is
+ *                      the case after \ref sc_aggregate_complete.
+ */
+void                sc_aggregate_destroy (sc_aggregate_t * agg);
+
+/** Register a message handler.
+ * All processes must register the same handlers in the same order.
+ * \param [in,out] agg  The aggregation context.
+ * \param [in] handler  The function to call for every message.
+ * \param [in] user     Passed to the handler.
+ * \return              The id of the handler to use in sending.
+ */
+int                 sc_aggregate_register (sc_aggregate_t * agg,
+                                           sc_aggregate_handler_t handler,
+                                           void *user);
+
+/** Send a message.  It is copied and may be modified on return.
+ * \param [in,out] agg  The aggregation context.
+ * \param [in] dest     The destination rank, which may be our own.
+ * \param [in] handler  The id of the handler on the destination.
+ * \param [in] data     The message.
+ * \param [in] bytes    The size of the message.
+ */
+void                sc_aggregate_send (sc_aggregate_t * agg, int dest,
+                                       int handler, const void *data,
+                                       size_t bytes);
+
+/** Send all buffered messages.
+ * Messages to ourselves are passed to their handlers right away.
+ * \param [in,out] agg  The aggregation context.
+ * \return              The number of messages handled.
+ */
+int                 sc_aggregate_flush (sc_aggregate_t * agg);
+
+/** Process the messages that have arrived and release buffers whose
+ * sends have completed.  Also flush if the time threshold has passed.
+ * \param [in,out] agg  The aggregation context.
+ * \return              The number of messages handled.
+ */
+int                 sc_aggregate_poll (sc_aggregate_t * agg);
+
+/** Deliver all messages that have been sent before this call.
+ * This function is collective.  Messages sent by handlers during the
+ * call are held back until the next flush.
+ * \param [in,out] agg  The aggregation context.
+ * \return              The number of messages handled.
+ */
+int                 sc_aggregate_complete (sc_aggregate_t * agg);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_AGGREGATE_H */
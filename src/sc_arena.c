@@ -0,0 +1,256 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_arena.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+static void        *
+sc_arena_malloc (size_t n)
+{
+  return sc_malloc (sc_package_id, n);
+}
+
+static void        *(*obstack_chunk_alloc) (size_t) = sc_arena_malloc;
+
+static void
+sc_arena_free (void *p)
+{
+  sc_free (sc_package_id, p);
+}
+
+static void         (*obstack_chunk_free) (void *) = sc_arena_free;
+
+/** Account for an allocation of the given size. */
+static void
+sc_arena_count (sc_arena_t * arena, size_t size)
+{
+  arena->bytes_used += size;
+  arena->high_water = SC_MAX (arena->high_water, arena->bytes_used);
+}
+
+/** Grow the most recent allocation in place or move it to a new block. */
+static void        *
+sc_arena_realloc (sc_allocator_t * allocator, void *ptr, size_t old_size,
+                  size_t new_size)
+{
+  char               *end;
+  void               *p;
+  sc_arena_t         *arena = (sc_arena_t *) allocator->user;
+  struct obstack     *ob = &arena->obstack;
+
+  if (new_size == 0) {
+    /* the memory is reclaimed when the arena is released */
+    return NULL;
+  }
+  if (ptr != NULL && new_size <= old_size) {
+    return ptr;
+  }
+
+  if (ptr != NULL) {
+    /* nothing but alignment padding may follow the last allocation */
+    end = (char *) ptr + old_size;
+    if ((char *) obstack_next_free (ob) >= end &&
+        (size_t) ((char *) obstack_next_free (ob) - end) <=
+        (size_t) obstack_alignment_mask (ob) &&
+        (size_t) (ob->chunk_limit - (char *) ptr) >= new_size) {
+      obstack_free (ob, ptr);
+      p = obstack_alloc (ob, (int) new_size);
+      SC_ASSERT (p == ptr);
+      sc_arena_count (arena, new_size - old_size);
+      return p;
+    }
+  }
+
+  p = sc_arena_alloc (arena, new_size);
+  if (ptr != NULL) {
+    memcpy (p, ptr, old_size);
+  }
+  return p;
+}
+
+sc_arena_t         *
+sc_arena_new (size_t chunk_size)
+{
+  sc_arena_t         *arena;
+
+  SC_ASSERT (chunk_size <= (size_t) INT_MAX);   /* obstack limited to int */
+
+  arena = SC_ALLOC_ZERO (sc_arena_t, 1);
+  obstack_begin (&arena->obstack, chunk_size > 0 ? (int) chunk_size :
+                 1 << 16);
+  arena->base = obstack_alloc (&arena->obstack, 0);
+  arena->allocator.realloc_fn = sc_arena_realloc;
+  arena->allocator.user = arena;
+
+  return arena;
+}
+
+void
+sc_arena_destroy (sc_arena_t * arena)
+{
+  obstack_free (&arena->obstack, NULL);
+  SC_FREE (arena);
+}
+
+void               *
+sc_arena_alloc (sc_arena_t * arena, size_t size)
+{
+  SC_ASSERT (size <= (size_t) INT_MAX);
+
+  sc_arena_count (arena, size);
+  ++arena->num_allocs;
+
+  return obstack_alloc (&arena->obstack, (int) size);
+}
+
+void               *
+sc_arena_alloc_aligned (sc_arena_t * arena, size_t size, size_t alignment)
+{
+  size_t              pad;
+  char               *p;
+
+  SC_ASSERT (alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  /* the obstack aligns every object to its default already */
+  if (alignment <= (size_t) obstack_alignment_mask (&arena->obstack) + 1) {
+    return sc_arena_alloc (arena, size);
+  }
+
+  /* otherwise leave room to move the start to the next multiple */
+  p = (char *) sc_arena_alloc (arena, size + alignment - 1);
+  pad = (alignment - (size_t) ((uintptr_t) p & (alignment - 1))) &
+    (alignment - 1);
+
+  return p + pad;
+}
+
+void
+sc_arena_mark (sc_arena_t * arena, sc_arena_mark_t * mark)
+{
+  mark->position = obstack_alloc (&arena->obstack, 0);
+  mark->bytes_used = arena->bytes_used;
+  mark->num_allocs = arena->num_allocs;
+}
+
+void
+sc_arena_release (sc_arena_t * arena, const sc_arena_mark_t * mark)
+{
+  SC_ASSERT (mark->bytes_used <= arena->bytes_used);
+  SC_ASSERT (mark->num_allocs <= arena->num_allocs);
+
+  /* freeing the empty object at the mark frees everything after it */
+  obstack_free (&arena->obstack, mark->position);
+  arena->bytes_used = mark->bytes_used;
+  arena->num_allocs = mark->num_allocs;
+}
+
+void
+sc_arena_clear (sc_arena_t * arena)
+{
+  obstack_free (&arena->obstack, arena->base);
+  arena->base = obstack_alloc (&arena->obstack, 0);
+  arena->bytes_used = 0;
+  arena->num_allocs = 0;
+}
+
+size_t
+sc_arena_memory_used (sc_arena_t * arena)
+{
+  return sizeof (sc_arena_t) + obstack_memory_used (&arena->obstack);
+}
+
+sc_allocator_t     *
+sc_arena_allocator (sc_arena_t * arena)
+{
+  return &arena->allocator;
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+static pthread_once_t sc_arena_once = PTHREAD_ONCE_INIT;
+static pthread_key_t sc_arena_key;
+
+static void
+sc_arena_key_destroy (void *v)
+{
+  sc_arena_destroy ((sc_arena_t *) v);
+}
+
+static void
+sc_arena_key_create (void)
+{
+  int                 pth;
+
+  pth = pthread_key_create (&sc_arena_key, sc_arena_key_destroy);
+  SC_CHECK_ABORT (pth == 0, "Fail in pthread_key_create");
+}
+
+#else
+
+static sc_arena_t  *sc_arena_single = NULL;
+
+#endif /* SC_ENABLE_PTHREAD */
+
+sc_arena_t         *
+sc_arena_thread (void)
+{
+  sc_arena_t         *arena;
+
+#ifdef SC_ENABLE_PTHREAD
+  pthread_once (&sc_arena_once, sc_arena_key_create);
+  arena = (sc_arena_t *) pthread_getspecific (sc_arena_key);
+  if (arena == NULL) {
+    arena = sc_arena_new (0);
+    pthread_setspecific (sc_arena_key, arena);
+  }
+#else
+  if (sc_arena_single == NULL) {
+    sc_arena_single = sc_arena_new (0);
+  }
+  arena = sc_arena_single;
+#endif
+
+  return arena;
+}
+
+void
+sc_arena_thread_destroy (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  sc_arena_t         *arena;
+
+  pthread_once (&sc_arena_once, sc_arena_key_create);
+  arena = (sc_arena_t *) pthread_getspecific (sc_arena_key);
+  if (arena != NULL) {
+    pthread_setspecific (sc_arena_key, NULL);
+    sc_arena_destroy (arena);
+  }
+#else
+  if (sc_arena_single != NULL) {
+    sc_arena_destroy (sc_arena_single);
+    sc_arena_single = NULL;
+  }
+#endif
+}
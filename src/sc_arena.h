@@ -0,0 +1,152 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_arena.h
+ * Region allocator for variable-size scratch memory.
+ *
+ * An arena hands out memory of any size and alignment by bumping a pointer
+ * through large chunks, which are obtained with sc_malloc by an obstack.
+ * Objects are not freed individually.  Instead, the application takes a
+ * mark, for example at the start of an assembly phase, and later releases
+ * everything allocated since the mark in one call.  The arena records its
+ * current and maximal usage.
+ *
+ * An arena is not thread-safe.  Every thread may create its own, or use
+ * the one returned by \ref sc_arena_thread.  An arena can provide the
+ * memory of an sc_array_t through \ref sc_arena_allocator.
+ */
+
+#ifndef SC_ARENA_H
+#define SC_ARENA_H
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** The arena structure is public so its statistics can be read. */
+typedef struct sc_arena
+{
+  /* interface variables */
+  size_t              bytes_used;       /**< Bytes allocated and not released,
+                                             including alignment padding. */
+  size_t              high_water;       /**< Maximum of bytes_used. */
+  size_t              num_allocs;       /**< Allocations not released. */
+
+  /* implementation variables */
+  struct obstack      obstack;  /**< Holds the chunks. */
+  void               *base;     /**< Empty object at the very start. */
+  sc_allocator_t      allocator;        /**< Hook for containers. */
+}
+sc_arena_t;
+
+/** A position in an arena to release back to. */
+typedef struct sc_arena_mark
+{
+  void               *position;         /**< Empty object at the mark. */
+  size_t              bytes_used;       /**< Usage at the mark. */
+  size_t              num_allocs;       /**< Allocations at the mark. */
+}
+sc_arena_mark_t;
+
+/** Create a new, empty arena.
+ * \param [in] chunk_size   Preferred size of the chunks in bytes, or 0 for
+ *                          a default of 64 KiB.  Larger allocations get a
+ *                          chunk of their own.
+ * \return                  An arena without allocations.
+ */
+sc_arena_t         *sc_arena_new (size_t chunk_size);
+
+/** Destroy an arena and free all memory allocated from it.
+ * \param [in,out] arena    This arena and its chunks are freed.
+ */
+void                sc_arena_destroy (sc_arena_t * arena);
+
+/** Allocate memory with the default alignment of the arena.
+ * This alignment is suitable for any basic type.
+ * \param [in,out] arena    The arena to allocate from.
+ * \param [in] size         Number of bytes; may be 0.
+ * \return                  Uninitialized memory valid until the arena is
+ *                          released to an earlier mark or destroyed.
+ */
+void               *sc_arena_alloc (sc_arena_t * arena, size_t size);
+
+/** Allocate memory with a given alignment.
+ * \param [in,out] arena    The arena to allocate from.
+ * \param [in] size         Number of bytes; may be 0.
+ * \param [in] alignment    A power of two.
+ * \return                  Uninitialized memory whose address is a multiple
+ *                          of \a alignment.
+ */
+void               *sc_arena_alloc_aligned (sc_arena_t * arena, size_t size,
+                                            size_t alignment);
+
+/** Record the current position of an arena.
+ * \param [in,out] arena    The arena to mark.
+ * \param [out] mark        Release to this mark by \ref sc_arena_release.
+ */
+void                sc_arena_mark (sc_arena_t * arena, sc_arena_mark_t * mark);
+
+/** Free all memory allocated since a mark was taken.
+ * Marks taken after this one become invalid.  The mark itself remains
+ * valid and may be released to again.
+ * \param [in,out] arena    The arena that was marked.
+ * \param [in] mark         A mark taken on this arena.
+ */
+void                sc_arena_release (sc_arena_t * arena,
+                                      const sc_arena_mark_t * mark);
+
+/** Free all allocations of an arena but keep its first chunk.
+ * \param [in,out] arena    The arena is empty afterwards.
+ */
+void                sc_arena_clear (sc_arena_t * arena);
+
+/** Return the size in bytes reserved by an arena.
+ * \param [in] arena        The arena including its chunks is counted.
+ */
+size_t              sc_arena_memory_used (sc_arena_t * arena);
+
+/** Return an allocator that takes memory from an arena.
+ * Use it with \ref sc_array_init_allocator for arrays that live within one
+ * phase.  Freeing through this allocator does nothing, and growing copies
+ * the data unless it is the most recent allocation of the arena.  An array
+ * must be reset before the arena is released below its allocations.
+ * \param [in] arena        The allocator remains valid with the arena.
+ * \return                  Pointer to the allocator inside the arena.
+ */
+sc_allocator_t     *sc_arena_allocator (sc_arena_t * arena);
+
+/** Return an arena that is private to the calling thread.
+ * It is created on first use with the default chunk size.  With pthreads,
+ * it is destroyed when the thread exits.  Since \ref sc_finalize checks
+ * for leaks, threads still running at that time, such as the main thread
+ * and the threads of a pool, call \ref sc_arena_thread_destroy before.
+ * \return                  The arena of the calling thread.
+ */
+sc_arena_t         *sc_arena_thread (void);
+
+/** Destroy the arena of the calling thread if it exists. */
+void                sc_arena_thread_destroy (void);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_ARENA_H */
@@ -49,7 +49,7 @@ static void avl_rebalance(avl_tree_t *, avl_node_t *);
 #define CALC_DEPTH(n)  ((L_DEPTH(n)>R_DEPTH(n)?L_DEPTH(n):R_DEPTH(n)) + 1)
 #endif
 
-#ifndef AVL_DEPTH
+#ifdef AVL_COUNT
 /* Also known as ffs() (from BSD) */
 static int lg(unsigned int u) {
 	int r = 1;
@@ -63,6 +63,22 @@ static int lg(unsigned int u) {
 }
 #endif
 
+#ifdef AVL_COUNT
+/* Balance of two subtrees with the given counts: -1 if the left one is
+ * too heavy, 1 if the right one is, and 0 otherwise. */
+static int avl_count_balance(unsigned l, unsigned r) {
+	int pl;
+
+	pl = lg(l);
+
+	if(r>>(pl+1))
+		return 1;
+	if(pl<2 || r>>(pl-2))
+		return 0;
+	return -1;
+}
+#endif
+
 static int avl_check_balance(avl_node_t *avlnode) {
 #ifdef AVL_DEPTH
 	int d;
@@ -74,17 +90,7 @@ static int avl_check_balance(avl_node_t *avlnode) {
  *	d = d<-1?-1:d>1?1:0;
  */
 #ifdef AVL_COUNT
-	int pl;
-        unsigned r;
-
-	pl = lg(L_COUNT(avlnode));
-	r = R_COUNT(avlnode);
-
-	if(r>>(pl+1))
-		return 1;
-	if(pl<2 || r>>(pl-2))
-		return 0;
-	return -1;
+	return avl_count_balance(L_COUNT(avlnode), R_COUNT(avlnode));
 #else
 #error No balancing possible.
 #endif
@@ -184,6 +190,7 @@ avl_tree_t *avl_init_tree(avl_tree_t *rc, avl_compare_t cmp, avl_freeitem_t free
 		rc->top = NULL;
 		rc->cmp = cmp;
 		rc->freeitem = freeitem;
+		rc->allocator = NULL;
 	}
 	return rc;
 }
@@ -192,6 +199,25 @@ avl_tree_t *avl_alloc_tree(avl_compare_t cmp, avl_freeitem_t freeitem) {
         return avl_init_tree(SC_ALLOC(avl_tree_t, 1), cmp, freeitem);
 }
 
+void avl_set_allocator(avl_tree_t *avltree, sc_mempool_t *allocator) {
+	SC_ASSERT(avltree->top == NULL);
+	SC_ASSERT(allocator == NULL || allocator->elem_size == sizeof(avl_node_t));
+	avltree->allocator = allocator;
+}
+
+static avl_node_t *avl_alloc_node(avl_tree_t *avltree) {
+	return avltree->allocator
+		? (avl_node_t *) sc_mempool_alloc(avltree->allocator)
+		: SC_ALLOC(avl_node_t, 1);
+}
+
+static void avl_free_node(avl_tree_t *avltree, avl_node_t *avlnode) {
+	if(avltree->allocator)
+		sc_mempool_free(avltree->allocator, avlnode);
+	else
+		SC_FREE(avlnode);
+}
+
 void avl_clear_tree(avl_tree_t *avltree) {
 	avltree->top = avltree->head = avltree->tail = NULL;
 }
@@ -206,7 +232,7 @@ void avl_free_nodes(avl_tree_t *avltree) {
 		next = node->next;
 		if(freeitem)
 			freeitem(node->item);
-		SC_FREE(node);
+		avl_free_node(avltree, node);
 	}
 
 	avl_clear_tree(avltree);
@@ -324,11 +350,11 @@ avl_node_t *avl_insert_node(avl_tree_t *avltree, avl_node_t *newnode) {
 avl_node_t *avl_insert(avl_tree_t *avltree, void *item) {
 	avl_node_t *newnode;
 
-	newnode = avl_init_node(SC_ALLOC(avl_node_t, 1), item);
+	newnode = avl_init_node(avl_alloc_node(avltree), item);
 	if(newnode) {
 		if(avl_insert_node(avltree, newnode))
 			return newnode;
-		SC_FREE(newnode);
+		avl_free_node(avltree, newnode);
 		/* errno = EEXIST; */
                 return NULL;
 	}
@@ -403,7 +429,7 @@ void *avl_delete_node(avl_tree_t *avltree, avl_node_t *avlnode) {
 		avl_unlink_node(avltree, avlnode);
 		if(avltree->freeitem)
 			avltree->freeitem(item);
-		SC_FREE(avlnode);
+		avl_free_node(avltree, avlnode);
 	}
 	return item;
 }
@@ -667,4 +693,199 @@ avl_to_array (avl_tree_t * avltree, sc_array_t * array)
   SC_ASSERT (adata.iz == adata.array->elem_count);
 }
 
+static avl_node_t  *
+avl_from_array_recursion (avl_tree_t * avltree, sc_array_t * items,
+                          size_t lo, size_t hi, avl_node_t * parent,
+                          avl_node_t ** prev)
+{
+  const size_t        mid = lo + (hi - lo) / 2;
+  avl_node_t         *node;
+
+  node = avl_alloc_node (avltree);
+  node->item = *(void **) sc_array_index (items, mid);
+  node->parent = parent;
+  node->left = lo < mid ?
+    avl_from_array_recursion (avltree, items, lo, mid, node, prev) : NULL;
+
+  /* append the node to the list in order */
+  SC_ASSERT (*prev == NULL || avltree->cmp ((*prev)->item, node->item) < 0);
+  node->prev = *prev;
+  if (*prev != NULL)
+    (*prev)->next = node;
+  else
+    avltree->head = node;
+  *prev = node;
+
+  node->right = mid + 1 < hi ?
+    avl_from_array_recursion (avltree, items, mid + 1, hi, node, prev) : NULL;
+  node->count = (unsigned int) (hi - lo);
+#ifdef AVL_DEPTH
+  node->depth = CALC_DEPTH (node);
+#endif
+  return node;
+}
+
+void
+avl_from_array (avl_tree_t * avltree, sc_array_t * items)
+{
+  avl_node_t         *prev;
+
+  SC_ASSERT (avltree->top == NULL);
+  SC_ASSERT (items->elem_size == sizeof (void *));
+
+  if (items->elem_count == 0)
+    return;
+
+  prev = NULL;
+  avltree->top = avl_from_array_recursion (avltree, items, 0,
+                                           items->elem_count, NULL, &prev);
+  prev->next = NULL;
+  avltree->tail = prev;
+}
+
+/** Join two subtrees and a node between them into one balanced subtree.
+ * All items of l must be less than the item of k, which must be less
+ * than all items of r.  The roots of l and r must not have a parent.
+ * We attach k to the spine of the heavier subtree where the counts are
+ * balanced and rebalance upwards as after an insertion.
+ * \return             The root of the joined subtree without a parent.
+ */
+static avl_node_t  *
+avl_join_nodes (avl_node_t * l, avl_node_t * k, avl_node_t * r)
+{
+  int                 balance;
+  avl_node_t         *p;
+  avl_tree_t          sub;
+
+  p = NULL;
+  balance = avl_count_balance (NODE_COUNT (l), NODE_COUNT (r));
+  if (balance < 0) {
+    sub.top = l;
+    while (avl_count_balance (NODE_COUNT (l), NODE_COUNT (r)) < 0) {
+      p = l;
+      l = l->right;
+    }
+    p->right = k;
+  }
+  else if (balance > 0) {
+    sub.top = r;
+    while (avl_count_balance (NODE_COUNT (l), NODE_COUNT (r)) > 0) {
+      p = r;
+      r = r->left;
+    }
+    p->left = k;
+  }
+
+  k->left = l;
+  if (l != NULL)
+    l->parent = k;
+  k->right = r;
+  if (r != NULL)
+    r->parent = k;
+  k->parent = p;
+  if (p == NULL)
+    sub.top = k;
+
+  avl_rebalance (&sub, k);
+  return sub.top;
+}
+
+/** Split a subtree into the nodes less than an item and the others. */
+static void
+avl_split_nodes (avl_compare_t cmp, avl_node_t * node, const void *item,
+                 avl_node_t ** left, avl_node_t ** right)
+{
+  avl_node_t         *l, *r, *sub;
+
+  if (node == NULL) {
+    *left = *right = NULL;
+    return;
+  }
+
+  l = node->left;
+  if (l != NULL)
+    l->parent = NULL;
+  r = node->right;
+  if (r != NULL)
+    r->parent = NULL;
+
+  if (cmp (item, node->item) <= 0) {
+    avl_split_nodes (cmp, l, item, left, &sub);
+    *right = avl_join_nodes (sub, node, r);
+  }
+  else {
+    avl_split_nodes (cmp, r, item, &sub, right);
+    *left = avl_join_nodes (l, node, sub);
+  }
+}
+
+void
+avl_split (avl_tree_t * avltree, const void *item, avl_tree_t * right)
+{
+  avl_node_t         *first, *left_top, *right_top;
+
+  avl_init_tree (right, avltree->cmp, avltree->freeitem);
+  right->allocator = avltree->allocator;
+
+  /* find the first node that moves */
+  if (avl_search_closest (avltree, item, &first) > 0)
+    first = first->next;
+  if (first == NULL)
+    return;
+  if (first == avltree->head) {
+    right->head = avltree->head;
+    right->tail = avltree->tail;
+    right->top = avltree->top;
+    avl_clear_tree (avltree);
+    return;
+  }
+
+  avl_split_nodes (avltree->cmp, avltree->top, item, &left_top, &right_top);
+
+  /* cut the list in order before the first node that moves */
+  right->head = first;
+  right->tail = avltree->tail;
+  right->top = right_top;
+  avltree->tail = first->prev;
+  avltree->tail->next = NULL;
+  avltree->top = left_top;
+  first->prev = NULL;
+}
+
+void
+avl_join (avl_tree_t * avltree, avl_tree_t * right)
+{
+  avl_node_t         *k;
+
+  SC_ASSERT (avltree->allocator == right->allocator);
+
+  if (right->top == NULL)
+    return;
+  if (avltree->top == NULL) {
+    avltree->head = right->head;
+    avltree->tail = right->tail;
+    avltree->top = right->top;
+    avl_clear_tree (right);
+    return;
+  }
+  SC_ASSERT (avltree->cmp (avltree->tail->item, right->head->item) < 0);
+
+  /* the smallest node of right goes between the trees */
+  k = right->head;
+  avl_unlink_node (right, k);
+
+  k->prev = avltree->tail;
+  avltree->tail->next = k;
+  k->next = right->head;
+  if (right->head != NULL) {
+    right->head->prev = k;
+    avltree->tail = right->tail;
+  }
+  else
+    avltree->tail = k;
+
+  avltree->top = avl_join_nodes (avltree->top, k, right->top);
+  avl_clear_tree (right);
+}
+
 #endif /* AVL_COUNT */
@@ -85,6 +85,7 @@ typedef struct avl_tree_t {
 	avl_node_t *top;
 	avl_compare_t cmp;
 	avl_freeitem_t freeitem;
+	sc_mempool_t *allocator;
 } avl_tree_t;
 
 /* Initializes a new tree for elements that will be ordered using
@@ -99,6 +100,13 @@ extern avl_tree_t *avl_init_tree(avl_tree_t *avltree, avl_compare_t, avl_freeite
  * O(1) */
 extern avl_tree_t *avl_alloc_tree(avl_compare_t, avl_freeitem_t);
 
+/* Sets the memory pool used to allocate the nodes of avl_insert and
+ * avl_from_array, which must have the element size sizeof(avl_node_t).
+ * If NULL, which is the default, nodes are allocated with SC_ALLOC.
+ * The tree must be empty.  The pool is not destroyed with the tree.
+ * O(1) */
+extern void avl_set_allocator(avl_tree_t *, sc_mempool_t *allocator);
+
 /* Frees the entire tree efficiently. Nodes will be free()d.
  * If the tree's freeitem is not NULL it will be invoked on every item.
  * O(n) */
@@ -205,6 +213,25 @@ extern unsigned int avl_index(const avl_node_t *);
 * O(n) */
 extern void avl_to_array (avl_tree_t *, sc_array_t *);
 
+/* Fills an empty tree with the items of an array of void *, which must
+ * be sorted strictly ascending by the compare function of the tree.
+ * The tree is perfectly balanced.
+ * O(n) */
+extern void avl_from_array (avl_tree_t *, sc_array_t *);
+
+/* Moves all items that are greater than or equal to the given item
+ * into the tree right, which is initialized by this function with the
+ * compare and freeitem functions and the allocator of the first tree.
+ * The previous contents of right are overwritten.
+ * O(lg n) */
+extern void avl_split (avl_tree_t *, const void *item, avl_tree_t *right);
+
+/* Appends all items of the tree right to the first tree, which leaves
+ * right empty.  All items of right must be greater than those of the
+ * first tree, and both trees must use the same allocator.
+ * O(lg n) */
+extern void avl_join (avl_tree_t *, avl_tree_t *right);
+
 #endif /* AVL_COUNT */
 
 SC_EXTERN_C_END;
@@ -0,0 +1,749 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_bptree.h>
+
+#define SC_BPTREE_LEAF_MIN (SC_BPTREE_LEAF / 2)
+#define SC_BPTREE_INNER_MIN (SC_BPTREE_FANOUT / 2)
+
+typedef struct sc_bptree_leaf
+{
+  int                 num;
+  struct sc_bptree_leaf *next;
+  void               *items[SC_BPTREE_LEAF];
+}
+sc_bptree_leaf_t;
+
+typedef struct sc_bptree_inner
+{
+  int                 num;
+  void               *keys[SC_BPTREE_FANOUT];   /* smallest item below */
+  size_t              counts[SC_BPTREE_FANOUT]; /* number of items below */
+  void               *child[SC_BPTREE_FANOUT];
+}
+sc_bptree_inner_t;
+
+static void        *
+sc_bptree_node_min (void *node, int level)
+{
+  return level == 0 ? ((sc_bptree_leaf_t *) node)->items[0] :
+    ((sc_bptree_inner_t *) node)->keys[0];
+}
+
+static int
+sc_bptree_node_num (void *node, int level)
+{
+  return level == 0 ? ((sc_bptree_leaf_t *) node)->num :
+    ((sc_bptree_inner_t *) node)->num;
+}
+
+static size_t
+sc_bptree_node_count (void *node, int level)
+{
+  int                 j;
+  size_t              count;
+  sc_bptree_inner_t  *inner;
+
+  if (level == 0) {
+    return (size_t) ((sc_bptree_leaf_t *) node)->num;
+  }
+  inner = (sc_bptree_inner_t *) node;
+  count = 0;
+  for (j = 0; j < inner->num; ++j) {
+    count += inner->counts[j];
+  }
+  return count;
+}
+
+/** Return the last child whose smallest item is not greater than item. */
+static int
+sc_bptree_inner_find (sc_bptree_t * tree, sc_bptree_inner_t * inner,
+                      const void *item)
+{
+  int                 lo, hi, mid;
+
+  lo = 1;
+  hi = inner->num;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (tree->compare (inner->keys[mid], item) <= 0) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return lo - 1;
+}
+
+/** Return the first position whose item is not less than item. */
+static int
+sc_bptree_leaf_find (sc_bptree_t * tree, sc_bptree_leaf_t * leaf,
+                     const void *item, int *is_found)
+{
+  int                 lo, hi, mid, c;
+
+  lo = 0;
+  hi = leaf->num;
+  *is_found = 0;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    c = tree->compare (leaf->items[mid], item);
+    if (c < 0) {
+      lo = mid + 1;
+    }
+    else {
+      /* the last such position is the result */
+      *is_found = (c == 0);
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static sc_bptree_leaf_t *
+sc_bptree_find_leaf (sc_bptree_t * tree, const void *item)
+{
+  int                 level;
+  void               *node;
+  sc_bptree_inner_t  *inner;
+
+  node = tree->root;
+  for (level = tree->height; level > 0; --level) {
+    inner = (sc_bptree_inner_t *) node;
+    node = inner->child[sc_bptree_inner_find (tree, inner, item)];
+  }
+  return (sc_bptree_leaf_t *) node;
+}
+
+static sc_bptree_leaf_t *
+sc_bptree_leaf_new (sc_bptree_t * tree)
+{
+  sc_bptree_leaf_t   *leaf;
+
+  leaf = (sc_bptree_leaf_t *) sc_mempool_alloc (tree->leaf_pool);
+  leaf->num = 0;
+  leaf->next = NULL;
+  return leaf;
+}
+
+sc_bptree_t        *
+sc_bptree_new (sc_bptree_compare_t compare)
+{
+  sc_bptree_t        *tree;
+
+  SC_ASSERT (compare != NULL);
+
+  tree = SC_ALLOC (sc_bptree_t, 1);
+  tree->elem_count = 0;
+  tree->height = 0;
+  tree->compare = compare;
+  tree->leaf_pool = sc_mempool_new (sizeof (sc_bptree_leaf_t));
+  tree->inner_pool = sc_mempool_new (sizeof (sc_bptree_inner_t));
+  tree->first = sc_bptree_leaf_new (tree);
+  tree->root = tree->first;
+
+  return tree;
+}
+
+void
+sc_bptree_destroy (sc_bptree_t * tree)
+{
+  sc_mempool_destroy (tree->leaf_pool);
+  sc_mempool_destroy (tree->inner_pool);
+  SC_FREE (tree);
+}
+
+size_t
+sc_bptree_memory_used (sc_bptree_t * tree)
+{
+  return sizeof (sc_bptree_t) +
+    sc_mempool_memory_used (tree->leaf_pool) +
+    sc_mempool_memory_used (tree->inner_pool);
+}
+
+void
+sc_bptree_bulk_load (sc_bptree_t * tree, sc_array_t * items)
+{
+  const size_t        n = items->elem_count;
+  int                 level;
+  size_t              num_nodes, num_parents, per, extra, offset, k;
+  void              **nodes;
+  sc_bptree_leaf_t   *leaf, *prev;
+  sc_bptree_inner_t  *inner;
+
+  SC_ASSERT (tree->elem_count == 0);
+  SC_ASSERT (items->elem_size == sizeof (void *));
+
+  if (n == 0) {
+    return;
+  }
+  sc_mempool_free (tree->leaf_pool, tree->root);
+
+  /* distribute the items evenly such that every leaf is at least half full */
+  num_nodes = (n + SC_BPTREE_LEAF - 1) / SC_BPTREE_LEAF;
+  nodes = SC_ALLOC (void *, num_nodes);
+  per = n / num_nodes;
+  extra = n % num_nodes;
+  offset = 0;
+  prev = NULL;
+  for (k = 0; k < num_nodes; ++k) {
+    leaf = sc_bptree_leaf_new (tree);
+    leaf->num = (int) (per + (k < extra));
+    memcpy (leaf->items, sc_array_index (items, offset),
+            leaf->num * sizeof (void *));
+    offset += leaf->num;
+    if (prev == NULL) {
+      tree->first = leaf;
+    }
+    else {
+      SC_ASSERT (tree->compare (prev->items[prev->num - 1],
+                                leaf->items[0]) < 0);
+      prev->next = leaf;
+    }
+    prev = leaf;
+    nodes[k] = leaf;
+  }
+  SC_ASSERT (offset == n);
+
+  /* build the inner levels bottom up in the same way */
+  for (level = 0; num_nodes > 1; ++level) {
+    num_parents = (num_nodes + SC_BPTREE_FANOUT - 1) / SC_BPTREE_FANOUT;
+    per = num_nodes / num_parents;
+    extra = num_nodes % num_parents;
+    offset = 0;
+    for (k = 0; k < num_parents; ++k) {
+      inner = (sc_bptree_inner_t *) sc_mempool_alloc (tree->inner_pool);
+      for (inner->num = 0; inner->num < (int) (per + (k < extra));
+           ++inner->num) {
+        inner->child[inner->num] = nodes[offset];
+        inner->keys[inner->num] = sc_bptree_node_min (nodes[offset], level);
+        inner->counts[inner->num] =
+          sc_bptree_node_count (nodes[offset], level);
+        ++offset;
+      }
+      nodes[k] = inner;
+    }
+    SC_ASSERT (offset == num_nodes);
+    num_nodes = num_parents;
+  }
+
+  tree->root = nodes[0];
+  tree->height = level;
+  tree->elem_count = n;
+  SC_FREE (nodes);
+}
+
+/** Insert below a node and return a new right sibling if it is split. */
+static void        *
+sc_bptree_insert_rec (sc_bptree_t * tree, void *node, int level,
+                      void *item, void **found, int *added)
+{
+  int                 i, pos, is_found;
+  void               *sibling;
+  sc_bptree_leaf_t   *leaf, *lright;
+  sc_bptree_inner_t  *inner, *iright;
+
+  if (level == 0) {
+    leaf = (sc_bptree_leaf_t *) node;
+    pos = sc_bptree_leaf_find (tree, leaf, item, &is_found);
+    if (is_found) {
+      if (found != NULL) {
+        *found = leaf->items[pos];
+      }
+      *added = 0;
+      return NULL;
+    }
+    *added = 1;
+
+    /* split a full leaf into halves and insert into one of them */
+    lright = NULL;
+    if (leaf->num == SC_BPTREE_LEAF) {
+      lright = sc_bptree_leaf_new (tree);
+      lright->num = SC_BPTREE_LEAF - SC_BPTREE_LEAF_MIN;
+      memcpy (lright->items, leaf->items + SC_BPTREE_LEAF_MIN,
+              lright->num * sizeof (void *));
+      leaf->num = SC_BPTREE_LEAF_MIN;
+      lright->next = leaf->next;
+      leaf->next = lright;
+      if (pos > SC_BPTREE_LEAF_MIN) {
+        leaf = lright;
+        pos -= SC_BPTREE_LEAF_MIN;
+      }
+    }
+    memmove (leaf->items + pos + 1, leaf->items + pos,
+             (leaf->num - pos) * sizeof (void *));
+    leaf->items[pos] = item;
+    ++leaf->num;
+    return lright;
+  }
+
+  inner = (sc_bptree_inner_t *) node;
+  i = sc_bptree_inner_find (tree, inner, item);
+  sibling = sc_bptree_insert_rec (tree, inner->child[i], level - 1,
+                                  item, found, added);
+  if (!*added) {
+    return NULL;
+  }
+  inner->keys[i] = sc_bptree_node_min (inner->child[i], level - 1);
+  if (sibling == NULL) {
+    ++inner->counts[i];
+    return NULL;
+  }
+  inner->counts[i] = sc_bptree_node_count (inner->child[i], level - 1);
+
+  /* split a full node into halves and add the sibling to one of them */
+  iright = NULL;
+  pos = i + 1;
+  if (inner->num == SC_BPTREE_FANOUT) {
+    iright = (sc_bptree_inner_t *) sc_mempool_alloc (tree->inner_pool);
+    iright->num = SC_BPTREE_FANOUT - SC_BPTREE_INNER_MIN;
+    memcpy (iright->keys, inner->keys + SC_BPTREE_INNER_MIN,
+            iright->num * sizeof (void *));
+    memcpy (iright->counts, inner->counts + SC_BPTREE_INNER_MIN,
+            iright->num * sizeof (size_t));
+    memcpy (iright->child, inner->child + SC_BPTREE_INNER_MIN,
+            iright->num * sizeof (void *));
+    inner->num = SC_BPTREE_INNER_MIN;
+    if (pos > SC_BPTREE_INNER_MIN) {
+      inner = iright;
+      pos -= SC_BPTREE_INNER_MIN;
+    }
+  }
+  memmove (inner->keys + pos + 1, inner->keys + pos,
+           (inner->num - pos) * sizeof (void *));
+  memmove (inner->counts + pos + 1, inner->counts + pos,
+           (inner->num - pos) * sizeof (size_t));
+  memmove (inner->child + pos + 1, inner->child + pos,
+           (inner->num - pos) * sizeof (void *));
+  inner->keys[pos] = sc_bptree_node_min (sibling, level - 1);
+  inner->counts[pos] = sc_bptree_node_count (sibling, level - 1);
+  inner->child[pos] = sibling;
+  ++inner->num;
+  return iright;
+}
+
+int
+sc_bptree_insert (sc_bptree_t * tree, void *item, void **found)
+{
+  int                 added;
+  void               *sibling;
+  sc_bptree_inner_t  *root;
+
+  sibling = sc_bptree_insert_rec (tree, tree->root, tree->height,
+                                  item, found, &added);
+  if (!added) {
+    return 0;
+  }
+  ++tree->elem_count;
+
+  /* a split of the root adds a level */
+  if (sibling != NULL) {
+    root = (sc_bptree_inner_t *) sc_mempool_alloc (tree->inner_pool);
+    root->num = 2;
+    root->child[0] = tree->root;
+    root->child[1] = sibling;
+    root->keys[0] = sc_bptree_node_min (tree->root, tree->height);
+    root->keys[1] = sc_bptree_node_min (sibling, tree->height);
+    root->counts[1] = sc_bptree_node_count (sibling, tree->height);
+    root->counts[0] = tree->elem_count - root->counts[1];
+    tree->root = root;
+    ++tree->height;
+  }
+  return 1;
+}
+
+/** Move the last entry of child i - 1 to the front of child i. */
+static void
+sc_bptree_borrow_left (sc_bptree_inner_t * inner, int i, int level)
+{
+  size_t              moved;
+  sc_bptree_leaf_t   *lleft, *lchild;
+  sc_bptree_inner_t  *ileft, *ichild;
+
+  if (level == 0) {
+    lleft = (sc_bptree_leaf_t *) inner->child[i - 1];
+    lchild = (sc_bptree_leaf_t *) inner->child[i];
+    memmove (lchild->items + 1, lchild->items,
+             lchild->num * sizeof (void *));
+    lchild->items[0] = lleft->items[--lleft->num];
+    ++lchild->num;
+    moved = 1;
+  }
+  else {
+    ileft = (sc_bptree_inner_t *) inner->child[i - 1];
+    ichild = (sc_bptree_inner_t *) inner->child[i];
+    memmove (ichild->keys + 1, ichild->keys, ichild->num * sizeof (void *));
+    memmove (ichild->counts + 1, ichild->counts,
+             ichild->num * sizeof (size_t));
+    memmove (ichild->child + 1, ichild->child,
+             ichild->num * sizeof (void *));
+    --ileft->num;
+    ichild->keys[0] = ileft->keys[ileft->num];
+    ichild->counts[0] = moved = ileft->counts[ileft->num];
+    ichild->child[0] = ileft->child[ileft->num];
+    ++ichild->num;
+  }
+  inner->counts[i - 1] -= moved;
+  inner->counts[i] += moved;
+  inner->keys[i] = sc_bptree_node_min (inner->child[i], level);
+}
+
+/** Move the first entry of child i + 1 to the end of child i. */
+static void
+sc_bptree_borrow_right (sc_bptree_inner_t * inner, int i, int level)
+{
+  size_t              moved;
+  sc_bptree_leaf_t   *lright, *lchild;
+  sc_bptree_inner_t  *iright, *ichild;
+
+  if (level == 0) {
+    lright = (sc_bptree_leaf_t *) inner->child[i + 1];
+    lchild = (sc_bptree_leaf_t *) inner->child[i];
+    lchild->items[lchild->num++] = lright->items[0];
+    --lright->num;
+    memmove (lright->items, lright->items + 1,
+             lright->num * sizeof (void *));
+    moved = 1;
+  }
+  else {
+    iright = (sc_bptree_inner_t *) inner->child[i + 1];
+    ichild = (sc_bptree_inner_t *) inner->child[i];
+    ichild->keys[ichild->num] = iright->keys[0];
+    ichild->counts[ichild->num] = moved = iright->counts[0];
+    ichild->child[ichild->num] = iright->child[0];
+    ++ichild->num;
+    --iright->num;
+    memmove (iright->keys, iright->keys + 1, iright->num * sizeof (void *));
+    memmove (iright->counts, iright->counts + 1,
+             iright->num * sizeof (size_t));
+    memmove (iright->child, iright->child + 1,
+             iright->num * sizeof (void *));
+  }
+  inner->counts[i + 1] -= moved;
+  inner->counts[i] += moved;
+  inner->keys[i] = sc_bptree_node_min (inner->child[i], level);
+  inner->keys[i + 1] = sc_bptree_node_min (inner->child[i + 1], level);
+}
+
+/** Append child j + 1 to child j and remove it from the node. */
+static void
+sc_bptree_merge (sc_bptree_t * tree, sc_bptree_inner_t * inner, int j,
+                 int level)
+{
+  sc_bptree_leaf_t   *lleft, *lright;
+  sc_bptree_inner_t  *ileft, *iright;
+
+  if (level == 0) {
+    lleft = (sc_bptree_leaf_t *) inner->child[j];
+    lright = (sc_bptree_leaf_t *) inner->child[j + 1];
+    SC_ASSERT (lleft->num + lright->num <= SC_BPTREE_LEAF);
+    memcpy (lleft->items + lleft->num, lright->items,
+            lright->num * sizeof (void *));
+    lleft->num += lright->num;
+    lleft->next = lright->next;
+    sc_mempool_free (tree->leaf_pool, lright);
+  }
+  else {
+    ileft = (sc_bptree_inner_t *) inner->child[j];
+    iright = (sc_bptree_inner_t *) inner->child[j + 1];
+    SC_ASSERT (ileft->num + iright->num <= SC_BPTREE_FANOUT);
+    memcpy (ileft->keys + ileft->num, iright->keys,
+            iright->num * sizeof (void *));
+    memcpy (ileft->counts + ileft->num, iright->counts,
+            iright->num * sizeof (size_t));
+    memcpy (ileft->child + ileft->num, iright->child,
+            iright->num * sizeof (void *));
+    ileft->num += iright->num;
+    sc_mempool_free (tree->inner_pool, iright);
+  }
+
+  inner->counts[j] += inner->counts[j + 1];
+  inner->keys[j] = sc_bptree_node_min (inner->child[j], level);
+  --inner->num;
+  memmove (inner->keys + j + 1, inner->keys + j + 2,
+           (inner->num - j - 1) * sizeof (void *));
+  memmove (inner->counts + j + 1, inner->counts + j + 2,
+           (inner->num - j - 1) * sizeof (size_t));
+  memmove (inner->child + j + 1, inner->child + j + 2,
+           (inner->num - j - 1) * sizeof (void *));
+}
+
+static int
+sc_bptree_remove_rec (sc_bptree_t * tree, void *node, int level,
+                      const void *item, void **found)
+{
+  int                 i, pos, is_found, min;
+  sc_bptree_leaf_t   *leaf;
+  sc_bptree_inner_t  *inner;
+
+  if (level == 0) {
+    leaf = (sc_bptree_leaf_t *) node;
+    pos = sc_bptree_leaf_find (tree, leaf, item, &is_found);
+    if (!is_found) {
+      return 0;
+    }
+    if (found != NULL) {
+      *found = leaf->items[pos];
+    }
+    --leaf->num;
+    memmove (leaf->items + pos, leaf->items + pos + 1,
+             (leaf->num - pos) * sizeof (void *));
+    return 1;
+  }
+
+  inner = (sc_bptree_inner_t *) node;
+  i = sc_bptree_inner_find (tree, inner, item);
+  if (!sc_bptree_remove_rec (tree, inner->child[i], level - 1,
+                             item, found)) {
+    return 0;
+  }
+  --inner->counts[i];
+
+  /* refill an underfull child from a sibling or merge it with one */
+  min = level == 1 ? SC_BPTREE_LEAF_MIN : SC_BPTREE_INNER_MIN;
+  if (sc_bptree_node_num (inner->child[i], level - 1) >= min) {
+    inner->keys[i] = sc_bptree_node_min (inner->child[i], level - 1);
+  }
+  else if (i > 0 &&
+           sc_bptree_node_num (inner->child[i - 1], level - 1) > min) {
+    sc_bptree_borrow_left (inner, i, level - 1);
+  }
+  else if (i + 1 < inner->num &&
+           sc_bptree_node_num (inner->child[i + 1], level - 1) > min) {
+    sc_bptree_borrow_right (inner, i, level - 1);
+  }
+  else {
+    SC_ASSERT (inner->num >= 2);
+    sc_bptree_merge (tree, inner, i > 0 ? i - 1 : i, level - 1);
+  }
+  return 1;
+}
+
+int
+sc_bptree_remove (sc_bptree_t * tree, const void *item, void **found)
+{
+  sc_bptree_inner_t  *root;
+
+  if (!sc_bptree_remove_rec (tree, tree->root, tree->height, item, found)) {
+    return 0;
+  }
+  --tree->elem_count;
+
+  /* a root with a single child is dropped */
+  if (tree->height > 0) {
+    root = (sc_bptree_inner_t *) tree->root;
+    if (root->num == 1) {
+      tree->root = root->child[0];
+      --tree->height;
+      sc_mempool_free (tree->inner_pool, root);
+    }
+  }
+  return 1;
+}
+
+int
+sc_bptree_lookup (sc_bptree_t * tree, const void *item, void **found)
+{
+  int                 pos, is_found;
+  sc_bptree_leaf_t   *leaf;
+
+  leaf = sc_bptree_find_leaf (tree, item);
+  pos = sc_bptree_leaf_find (tree, leaf, item, &is_found);
+  if (is_found && found != NULL) {
+    *found = leaf->items[pos];
+  }
+  return is_found;
+}
+
+int
+sc_bptree_search_closest (sc_bptree_t * tree, const void *item,
+                          void **found)
+{
+  int                 pos, is_found, result;
+  void               *closest;
+  sc_bptree_leaf_t   *leaf;
+
+  if (tree->elem_count == 0) {
+    closest = NULL;
+    result = 0;
+  }
+  else {
+    leaf = sc_bptree_find_leaf (tree, item);
+    pos = sc_bptree_leaf_find (tree, leaf, item, &is_found);
+    if (pos < leaf->num) {
+      closest = leaf->items[pos];
+      result = is_found ? 0 : 1;
+    }
+    else if (leaf->next != NULL) {
+      /* the next leaf begins with the successor */
+      closest = leaf->next->items[0];
+      result = 1;
+    }
+    else {
+      closest = leaf->items[leaf->num - 1];
+      result = -1;
+    }
+  }
+  if (found != NULL) {
+    *found = closest;
+  }
+  return result;
+}
+
+void               *
+sc_bptree_at (sc_bptree_t * tree, size_t index)
+{
+  int                 level, i;
+  void               *node;
+  sc_bptree_inner_t  *inner;
+
+  if (index >= tree->elem_count) {
+    return NULL;
+  }
+  node = tree->root;
+  for (level = tree->height; level > 0; --level) {
+    inner = (sc_bptree_inner_t *) node;
+    for (i = 0; index >= inner->counts[i]; ++i) {
+      index -= inner->counts[i];
+    }
+    SC_ASSERT (i < inner->num);
+    node = inner->child[i];
+  }
+  return ((sc_bptree_leaf_t *) node)->items[index];
+}
+
+ssize_t
+sc_bptree_index (sc_bptree_t * tree, const void *item)
+{
+  int                 level, i, j, pos, is_found;
+  size_t              rank;
+  void               *node;
+  sc_bptree_inner_t  *inner;
+
+  rank = 0;
+  node = tree->root;
+  for (level = tree->height; level > 0; --level) {
+    inner = (sc_bptree_inner_t *) node;
+    i = sc_bptree_inner_find (tree, inner, item);
+    for (j = 0; j < i; ++j) {
+      rank += inner->counts[j];
+    }
+    node = inner->child[i];
+  }
+  pos = sc_bptree_leaf_find (tree, (sc_bptree_leaf_t *) node, item,
+                             &is_found);
+  return is_found ? (ssize_t) (rank + pos) : -1;
+}
+
+void
+sc_bptree_foreach (sc_bptree_t * tree, sc_bptree_foreach_t fn, void *data)
+{
+  int                 j;
+  sc_bptree_leaf_t   *leaf;
+
+  for (leaf = tree->first; leaf != NULL; leaf = leaf->next) {
+    for (j = 0; j < leaf->num; ++j) {
+      fn (leaf->items[j], data);
+    }
+  }
+}
+
+void
+sc_bptree_to_array (sc_bptree_t * tree, sc_array_t * array)
+{
+  size_t              offset;
+  sc_bptree_leaf_t   *leaf;
+
+  SC_ASSERT (array->elem_size == sizeof (void *));
+
+  sc_array_resize (array, tree->elem_count);
+  offset = 0;
+  for (leaf = tree->first; leaf != NULL && leaf->num > 0; leaf = leaf->next) {
+    memcpy (sc_array_index (array, offset), leaf->items,
+            leaf->num * sizeof (void *));
+    offset += leaf->num;
+  }
+  SC_ASSERT (offset == tree->elem_count);
+}
+
+static int
+sc_bptree_is_valid_rec (sc_bptree_t * tree, void *node, int level,
+                        int is_root, const void *upper, size_t *count,
+                        sc_bptree_leaf_t ** next_leaf)
+{
+  int                 j;
+  size_t              child_count;
+  sc_bptree_leaf_t   *leaf;
+  sc_bptree_inner_t  *inner;
+
+  if (level == 0) {
+    leaf = (sc_bptree_leaf_t *) node;
+    if (leaf != *next_leaf || leaf->num > SC_BPTREE_LEAF ||
+        leaf->num < (is_root ? 0 : SC_BPTREE_LEAF_MIN)) {
+      return 0;
+    }
+    for (j = 1; j < leaf->num; ++j) {
+      if (tree->compare (leaf->items[j - 1], leaf->items[j]) >= 0) {
+        return 0;
+      }
+    }
+    if (upper != NULL && leaf->num > 0 &&
+        tree->compare (leaf->items[leaf->num - 1], upper) >= 0) {
+      return 0;
+    }
+    *count = (size_t) leaf->num;
+    *next_leaf = leaf->next;
+    return 1;
+  }
+
+  inner = (sc_bptree_inner_t *) node;
+  if (inner->num > SC_BPTREE_FANOUT ||
+      inner->num < (is_root ? 2 : SC_BPTREE_INNER_MIN)) {
+    return 0;
+  }
+  *count = 0;
+  for (j = 0; j < inner->num; ++j) {
+    if (!sc_bptree_is_valid_rec (tree, inner->child[j], level - 1, 0,
+                                 j + 1 < inner->num ? inner->keys[j + 1] :
+                                 upper, &child_count, next_leaf) ||
+        inner->keys[j] != sc_bptree_node_min (inner->child[j], level - 1) ||
+        inner->counts[j] != child_count) {
+      return 0;
+    }
+    *count += child_count;
+  }
+  return 1;
+}
+
+int
+sc_bptree_is_valid (sc_bptree_t * tree)
+{
+  size_t              count;
+  sc_bptree_leaf_t   *next_leaf;
+
+  next_leaf = tree->first;
+  return sc_bptree_is_valid_rec (tree, tree->root, tree->height, 1, NULL,
+                                 &count, &next_leaf) &&
+    next_leaf == NULL && count == tree->elem_count;
+}
@@ -0,0 +1,205 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_bptree.h
+ * Ordered set of items in a B+-tree with wide nodes.
+ *
+ * The tree offers the operations of the AVL tree in sc_avl.h: insert,
+ * remove, search, closest search, access by rank, rank of an item and
+ * traversal in order.  The items are pointers ordered by a user supplied
+ * comparison function and each item is contained at most once.
+ *
+ * The items are stored in leaves of up to \ref SC_BPTREE_LEAF entries,
+ * which are linked in order.  An inner node stores for each of its up to
+ * \ref SC_BPTREE_FANOUT children the smallest item and the number of items
+ * below the child.  A search bisects the small arrays of a few nodes
+ * instead of chasing one pointer per comparison, and a traversal in order
+ * reads the items contiguously.  The nodes are allocated from two
+ * sc_mempool_t, which makes destroying the tree O(1) in the number of
+ * allocations.  A sorted array is turned into a tree in linear time by
+ * \ref sc_bptree_bulk_load.
+ *
+ * Inserting and removing items moves other items between nodes.  Thus
+ * items are identified by value, not by their position in the tree.
+ */
+
+#ifndef SC_BPTREE_H
+#define SC_BPTREE_H
+
+#include <sc_containers.h>
+
+/** Maximum number of items in a leaf. */
+#define SC_BPTREE_LEAF 64
+
+/** Maximum number of children of an inner node. */
+#define SC_BPTREE_FANOUT 32
+
+SC_EXTERN_C_BEGIN;
+
+/** Function to compare two items like strcmp does.
+ * \return      Less than, equal to, or greater than zero if the first
+ *              argument is less than, equal to, or greater than the second.
+ */
+typedef int         (*sc_bptree_compare_t) (const void *, const void *);
+
+/** Function called for every item by \ref sc_bptree_foreach.
+ * \param [in] item     The item in the tree.
+ * \param [in] data     The user data passed to \ref sc_bptree_foreach.
+ */
+typedef void        (*sc_bptree_foreach_t) (void *item, void *data);
+
+/** The B+-tree.
+ * The interface variables may be read and must not be changed.
+ */
+typedef struct sc_bptree
+{
+  /* interface variables */
+  size_t              elem_count;       /**< The number of items. */
+  int                 height;   /**< The number of inner node levels. */
+
+  /* implementation variables */
+  sc_bptree_compare_t compare;
+  void               *root;     /**< A leaf if height is zero. */
+  struct sc_bptree_leaf *first; /**< Leftmost leaf, never NULL. */
+  sc_mempool_t       *leaf_pool;
+  sc_mempool_t       *inner_pool;
+}
+sc_bptree_t;
+
+/** Create a new, empty tree.
+ * \param [in] compare  Function to compare two items.
+ * \return              The tree, to be destroyed by \ref sc_bptree_destroy.
+ */
+sc_bptree_t        *sc_bptree_new (sc_bptree_compare_t compare);
+
+/** Destroy a tree.
+ * The items are not touched.  This runs in O(1) allocations.
+ * \param [in,out] tree         Its memory is freed.
+ */
+void                sc_bptree_destroy (sc_bptree_t * tree);
+
+/** Calculate the memory used by a tree.
+ * \param [in] tree     The tree.
+ * \return              Memory used in bytes.
+ */
+size_t              sc_bptree_memory_used (sc_bptree_t * tree);
+
+/** Fill an empty tree with items from a sorted array.
+ * The leaves and inner nodes are filled almost completely.
+ * This runs in O(N).
+ * \param [in,out] tree The tree, must be empty.
+ * \param [in] items    Array of void * sorted strictly ascending
+ *                      by the comparison function of the tree.
+ */
+void                sc_bptree_bulk_load (sc_bptree_t * tree,
+                                         sc_array_t * items);
+
+/** Insert an item into a tree if it is not contained already.
+ * \param [in,out] tree The tree.
+ * \param [in] item     The item to be inserted.
+ * \param [out] found   If found != NULL, *found is set to the contained
+ *                      item if the item is found.
+ * \return              True if the item is added, false if an equal item
+ *                      is already contained.
+ */
+int                 sc_bptree_insert (sc_bptree_t * tree, void *item,
+                                      void **found);
+
+/** Remove an item from a tree.
+ * \param [in,out] tree The tree.
+ * \param [in] item     The item to be removed.
+ * \param [out] found   If found != NULL, *found is set to the removed item
+ *                      if it is found.
+ * \return              True if the item is found, false otherwise.
+ */
+int                 sc_bptree_remove (sc_bptree_t * tree, const void *item,
+                                      void **found);
+
+/** Check if an item is contained in a tree.
+ * \param [in] tree     The tree.
+ * \param [in] item     The item to be looked up.
+ * \param [out] found   If found != NULL, *found is set to the contained
+ *                      item if the item is found.
+ * \return              True if the item is found, false otherwise.
+ */
+int                 sc_bptree_lookup (sc_bptree_t * tree, const void *item,
+                                      void **found);
+
+/** Find the contained item closest to a given one.
+ * This is the equal item if contained, otherwise the smallest greater
+ * item if it exists, and the greatest item if not.
+ * \param [in] tree     The tree.
+ * \param [in] item     The item to be searched for.
+ * \param [out] found   If found != NULL, *found is set to the closest
+ *                      item, or NULL if the tree is empty.
+ * \return              -1 if the closest item is smaller, 1 if it is
+ *                      greater, and 0 if it is equal or the tree is empty.
+ */
+int                 sc_bptree_search_closest (sc_bptree_t * tree,
+                                              const void *item,
+                                              void **found);
+
+/** Return the item at a given rank.
+ * \param [in] tree     The tree.
+ * \param [in] index    Rank counting from 0.
+ * \return              The item at this rank, or NULL if the index
+ *                      is not less than the number of items.
+ */
+void               *sc_bptree_at (sc_bptree_t * tree, size_t index);
+
+/** Return the rank of an item.
+ * \param [in] tree     The tree.
+ * \param [in] item     The item to be looked up.
+ * \return              The rank counting from 0 if the item is found,
+ *                      or -1 otherwise.
+ */
+ssize_t             sc_bptree_index (sc_bptree_t * tree, const void *item);
+
+/** Call a function for every item in ascending order.
+ * The tree must not be changed by the function.
+ * \param [in] tree     The tree.
+ * \param [in] fn       Function called with each item and data.
+ * \param [in] data     User data passed to the function.
+ */
+void                sc_bptree_foreach (sc_bptree_t * tree,
+                                       sc_bptree_foreach_t fn, void *data);
+
+/** Copy all items in ascending order into an array.
+ * \param [in] tree     The tree.
+ * \param [in,out] array        Array of element size sizeof (void *).
+ *                              It is resized to the number of items.
+ */
+void                sc_bptree_to_array (sc_bptree_t * tree,
+                                        sc_array_t * array);
+
+/** Check the structure of a tree.
+ * This verifies the ordering, the node occupancy, the stored smallest
+ * items and counts, and the links between the leaves.
+ * \param [in] tree     The tree.
+ * \return              True if the tree is consistent.
+ */
+int                 sc_bptree_is_valid (sc_bptree_t * tree);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_BPTREE_H */
@@ -23,6 +23,9 @@
 
 #include <sc_bspline.h>
 
+/** Number of points evaluated simultaneously by the batch functions. */
+#define SC_BSPLINE_LANES 8
+
 int
 sc_bspline_min_number_points (int n)
 {
@@ -297,8 +300,35 @@ sc_bspline_destroy (sc_bspline_t * bs)
   SC_FREE (bs);
 }
 
+sc_bspline_eval_t  *
+sc_bspline_eval_new (const sc_bspline_t * bs)
+{
+  sc_bspline_eval_t  *ev;
+
+  ev = SC_ALLOC (sc_bspline_eval_t, 1);
+  ev->cacheknot = bs->n;
+  ev->works = sc_bspline_workspace_new (bs->n, bs->d);
+  ev->weights = SC_ALLOC (double, (bs->n + 1) * SC_BSPLINE_LANES);
+
+  return ev;
+}
+
+void
+sc_bspline_eval_destroy (sc_bspline_eval_t * ev)
+{
+  sc_dmatrix_destroy (ev->works);
+  SC_FREE (ev->weights);
+
+  SC_FREE (ev);
+}
+
+/** Find the knot interval of a parameter.
+ * The B-spline is not modified, so this function is reentrant.
+ * \param [in,out] cacheknot    On input, the interval to try first.
+ *                              On output, the interval found.
+ */
 static int
-sc_bspline_find_interval (sc_bspline_t * bs, double t)
+sc_bspline_find_interval (const sc_bspline_t * bs, double t, int *cacheknot)
 {
   int                 i, iguess;
   double              t0, t1;
@@ -307,13 +337,13 @@ sc_bspline_find_interval (sc_bspline_t * bs, double t)
   t0 = knotse[bs->n];
   t1 = knotse[bs->n + bs->l];
   SC_ASSERT (t >= t0 && t <= t1);
-  SC_ASSERT (bs->cacheknot >= bs->n && bs->cacheknot < bs->n + bs->l);
+  SC_ASSERT (*cacheknot >= bs->n && *cacheknot < bs->n + bs->l);
 
   if (t >= t1) {
-    iguess = bs->cacheknot = bs->n + bs->l - 1;
+    iguess = *cacheknot = bs->n + bs->l - 1;
   }
-  else if (knotse[bs->cacheknot] <= t && t < knotse[bs->cacheknot + 1]) {
-    iguess = bs->cacheknot;
+  else if (knotse[*cacheknot] <= t && t < knotse[*cacheknot + 1]) {
+    iguess = *cacheknot;
   }
   else {
     const int           nshift = 1;
@@ -354,7 +384,7 @@ sc_bspline_find_interval (sc_bspline_t * bs, double t)
         break;
       }
     }
-    bs->cacheknot = iguess;
+    *cacheknot = iguess;
   }
   SC_ASSERT (iguess >= bs->n && iguess < bs->n + bs->l);
   SC_CHECK_ABORT ((knotse[iguess] <= t && t < knotse[iguess + 1]) ||
@@ -364,8 +394,10 @@ sc_bspline_find_interval (sc_bspline_t * bs, double t)
   return iguess;
 }
 
-void
-sc_bspline_evaluate (sc_bspline_t * bs, double t, double *result)
+/** Evaluate a B-spline using the given workspace and interval cache. */
+static void
+sc_bspline_evaluate_works (const sc_bspline_t * bs, double t, double *result,
+                           sc_dmatrix_t * works, int *cacheknot)
 {
   int                 i, k, n;
   int                 iguess;
@@ -373,12 +405,12 @@ sc_bspline_evaluate (sc_bspline_t * bs, double t, double *result)
   double             *wfrom, *wto;
   const double       *knotse = bs->knots->e[0];
 
-  iguess = sc_bspline_find_interval (bs, t);
+  iguess = sc_bspline_find_interval (bs, t, cacheknot);
 
   toffset = 0;
   wfrom = wto = bs->points->e[iguess - bs->n];
   for (n = bs->n; n > 0; --n) {
-    wto = bs->works->e[toffset];
+    wto = works->e[toffset];
 
     for (i = 0; i < n; ++i) {
       const double        tleft = knotse[iguess + i - n + 1];
@@ -400,6 +432,19 @@ sc_bspline_evaluate (sc_bspline_t * bs, double t, double *result)
   memcpy (result, wfrom, sizeof (double) * bs->d);
 }
 
+void
+sc_bspline_evaluate (sc_bspline_t * bs, double t, double *result)
+{
+  sc_bspline_evaluate_works (bs, t, result, bs->works, &bs->cacheknot);
+}
+
+void
+sc_bspline_evaluate_r (const sc_bspline_t * bs, sc_bspline_eval_t * ev,
+                       double t, double *result)
+{
+  sc_bspline_evaluate_works (bs, t, result, ev->works, &ev->cacheknot);
+}
+
 void
 sc_bspline_derivative (sc_bspline_t * bs, double t, double *result)
 {
@@ -407,28 +452,38 @@ sc_bspline_derivative (sc_bspline_t * bs, double t, double *result)
 }
 
 void
-sc_bspline_derivative_n (sc_bspline_t * bs, int order,
+sc_bspline_derivative_r (const sc_bspline_t * bs, sc_bspline_eval_t * ev,
                          double t, double *result)
+{
+  sc_bspline_derivative_n_r (bs, ev, 1, t, result);
+}
+
+/** Evaluate a derivative within a given knot interval.
+ * \param [in] iguess   Knot interval, n <= iguess < n + l.
+ * \param [in] works    Workspace ((n + 1) * (n + 1)) x d.
+ */
+static void
+sc_bspline_derivative_n_interval (const sc_bspline_t * bs, int order,
+                                  int iguess, double t, double *result,
+                                  sc_dmatrix_t * works)
 {
   int                 i, k, n;
-  int                 iguess;
   int                 toffset;
   double             *wfrom, *wto;
   const double       *knotse = bs->knots->e[0];
 
   SC_ASSERT (order >= 0);
+  SC_ASSERT (iguess >= bs->n && iguess < bs->n + bs->l);
 
   if (bs->n < order) {
     memset (result, 0, sizeof (double) * bs->d);
     return;
   }
 
-  iguess = sc_bspline_find_interval (bs, t);
-
   toffset = 0;
   wfrom = wto = bs->points->e[iguess - bs->n];
   for (n = bs->n; n > 0; --n) {
-    wto = bs->works->e[toffset];
+    wto = works->e[toffset];
 
     if (bs->n < n + order) {
       for (i = 0; i < n; ++i) {
@@ -464,6 +519,207 @@ sc_bspline_derivative_n (sc_bspline_t * bs, int order,
   memcpy (result, wfrom, sizeof (double) * bs->d);
 }
 
+/** Evaluate a derivative using the given workspace and interval cache. */
+static void
+sc_bspline_derivative_n_works (const sc_bspline_t * bs, int order,
+                               double t, double *result,
+                               sc_dmatrix_t * works, int *cacheknot)
+{
+  SC_ASSERT (order >= 0);
+
+  if (bs->n < order) {
+    memset (result, 0, sizeof (double) * bs->d);
+    return;
+  }
+
+  sc_bspline_derivative_n_interval (bs, order,
+                                    sc_bspline_find_interval (bs, t,
+                                                              cacheknot),
+                                    t, result, works);
+}
+
+void
+sc_bspline_derivative_n (sc_bspline_t * bs, int order,
+                         double t, double *result)
+{
+  sc_bspline_derivative_n_works (bs, order, t, result,
+                                 bs->works, &bs->cacheknot);
+}
+
+void
+sc_bspline_derivative_n_r (const sc_bspline_t * bs, sc_bspline_eval_t * ev,
+                           int order, double t, double *result)
+{
+  sc_bspline_derivative_n_works (bs, order, t, result,
+                                 ev->works, &ev->cacheknot);
+}
+
+/** Find the knot interval by walking forward from the previous interval.
+ * This is fast for sorted parameters that are close to each other.
+ * Otherwise we fall back to sc_bspline_find_interval.
+ */
+static int
+sc_bspline_find_interval_sweep (const sc_bspline_t * bs, double t,
+                                int *cacheknot)
+{
+  const int           nsteps = 4;
+  const int           ilast = bs->n + bs->l - 1;
+  const double       *knotse = bs->knots->e[0];
+  int                 i, iguess;
+
+  iguess = *cacheknot;
+  if (t >= knotse[iguess]) {
+    for (i = 0; i < nsteps; ++i) {
+      if (t < knotse[iguess + 1] || iguess == ilast) {
+        *cacheknot = iguess;
+        return iguess;
+      }
+      ++iguess;
+    }
+  }
+
+  return sc_bspline_find_interval (bs, t, cacheknot);
+}
+
+/** Evaluate a derivative for up to SC_BSPLINE_LANES points at once.
+ * Each level of the de Boor recursion combines neighboring entries linearly.
+ * Instead of applying the recursion to the d-dimensional points, we apply
+ * its transpose to the scalar weights of the n + 1 relevant control points,
+ * which makes the work independent of d.  The weights of all points are
+ * stored such that the points are the fastest varying index, which lets
+ * the compiler vectorize over the points.
+ * \param [in] nl       Number of points, 1 <= nl <= SC_BSPLINE_LANES.
+ * \param [in] c        Workspace of (n + 1) * SC_BSPLINE_LANES doubles.
+ */
+static void
+sc_bspline_derivative_lanes (const sc_bspline_t * bs, int order, int nl,
+                             const double *t, double *result,
+                             double *c, int *cacheknot)
+{
+  const int           d = bs->d;
+  const double       *knotse = bs->knots->e[0];
+  int                 i, j, k, n;
+  int                 ileft[SC_BSPLINE_LANES];
+  double              tl[SC_BSPLINE_LANES];
+  double             *cfrom, *cto;
+  const double       *pfrom;
+
+  SC_ASSERT (1 <= nl && nl <= SC_BSPLINE_LANES);
+
+  /* pad unused lanes with the last point to keep the loop length fixed */
+  for (j = 0; j < SC_BSPLINE_LANES; ++j) {
+    tl[j] = t[SC_MIN (j, nl - 1)];
+    ileft[j] = j < nl ?
+      sc_bspline_find_interval_sweep (bs, tl[j], cacheknot) - bs->n :
+      ileft[nl - 1];
+    c[j] = 1.;
+  }
+
+  /* run the recursion backwards from the result to the control points:
+   * weight i on level n - 1 contributes to weights i and i + 1 on level n */
+  for (n = 1; n <= bs->n; ++n) {
+    memset (c + n * SC_BSPLINE_LANES, 0, sizeof (double) * SC_BSPLINE_LANES);
+    for (i = n - 1; i >= 0; --i) {
+      cfrom = c + i * SC_BSPLINE_LANES;
+      cto = cfrom + SC_BSPLINE_LANES;
+      if (bs->n < n + order) {
+        for (j = 0; j < SC_BSPLINE_LANES; ++j) {
+          const int           il = ileft[j] + i + bs->n - n + 1;
+          const double        tfactor = n / (knotse[il + n] - knotse[il]);
+
+          cto[j] += tfactor * cfrom[j];
+          cfrom[j] *= -tfactor;
+        }
+      }
+      else {
+        for (j = 0; j < SC_BSPLINE_LANES; ++j) {
+          const int           il = ileft[j] + i + bs->n - n + 1;
+          const double        tfactor = 1. / (knotse[il + n] - knotse[il]);
+
+          cto[j] += (tl[j] - knotse[il]) * tfactor * cfrom[j];
+          cfrom[j] *= (knotse[il + n] - tl[j]) * tfactor;
+        }
+      }
+    }
+  }
+
+  /* combine the control points with their weights */
+  for (j = 0; j < nl; ++j) {
+    pfrom = bs->points->e[ileft[j]];
+    for (k = 0; k < d; ++k) {
+      result[j * d + k] = c[j] * pfrom[k];
+    }
+    for (i = 1; i <= bs->n; ++i) {
+      const double        ci = c[i * SC_BSPLINE_LANES + j];
+
+      for (k = 0; k < d; ++k) {
+        result[j * d + k] += ci * pfrom[i * d + k];
+      }
+    }
+  }
+}
+
+/** Evaluate a derivative at many points using the given weights workspace
+ * of (n + 1) * SC_BSPLINE_LANES doubles and interval cache. */
+static void
+sc_bspline_derivative_n_batch_works (const sc_bspline_t * bs, int order,
+                                     size_t num_t, const double *t,
+                                     double *result, double *c,
+                                     int *cacheknot)
+{
+  size_t              zz;
+
+  SC_ASSERT (order >= 0);
+
+  if (bs->n < order) {
+    memset (result, 0, sizeof (double) * bs->d * num_t);
+    return;
+  }
+
+  for (zz = 0; zz < num_t; zz += SC_BSPLINE_LANES) {
+    sc_bspline_derivative_lanes (bs, order,
+                                 (int) SC_MIN (num_t - zz,
+                                              (size_t) SC_BSPLINE_LANES),
+                                 t + zz, result + bs->d * zz, c, cacheknot);
+  }
+}
+
+void
+sc_bspline_evaluate_batch (sc_bspline_t * bs, size_t num_t,
+                           const double *t, double *result)
+{
+  sc_bspline_derivative_n_batch (bs, 0, num_t, t, result);
+}
+
+void
+sc_bspline_derivative_batch (sc_bspline_t * bs, size_t num_t,
+                             const double *t, double *result)
+{
+  sc_bspline_derivative_n_batch (bs, 1, num_t, t, result);
+}
+
+void
+sc_bspline_derivative_n_batch (sc_bspline_t * bs, int order, size_t num_t,
+                               const double *t, double *result)
+{
+  double             *c;
+
+  c = SC_ALLOC (double, (bs->n + 1) * SC_BSPLINE_LANES);
+  sc_bspline_derivative_n_batch_works (bs, order, num_t, t, result,
+                                       c, &bs->cacheknot);
+  SC_FREE (c);
+}
+
+void
+sc_bspline_derivative_n_batch_r (const sc_bspline_t * bs,
+                                 sc_bspline_eval_t * ev, int order,
+                                 size_t num_t, const double *t,
+                                 double *result)
+{
+  sc_bspline_derivative_n_batch_works (bs, order, num_t, t, result,
+                                       ev->weights, &ev->cacheknot);
+}
+
 void
 sc_bspline_derivative2 (sc_bspline_t * bs, double t, double *result)
 {
@@ -474,7 +730,7 @@ sc_bspline_derivative2 (sc_bspline_t * bs, double t, double *result)
   double             *qfrom, *qto;
   const double       *knotse = bs->knots->e[0];
 
-  iguess = sc_bspline_find_interval (bs, t);
+  iguess = sc_bspline_find_interval (bs, t, &bs->cacheknot);
 
   toffset = bs->n + 1;
   pfrom = pto = bs->works->e[0];
@@ -508,3 +764,195 @@ sc_bspline_derivative2 (sc_bspline_t * bs, double t, double *result)
 
   memcpy (result, pfrom, sizeof (double) * bs->d);
 }
+
+sc_bspline_poly_t  *
+sc_bspline_poly_new (const sc_bspline_t * bs)
+{
+  const int           d = bs->d;
+  const int           n = bs->n;
+  const int           l = bs->l;
+  int                 j, k, q;
+  double              kfact, *c;
+  sc_dmatrix_t       *works;
+  sc_bspline_poly_t  *poly;
+
+  poly = SC_ALLOC (sc_bspline_poly_t, 1);
+  poly->d = d;
+  poly->n = n;
+  poly->l = l;
+  poly->breaks = SC_ALLOC (double, l + 1);
+  memcpy (poly->breaks, bs->knots->e[0] + n, sizeof (double) * (l + 1));
+  poly->coeffs = SC_ALLOC (double, (size_t) l * (n + 1) * d);
+
+  /* the Taylor coefficients at the left end of each interval */
+  works = sc_bspline_workspace_new (n, d);
+  for (j = 0; j < l; ++j) {
+    c = poly->coeffs + (size_t) j * (n + 1) * d;
+    if (!(poly->breaks[j] < poly->breaks[j + 1])) {
+      /* this interval is never found by the search */
+      memset (c, 0, sizeof (double) * (n + 1) * d);
+      continue;
+    }
+    kfact = 1.;
+    for (k = 0; k <= n; ++k) {
+      kfact *= SC_MAX (k, 1);
+      sc_bspline_derivative_n_interval (bs, k, n + j, poly->breaks[j],
+                                        c + k * d, works);
+      for (q = 0; q < d; ++q) {
+        c[k * d + q] /= kfact;
+      }
+    }
+  }
+  sc_dmatrix_destroy (works);
+
+  return poly;
+}
+
+void
+sc_bspline_poly_destroy (sc_bspline_poly_t * poly)
+{
+  SC_FREE (poly->breaks);
+  SC_FREE (poly->coeffs);
+
+  SC_FREE (poly);
+}
+
+/** Find the interval j with breaks[j] <= t < breaks[j + 1].
+ * \param [in] iguess   Interval to try first together with its right
+ *                      neighbor, which makes sweeps over sorted parameters
+ *                      fast, or -1.  If this fails, we guess the interval
+ *                      from the position of t assuming equidistant breaks
+ *                      and bisect from there.
+ */
+static int
+sc_bspline_poly_find_interval (const sc_bspline_poly_t * poly, double t,
+                               int iguess)
+{
+  const int           ilast = poly->l - 1;
+  const double       *breaks = poly->breaks;
+  int                 ileft, iright, imid;
+
+  SC_ASSERT (t >= breaks[0] && t <= breaks[poly->l]);
+  SC_ASSERT (iguess < poly->l);
+
+  if (iguess >= 0 && breaks[iguess] <= t) {
+    if (t < breaks[iguess + 1] || iguess == ilast) {
+      return iguess;
+    }
+    if (t < breaks[iguess + 2] || iguess + 1 == ilast) {
+      return iguess + 1;
+    }
+  }
+
+  iguess = (int) floor ((t - breaks[0]) / (breaks[poly->l] - breaks[0]) *
+                        poly->l);
+  iguess = SC_MIN (SC_MAX (iguess, 0), ilast);
+  if (breaks[iguess] <= t) {
+    if (t < breaks[iguess + 1] || iguess == ilast) {
+      return iguess;
+    }
+    ileft = iguess + 1;
+    iright = ilast;
+  }
+  else {
+    ileft = 0;
+    iright = iguess - 1;
+  }
+
+  /* find the last interval in range whose left end is at most t */
+  while (ileft < iright) {
+    imid = (ileft + iright + 1) / 2;
+    if (breaks[imid] <= t) {
+      ileft = imid;
+    }
+    else {
+      iright = imid - 1;
+    }
+  }
+
+  return ileft;
+}
+
+/** Evaluate a derivative on interval j by Horner's scheme.
+ * The coefficient of (t - breaks[j])^k contributes to derivative r with
+ * the factor k! / (k - r)!, which we update from k + 1 to k on the fly.
+ */
+static void
+sc_bspline_poly_horner (const sc_bspline_poly_t * poly, int order, int j,
+                        double t, double *result)
+{
+  const int           d = poly->d;
+  const int           n = poly->n;
+  const double        x = t - poly->breaks[j];
+  const double       *c = poly->coeffs + (size_t) j * (n + 1) * d;
+  int                 k, q;
+  double              f;
+
+  SC_ASSERT (0 <= order && order <= n);
+
+  f = 1.;
+  for (k = n - order + 1; k <= n; ++k) {
+    f *= k;
+  }
+  for (q = 0; q < d; ++q) {
+    result[q] = f * c[n * d + q];
+  }
+  for (k = n - 1; k >= order; --k) {
+    f = f * (k - order + 1) / (k + 1);
+    for (q = 0; q < d; ++q) {
+      result[q] = result[q] * x + f * c[k * d + q];
+    }
+  }
+}
+
+void
+sc_bspline_poly_evaluate (const sc_bspline_poly_t * poly,
+                          double t, double *result)
+{
+  sc_bspline_poly_derivative_n (poly, 0, t, result);
+}
+
+void
+sc_bspline_poly_derivative (const sc_bspline_poly_t * poly,
+                            double t, double *result)
+{
+  sc_bspline_poly_derivative_n (poly, 1, t, result);
+}
+
+void
+sc_bspline_poly_derivative_n (const sc_bspline_poly_t * poly, int order,
+                              double t, double *result)
+{
+  SC_ASSERT (order >= 0);
+
+  if (poly->n < order) {
+    memset (result, 0, sizeof (double) * poly->d);
+    return;
+  }
+
+  sc_bspline_poly_horner (poly, order,
+                          sc_bspline_poly_find_interval (poly, t, -1),
+                          t, result);
+}
+
+void
+sc_bspline_poly_derivative_n_batch (const sc_bspline_poly_t * poly,
+                                    int order, size_t num_t,
+                                    const double *t, double *result)
+{
+  int                 j;
+  size_t              zz;
+
+  SC_ASSERT (order >= 0);
+
+  if (poly->n < order) {
+    memset (result, 0, sizeof (double) * poly->d * num_t);
+    return;
+  }
+
+  j = -1;
+  for (zz = 0; zz < num_t; ++zz) {
+    j = sc_bspline_poly_find_interval (poly, t[zz], j);
+    sc_bspline_poly_horner (poly, order, j, t[zz], result + poly->d * zz);
+  }
+}
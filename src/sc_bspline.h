@@ -44,6 +44,40 @@ typedef struct
 }
 sc_bspline_t;
 
+/** Workspace and interval cache for reentrant B-spline evaluation.
+ * The evaluation functions without the _r suffix modify the cache and
+ * workspace inside the \ref sc_bspline_t, so they must not be called on the
+ * same B-spline from several threads at once.  The _r functions leave the
+ * B-spline untouched and use this structure instead.  Thus, one B-spline
+ * may be evaluated concurrently by any number of threads, each passing its
+ * own sc_bspline_eval_t.
+ */
+typedef struct
+{
+  int                 cacheknot;        /**< Previously evaluated knot interval */
+  sc_dmatrix_t       *works;    /**< Workspace ((n + 1) * (n + 1)) x d */
+  double             *weights;  /**< Workspace for the batch functions */
+}
+sc_bspline_eval_t;
+
+/** Piecewise polynomial form of a B-spline.
+ * On each of its l intervals the B-spline is a polynomial of degree n.
+ * We store its coefficients with respect to the left end of the interval,
+ * which allows to evaluate it by Horner's scheme without any divisions.
+ * This pays off when a B-spline is evaluated many times.  Evaluation does
+ * not modify this structure, so it may be shared between threads.
+ */
+typedef struct
+{
+  int                 d;        /**< Dimensionality of control points */
+  int                 n;        /**< Polynomial degree */
+  int                 l;        /**< Number of intervals */
+  double             *breaks;   /**< The l + 1 interval boundaries */
+  double             *coeffs;   /**< l x (n + 1) x d array of coefficients,
+                                     the constant ones first */
+}
+sc_bspline_poly_t;
+
 /** Compute the minimum required number of points for a certain degree.
  * \param [in] n    Polynomial degree of the spline functions, n >= 0.
  * \return          Return minimum point number = p + 1 >= n + 1.
@@ -130,6 +164,20 @@ sc_bspline_t       *sc_bspline_new (int n, sc_dmatrix_t * points,
  */
 void                sc_bspline_destroy (sc_bspline_t * bs);
 
+/** Create a workspace for reentrant evaluation of a B-spline.
+ * Each thread needs its own.  Since the memory allocation is only
+ * thread-safe if libsc is configured with pthreads, it is best to create
+ * the workspaces before entering a parallel region.
+ * \param [in] bs       B-spline structure.
+ * \return              Workspace to be destroyed by
+ *                      \ref sc_bspline_eval_destroy.
+ */
+sc_bspline_eval_t  *sc_bspline_eval_new (const sc_bspline_t * bs);
+
+/** Destroy a workspace for reentrant evaluation.
+ */
+void                sc_bspline_eval_destroy (sc_bspline_eval_t * ev);
+
 /** Evaluate a B-spline at a certain point.
  * \param [in] bs       B-spline structure.
  * \param [in] t        Value that must be within the range of the knots.
@@ -155,6 +203,155 @@ void                sc_bspline_derivative (sc_bspline_t * bs,
 void                sc_bspline_derivative_n (sc_bspline_t * bs, int order,
                                              double t, double *result);
 
+/** Evaluate a B-spline at a certain point.  Reentrant.
+ * \param [in] bs       B-spline structure, not modified.
+ * \param [in,out] ev   Workspace private to the calling thread.
+ * \param [in] t        Value that must be within the range of the knots.
+ * \param [out] result  The computed point in R^d is placed here.
+ */
+void                sc_bspline_evaluate_r (const sc_bspline_t * bs,
+                                           sc_bspline_eval_t * ev,
+                                           double t, double *result);
+
+/** Evaluate a B-spline derivative at a certain point.  Reentrant.
+ * \param [in] bs       B-spline structure, not modified.
+ * \param [in,out] ev   Workspace private to the calling thread.
+ * \param [in] t        Value that must be within the range of the knots.
+ * \param [out] result  The computed derivative in R^d is placed here.
+ */
+void                sc_bspline_derivative_r (const sc_bspline_t * bs,
+                                             sc_bspline_eval_t * ev,
+                                             double t, double *result);
+
+/** Evaluate any order B-spline derivative at a certain point.  Reentrant.
+ * \param [in] bs       B-spline structure, not modified.
+ * \param [in,out] ev   Workspace private to the calling thread.
+ * \param [in] order    Order of the derivative >= 0.
+ * \param [in] t        Value that must be within the range of the knots.
+ * \param [out] result  The computed derivative in R^d is placed here.
+ */
+void                sc_bspline_derivative_n_r (const sc_bspline_t * bs,
+                                               sc_bspline_eval_t * ev,
+                                               int order, double t,
+                                               double *result);
+
+/** Evaluate a B-spline at many points.
+ * The parameters may come in any order, but sorted parameters are faster:
+ * the knot intervals are then found by a sweep over the knots.
+ * \param [in] bs       B-spline structure.
+ * \param [in] num_t    Number of parameters.
+ * \param [in] t        Array of \b num_t values, each of which must be
+ *                      within the range of the knots.
+ * \param [out] result  The computed points in R^d are placed here, one
+ *                      after the other, (num_t x d) values total.
+ */
+void                sc_bspline_evaluate_batch (sc_bspline_t * bs,
+                                               size_t num_t, const double *t,
+                                               double *result);
+
+/** Evaluate a B-spline derivative at many points.
+ * \param [in] bs       B-spline structure.
+ * \param [in] num_t    Number of parameters.
+ * \param [in] t        Array of \b num_t values, each of which must be
+ *                      within the range of the knots.
+ * \param [out] result  The computed derivatives in R^d are placed here,
+ *                      one after the other, (num_t x d) values total.
+ */
+void                sc_bspline_derivative_batch (sc_bspline_t * bs,
+                                                 size_t num_t,
+                                                 const double *t,
+                                                 double *result);
+
+/** Evaluate any order B-spline derivative at many points.
+ * \param [in] bs       B-spline structure.
+ * \param [in] order    Order of the derivative >= 0.
+ * \param [in] num_t    Number of parameters.
+ * \param [in] t        Array of \b num_t values, each of which must be
+ *                      within the range of the knots.
+ * \param [out] result  The computed derivatives in R^d are placed here,
+ *                      one after the other, (num_t x d) values total.
+ */
+void                sc_bspline_derivative_n_batch (sc_bspline_t * bs,
+                                                   int order, size_t num_t,
+                                                   const double *t,
+                                                   double *result);
+
+/** Evaluate any order B-spline derivative at many points.  Reentrant.
+ * This allows to split a large batch of parameters between threads.
+ * \param [in] bs       B-spline structure, not modified.
+ * \param [in,out] ev   Workspace private to the calling thread.
+ * \param [in] order    Order of the derivative >= 0.
+ * \param [in] num_t    Number of parameters.
+ * \param [in] t        Array of \b num_t values, each of which must be
+ *                      within the range of the knots.
+ * \param [out] result  The computed derivatives in R^d are placed here,
+ *                      one after the other, (num_t x d) values total.
+ */
+void                sc_bspline_derivative_n_batch_r (const sc_bspline_t *
+                                                     bs,
+                                                     sc_bspline_eval_t * ev,
+                                                     int order, size_t num_t,
+                                                     const double *t,
+                                                     double *result);
+
+/** Convert a B-spline into piecewise polynomial form.
+ * The result does not reference the B-spline or its points and knots.
+ * \param [in] bs       B-spline structure, not modified.
+ * \return              Piecewise polynomial to be destroyed by
+ *                      \ref sc_bspline_poly_destroy.
+ */
+sc_bspline_poly_t  *sc_bspline_poly_new (const sc_bspline_t * bs);
+
+/** Destroy a piecewise polynomial form.
+ */
+void                sc_bspline_poly_destroy (sc_bspline_poly_t * poly);
+
+/** Evaluate a piecewise polynomial at a certain point.
+ * \param [in] poly     Piecewise polynomial form of a B-spline.
+ * \param [in] t        Value that must be within the range of the knots.
+ * \param [out] result  The computed point in R^d is placed here.
+ */
+void                sc_bspline_poly_evaluate (const sc_bspline_poly_t *
+                                              poly, double t,
+                                              double *result);
+
+/** Evaluate a piecewise polynomial derivative at a certain point.
+ * \param [in] poly     Piecewise polynomial form of a B-spline.
+ * \param [in] t        Value that must be within the range of the knots.
+ * \param [out] result  The computed derivative in R^d is placed here.
+ */
+void                sc_bspline_poly_derivative (const sc_bspline_poly_t *
+                                                poly, double t,
+                                                double *result);
+
+/** Evaluate any order piecewise polynomial derivative at a certain point.
+ * \param [in] poly     Piecewise polynomial form of a B-spline.
+ * \param [in] order    Order of the derivative >= 0.
+ * \param [in] t        Value that must be within the range of the knots.
+ * \param [out] result  The computed derivative in R^d is placed here.
+ */
+void                sc_bspline_poly_derivative_n (const sc_bspline_poly_t *
+                                                  poly, int order, double t,
+                                                  double *result);
+
+/** Evaluate any order piecewise polynomial derivative at many points.
+ * Sorted parameters are faster since the interval search is skipped
+ * while they stay within the same or the next interval.
+ * \param [in] poly     Piecewise polynomial form of a B-spline.
+ * \param [in] order    Order of the derivative >= 0.
+ * \param [in] num_t    Number of parameters.
+ * \param [in] t        Array of \b num_t values, each of which must be
+ *                      within the range of the knots.
+ * \param [out] result  The computed derivatives in R^d are placed here,
+ *                      one after the other, (num_t x d) values total.
+ */
+void                sc_bspline_poly_derivative_n_batch (const
+                                                        sc_bspline_poly_t *
+                                                        poly, int order,
+                                                        size_t num_t,
+                                                        const double *t,
+                                                        double *result);
+
 /** Evaluate a B-spline derivative at a certain point.  Obsolete.
  * \param [in] bs       B-spline structure.
  * \param [in] t        Value that must be within the range of the knots.
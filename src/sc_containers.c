@@ -25,9 +25,116 @@
 #ifdef SC_HAVE_ZLIB
 #include <zlib.h>
 #endif
+#if defined SC_HAVE_SYS_MMAN_H && defined SC_HAVE_MADVISE
+#include <sys/mman.h>
+#define SC_ALLOCATOR_MMAP
+#endif
+
+/* allocator routines */
+
+/** Blocks of at least this size are placed into huge pages. */
+#define SC_HUGEPAGE_SIZE ((size_t) 1 << 21)
+#define SC_HUGEPAGE_ROUNDUP(s) \
+  (((s) + SC_HUGEPAGE_SIZE - 1) / SC_HUGEPAGE_SIZE * SC_HUGEPAGE_SIZE)
+
+#ifdef SC_ALLOCATOR_MMAP
+
+/** Map memory at a multiple of the huge page size and advise its use. */
+static void        *
+sc_hugepage_map (size_t size)
+{
+  size_t              head;
+  char               *p;
+
+  /* map one huge page more and unmap the misaligned head and tail */
+  p = (char *) mmap (NULL, size + SC_HUGEPAGE_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  SC_CHECK_ABORTF (p != (char *) MAP_FAILED,
+                   "Insufficient memory (mmap size %llu)",
+                   (unsigned long long) size);
+  head = (SC_HUGEPAGE_SIZE - (size_t) ((uintptr_t) p % SC_HUGEPAGE_SIZE)) %
+    SC_HUGEPAGE_SIZE;
+  if (head > 0) {
+    munmap (p, head);
+  }
+  munmap (p + head + size, SC_HUGEPAGE_SIZE - head);
+  p += head;
+
+#ifdef MADV_HUGEPAGE
+  /* this is only a hint and may fail if huge pages are disabled */
+  (void) madvise (p, size, MADV_HUGEPAGE);
+#endif
+
+  return p;
+}
+
+#endif /* SC_ALLOCATOR_MMAP */
+
+static void        *
+sc_hugepage_realloc (sc_allocator_t * allocator, void *ptr, size_t old_size,
+                     size_t new_size)
+{
+#ifdef SC_ALLOCATOR_MMAP
+  int                 old_huge, new_huge;
+  void               *p;
+
+  /* huge blocks are mapped in multiples of the huge page size */
+  old_huge = ptr != NULL && old_size >= SC_HUGEPAGE_SIZE;
+  new_huge = new_size >= SC_HUGEPAGE_SIZE;
+  old_size = old_huge ? SC_HUGEPAGE_ROUNDUP (old_size) : old_size;
+  new_size = new_huge ? SC_HUGEPAGE_ROUNDUP (new_size) : new_size;
+
+  if (!old_huge && !new_huge) {
+    if (new_size == 0) {
+      sc_free (sc_package_id, ptr);
+      return NULL;
+    }
+    return sc_realloc (sc_package_id, ptr, new_size);
+  }
+  if (old_huge && new_size == old_size) {
+    return ptr;
+  }
+
+  /* move between a small and a huge block or between huge blocks */
+  p = NULL;
+  if (new_size > 0) {
+    p = new_huge ? sc_hugepage_map (new_size) :
+      sc_malloc (sc_package_id, new_size);
+    if (ptr != NULL) {
+      memcpy (p, ptr, SC_MIN (old_size, new_size));
+    }
+  }
+  if (old_huge) {
+    munmap (ptr, old_size);
+  }
+  else {
+    sc_free (sc_package_id, ptr);
+  }
+  return p;
+#else
+  if (new_size == 0) {
+    sc_free (sc_package_id, ptr);
+    return NULL;
+  }
+  return sc_realloc (sc_package_id, ptr, new_size);
+#endif
+}
+
+static sc_allocator_t sc_allocator_hugepage_static =
+  { sc_hugepage_realloc, NULL, SC_HUGEPAGE_SIZE, 0 };
+
+sc_allocator_t     *
+sc_allocator_hugepage (void)
+{
+  return &sc_allocator_hugepage_static;
+}
 
 /* array routines */
 
+/** Shared memory is not written to without the user's write access. */
+#define SC_ARRAY_IS_PRIVATE(a) \
+  ((a)->allocator == NULL || !(a)->allocator->shared)
+
 size_t
 sc_array_memory_used (sc_array_t * array, int is_dynamic)
 {
@@ -83,11 +190,28 @@ sc_array_new_data (void *base, size_t elem_size, size_t elem_count)
   return view;
 }
 
+/** Free the data of an array that owns it. */
+static void
+sc_array_free_data (sc_array_t * array)
+{
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+
+  if (array->allocator != NULL) {
+    if (array->array != NULL) {
+      array->allocator->realloc_fn (array->allocator, array->array,
+                                    (size_t) array->byte_alloc, 0);
+    }
+  }
+  else {
+    SC_FREE (array->array);
+  }
+}
+
 void
 sc_array_destroy (sc_array_t * array)
 {
   if (SC_ARRAY_IS_OWNER (array)) {
-    SC_FREE (array->array);
+    sc_array_free_data (array);
   }
   SC_FREE (array);
 }
@@ -101,6 +225,17 @@ sc_array_init (sc_array_t * array, size_t elem_size)
   array->elem_count = 0;
   array->byte_alloc = 0;
   array->array = NULL;
+  array->allocator = NULL;
+}
+
+void
+sc_array_init_allocator (sc_array_t * array, size_t elem_size,
+                         sc_allocator_t * allocator)
+{
+  SC_ASSERT (allocator == NULL || allocator->realloc_fn != NULL);
+
+  sc_array_init (array, elem_size);
+  array->allocator = allocator;
 }
 
 void
@@ -112,6 +247,7 @@ sc_array_init_size (sc_array_t * array, size_t elem_size, size_t elem_count)
   array->elem_count = elem_count;
   array->byte_alloc = (ssize_t) (elem_size * elem_count);
   array->array = SC_ALLOC (char, (size_t) array->byte_alloc);
+  array->allocator = NULL;
 }
 
 void
@@ -124,6 +260,7 @@ sc_array_init_view (sc_array_t * view, sc_array_t * array, size_t offset,
   view->elem_count = length;
   view->byte_alloc = -(ssize_t) (length * array->elem_size + 1);
   view->array = array->array + offset * array->elem_size;
+  view->allocator = NULL;
 }
 
 void
@@ -136,13 +273,14 @@ sc_array_init_data (sc_array_t * view, void *base, size_t elem_size,
   view->elem_count = elem_count;
   view->byte_alloc = -(ssize_t) (elem_count * elem_size + 1);
   view->array = (char *) base;
+  view->allocator = NULL;
 }
 
 void
 sc_array_reset (sc_array_t * array)
 {
   if (SC_ARRAY_IS_OWNER (array)) {
-    SC_FREE (array->array);
+    sc_array_free_data (array);
   }
   array->array = NULL;
 
@@ -159,14 +297,16 @@ sc_array_truncate (sc_array_t * array)
 
 #if SC_DEBUG
   SC_ASSERT (array->byte_alloc >= 0);
-  memset (array->array, -1, array->byte_alloc);
+  if (SC_ARRAY_IS_PRIVATE (array)) {
+    memset (array->array, -1, array->byte_alloc);
+  }
 #endif
 }
 
 void
 sc_array_resize (sc_array_t * array, size_t new_count)
 {
-  size_t              newoffs, roundup, newsize;
+  size_t              newoffs, roundup, oldsize, newsize;
 #if !defined SC_ENABLE_USE_REALLOC || defined SC_DEBUG
   size_t              oldoffs, minoffs;
 #endif
@@ -199,6 +339,7 @@ sc_array_resize (sc_array_t * array, size_t new_count)
   minoffs = SC_MIN (oldoffs, newoffs);
 #endif
   array->elem_count = new_count;
+  oldsize = (size_t) array->byte_alloc;
   roundup = (size_t) SC_ROUNDUP2_64 (newoffs);
   SC_ASSERT (roundup >= newoffs && roundup <= 2 * newoffs);
 
@@ -209,11 +350,13 @@ sc_array_resize (sc_array_t * array, size_t new_count)
   }
   else {
 #ifdef SC_DEBUG
-    if (newoffs < oldoffs) {
-      memset (array->array + newoffs, -1, oldoffs - newoffs);
-    }
-    for (i = oldoffs; i < newoffs; ++i) {
-      SC_ASSERT (array->array[i] == (char) -1);
+    if (SC_ARRAY_IS_PRIVATE (array)) {
+      if (newoffs < oldoffs) {
+        memset (array->array + newoffs, -1, oldoffs - newoffs);
+      }
+      for (i = oldoffs; i < newoffs; ++i) {
+        SC_ASSERT (array->array[i] == (char) -1);
+      }
     }
 #endif
     /* we keep the current allocation */
@@ -224,18 +367,27 @@ sc_array_resize (sc_array_t * array, size_t new_count)
   SC_ASSERT ((size_t) array->byte_alloc >= newoffs);
 
   newsize = (size_t) array->byte_alloc;
+  if (array->allocator != NULL) {
+    array->array = (char *) array->allocator->realloc_fn
+      (array->allocator, array->array, oldsize, newsize);
+    SC_CHECK_ABORT (array->array != NULL, "Allocator returned NULL");
+  }
+  else {
 #ifdef SC_ENABLE_USE_REALLOC
-  array->array = SC_REALLOC (array->array, char, newsize);
+    array->array = SC_REALLOC (array->array, char, newsize);
 #else
-  ptr = SC_ALLOC (char, newsize);
-  memcpy (ptr, array->array, minoffs);
-  SC_FREE (array->array);
-  array->array = ptr;
+    ptr = SC_ALLOC (char, newsize);
+    memcpy (ptr, array->array, minoffs);
+    SC_FREE (array->array);
+    array->array = ptr;
 #endif
+  }
 
 #ifdef SC_DEBUG
   SC_ASSERT (minoffs <= newsize);
-  memset (array->array + minoffs, -1, newsize - minoffs);
+  if (SC_ARRAY_IS_PRIVATE (array)) {
+    memset (array->array + minoffs, -1, newsize - minoffs);
+  }
 #endif
 }
 
@@ -568,7 +720,21 @@ size_t
 sc_array_pqueue_add (sc_array_t * array, void *temp,
                      int (*compar) (const void *, const void *))
 {
-  int                 comp;
+  return sc_array_pqueue_add_arity (array, temp, compar, 2);
+}
+
+size_t
+sc_array_pqueue_pop (sc_array_t * array, void *result,
+                     int (*compar) (const void *, const void *))
+{
+  return sc_array_pqueue_pop_arity (array, result, compar, 2);
+}
+
+size_t
+sc_array_pqueue_add_arity (sc_array_t * array, void *temp,
+                           int (*compar) (const void *, const void *),
+                           int arity)
+{
   size_t              parent, child, swaps;
   const size_t        size = array->elem_size;
   void               *p, *c;
@@ -576,101 +742,86 @@ sc_array_pqueue_add (sc_array_t * array, void *temp,
   /* this works on a pre-allocated array that is not a view */
   SC_ASSERT (SC_ARRAY_IS_OWNER (array));
   SC_ASSERT (array->elem_count > 0);
+  SC_ASSERT (arity >= 2);
 
-  /* PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED. */
-  SC_ABORT_NOT_REACHED ();
-
+  /* move the parents down while they are larger than the new element */
   swaps = 0;
   child = array->elem_count - 1;
   c = array->array + (size * child);
+  memcpy (temp, c, size);
   while (child > 0) {
-    parent = (child - 1) / 2;
+    parent = (child - 1) / (size_t) arity;
     p = array->array + (size * parent);
-
-    /* compare child to parent */
-    comp = compar (p, c);
-    if (comp <= 0) {
+    if (compar (p, temp) <= 0) {
       break;
     }
-
-    /* swap child and parent */
-    memcpy (temp, c, size);
     memcpy (c, p, size);
-    memcpy (p, temp, size);
     ++swaps;
 
     /* walk up the tree */
     child = parent;
     c = p;
   }
+  if (swaps > 0) {
+    memcpy (c, temp, size);
+  }
 
   return swaps;
 }
 
 size_t
-sc_array_pqueue_pop (sc_array_t * array, void *result,
-                     int (*compar) (const void *, const void *))
+sc_array_pqueue_pop_arity (sc_array_t * array, void *result,
+                           int (*compar) (const void *, const void *),
+                           int arity)
 {
-  int                 comp;
   size_t              new_count, swaps;
-  size_t              parent, child, child1;
+  size_t              parent, child, first, last, k;
   const size_t        size = array->elem_size;
-  void               *p, *c, *c1;
-  void               *temp;
+  void               *p, *c, *best, *moved;
 
   /* array must not be empty or a view */
   SC_ASSERT (SC_ARRAY_IS_OWNER (array));
   SC_ASSERT (array->elem_count > 0);
-
-  /* PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED. */
-  SC_ABORT_NOT_REACHED ();
+  SC_ASSERT (arity >= 2);
 
   swaps = 0;
   new_count = array->elem_count - 1;
 
   /* extract root */
   parent = 0;
-  p = array->array + (size * parent);
+  p = array->array;
   memcpy (result, p, size);
 
-  /* copy the last element to the top and reuse it as temp storage */
-  temp = array->array + (size * new_count);
-  if (new_count > 0) {
-    memcpy (p, temp, size);
-  }
-
-  /* sift down the tree */
-  while ((child = 2 * parent + 1) < new_count) {
-    c = array->array + (size * child);
-
-    /* check if child has a sibling and use that one if it is smaller */
-    if ((child1 = 2 * parent + 2) < new_count) {
-      c1 = array->array + (size * child1);
-      comp = compar (c, c1);
-      if (comp > 0) {
-        child = child1;
-        c = c1;
+  /* the last element fills the hole at the root */
+  moved = array->array + (size * new_count);
+
+  /* sift the hole down the tree while a child is less than that element */
+  while ((first = (size_t) arity * parent + 1) < new_count) {
+    last = SC_MIN (first + (size_t) arity, new_count);
+    child = first;
+    best = array->array + (size * first);
+    for (k = first + 1; k < last; ++k) {
+      c = array->array + (size * k);
+      if (compar (c, best) < 0) {
+        child = k;
+        best = c;
       }
     }
-
-    /* sift down the parent if it is larger */
-    comp = compar (p, c);
-    if (comp <= 0) {
+    if (compar (moved, best) <= 0) {
       break;
     }
-
-    /* swap child and parent */
-    memcpy (temp, c, size);
-    memcpy (c, p, size);
-    memcpy (p, temp, size);
+    memcpy (p, best, size);
     ++swaps;
 
     /* walk down the tree */
     parent = child;
-    p = c;
+    p = best;
+  }
+  if (new_count > 0) {
+    memcpy (p, moved, size);
   }
 
-  /* we can resize down here only since we need the temp element above */
+  /* we can resize down here only since we need the moved element above */
   sc_array_resize (array, new_count);
 
   return swaps;
@@ -702,28 +853,76 @@ sc_containers_free (void *p)
 
 static void         (*obstack_chunk_free) (void *) = sc_containers_free;
 
+static void        *
+sc_mempool_chunk_alloc (void *allocator, size_t n)
+{
+  sc_allocator_t     *a = (sc_allocator_t *) allocator;
+
+  return a->realloc_fn (a, NULL, 0, n);
+}
+
+static void
+sc_mempool_chunk_free (void *allocator, void *p)
+{
+  sc_allocator_t     *a = (sc_allocator_t *) allocator;
+  struct _obstack_chunk *chunk = (struct _obstack_chunk *) p;
+
+  /* the obstack records the end of each chunk it requested */
+  a->realloc_fn (a, p, (size_t) (chunk->limit - (char *) chunk), 0);
+}
+
+/** Set up the obstack to take its chunks from the allocator. */
+static void
+sc_mempool_begin (sc_mempool_t * mempool)
+{
+  sc_allocator_t     *a = mempool->allocator;
+
+  if (a == NULL) {
+    obstack_init (&mempool->obstack);
+  }
+  else {
+    SC_ASSERT (a->block_size <= (size_t) INT_MAX);
+    obstack_specify_allocation_with_arg (&mempool->obstack,
+                                         (int) a->block_size, 0,
+                                         sc_mempool_chunk_alloc,
+                                         sc_mempool_chunk_free, a);
+  }
+}
+
 /** This function is static; we do not like to expose _ext functions in libsc. */
 static void
 sc_mempool_init_ext (sc_mempool_t * mempool, size_t elem_size,
-                     int zero_and_persist)
+                     int zero_and_persist, sc_allocator_t * allocator)
 {
+  SC_ASSERT (allocator == NULL ||
+             (allocator->realloc_fn != NULL && !allocator->shared));
+
   mempool->elem_size = elem_size;
   mempool->elem_count = 0;
   mempool->zero_and_persist = zero_and_persist;
+  mempool->allocator = allocator;
 
-  obstack_init (&mempool->obstack);
+  sc_mempool_begin (mempool);
   sc_array_init (&mempool->freed, sizeof (void *));
 }
 
 void
 sc_mempool_init (sc_mempool_t * mempool, size_t elem_size)
 {
-  sc_mempool_init_ext (mempool, elem_size, 0);
+  sc_mempool_init_ext (mempool, elem_size, 0, NULL);
+}
+
+void
+sc_mempool_init_allocator (sc_mempool_t * mempool, size_t elem_size,
+                           sc_allocator_t * allocator)
+{
+  sc_mempool_init_ext (mempool, elem_size, 0, allocator);
 }
 
 /** This function is static; we do not like to expose _ext functions in libsc. */
 static sc_mempool_t *
-sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
+sc_mempool_new_ext (size_t elem_size, int zero_and_persist,
+                    sc_allocator_t * allocator)
 {
   sc_mempool_t       *mempool;
 
@@ -732,7 +931,7 @@ sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
 
   mempool = SC_ALLOC (sc_mempool_t, 1);
 
-  sc_mempool_init_ext (mempool, elem_size, zero_and_persist);
+  sc_mempool_init_ext (mempool, elem_size, zero_and_persist, allocator);
 
   return mempool;
 }
@@ -740,13 +939,19 @@ sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
 sc_mempool_t       *
 sc_mempool_new (size_t elem_size)
 {
-  return sc_mempool_new_ext (elem_size, 0);
+  return sc_mempool_new_ext (elem_size, 0, NULL);
 }
 
 sc_mempool_t       *
 sc_mempool_new_zero_and_persist (size_t elem_size)
 {
-  return sc_mempool_new_ext (elem_size, 1);
+  return sc_mempool_new_ext (elem_size, 1, NULL);
+}
+
+sc_mempool_t       *
+sc_mempool_new_allocator (size_t elem_size, sc_allocator_t * allocator)
+{
+  return sc_mempool_new_ext (elem_size, 0, allocator);
 }
 
 void
@@ -768,7 +973,7 @@ sc_mempool_truncate (sc_mempool_t * mempool)
 {
   sc_array_reset (&mempool->freed);
   obstack_free (&mempool->obstack, NULL);
-  obstack_init (&mempool->obstack);
+  sc_mempool_begin (mempool);
   mempool->elem_count = 0;
 }
 
@@ -1531,3 +1736,177 @@ sc_recycle_array_remove (sc_recycle_array_t * rec_array, size_t position)
 
   return sc_array_index (&rec_array->a, position);
 }
+
+static inline int
+sc_slot_array_ctz (uint64_t bits)
+{
+#if defined __GNUC__ || defined __clang__
+  return __builtin_ctzll ((unsigned long long) bits);
+#else
+  int                 b;
+
+  for (b = 0; !((bits >> b) & 1); ++b);
+  return b;
+#endif
+}
+
+void
+sc_slot_array_init (sc_slot_array_t * slot_array, size_t elem_size)
+{
+  sc_array_init (&slot_array->a, elem_size);
+  sc_array_init (&slot_array->live, sizeof (uint64_t));
+
+  slot_array->elem_count = 0;
+  slot_array->first_free = 0;
+}
+
+void
+sc_slot_array_reset (sc_slot_array_t * slot_array)
+{
+  sc_array_reset (&slot_array->a);
+  sc_array_reset (&slot_array->live);
+
+  slot_array->elem_count = 0;
+  slot_array->first_free = 0;
+}
+
+void               *
+sc_slot_array_insert (sc_slot_array_t * slot_array, size_t * position)
+{
+  size_t              w, newpos;
+  size_t              num_words = slot_array->live.elem_count;
+  uint64_t           *live = (uint64_t *) slot_array->live.array;
+
+  /* look for a hole below the end of the array */
+  newpos = slot_array->a.elem_count;
+  if (slot_array->elem_count < newpos) {
+    for (w = slot_array->first_free; w < num_words; ++w) {
+      if (~live[w] != 0) {
+        newpos = 64 * w + sc_slot_array_ctz (~live[w]);
+        break;
+      }
+    }
+    slot_array->first_free = w;
+    SC_ASSERT (newpos < slot_array->a.elem_count);
+  }
+
+  /* or grow the array and its bitmap */
+  if (newpos == slot_array->a.elem_count) {
+    sc_array_push (&slot_array->a);
+    if (newpos % 64 == 0) {
+      *(uint64_t *) sc_array_push (&slot_array->live) = 0;
+      live = (uint64_t *) slot_array->live.array;
+    }
+  }
+  SC_ASSERT (!(live[newpos / 64] & ((uint64_t) 1 << (newpos % 64))));
+  live[newpos / 64] |= (uint64_t) 1 << (newpos % 64);
+
+  if (position != NULL) {
+    *position = newpos;
+  }
+  if (++slot_array->elem_count == slot_array->a.elem_count) {
+    /* without holes the next removal sets the hint exactly */
+    slot_array->first_free = slot_array->live.elem_count;
+  }
+
+  return sc_array_index (&slot_array->a, newpos);
+}
+
+void               *
+sc_slot_array_remove (sc_slot_array_t * slot_array, size_t position)
+{
+  uint64_t           *word;
+
+  SC_ASSERT (slot_array->elem_count > 0);
+  SC_ASSERT (sc_slot_array_is_live (slot_array, position));
+
+  word = (uint64_t *) sc_array_index (&slot_array->live, position / 64);
+  *word &= ~((uint64_t) 1 << (position % 64));
+  slot_array->first_free = SC_MIN (slot_array->first_free, position / 64);
+  --slot_array->elem_count;
+
+  return sc_array_index (&slot_array->a, position);
+}
+
+int
+sc_slot_array_is_live (sc_slot_array_t * slot_array, size_t position)
+{
+  SC_ASSERT (position < slot_array->a.elem_count);
+
+  return (int) ((*(uint64_t *) sc_array_index (&slot_array->live,
+                                               position / 64) >>
+                 (position % 64)) & 1);
+}
+
+size_t
+sc_slot_array_next (sc_slot_array_t * slot_array, size_t position)
+{
+  size_t              w;
+  size_t              num_words = slot_array->live.elem_count;
+  uint64_t           *live = (uint64_t *) slot_array->live.array;
+  uint64_t            bits;
+
+  if (position >= slot_array->a.elem_count) {
+    return slot_array->a.elem_count;
+  }
+
+  /* mask the bits below position in its word, then skip empty words */
+  w = position / 64;
+  bits = live[w] & (~(uint64_t) 0 << (position % 64));
+  while (bits == 0) {
+    if (++w == num_words) {
+      return slot_array->a.elem_count;
+    }
+    bits = live[w];
+  }
+  return 64 * w + sc_slot_array_ctz (bits);
+}
+
+void
+sc_slot_array_compact (sc_slot_array_t * slot_array, sc_array_t * newindices)
+{
+  size_t              zi, zlive, zfree;
+  size_t              count = slot_array->a.elem_count;
+  size_t              esize = slot_array->a.elem_size;
+  size_t             *newind = NULL;
+  char               *carray = slot_array->a.array;
+
+  if (newindices != NULL) {
+    SC_ASSERT (newindices->elem_size == sizeof (size_t));
+    sc_array_resize (newindices, count);
+    newind = (size_t *) newindices->array;
+  }
+
+  /* live objects only move down, so a forward pass is safe */
+  zlive = 0;
+  zfree = slot_array->elem_count;
+  for (zi = 0; zi < count; ++zi) {
+    if (sc_slot_array_is_live (slot_array, zi)) {
+      if (zlive != zi) {
+        memcpy (carray + esize * zlive, carray + esize * zi, esize);
+      }
+      if (newind != NULL) {
+        newind[zi] = zlive;
+      }
+      ++zlive;
+    }
+    else if (newind != NULL) {
+      newind[zi] = zfree++;
+    }
+  }
+  SC_ASSERT (zlive == slot_array->elem_count);
+  SC_ASSERT (newind == NULL || zfree == count);
+
+  /* the live objects now fill the leading bits */
+  sc_array_resize (&slot_array->a, zlive);
+  sc_array_resize (&slot_array->live, (zlive + 63) / 64);
+  if (zlive > 0) {
+    memset (slot_array->live.array, -1, slot_array->live.elem_count *
+            sizeof (uint64_t));
+  }
+  if (zlive % 64 != 0) {
+    *(uint64_t *) sc_array_index (&slot_array->live, zlive / 64) =
+      ((uint64_t) 1 << (zlive % 64)) - 1;
+  }
+  slot_array->first_free = slot_array->live.elem_count;
+}
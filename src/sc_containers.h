@@ -81,6 +81,48 @@ typedef int         (*sc_equal_function_t) (const void *v1,
  */
 typedef int         (*sc_hash_foreach_t) (void **v, const void *u);
 
+/** An allocator provides memory to containers in place of sc_malloc.
+ * It consists of a single reallocation function, user data, and hints on
+ * how the containers should use it.
+ */
+typedef struct sc_allocator sc_allocator_t;
+
+/** Function to allocate, resize, or free a block of memory.
+ * \param [in] allocator  The allocator this function belongs to.
+ * \param [in] ptr        NULL to allocate a new block, otherwise a block
+ *                        previously returned by this allocator.
+ * \param [in] old_size   The current size of \a ptr in bytes, or 0.
+ * \param [in] new_size   The requested size in bytes, or 0 to free \a ptr.
+ * \return                A block of at least \a new_size bytes that holds
+ *                        the first min(old_size, new_size) bytes of \a ptr,
+ *                        or NULL if \a new_size is 0.
+ */
+typedef void       *(*sc_allocator_realloc_t) (sc_allocator_t * allocator,
+                                               void *ptr, size_t old_size,
+                                               size_t new_size);
+
+/** The allocator structure is public so it can be embedded. */
+struct sc_allocator
+{
+  sc_allocator_realloc_t realloc_fn;    /**< Allocates, resizes and frees. */
+  void               *user;     /**< Arbitrary data for realloc_fn. */
+  size_t              block_size;       /**< Preferred size of the blocks
+                                             requested by a mempool,
+                                             0 for its default. */
+  int                 shared;   /**< Boolean; the memory is shared between
+                                     processes.  Arrays do not write debug
+                                     patterns into it, mempools refuse it. */
+};
+
+/** Return an allocator that backs large blocks by transparent huge pages.
+ * Blocks of 2 MiB or more are mapped at a multiple of 2 MiB and advised
+ * to use huge pages, which reduces TLB misses when scanning them.
+ * Smaller blocks are taken from sc_malloc.  Without mmap and madvise all
+ * blocks are taken from sc_malloc.
+ * \return             A static allocator that must not be modified.
+ */
+sc_allocator_t     *sc_allocator_hugepage (void);
+
 /** The sc_array object provides a large array of equal-size elements.
  * The array can be resized.
  * Elements are accessed by their 0-based index, their address may change.
@@ -103,6 +145,8 @@ typedef struct sc_array
                                            distinguishes an array of size 0
                                            from a view of size 0 */
   char               *array;    /**< linear array to store elements */
+  sc_allocator_t     *allocator;        /**< provides the array memory,
+                                           NULL for sc_malloc */
 }
 sc_array_t;
 
@@ -198,6 +242,19 @@ void                sc_array_init_view (sc_array_t * view, sc_array_t * array,
 void                sc_array_init_data (sc_array_t * view, void *base,
                                         size_t elem_size, size_t elem_count);
 
+/** Initializes an already allocated (or static) array structure that
+ * takes its memory from an allocator.
+ * The allocator is kept by \ref sc_array_reset and must remain valid until
+ * the array is reset or destroyed for the last time.
+ * \param [in,out]  array       Array structure to be initialized.
+ * \param [in] elem_size        Size of one array element in bytes.
+ * \param [in] allocator        Provides the memory of the array, or NULL
+ *                              for the default sc_malloc.
+ */
+void                sc_array_init_allocator (sc_array_t * array,
+                                             size_t elem_size,
+                                             sc_allocator_t * allocator);
+
 /** Sets the array count to zero and frees all elements.
  * This function turns a view into a newly initialized array.
  * \param [in,out]  array       Array structure to be reset.
@@ -337,7 +394,6 @@ void                sc_array_permute (sc_array_t * array,
 unsigned            sc_array_checksum (sc_array_t * array);
 
 /** Adds an element to a priority queue.
- * PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED.
  * This function is not allowed for views.
  * The priority queue is implemented as a heap in ascending order.
  * A heap is a binary tree where the children are not less than their parent.
@@ -355,7 +411,6 @@ size_t              sc_array_pqueue_add (sc_array_t * array,
                                                         const void *));
 
 /** Pops the smallest element from a priority queue.
- * PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED.
  * This function is not allowed for views.
  * This function assumes that the array forms a valid heap in ascending order.
  * \param [out] result  Pointer to unused allocated memory of elem_size.
@@ -368,6 +423,39 @@ size_t              sc_array_pqueue_pop (sc_array_t * array,
                                          int (*compar) (const void *,
                                                         const void *));
 
+/** Adds an element to a priority queue with nodes of arity children.
+ * The heap is stored such that the children of element [i] are
+ * [arity*i+1]..[arity*i+arity].  With arity 2 this is the binary heap of
+ * \ref sc_array_pqueue_add.  A larger arity makes the tree flatter and
+ * places the children of a node in consecutive memory, which reduces the
+ * cache misses per operation on large heaps at the cost of more
+ * comparisons when popping.  Arities 4 and 8 are good choices.
+ * \param [in] temp    Pointer to unused allocated memory of elem_size.
+ * \param [in] compar  The comparison function to be used.
+ * \param [in] arity   The number of children per node, at least 2.
+ *                     It must be the same for all calls on one heap.
+ * \return Returns the number of levels the element moved up.
+ */
+size_t              sc_array_pqueue_add_arity (sc_array_t * array,
+                                               void *temp,
+                                               int (*compar) (const void *,
+                                                              const void *),
+                                               int arity);
+
+/** Pops the smallest element from a priority queue of given arity.
+ * \see sc_array_pqueue_add_arity.
+ * \param [out] result  Pointer to unused allocated memory of elem_size.
+ * \param [in]  compar  The comparison function to be used.
+ * \param [in]  arity   The number of children per node, at least 2.
+ * \return Returns the number of levels the last element moved down.
+ * \note This function resizes the array to elem_count-1.
+ */
+size_t              sc_array_pqueue_pop_arity (sc_array_t * array,
+                                               void *result,
+                                               int (*compar) (const void *,
+                                                              const void *),
+                                               int arity);
+
 /** Returns a pointer to an array element.
  * \param [in] index needs to be in [0]..[elem_count-1].
  */
@@ -515,6 +603,8 @@ typedef struct sc_mempool
   /* implementation variables */
   struct obstack      obstack;  /**< holds the allocated elements */
   sc_array_t          freed;    /**< buffers the freed elements */
+  sc_allocator_t     *allocator;        /**< provides the obstack chunks,
+                                           NULL for sc_malloc */
 }
 sc_mempool_t;
 
@@ -543,6 +633,24 @@ sc_mempool_t       *sc_mempool_new_zero_and_persist (size_t elem_size);
 void                sc_mempool_init (sc_mempool_t * mempool,
                                      size_t elem_size);
 
+/** Creates a new mempool structure that takes its memory from an allocator.
+ * The zero_and_persist option is off.  The pool requests blocks of the
+ * allocator's block_size and frees them on reset, destroy and truncate.
+ * \param [in] elem_size  Size of one element in bytes.
+ * \param [in] allocator  Provides the memory of the pool, or NULL for the
+ *                        default sc_malloc.  Must not be shared.  It must
+ *                        remain valid until the pool is reset or destroyed.
+ * \return Returns an allocated and initialized memory pool.
+ */
+sc_mempool_t       *sc_mempool_new_allocator (size_t elem_size,
+                                              sc_allocator_t * allocator);
+
+/** Same as sc_mempool_new_allocator, but for an already allocated
+ * sc_mempool_t pointer. */
+void                sc_mempool_init_allocator (sc_mempool_t * mempool,
+                                               size_t elem_size,
+                                               sc_allocator_t * allocator);
+
 /** Destroys a mempool structure.
  * All elements that are still in use are invalidated.
  */
@@ -957,6 +1065,94 @@ void               *sc_recycle_array_insert (sc_recycle_array_t * rec_array,
 void               *sc_recycle_array_remove (sc_recycle_array_t * rec_array,
                                              size_t position);
 
+/** The sc_slot_array object is a recycle array that knows its live slots.
+ *
+ * A bitmap marks every live slot.  Insertion reuses the free slot with the
+ * lowest index, which keeps the live entries packed at the front, and
+ * iteration skips free slots a word of 64 at a time.  After much removal
+ * the array can be compacted, producing a permutation that applies the
+ * same move to dependent arrays by \ref sc_array_permute.
+ */
+typedef struct sc_slot_array
+{
+  /* interface variables */
+  size_t              elem_count;       /* number of live entries */
+  sc_array_t          a;                /* all slots, live or free */
+
+  /* implementation variables */
+  sc_array_t          live;             /* uint64_t bitmap of live slots */
+  size_t              first_free;       /* no free slot in lower words */
+}
+sc_slot_array_t;
+
+/** Initialize a slot array.
+ *
+ * \param [in] elem_size   Size of the objects to be stored in the array.
+ */
+void                sc_slot_array_init (sc_slot_array_t * slot_array,
+                                        size_t elem_size);
+
+/** Reset a slot array.
+ *
+ * As with all _reset functions, calling _init, then any array operations,
+ * then _reset is memory neutral.
+ */
+void                sc_slot_array_reset (sc_slot_array_t * slot_array);
+
+/** Insert an object into the slot array at the lowest free position.
+ * The object is not copied into the array.  Use the return value for that.
+ *
+ * \param [out] position   If position != NULL, *position is set to the
+ *                         array position of the inserted object.
+ * \return                 Returns the new address of the object in the array.
+ */
+void               *sc_slot_array_insert (sc_slot_array_t * slot_array,
+                                          size_t * position);
+
+/** Remove an object from the slot array.  It must be live.
+ *
+ * \param [in] position   Index into the array for the object to remove.
+ * \return                The pointer to the removed object.  Will be valid
+ *                        as long as no other function is called
+ *                        on this slot array.
+ */
+void               *sc_slot_array_remove (sc_slot_array_t * slot_array,
+                                          size_t position);
+
+/** Determine whether a slot holds a live object.
+ *
+ * \param [in] position   Index less than slot_array->a.elem_count.
+ * \return                True if the slot is live, false if it is free.
+ */
+int                 sc_slot_array_is_live (sc_slot_array_t * slot_array,
+                                           size_t position);
+
+/** Find the next live slot.  To visit all live objects in order, use
+ *
+ *     for (i = sc_slot_array_next (s, 0); i < s->a.elem_count;
+ *          i = sc_slot_array_next (s, i + 1)) { ... }
+ *
+ * \param [in] position   The search starts at this index.
+ * \return                The smallest live index greater or equal position,
+ *                        or slot_array->a.elem_count if there is none.
+ */
+size_t              sc_slot_array_next (sc_slot_array_t * slot_array,
+                                        size_t position);
+
+/** Move all live objects to the front, preserving their order.
+ * Afterwards the array has no free slots and the position of every object
+ * may have changed.
+ *
+ * \param [out] newindices If not NULL, it must be an array of size_t.  It is
+ *                         resized to the number of slots before compaction
+ *                         and entry i is set to the new position of the
+ *                         object formerly at position i.  Free slots are
+ *                         assigned the positions after the live ones, so
+ *                         this is a permutation for \ref sc_array_permute.
+ */
+void                sc_slot_array_compact (sc_slot_array_t * slot_array,
+                                           sc_array_t * newindices);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_CONTAINERS_H */
@@ -23,6 +23,9 @@
 
 #include <sc_dmatrix.h>
 #include <sc_lapack.h>
+#ifdef SC_HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
 
 int
 sc_darray_is_valid (const double *darray, size_t nelem)
@@ -879,14 +882,131 @@ sc_darray_work_new (const int n_threads, const int n_blocks,
   work->n_threads = n_threads;
   work->n_blocks = n_blocks;
   work->n_entries = n_entries_aligned;
+  work->thread_stride = (size_t) n_blocks * n_entries_aligned;
+  work->mem = work->data;
+
+  return work;
+}
+
+/** Return the size of a memory page in bytes. */
+static size_t
+sc_darray_work_page_bytes (void)
+{
+#ifdef _SC_PAGESIZE
+  const long          page_bytes = sysconf (_SC_PAGESIZE);
+
+  if (page_bytes > 0) {
+    return (size_t) page_bytes;
+  }
+#endif
+  return 4096;
+}
+
+sc_darray_work_t   *
+sc_darray_work_new_numa (const int n_threads, const int n_blocks,
+                         const int n_entries, const int alignment_bytes)
+{
+  const size_t        page_bytes = sc_darray_work_page_bytes ();
+  const int           align_dbl = alignment_bytes / 8;
+  const int           n_entries_aligned = SC_ALIGN_UP (n_entries, align_dbl);
+  size_t              thread_bytes, shift;
+  sc_darray_work_t   *work;
+
+  SC_ASSERT (0 < n_threads);
+  SC_ASSERT (0 < n_blocks);
+  SC_ASSERT (alignment_bytes <= 0 || (alignment_bytes % 8) == 0);
+  SC_ASSERT (alignment_bytes <= 0 || page_bytes % alignment_bytes == 0);
+
+  work = SC_ALLOC (sc_darray_work_t, 1);
+
+  /* pad the memory of each thread to full pages */
+  thread_bytes = (size_t) n_blocks * n_entries_aligned * sizeof (double);
+  thread_bytes = (thread_bytes + page_bytes - 1) / page_bytes * page_bytes;
+
+  /* allocate one spare page to shift the data onto a page boundary;
+   * malloc does not write to the pages beyond its own bookkeeping */
+  work->mem = SC_ALLOC (char, n_threads * thread_bytes + page_bytes);
+  shift = (page_bytes - (size_t) ((uintptr_t) work->mem % page_bytes))
+    % page_bytes;
+  work->data = (double *) ((char *) work->mem + shift);
+  work->n_threads = n_threads;
+  work->n_blocks = n_blocks;
+  work->n_entries = n_entries_aligned;
+  work->thread_stride = thread_bytes / sizeof (double);
 
   return work;
 }
 
+void
+sc_darray_work_first_touch (sc_darray_work_t * work, const int thread)
+{
+  SC_ASSERT (0 <= thread && thread < work->n_threads);
+
+  memset (work->data + work->thread_stride * thread, 0,
+          work->thread_stride * sizeof (double));
+}
+
+int
+sc_darray_work_get_numa_node (sc_darray_work_t * work, const int thread)
+{
+#if defined SC_HAVE_SYS_SYSCALL_H && defined SYS_move_pages
+  const size_t        page_bytes = sc_darray_work_page_bytes ();
+  const size_t        thread_bytes =
+    (size_t) work->n_blocks * work->n_entries * sizeof (double);
+  int                 node, *status;
+  long                sysret;
+  size_t              zz, num_pages;
+  uintptr_t           first, last;
+  void              **pages;
+
+  SC_ASSERT (0 <= thread && thread < work->n_threads);
+
+  /* collect the pages overlapping the blocks of this thread */
+  first = (uintptr_t) (work->data + work->thread_stride * thread);
+  last = first + thread_bytes - 1;
+  first -= first % page_bytes;
+  last -= last % page_bytes;
+  num_pages = (size_t) (last - first) / page_bytes + 1;
+  pages = SC_ALLOC (void *, num_pages);
+  status = SC_ALLOC (int, num_pages);
+  for (zz = 0; zz < num_pages; ++zz) {
+    pages[zz] = (void *) (first + zz * page_bytes);
+  }
+
+  /* without a nodes argument move_pages only reports the placement */
+  node = -1;
+  sysret = syscall (SYS_move_pages, 0, (unsigned long) num_pages,
+                    pages, NULL, status, 0);
+  if (sysret == 0) {
+    for (zz = 0; zz < num_pages; ++zz) {
+      if (status[zz] < 0) {
+        /* this page has not been touched yet */
+        continue;
+      }
+      if (node == -1) {
+        node = status[zz];
+      }
+      else if (node != status[zz]) {
+        node = -1;
+        break;
+      }
+    }
+  }
+  SC_FREE (pages);
+  SC_FREE (status);
+
+  return node;
+#else
+  SC_ASSERT (0 <= thread && thread < work->n_threads);
+
+  return -1;
+#endif
+}
+
 void
 sc_darray_work_destroy (sc_darray_work_t * work)
 {
-  SC_FREE (work->data);
+  SC_FREE (work->mem);
   SC_FREE (work);
 }
 
@@ -897,7 +1017,7 @@ sc_darray_work_get (sc_darray_work_t * work, const int thread,
   SC_ASSERT (0 <= thread && thread < work->n_threads);
   SC_ASSERT (0 <= block && block < work->n_blocks);
 
-  return work->data + work->n_entries * (work->n_blocks * thread + block);
+  return work->data + work->thread_stride * thread + work->n_entries * block;
 }
 
 int
@@ -429,6 +429,8 @@ typedef struct sc_darray_work
   int                 n_threads;  /**< Number of threads */
   int                 n_blocks;   /**< Number of blocks per thread */
   int                 n_entries;  /**< Number of entries per block */
+  size_t              thread_stride;    /**< Entries between two threads */
+  void               *mem;        /**< Allocated memory containing data */
 }
 sc_darray_work_t;
 
@@ -449,6 +451,49 @@ sc_darray_work_t   *sc_darray_work_new (const int n_threads,
                                         const int n_entries,
                                         const int alignment_bytes);
 
+/** Create a new multithreaded workspace with NUMA-aware page placement.
+ * The blocks are laid out as in \ref sc_darray_work_new, but the memory
+ * of each thread starts on a page boundary and is padded to a multiple of
+ * the page size, such that no two threads share a page.  The memory is
+ * not touched by this function.  Each thread should call
+ * \ref sc_darray_work_first_touch on its own blocks from within the
+ * parallel region, so that the operating system's first-touch policy
+ * places the pages on the NUMA node the thread is running on.
+ * This function aborts on memory allocation errors.
+ * \param [in] n_threads        Number of thread.
+ * \param [in] n_blocks         Number of blocks per thread.
+ * \param [in] n_entries        Minimum number of entries per block.
+ * \param [in] alignment_bytes  Align blocks to this byte boundary.
+ *                              Must divide the page size if positive.
+ * \return                      A valid darray_work object.
+ */
+sc_darray_work_t   *sc_darray_work_new_numa (const int n_threads,
+                                             const int n_blocks,
+                                             const int n_entries,
+                                             const int alignment_bytes);
+
+/** Write zeros to all blocks of one thread.
+ * For a workspace created by \ref sc_darray_work_new_numa, this function is
+ * meant to be called by the thread owning the blocks before any other
+ * thread accesses them.  It may be called for any workspace though.
+ * \param [in,out] work     Workspace whose blocks are zeroed.
+ * \param [in] thread       Valid thread index into \b work.
+ */
+void                sc_darray_work_first_touch (sc_darray_work_t * work,
+                                                const int thread);
+
+/** Query the NUMA node holding the memory of one thread.
+ * The query examines all pages of the thread without faulting them in.
+ * \param [in] work         Workspace taken as a source.
+ * \param [in] thread       Valid thread index into \b work.
+ * \return                  The NUMA node if all touched pages of the
+ *                          thread reside on the same node, -1 if the pages
+ *                          have not been touched or are spread over several
+ *                          nodes, or if the query is not supported.
+ */
+int                 sc_darray_work_get_numa_node (sc_darray_work_t * work,
+                                                  const int thread);
+
 /** Destroy a darray_work object and all allocated memory. */
 void                sc_darray_work_destroy (sc_darray_work_t * work);
 
@@ -0,0 +1,413 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_exchange.h>
+#include <sc_notify.h>
+
+#if defined SC_ENABLE_MPI && defined MPI_VERSION && MPI_VERSION >= 3
+#define SC_EXCHANGE_HAVE_NEIGHBOR
+#endif
+
+/** Find a rank in an array of unique ranks.
+ * \return              Its index or -1.
+ */
+static int
+sc_exchange_find (int num, const int *ranks, int rank)
+{
+  int                 i;
+
+  for (i = 0; i < num; ++i) {
+    if (ranks[i] == rank) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/** Send the message sizes to the receivers once. */
+static void
+sc_exchange_sizes (sc_exchange_t * ex, const size_t *send_sizes,
+                   size_t *recv_sizes)
+{
+  int                 mpiret;
+  int                 i, num_requests;
+  unsigned long long *sizes;
+  sc_MPI_Request     *requests;
+
+  sizes = SC_ALLOC (unsigned long long, ex->num_senders + ex->num_receivers);
+  requests = SC_ALLOC (sc_MPI_Request, ex->num_senders + ex->num_receivers);
+  num_requests = 0;
+  for (i = 0; i < ex->num_senders; ++i) {
+    if (i != ex->self_recv) {
+      mpiret = sc_MPI_Irecv (sizes + i, 1, sc_MPI_UNSIGNED_LONG_LONG,
+                             ex->senders[i], SC_TAG_EXCHANGE_SIZES,
+                             ex->mpicomm,
+                             requests + num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  for (i = 0; i < ex->num_receivers; ++i) {
+    sizes[ex->num_senders + i] = (unsigned long long) send_sizes[i];
+    if (i != ex->self_send) {
+      mpiret = sc_MPI_Isend (sizes + ex->num_senders + i, 1,
+                             sc_MPI_UNSIGNED_LONG_LONG, ex->receivers[i],
+                             SC_TAG_EXCHANGE_SIZES, ex->mpicomm,
+                             requests + num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  mpiret = sc_MPI_Waitall (num_requests, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  for (i = 0; i < ex->num_senders; ++i) {
+    recv_sizes[i] = (i == ex->self_recv) ? send_sizes[ex->self_send] :
+      (size_t) sizes[i];
+  }
+  SC_FREE (requests);
+  SC_FREE (sizes);
+}
+
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+
+/** Create the graph communicator and the alltoallv arguments. */
+static void
+sc_exchange_setup_neighbor (sc_exchange_t * ex)
+{
+  int                 mpiret;
+  int                 i, nr, ns;
+  int                *sendcounts, *sdispls, *recvcounts, *rdispls;
+  int                *destinations, *sources, *weights;
+
+  /* the own rank is not part of the graph */
+  nr = ex->num_receivers - (ex->self_send >= 0);
+  ns = ex->num_senders - (ex->self_recv >= 0);
+  ex->counts = SC_ALLOC (int, 2 * (nr + ns));
+  sendcounts = ex->counts;
+  sdispls = sendcounts + nr;
+  recvcounts = sdispls + nr;
+  rdispls = recvcounts + ns;
+  destinations = SC_ALLOC (int, SC_MAX (nr, 1));
+  sources = SC_ALLOC (int, SC_MAX (ns, 1));
+
+  for (nr = i = 0; i < ex->num_receivers; ++i) {
+    if (i != ex->self_send) {
+      destinations[nr] = ex->receivers[i];
+      sendcounts[nr] = (int) (ex->send_offsets[i + 1] - ex->send_offsets[i]);
+      sdispls[nr++] = (int) ex->send_offsets[i];
+    }
+  }
+  for (ns = i = 0; i < ex->num_senders; ++i) {
+    if (i != ex->self_recv) {
+      sources[ns] = ex->senders[i];
+      recvcounts[ns] = (int) (ex->recv_offsets[i + 1] - ex->recv_offsets[i]);
+      rdispls[ns++] = (int) ex->recv_offsets[i];
+    }
+  }
+
+  /* unit weights avoid the MPI_UNWEIGHTED sentinel, which some compilers
+   * flag as an out-of-bounds read */
+  weights = SC_ALLOC (int, SC_MAX (SC_MAX (nr, ns), 1));
+  for (i = 0; i < SC_MAX (nr, ns); ++i) {
+    weights[i] = 1;
+  }
+  mpiret = MPI_Dist_graph_create_adjacent
+    (ex->mpicomm, ns, sources, weights, nr, destinations, weights,
+     MPI_INFO_NULL, 0, &ex->graphcomm);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (weights);
+  SC_FREE (destinations);
+  SC_FREE (sources);
+}
+
+#endif
+
+/** Set up the persistent requests for the messages to other ranks. */
+static void
+sc_exchange_setup_persistent (sc_exchange_t * ex)
+{
+  int                 mpiret;
+  int                 i;
+  size_t              bytes;
+
+  ex->requests = SC_ALLOC (sc_MPI_Request, ex->num_senders +
+                           ex->num_receivers);
+  ex->num_requests = 0;
+  for (i = 0; i < ex->num_senders; ++i) {
+    if (i != ex->self_recv) {
+      bytes = ex->recv_offsets[i + 1] - ex->recv_offsets[i];
+      mpiret = sc_MPI_Recv_init (ex->recv_buffer + ex->recv_offsets[i],
+                                 (int) bytes, sc_MPI_BYTE, ex->senders[i],
+                                 SC_TAG_EXCHANGE, ex->mpicomm,
+                                 ex->requests + ex->num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  for (i = 0; i < ex->num_receivers; ++i) {
+    if (i != ex->self_send) {
+      bytes = ex->send_offsets[i + 1] - ex->send_offsets[i];
+      mpiret = sc_MPI_Send_init (ex->send_buffer + ex->send_offsets[i],
+                                 (int) bytes, sc_MPI_BYTE, ex->receivers[i],
+                                 SC_TAG_EXCHANGE, ex->mpicomm,
+                                 ex->requests + ex->num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+}
+
+sc_exchange_t      *
+sc_exchange_new (sc_MPI_Comm mpicomm, int num_receivers,
+                 const int *receivers, const size_t *send_sizes,
+                 int num_senders, const int *senders,
+                 const size_t *recv_sizes, sc_exchange_method_t method)
+{
+  int                 mpiret;
+  int                 i;
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+  int                 fits, allfits;
+#endif
+  size_t             *sizes;
+  sc_exchange_t      *ex;
+
+  SC_ASSERT (num_receivers >= 0 && num_senders >= 0);
+  SC_ASSERT (0 <= method && method < SC_EXCHANGE_METHOD_LAST);
+
+  ex = SC_ALLOC_ZERO (sc_exchange_t, 1);
+  ex->mpicomm = mpicomm;
+  mpiret = sc_MPI_Comm_rank (mpicomm, &ex->mpirank);
+  SC_CHECK_MPI (mpiret);
+  ex->graphcomm = sc_MPI_COMM_NULL;
+  ex->progress_id = -1;
+
+  /* copy the pattern */
+  ex->num_receivers = num_receivers;
+  ex->receivers = SC_ALLOC (int, num_receivers);
+  memcpy (ex->receivers, receivers, num_receivers * sizeof (int));
+  ex->self_send = sc_exchange_find (num_receivers, receivers, ex->mpirank);
+  ex->num_senders = num_senders;
+  ex->senders = SC_ALLOC (int, num_senders);
+  memcpy (ex->senders, senders, num_senders * sizeof (int));
+  ex->self_recv = sc_exchange_find (num_senders, senders, ex->mpirank);
+  SC_ASSERT ((ex->self_send == -1) == (ex->self_recv == -1));
+
+  /* message sizes determine the buffer offsets */
+  sizes = NULL;
+  if (recv_sizes == NULL) {
+    recv_sizes = sizes = SC_ALLOC (size_t, num_senders);
+    sc_exchange_sizes (ex, send_sizes, sizes);
+  }
+  ex->send_offsets = SC_ALLOC (size_t, num_receivers + 1);
+  ex->send_offsets[0] = 0;
+  for (i = 0; i < num_receivers; ++i) {
+    SC_CHECK_ABORT (send_sizes[i] <= (size_t) INT_MAX,
+                    "Exchange message exceeds INT_MAX bytes");
+    ex->send_offsets[i + 1] = ex->send_offsets[i] + send_sizes[i];
+  }
+  ex->recv_offsets = SC_ALLOC (size_t, num_senders + 1);
+  ex->recv_offsets[0] = 0;
+  for (i = 0; i < num_senders; ++i) {
+    SC_CHECK_ABORT (recv_sizes[i] <= (size_t) INT_MAX,
+                    "Exchange message exceeds INT_MAX bytes");
+    ex->recv_offsets[i + 1] = ex->recv_offsets[i] + recv_sizes[i];
+  }
+  SC_ASSERT (ex->self_send == -1 ||
+             send_sizes[ex->self_send] == recv_sizes[ex->self_recv]);
+  SC_FREE (sizes);
+  ex->send_buffer = SC_ALLOC (char, ex->send_offsets[num_receivers]);
+  ex->recv_buffer = SC_ALLOC (char, ex->recv_offsets[num_senders]);
+
+  /* set up the communication once */
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+  if (method == SC_EXCHANGE_NEIGHBOR) {
+    /* the graph is collective, so all processes must agree on the method */
+    fits = ex->send_offsets[num_receivers] <= (size_t) INT_MAX &&
+      ex->recv_offsets[num_senders] <= (size_t) INT_MAX;
+    mpiret = sc_MPI_Allreduce (&fits, &allfits, 1, sc_MPI_INT, sc_MPI_LAND,
+                               mpicomm);
+    SC_CHECK_MPI (mpiret);
+    if (!allfits) {
+      method = SC_EXCHANGE_PERSISTENT;
+    }
+  }
+  if (method == SC_EXCHANGE_NEIGHBOR) {
+    ex->method = SC_EXCHANGE_NEIGHBOR;
+    sc_exchange_setup_neighbor (ex);
+    ex->requests = SC_ALLOC (sc_MPI_Request, 1);
+    ex->requests[0] = sc_MPI_REQUEST_NULL;
+    ex->num_requests = 1;
+    return ex;
+  }
+#endif
+  ex->method = SC_EXCHANGE_PERSISTENT;
+  sc_exchange_setup_persistent (ex);
+  return ex;
+}
+
+sc_exchange_t      *
+sc_exchange_new_notify (sc_MPI_Comm mpicomm, int num_receivers,
+                        const int *receivers, const size_t *send_sizes,
+                        sc_exchange_method_t method)
+{
+  int                 mpiret;
+  int                 mpisize, num_senders;
+  int                *senders;
+  sc_exchange_t      *ex;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  senders = SC_ALLOC (int, mpisize);
+  mpiret = sc_notify ((int *) receivers, num_receivers,
+                      senders, &num_senders, mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  ex = sc_exchange_new (mpicomm, num_receivers, receivers, send_sizes,
+                        num_senders, senders, NULL, method);
+  SC_FREE (senders);
+  return ex;
+}
+
+void
+sc_exchange_destroy (sc_exchange_t * ex)
+{
+  int                 mpiret;
+  int                 i;
+
+  SC_ASSERT (!ex->active);
+
+  if (ex->method == SC_EXCHANGE_PERSISTENT) {
+    for (i = 0; i < ex->num_requests; ++i) {
+      mpiret = sc_MPI_Request_free (ex->requests + i);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  if (ex->graphcomm != sc_MPI_COMM_NULL) {
+    mpiret = sc_MPI_Comm_free (&ex->graphcomm);
+    SC_CHECK_MPI (mpiret);
+  }
+  SC_FREE (ex->requests);
+  SC_FREE (ex->counts);
+  SC_FREE (ex->send_buffer);
+  SC_FREE (ex->recv_buffer);
+  SC_FREE (ex->send_offsets);
+  SC_FREE (ex->recv_offsets);
+  SC_FREE (ex->receivers);
+  SC_FREE (ex->senders);
+  SC_FREE (ex);
+}
+
+/** Progress hook that tests the outstanding requests of a plan. */
+static int
+sc_exchange_progress (void *v)
+{
+  int                 mpiret, flag;
+  sc_exchange_t      *ex = (sc_exchange_t *) v;
+
+  mpiret = sc_MPI_Testall (ex->num_requests, ex->requests, &flag,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  return flag;
+}
+
+void
+sc_exchange_begin (sc_exchange_t * ex, sc_exchange_pack_t pack, void *user)
+{
+  int                 mpiret;
+  int                 i;
+
+  SC_ASSERT (!ex->active);
+  ex->active = 1;
+
+  if (pack != NULL) {
+    for (i = 0; i < ex->num_receivers; ++i) {
+      pack (ex->send_buffer + ex->send_offsets[i],
+            ex->send_offsets[i + 1] - ex->send_offsets[i], i,
+            ex->receivers[i], user);
+    }
+  }
+
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+  if (ex->method == SC_EXCHANGE_NEIGHBOR) {
+    int                 nr, ns;
+
+    nr = ex->num_receivers - (ex->self_send >= 0);
+    ns = ex->num_senders - (ex->self_recv >= 0);
+    mpiret = MPI_Ineighbor_alltoallv
+      (ex->send_buffer, ex->counts, ex->counts + nr, MPI_BYTE,
+       ex->recv_buffer, ex->counts + 2 * nr, ex->counts + 2 * nr + ns,
+       MPI_BYTE, ex->graphcomm, ex->requests);
+    SC_CHECK_MPI (mpiret);
+  }
+  else
+#endif
+  {
+    mpiret = sc_MPI_Startall (ex->num_requests, ex->requests);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* let sc_mpi_progress drive the messages while the caller computes */
+  ex->progress_id = ex->num_requests > 0 ?
+    sc_mpi_progress_register (sc_exchange_progress, ex) : -1;
+
+  /* the message to ourselves does not need MPI */
+  if (ex->self_send >= 0) {
+    memcpy (ex->recv_buffer + ex->recv_offsets[ex->self_recv],
+            ex->send_buffer + ex->send_offsets[ex->self_send],
+            ex->send_offsets[ex->self_send + 1] -
+            ex->send_offsets[ex->self_send]);
+  }
+}
+
+void
+sc_exchange_end (sc_exchange_t * ex, sc_exchange_unpack_t unpack,
+                 void *user)
+{
+  int                 mpiret;
+  int                 i;
+
+  SC_ASSERT (ex->active);
+
+  if (ex->progress_id >= 0) {
+    sc_mpi_progress_unregister (ex->progress_id);
+    ex->progress_id = -1;
+  }
+  mpiret = sc_MPI_Waitall (ex->num_requests, ex->requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  ex->active = 0;
+
+  if (unpack != NULL) {
+    for (i = 0; i < ex->num_senders; ++i) {
+      unpack (ex->recv_buffer + ex->recv_offsets[i],
+              ex->recv_offsets[i + 1] - ex->recv_offsets[i], i,
+              ex->senders[i], user);
+    }
+  }
+}
+
+void
+sc_exchange_execute (sc_exchange_t * ex, sc_exchange_pack_t pack,
+                     sc_exchange_unpack_t unpack, void *user)
+{
+  sc_exchange_begin (ex, pack, user);
+  sc_exchange_end (ex, unpack, user);
+}
@@ -0,0 +1,209 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_exchange.h
+ * Persistent plan for a repeated point-to-point exchange.
+ *
+ * Many applications determine once who sends to whom, for example by
+ * \ref sc_notify, and then repeat the same exchange of messages in every
+ * time step.  The plan stores the peers and message sizes, allocates one
+ * contiguous send and receive buffer, and sets up the communication once.
+ * By default we use persistent MPI requests that are restarted on every
+ * exchange.  If MPI 3 is available, we can alternatively use a
+ * neighborhood collective on a distributed graph communicator.
+ *
+ * An exchange is split into \ref sc_exchange_begin and \ref
+ * sc_exchange_end such that computation can overlap with communication.
+ * Many MPI implementations only move large messages forward inside MPI
+ * calls; an active exchange registers a hook with \ref sc_mpi_progress,
+ * which the application or the thread of \ref sc_mpi_progress_thread_start
+ * may call meanwhile.
+ * Messages are written and read by pack and unpack callbacks, or directly
+ * in the buffers at the offsets stored in the plan.  A message to the own
+ * rank is copied without MPI, so a plan also works without MPI when all
+ * peers are the calling process itself.
+ */
+
+#ifndef SC_EXCHANGE_H
+#define SC_EXCHANGE_H
+
+#include <sc.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** The communication method of an exchange plan. */
+typedef enum sc_exchange_method
+{
+  SC_EXCHANGE_PERSISTENT,       /**< Persistent send and receive requests. */
+  SC_EXCHANGE_NEIGHBOR,         /**< Neighborhood alltoallv collective.
+                                     Falls back to persistent requests
+                                     if MPI 3 is not available. */
+  SC_EXCHANGE_METHOD_LAST
+}
+sc_exchange_method_t;
+
+/** Fill the message to one receiver before an exchange.
+ * \param [out] buffer  The message to write.
+ * \param [in] bytes    The size of the message in bytes.
+ * \param [in] index    Index of the receiver in the plan.
+ * \param [in] peer     Rank of the receiver.
+ * \param [in] user     Context passed to \ref sc_exchange_begin.
+ */
+typedef void        (*sc_exchange_pack_t) (void *buffer, size_t bytes,
+                                           int index, int peer,
+                                           void *user);
+
+/** Process the message from one sender after an exchange.
+ * \param [in] buffer   The message received.
+ * \param [in] bytes    The size of the message in bytes.
+ * \param [in] index    Index of the sender in the plan.
+ * \param [in] peer     Rank of the sender.
+ * \param [in] user     Context passed to \ref sc_exchange_end.
+ */
+typedef void        (*sc_exchange_unpack_t) (const void *buffer,
+                                             size_t bytes, int index,
+                                             int peer, void *user);
+
+/** The exchange plan.  All members are read-only for the user except
+ * the contents of the buffers. */
+typedef struct sc_exchange
+{
+  sc_MPI_Comm         mpicomm;          /**< Not owned by the plan. */
+  int                 mpirank;          /**< Rank in mpicomm. */
+  sc_exchange_method_t method;          /**< The method in use. */
+  int                 active;           /**< Between begin and end. */
+  int                 num_receivers;    /**< Number of ranks we send to. */
+  int                *receivers;        /**< Unique ranks we send to. */
+  size_t             *send_offsets;     /**< Message i to receivers[i]
+                                             is at send_buffer +
+                                             send_offsets[i] and ends at
+                                             send_offsets[i + 1]. */
+  char               *send_buffer;      /**< All outgoing messages. */
+  int                 num_senders;      /**< Number of ranks we hear from. */
+  int                *senders;          /**< Unique ranks we hear from. */
+  size_t             *recv_offsets;     /**< Same layout as send_offsets. */
+  char               *recv_buffer;      /**< All incoming messages. */
+  int                 self_send;        /**< Index of mpirank in receivers
+                                             or -1. */
+  int                 self_recv;        /**< Index of mpirank in senders
+                                             or -1. */
+  int                 num_requests;     /**< Persistent requests. */
+  sc_MPI_Request     *requests;         /**< Receives before sends. */
+  sc_MPI_Comm         graphcomm;        /**< The neighborhood graph or
+                                             sc_MPI_COMM_NULL. */
+  int                *counts;           /**< Neighborhood counts and
+                                             displacements. */
+  int                 progress_id;      /**< Registered progress hook
+                                             while active or -1. */
+}
+sc_exchange_t;
+
+/** Create an exchange plan from a known communication pattern.
+ * This function is collective over all processes that are peers.  With
+ * \ref SC_EXCHANGE_NEIGHBOR it creates a graph communicator and is thus
+ * collective over all of mpicomm, even the processes without peers.
+ * If any process has more than INT_MAX bytes to send or receive in total,
+ * all of them fall back to \ref SC_EXCHANGE_PERSISTENT.
+ * \param [in] mpicomm          Communicator used for every exchange.
+ *                              It must remain valid for the plan's life.
+ * \param [in] num_receivers    Number of processes we send to.
+ * \param [in] receivers        Array [num_receivers] of unique ranks.
+ * \param [in] send_sizes       Array [num_receivers] of message sizes.
+ *                              Each is at most INT_MAX bytes.
+ * \param [in] num_senders      Number of processes we receive from.
+ * \param [in] senders          Array [num_senders] of unique ranks.
+ *                              This is the output of \ref sc_notify
+ *                              called with the receivers.
+ * \param [in] recv_sizes       Array [num_senders] of message sizes.  If
+ *                              NULL, the sizes are sent once by the
+ *                              senders.  Each sender must match the
+ *                              size that the receiver expects.
+ * \param [in] method           The communication method, which must be
+ *                              the same on all processes.
+ * \return                      The plan, to be destroyed with
+ *                              \ref sc_exchange_destroy.
+ */
+sc_exchange_t      *sc_exchange_new (sc_MPI_Comm mpicomm,
+                                     int num_receivers,
+                                     const int *receivers,
+                                     const size_t *send_sizes,
+                                     int num_senders, const int *senders,
+                                     const size_t *recv_sizes,
+                                     sc_exchange_method_t method);
+
+/** Create an exchange plan when only the receivers are known.
+ * The senders are found with \ref sc_notify and the message sizes are
+ * sent along.  This function is collective over mpicomm.
+ * \param [in] mpicomm          Communicator used for every exchange.
+ * \param [in] num_receivers    Number of processes we send to.
+ * \param [in] receivers        Array [num_receivers] of ranks in
+ *                              ascending order without duplicates.
+ * \param [in] send_sizes       Array [num_receivers] of message sizes.
+ * \param [in] method           The communication method.
+ * \return                      The plan as in \ref sc_exchange_new.
+ */
+sc_exchange_t      *sc_exchange_new_notify (sc_MPI_Comm mpicomm,
+                                            int num_receivers,
+                                            const int *receivers,
+                                            const size_t *send_sizes,
+                                            sc_exchange_method_t method);
+
+/** Destroy an exchange plan and free its buffers and requests.
+ * With \ref SC_EXCHANGE_NEIGHBOR this frees the graph communicator and is
+ * collective over the communicator of the plan.
+ * \param [in,out] ex   The plan must not be active.
+ */
+void                sc_exchange_destroy (sc_exchange_t * ex);
+
+/** Start an exchange.  This function returns without waiting.
+ * \param [in,out] ex   The plan must not be active.
+ * \param [in] pack     If not NULL, called for every receiver before its
+ *                      message is sent.  Otherwise the send buffer is
+ *                      expected to be filled by the caller.
+ * \param [in] user     Passed to the pack callback.
+ */
+void                sc_exchange_begin (sc_exchange_t * ex,
+                                       sc_exchange_pack_t pack, void *user);
+
+/** Wait for an exchange to complete.
+ * The send buffer may be reused on return.
+ * \param [in,out] ex   The plan must be active.
+ * \param [in] unpack   If not NULL, called for every sender in order.
+ *                      Otherwise the caller reads the receive buffer.
+ * \param [in] user     Passed to the unpack callback.
+ */
+void                sc_exchange_end (sc_exchange_t * ex,
+                                     sc_exchange_unpack_t unpack,
+                                     void *user);
+
+/** Exchange messages without overlap.
+ * This is \ref sc_exchange_begin followed by \ref sc_exchange_end.
+ */
+void                sc_exchange_execute (sc_exchange_t * ex,
+                                         sc_exchange_pack_t pack,
+                                         sc_exchange_unpack_t unpack,
+                                         void *user);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_EXCHANGE_H */
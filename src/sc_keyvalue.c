@@ -26,6 +26,7 @@
 typedef struct sc_keyvalue_entry
 {
   const char         *key;
+  unsigned            hash;
   sc_keyvalue_entry_type_t type;
   union
   {
@@ -38,10 +39,34 @@ typedef struct sc_keyvalue_entry
 }
 sc_keyvalue_entry_t;
 
+/** A slot of the flat table refers to an entry by its index. */
+typedef struct sc_keyvalue_slot
+{
+  unsigned            hash;
+  int                 index;
+}
+sc_keyvalue_slot_t;
+
+/* values of sc_keyvalue_slot_t.index that do not refer to an entry */
+#define SC_KEYVALUE_SLOT_EMPTY (-1)
+#define SC_KEYVALUE_SLOT_DELETED (-2)
+
+/* the smallest number of slots of the flat table, a power of 2 */
+#define SC_KEYVALUE_SLOTS_MIN 16
+
 struct sc_keyvalue
 {
+  sc_keyvalue_storage_t storage;
+
+  /* members of SC_KEYVALUE_STORAGE_HASH */
   sc_hash_t          *hash;
   sc_mempool_t       *value_allocator;
+
+  /* members of SC_KEYVALUE_STORAGE_FLAT */
+  sc_array_t         *entries;  /* in order of insertion */
+  sc_array_t         *slots;    /* open addressing with linear probing */
+  size_t              num_deleted;      /* removed entries */
+  size_t              num_occupied;     /* slots not empty */
 };
 
 static unsigned
@@ -49,7 +74,8 @@ sc_keyvalue_entry_hash (const void *v, const void *u)
 {
   const sc_keyvalue_entry_t *ov = (const sc_keyvalue_entry_t *) v;
 
-  return sc_hash_function_string (ov->key, NULL);
+  /* the hash value has been computed when the key was created */
+  return ov->hash;
 }
 
 static int
@@ -59,7 +85,185 @@ sc_keyvalue_entry_equal (const void *v1, const void *v2, const void *u)
   const sc_keyvalue_entry_t *ov1 = (const sc_keyvalue_entry_t *) v1;
   const sc_keyvalue_entry_t *ov2 = (const sc_keyvalue_entry_t *) v2;
 
-  return !strcmp (ov1->key, ov2->key);
+  /* keys from the same string compare equal without looking at it */
+  return ov1->key == ov2->key ||
+    (ov1->hash == ov2->hash && !strcmp (ov1->key, ov2->key));
+}
+
+void
+sc_keyvalue_key_init (sc_keyvalue_key_t * key, const char *name)
+{
+  SC_ASSERT (key != NULL);
+  SC_ASSERT (name != NULL);
+
+  key->key = name;
+  key->hash = sc_hash_function_string (name, NULL);
+}
+
+/** Find the slot of a key in the flat table.
+ * \param [out] free_slot  If not NULL, the first deleted or empty slot
+ *                         on the probe sequence, -1 if there is none.
+ * \return                 The slot of the key, or -1 if not found.
+ */
+static long
+sc_keyvalue_flat_find (sc_keyvalue_t * kv, const sc_keyvalue_key_t * key,
+                       long *free_slot)
+{
+  const size_t        mask = kv->slots->elem_count - 1;
+  size_t              zz;
+  sc_keyvalue_slot_t *slots = (sc_keyvalue_slot_t *) kv->slots->array;
+  sc_keyvalue_entry_t *value;
+
+  if (free_slot != NULL) {
+    *free_slot = -1;
+  }
+  for (zz = key->hash & mask;; zz = (zz + 1) & mask) {
+    if (slots[zz].index == SC_KEYVALUE_SLOT_EMPTY) {
+      if (free_slot != NULL && *free_slot == -1) {
+        *free_slot = (long) zz;
+      }
+      return -1;
+    }
+    if (slots[zz].index == SC_KEYVALUE_SLOT_DELETED) {
+      if (free_slot != NULL && *free_slot == -1) {
+        *free_slot = (long) zz;
+      }
+      continue;
+    }
+    if (slots[zz].hash == key->hash) {
+      value = (sc_keyvalue_entry_t *)
+        sc_array_index_int (kv->entries, slots[zz].index);
+      if (value->key == key->key || !strcmp (value->key, key->key)) {
+        return (long) zz;
+      }
+    }
+  }
+}
+
+/** Compact the entries of the flat table and rebuild its slots.
+ * \param [in] num_slots   New number of slots, a power of 2.
+ */
+static void
+sc_keyvalue_flat_rebuild (sc_keyvalue_t * kv, size_t num_slots)
+{
+  size_t              zz, h, live, mask;
+  sc_keyvalue_slot_t *slots;
+  sc_keyvalue_entry_t *value;
+
+  /* remove deleted entries while keeping the order of the others */
+  live = 0;
+  for (zz = 0; zz < kv->entries->elem_count; ++zz) {
+    value = (sc_keyvalue_entry_t *) sc_array_index (kv->entries, zz);
+    if (value->type != SC_KEYVALUE_ENTRY_NONE) {
+      if (live < zz) {
+        *(sc_keyvalue_entry_t *) sc_array_index (kv->entries, live) = *value;
+      }
+      ++live;
+    }
+  }
+  sc_array_resize (kv->entries, live);
+  kv->num_deleted = 0;
+
+  sc_array_resize (kv->slots, num_slots);
+  slots = (sc_keyvalue_slot_t *) kv->slots->array;
+  for (zz = 0; zz < num_slots; ++zz) {
+    slots[zz].index = SC_KEYVALUE_SLOT_EMPTY;
+  }
+  mask = num_slots - 1;
+  for (zz = 0; zz < live; ++zz) {
+    value = (sc_keyvalue_entry_t *) sc_array_index (kv->entries, zz);
+    for (h = value->hash & mask; slots[h].index != SC_KEYVALUE_SLOT_EMPTY;
+         h = (h + 1) & mask);
+    slots[h].hash = value->hash;
+    slots[h].index = (int) zz;
+  }
+  kv->num_occupied = live;
+}
+
+/** Find the entry of a key.
+ * \return          The entry or NULL if the key does not exist.
+ */
+static sc_keyvalue_entry_t *
+sc_keyvalue_lookup (sc_keyvalue_t * kv, const sc_keyvalue_key_t * key)
+{
+  void              **found;
+  long                slot;
+  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
+
+  SC_ASSERT (kv != NULL);
+  SC_ASSERT (key != NULL && key->key != NULL);
+
+  if (kv->storage == SC_KEYVALUE_STORAGE_FLAT) {
+    slot = sc_keyvalue_flat_find (kv, key, NULL);
+    return slot < 0 ? NULL : (sc_keyvalue_entry_t *)
+      sc_array_index_int (kv->entries, ((sc_keyvalue_slot_t *)
+                                        kv->slots->array)[slot].index);
+  }
+
+  pvalue->key = key->key;
+  pvalue->hash = key->hash;
+  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
+  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
+    return (sc_keyvalue_entry_t *) (*found);
+  }
+  else
+    return NULL;
+}
+
+/** Find the entry of a key and create it if it does not exist.
+ * \param [in] type     The type of an existing entry must match.
+ * \return              The entry whose value is to be set.
+ */
+static sc_keyvalue_entry_t *
+sc_keyvalue_insert (sc_keyvalue_t * kv, const sc_keyvalue_key_t * key,
+                    sc_keyvalue_entry_type_t type)
+{
+  void              **found;
+  long                slot;
+  size_t              num_slots;
+  sc_keyvalue_slot_t *pslot;
+  sc_keyvalue_entry_t *value;
+
+  value = sc_keyvalue_lookup (kv, key);
+  if (value != NULL) {
+    /* Key already exists in hash table */
+    SC_ASSERT (value->type == type);
+  }
+  else if (kv->storage == SC_KEYVALUE_STORAGE_FLAT) {
+    /* keep at most half of the slots occupied */
+    if (2 * (kv->num_occupied + 1) > kv->slots->elem_count) {
+      num_slots = kv->slots->elem_count;
+      while (2 * (kv->entries->elem_count - kv->num_deleted + 1) >
+             num_slots) {
+        num_slots *= 2;
+      }
+      sc_keyvalue_flat_rebuild (kv, num_slots);
+    }
+    sc_keyvalue_flat_find (kv, key, &slot);
+    SC_ASSERT (slot >= 0);
+    pslot = (sc_keyvalue_slot_t *) sc_array_index (kv->slots, (size_t) slot);
+    if (pslot->index == SC_KEYVALUE_SLOT_EMPTY) {
+      ++kv->num_occupied;
+    }
+    pslot->hash = key->hash;
+    pslot->index = (int) kv->entries->elem_count;
+    value = (sc_keyvalue_entry_t *) sc_array_push (kv->entries);
+    value->key = key->key;
+    value->hash = key->hash;
+    value->type = type;
+  }
+  else {
+    /* Key does not exist and must be created */
+    value = (sc_keyvalue_entry_t *) sc_mempool_alloc (kv->value_allocator);
+    value->key = key->key;
+    value->hash = key->hash;
+    value->type = type;
+
+    /* Insert value into the hash table */
+    SC_EXECUTE_ASSERT_TRUE (sc_hash_insert_unique (kv->hash, value, &found));
+  }
+
+  return value;
 }
 
 sc_keyvalue_t      *
@@ -84,6 +288,7 @@ sc_keyvalue_newv (va_list ap)
     SC_ASSERT (s[0] != '\0' && s[1] == ':' && s[2] != '\0');
     value = (sc_keyvalue_entry_t *) sc_mempool_alloc (kv->value_allocator);
     value->key = &s[2];
+    value->hash = sc_hash_function_string (value->key, NULL);
     switch (s[0]) {
     case 'i':
       value->type = SC_KEYVALUE_ENTRY_INT;
@@ -131,13 +336,28 @@ sc_keyvalue_newf (int dummy, ...)
 
 sc_keyvalue_t      *
 sc_keyvalue_new ()
+{
+  return sc_keyvalue_new_storage (SC_KEYVALUE_STORAGE_HASH);
+}
+
+sc_keyvalue_t      *
+sc_keyvalue_new_storage (sc_keyvalue_storage_t storage)
 {
   sc_keyvalue_t      *kv;
 
-  kv = SC_ALLOC (sc_keyvalue_t, 1);
-  kv->hash = sc_hash_new (sc_keyvalue_entry_hash, sc_keyvalue_entry_equal,
-                          NULL, NULL);
-  kv->value_allocator = sc_mempool_new (sizeof (sc_keyvalue_entry_t));
+  kv = SC_ALLOC_ZERO (sc_keyvalue_t, 1);
+  kv->storage = storage;
+  if (storage == SC_KEYVALUE_STORAGE_FLAT) {
+    kv->entries = sc_array_new (sizeof (sc_keyvalue_entry_t));
+    kv->slots = sc_array_new (sizeof (sc_keyvalue_slot_t));
+    sc_keyvalue_flat_rebuild (kv, SC_KEYVALUE_SLOTS_MIN);
+  }
+  else {
+    SC_ASSERT (storage == SC_KEYVALUE_STORAGE_HASH);
+    kv->hash = sc_hash_new (sc_keyvalue_entry_hash, sc_keyvalue_entry_equal,
+                            NULL, NULL);
+    kv->value_allocator = sc_mempool_new (sizeof (sc_keyvalue_entry_t));
+  }
 
   return kv;
 }
@@ -145,46 +365,86 @@ sc_keyvalue_new ()
 void
 sc_keyvalue_destroy (sc_keyvalue_t * kv)
 {
-  sc_hash_destroy (kv->hash);
-  sc_mempool_destroy (kv->value_allocator);
+  if (kv->storage == SC_KEYVALUE_STORAGE_FLAT) {
+    sc_array_destroy (kv->entries);
+    sc_array_destroy (kv->slots);
+  }
+  else {
+    sc_hash_destroy (kv->hash);
+    sc_mempool_destroy (kv->value_allocator);
+  }
 
   SC_FREE (kv);
 }
 
+size_t
+sc_keyvalue_memory_used (sc_keyvalue_t * kv)
+{
+  if (kv->storage == SC_KEYVALUE_STORAGE_FLAT) {
+    return sizeof (sc_keyvalue_t) +
+      sc_array_memory_used (kv->entries, 1) +
+      sc_array_memory_used (kv->slots, 1);
+  }
+  else {
+    return sizeof (sc_keyvalue_t) +
+      sc_hash_memory_used (kv->hash) +
+      sc_mempool_memory_used (kv->value_allocator);
+  }
+}
+
 sc_keyvalue_entry_type_t
-sc_keyvalue_exists (sc_keyvalue_t * kv, const char *key)
+sc_keyvalue_exists_key (sc_keyvalue_t * kv, const sc_keyvalue_key_t * key)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
   sc_keyvalue_entry_t *value;
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
+  value = sc_keyvalue_lookup (kv, key);
+  return value != NULL ? value->type : SC_KEYVALUE_ENTRY_NONE;
+}
 
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    value = (sc_keyvalue_entry_t *) (*found);
-    return value->type;
-  }
-  else
-    return SC_KEYVALUE_ENTRY_NONE;
+sc_keyvalue_entry_type_t
+sc_keyvalue_exists (sc_keyvalue_t * kv, const char *key)
+{
+  sc_keyvalue_key_t   skey;
+
+  sc_keyvalue_key_init (&skey, key);
+  return sc_keyvalue_exists_key (kv, &skey);
 }
 
 sc_keyvalue_entry_type_t
-sc_keyvalue_unset (sc_keyvalue_t * kv, const char *key)
+sc_keyvalue_unset_key (sc_keyvalue_t * kv, const sc_keyvalue_key_t * key)
 {
   void               *found;
   sc_keyvalue_entry_t svalue, *pvalue = &svalue;
   sc_keyvalue_entry_t *value;
 
   int                 remove_test;
+  long                slot;
+  sc_keyvalue_slot_t *pslot;
   sc_keyvalue_entry_type_t type;
 
   SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
+  SC_ASSERT (key != NULL && key->key != NULL);
+
+  if (kv->storage == SC_KEYVALUE_STORAGE_FLAT) {
+    slot = sc_keyvalue_flat_find (kv, key, NULL);
+    if (slot < 0)
+      return SC_KEYVALUE_ENTRY_NONE;
+
+    /* the entry stays in place until the next rebuild */
+    pslot = (sc_keyvalue_slot_t *) sc_array_index (kv->slots, (size_t) slot);
+    value = (sc_keyvalue_entry_t *)
+      sc_array_index_int (kv->entries, pslot->index);
+    type = value->type;
+    value->type = SC_KEYVALUE_ENTRY_NONE;
+    pslot->index = SC_KEYVALUE_SLOT_DELETED;
+    if (2 * ++kv->num_deleted > kv->entries->elem_count) {
+      sc_keyvalue_flat_rebuild (kv, kv->slots->elem_count);
+    }
+    return type;
+  }
 
-  pvalue->key = key;
+  pvalue->key = key->key;
+  pvalue->hash = key->hash;
   pvalue->type = SC_KEYVALUE_ENTRY_NONE;
 
   /* Remove this entry */
@@ -207,20 +467,22 @@ sc_keyvalue_unset (sc_keyvalue_t * kv, const char *key)
   return type;
 }
 
+sc_keyvalue_entry_type_t
+sc_keyvalue_unset (sc_keyvalue_t * kv, const char *key)
+{
+  sc_keyvalue_key_t   skey;
+
+  sc_keyvalue_key_init (&skey, key);
+  return sc_keyvalue_unset_key (kv, &skey);
+}
+
 int
-sc_keyvalue_get_int (sc_keyvalue_t * kv, const char *key, int dvalue)
+sc_keyvalue_get_int_key (sc_keyvalue_t * kv,
+                         const sc_keyvalue_key_t * key, int dvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
   sc_keyvalue_entry_t *value;
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    value = (sc_keyvalue_entry_t *) (*found);
+  if ((value = sc_keyvalue_lookup (kv, key)) != NULL) {
     SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_INT);
     return value->value.i;
   }
@@ -229,19 +491,12 @@ sc_keyvalue_get_int (sc_keyvalue_t * kv, const char *key, int dvalue)
 }
 
 double
-sc_keyvalue_get_double (sc_keyvalue_t * kv, const char *key, double dvalue)
+sc_keyvalue_get_double_key (sc_keyvalue_t * kv,
+                            const sc_keyvalue_key_t * key, double dvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
   sc_keyvalue_entry_t *value;
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    value = (sc_keyvalue_entry_t *) (*found);
+  if ((value = sc_keyvalue_lookup (kv, key)) != NULL) {
     SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_DOUBLE);
     return value->value.g;
   }
@@ -250,20 +505,12 @@ sc_keyvalue_get_double (sc_keyvalue_t * kv, const char *key, double dvalue)
 }
 
 const char         *
-sc_keyvalue_get_string (sc_keyvalue_t * kv, const char *key,
-                        const char *dvalue)
+sc_keyvalue_get_string_key (sc_keyvalue_t * kv,
+                            const sc_keyvalue_key_t * key, const char *dvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
   sc_keyvalue_entry_t *value;
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    value = (sc_keyvalue_entry_t *) (*found);
+  if ((value = sc_keyvalue_lookup (kv, key)) != NULL) {
     SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_STRING);
     return value->value.s;
   }
@@ -272,19 +519,12 @@ sc_keyvalue_get_string (sc_keyvalue_t * kv, const char *key,
 }
 
 void               *
-sc_keyvalue_get_pointer (sc_keyvalue_t * kv, const char *key, void *dvalue)
+sc_keyvalue_get_pointer_key (sc_keyvalue_t * kv,
+                             const sc_keyvalue_key_t * key, void *dvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
   sc_keyvalue_entry_t *value;
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    value = (sc_keyvalue_entry_t *) (*found);
+  if ((value = sc_keyvalue_lookup (kv, key)) != NULL) {
     SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_POINTER);
     return value->value.p;
   }
@@ -292,24 +532,55 @@ sc_keyvalue_get_pointer (sc_keyvalue_t * kv, const char *key, void *dvalue)
     return dvalue;
 }
 
+int
+sc_keyvalue_get_int (sc_keyvalue_t * kv, const char *key, int dvalue)
+{
+  sc_keyvalue_key_t   skey;
+
+  sc_keyvalue_key_init (&skey, key);
+  return sc_keyvalue_get_int_key (kv, &skey, dvalue);
+}
+
+double
+sc_keyvalue_get_double (sc_keyvalue_t * kv, const char *key, double dvalue)
+{
+  sc_keyvalue_key_t   skey;
+
+  sc_keyvalue_key_init (&skey, key);
+  return sc_keyvalue_get_double_key (kv, &skey, dvalue);
+}
+
+const char         *
+sc_keyvalue_get_string (sc_keyvalue_t * kv, const char *key,
+                        const char *dvalue)
+{
+  sc_keyvalue_key_t   skey;
+
+  sc_keyvalue_key_init (&skey, key);
+  return sc_keyvalue_get_string_key (kv, &skey, dvalue);
+}
+
+void               *
+sc_keyvalue_get_pointer (sc_keyvalue_t * kv, const char *key, void *dvalue)
+{
+  sc_keyvalue_key_t   skey;
+
+  sc_keyvalue_key_init (&skey, key);
+  return sc_keyvalue_get_pointer_key (kv, &skey, dvalue);
+}
+
 int
 sc_keyvalue_get_int_check (sc_keyvalue_t * kv, const char *key, int *status)
 {
   int                 result;
   int                 etype;
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
+  sc_keyvalue_key_t   skey;
   sc_keyvalue_entry_t *value;
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
   result = (status != NULL) ? *status : INT_MIN;
   etype = 1;
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    value = (sc_keyvalue_entry_t *) (*found);
+  sc_keyvalue_key_init (&skey, key);
+  if ((value = sc_keyvalue_lookup (kv, &skey)) != NULL) {
     if (value->type == SC_KEYVALUE_ENTRY_INT) {
       etype = 0;
       result = value->value.i;
@@ -326,128 +597,70 @@ sc_keyvalue_get_int_check (sc_keyvalue_t * kv, const char *key, int *status)
 }
 
 void
-sc_keyvalue_set_int (sc_keyvalue_t * kv, const char *key, int newvalue)
+sc_keyvalue_set_int_key (sc_keyvalue_t * kv,
+                         const sc_keyvalue_key_t * key, int newvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
-  sc_keyvalue_entry_t *value;
-
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    /* Key already exists in hash table */
-    value = (sc_keyvalue_entry_t *) (*found);
-    SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_INT);
+  sc_keyvalue_insert (kv, key, SC_KEYVALUE_ENTRY_INT)->value.i = newvalue;
+}
 
-    value->value.i = newvalue;
-  }
-  else {
-    /* Key does not exist and must be created */
-    value = (sc_keyvalue_entry_t *) sc_mempool_alloc (kv->value_allocator);
-    value->key = key;
-    value->type = SC_KEYVALUE_ENTRY_INT;
-    value->value.i = newvalue;
+void
+sc_keyvalue_set_double_key (sc_keyvalue_t * kv,
+                            const sc_keyvalue_key_t * key, double newvalue)
+{
+  sc_keyvalue_insert (kv, key, SC_KEYVALUE_ENTRY_DOUBLE)->value.g = newvalue;
+}
 
-    /* Insert value into the hash table */
-    SC_EXECUTE_ASSERT_TRUE (sc_hash_insert_unique (kv->hash, value, &found));
-  }
+void
+sc_keyvalue_set_string_key (sc_keyvalue_t * kv,
+                            const sc_keyvalue_key_t * key,
+                            const char *newvalue)
+{
+  sc_keyvalue_insert (kv, key, SC_KEYVALUE_ENTRY_STRING)->value.s = newvalue;
 }
 
 void
-sc_keyvalue_set_double (sc_keyvalue_t * kv, const char *key, double newvalue)
+sc_keyvalue_set_pointer_key (sc_keyvalue_t * kv,
+                             const sc_keyvalue_key_t * key, void *newvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
-  sc_keyvalue_entry_t *value;
+  sc_keyvalue_insert (kv, key, SC_KEYVALUE_ENTRY_POINTER)->value.p =
+    newvalue;
+}
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
+void
+sc_keyvalue_set_int (sc_keyvalue_t * kv, const char *key, int newvalue)
+{
+  sc_keyvalue_key_t   skey;
 
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    /* Key already exists in hash table */
-    value = (sc_keyvalue_entry_t *) (*found);
-    SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_DOUBLE);
+  sc_keyvalue_key_init (&skey, key);
+  sc_keyvalue_set_int_key (kv, &skey, newvalue);
+}
 
-    value->value.g = newvalue;
-  }
-  else {
-    /* Key does not exist and must be created */
-    value = (sc_keyvalue_entry_t *) sc_mempool_alloc (kv->value_allocator);
-    value->key = key;
-    value->type = SC_KEYVALUE_ENTRY_DOUBLE;
-    value->value.g = newvalue;
+void
+sc_keyvalue_set_double (sc_keyvalue_t * kv, const char *key, double newvalue)
+{
+  sc_keyvalue_key_t   skey;
 
-    /* Insert value into the hash table */
-    SC_EXECUTE_ASSERT_TRUE (sc_hash_insert_unique (kv->hash, value, &found));
-  }
+  sc_keyvalue_key_init (&skey, key);
+  sc_keyvalue_set_double_key (kv, &skey, newvalue);
 }
 
 void
 sc_keyvalue_set_string (sc_keyvalue_t * kv, const char *key,
                         const char *newvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
-  sc_keyvalue_entry_t *value;
-
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    /* Key already exists in hash table */
-    value = (sc_keyvalue_entry_t *) (*found);
-    SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_STRING);
+  sc_keyvalue_key_t   skey;
 
-    value->value.s = newvalue;
-  }
-  else {
-    /* Key does not exist and must be created */
-    value = (sc_keyvalue_entry_t *) sc_mempool_alloc (kv->value_allocator);
-    value->key = key;
-    value->type = SC_KEYVALUE_ENTRY_STRING;
-    value->value.s = newvalue;
-
-    /* Insert value into the hash table */
-    SC_EXECUTE_ASSERT_TRUE (sc_hash_insert_unique (kv->hash, value, &found));
-  }
+  sc_keyvalue_key_init (&skey, key);
+  sc_keyvalue_set_string_key (kv, &skey, newvalue);
 }
 
 void
 sc_keyvalue_set_pointer (sc_keyvalue_t * kv, const char *key, void *newvalue)
 {
-  void              **found;
-  sc_keyvalue_entry_t svalue, *pvalue = &svalue;
-  sc_keyvalue_entry_t *value;
+  sc_keyvalue_key_t   skey;
 
-  SC_ASSERT (kv != NULL);
-  SC_ASSERT (key != NULL);
-
-  pvalue->key = key;
-  pvalue->type = SC_KEYVALUE_ENTRY_NONE;
-  if (sc_hash_lookup (kv->hash, pvalue, &found)) {
-    /* Key already exists in hash table */
-    value = (sc_keyvalue_entry_t *) (*found);
-    SC_ASSERT (value->type == SC_KEYVALUE_ENTRY_POINTER);
-
-    value->value.p = (void *) newvalue;
-  }
-  else {
-    /* Key does not exist and must be created */
-    value = (sc_keyvalue_entry_t *) sc_mempool_alloc (kv->value_allocator);
-    value->key = key;
-    value->type = SC_KEYVALUE_ENTRY_POINTER;
-    value->value.p = (void *) newvalue;
-
-    /* Insert value into the hash table */
-    SC_EXECUTE_ASSERT_TRUE (sc_hash_insert_unique (kv->hash, value, &found));
-  }
+  sc_keyvalue_key_init (&skey, key);
+  sc_keyvalue_set_pointer_key (kv, &skey, newvalue);
 }
 
 typedef struct sc_kv_hash_data
@@ -473,7 +686,20 @@ void
 sc_keyvalue_foreach (sc_keyvalue_t * kv, sc_keyvalue_foreach_t fn,
                      void *user_data)
 {
+  size_t              zz;
   sc_kv_hash_data_t   hdata;
+  sc_keyvalue_entry_t *value;
+
+  if (kv->storage == SC_KEYVALUE_STORAGE_FLAT) {
+    for (zz = 0; zz < kv->entries->elem_count; ++zz) {
+      value = (sc_keyvalue_entry_t *) sc_array_index (kv->entries, zz);
+      if (value->type != SC_KEYVALUE_ENTRY_NONE &&
+          !fn (value->key, value->type, &value->value.p, user_data)) {
+        break;
+      }
+    }
+    return;
+  }
 
   hdata.fn = fn;
   hdata.data = user_data;
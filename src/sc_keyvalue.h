@@ -44,14 +44,48 @@ typedef enum
 }
 sc_keyvalue_entry_type_t;
 
+/** The storage of the entries is selected when creating a container. */
+typedef enum
+{
+  SC_KEYVALUE_STORAGE_HASH = 0, /**< Linked entries in a hash table.
+                                     Iteration follows the hash slots. */
+  SC_KEYVALUE_STORAGE_FLAT      /**< Entries inline in an array indexed
+                                     by an open addressing table.
+                                     Iteration is in insertion order. */
+}
+sc_keyvalue_storage_t;
+
 /** The key-value container is an opaque structure. */
 typedef struct sc_keyvalue sc_keyvalue_t;
 
+/** A key whose hash value is computed once.
+ * Initialize it by \ref sc_keyvalue_key_init and use it with the
+ * functions whose names end in _key.  These skip hashing the string,
+ * and the string comparison if the entry has been created from the same
+ * string pointer, which makes them suitable for frequent lookups.
+ * The same key may be used with any number of containers.
+ */
+typedef struct sc_keyvalue_key
+{
+  const char         *key;      /**< The string is not copied. */
+  unsigned            hash;     /**< Hash value of the string. */
+}
+sc_keyvalue_key_t;
+
 /** Create a new key-value container.
  * \return          The container is ready to use.
  */
 sc_keyvalue_t      *sc_keyvalue_new ();
 
+/** Create a new key-value container with a given storage.
+ * Both storages support the same functions.  The flat storage needs less
+ * memory per entry, avoids a pointer chase per lookup, and iterates
+ * through the entries in the order of their insertion.
+ * \param [in] storage  The storage of the entries.
+ * \return              The container is ready to use.
+ */
+sc_keyvalue_t      *sc_keyvalue_new_storage (sc_keyvalue_storage_t storage);
+
 /** Create a container and set one or more key-value pairs.
  * Arguments come in pairs of 2: a static string "type:key" and a value.
  * The type is the letter i, g, s, p for int, double, const char *, and void *,
@@ -76,6 +110,13 @@ sc_keyvalue_t      *sc_keyvalue_newv (va_list ap);
  */
 void                sc_keyvalue_destroy (sc_keyvalue_t * kv);
 
+/** Calculate the memory used by a key-value container.
+ * The key strings are not included since they are not copied.
+ * \param [in] kv               Valid key-value container.
+ * \return                      Memory used in bytes.
+ */
+size_t              sc_keyvalue_memory_used (sc_keyvalue_t * kv);
+
 /** Routine to check existence of an entry.
  * \param [in] kv               Valid key-value container.
  * \param [in] key              Lookup key to query.
@@ -194,6 +235,85 @@ void                sc_keyvalue_set_string (sc_keyvalue_t * kv,
 void                sc_keyvalue_set_pointer (sc_keyvalue_t * kv,
                                              const char *key, void *newvalue);
 
+/** Initialize a prehashed key.
+ * \param [out] key             The key to initialize.
+ * \param [in] name             Non-NULL key string.  It is not copied
+ *                              and must stay valid as long as the key
+ *                              or any entry created with it is in use.
+ */
+void                sc_keyvalue_key_init (sc_keyvalue_key_t * key,
+                                          const char *name);
+
+/** Check existence of an entry by a prehashed key.
+ * \see sc_keyvalue_exists.
+ */
+sc_keyvalue_entry_type_t sc_keyvalue_exists_key (sc_keyvalue_t * kv,
+                                                 const sc_keyvalue_key_t *
+                                                 key);
+
+/** Remove an entry by a prehashed key.
+ * \see sc_keyvalue_unset.
+ */
+sc_keyvalue_entry_type_t sc_keyvalue_unset_key (sc_keyvalue_t * kv,
+                                                const sc_keyvalue_key_t *
+                                                key);
+
+/** Retrieve an integer value by a prehashed key.
+ * \see sc_keyvalue_get_int.
+ */
+int                 sc_keyvalue_get_int_key (sc_keyvalue_t * kv,
+                                             const sc_keyvalue_key_t * key,
+                                             int dvalue);
+
+/** Retrieve a double value by a prehashed key.
+ * \see sc_keyvalue_get_double.
+ */
+double              sc_keyvalue_get_double_key (sc_keyvalue_t * kv,
+                                                const sc_keyvalue_key_t *
+                                                key, double dvalue);
+
+/** Retrieve a string value by a prehashed key.
+ * \see sc_keyvalue_get_string.
+ */
+const char         *sc_keyvalue_get_string_key (sc_keyvalue_t * kv,
+                                                const sc_keyvalue_key_t *
+                                                key, const char *dvalue);
+
+/** Retrieve a pointer value by a prehashed key.
+ * \see sc_keyvalue_get_pointer.
+ */
+void               *sc_keyvalue_get_pointer_key (sc_keyvalue_t * kv,
+                                                 const sc_keyvalue_key_t *
+                                                 key, void *dvalue);
+
+/** Set an integer value by a prehashed key.
+ * \see sc_keyvalue_set_int.  A new entry stores the key's string pointer.
+ */
+void                sc_keyvalue_set_int_key (sc_keyvalue_t * kv,
+                                             const sc_keyvalue_key_t * key,
+                                             int newvalue);
+
+/** Set a double value by a prehashed key.
+ * \see sc_keyvalue_set_double.  A new entry stores the key's string pointer.
+ */
+void                sc_keyvalue_set_double_key (sc_keyvalue_t * kv,
+                                                const sc_keyvalue_key_t *
+                                                key, double newvalue);
+
+/** Set a string value by a prehashed key.
+ * \see sc_keyvalue_set_string.  A new entry stores the key's string pointer.
+ */
+void                sc_keyvalue_set_string_key (sc_keyvalue_t * kv,
+                                                const sc_keyvalue_key_t *
+                                                key, const char *newvalue);
+
+/** Set a pointer value by a prehashed key.
+ * \see sc_keyvalue_set_pointer.  A new entry stores the key's string pointer.
+ */
+void                sc_keyvalue_set_pointer_key (sc_keyvalue_t * kv,
+                                                 const sc_keyvalue_key_t *
+                                                 key, void *newvalue);
+
 /** Function to call on every key value pair
  * \param [in] key   The key for this pair
  * \param [in] type  The type of entry
@@ -23,6 +23,12 @@
 
 /* including sc_mpi.h does not work here since sc_mpi.h is included by sc.h */
 #include <sc.h>
+#include <sc_containers.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
 
 #ifndef SC_ENABLE_MPI
 
@@ -72,6 +78,13 @@ sc_MPI_Init_thread (int *argc, char ***argv, int required, int *provided)
   return sc_MPI_SUCCESS;
 }
 
+int
+sc_MPI_Query_thread (int *provided)
+{
+  *provided = sc_MPI_THREAD_SINGLE;
+  return sc_MPI_SUCCESS;
+}
+
 int
 sc_MPI_Finalize (void)
 {
@@ -432,6 +445,24 @@ sc_MPI_Isend (void *buf, int count, sc_MPI_Datatype datatype, int dest,
   return sc_MPI_SUCCESS;
 }
 
+int
+sc_MPI_Recv_init (void *buf, int count, sc_MPI_Datatype datatype,
+                  int source, int tag, sc_MPI_Comm comm,
+                  sc_MPI_Request * request)
+{
+  SC_ABORT ("non-MPI MPI_Recv_init is not implemented");
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Send_init (void *buf, int count, sc_MPI_Datatype datatype,
+                  int dest, int tag, sc_MPI_Comm comm,
+                  sc_MPI_Request * request)
+{
+  SC_ABORT ("non-MPI MPI_Send_init is not implemented");
+  return sc_MPI_SUCCESS;
+}
+
 int
 sc_MPI_Probe (int source, int tag, sc_MPI_Comm comm, sc_MPI_Status * status)
 {
@@ -492,6 +523,49 @@ sc_MPI_Waitall (int count, sc_MPI_Request * array_of_requests,
   return sc_MPI_SUCCESS;
 }
 
+int
+sc_MPI_Test (sc_MPI_Request * request, int *flag, sc_MPI_Status * status)
+{
+  SC_CHECK_ABORT (*request == sc_MPI_REQUEST_NULL,
+                  "non-MPI MPI_Test handles NULL request only");
+  *flag = 1;
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Testall (int count, sc_MPI_Request * array_of_requests, int *flag,
+                sc_MPI_Status * array_of_statuses)
+{
+  int                 i;
+
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (array_of_requests[i] == sc_MPI_REQUEST_NULL,
+                    "non-MPI MPI_Testall handles NULL requests only");
+  }
+  *flag = 1;
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Startall (int count, sc_MPI_Request * array_of_requests)
+{
+  int                 i;
+
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (array_of_requests[i] == sc_MPI_REQUEST_NULL,
+                    "non-MPI MPI_Startall handles NULL requests only");
+  }
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Request_free (sc_MPI_Request * request)
+{
+  SC_CHECK_ABORT (*request == sc_MPI_REQUEST_NULL,
+                  "non-MPI MPI_Request_free handles NULL request only");
+  return sc_MPI_SUCCESS;
+}
+
 double
 sc_MPI_Wtime (void)
 {
@@ -518,6 +592,13 @@ sc_MPI_Init_thread (int *argc, char ***argv, int required, int *provided)
   return sc_MPI_Init (argc, argv);
 }
 
+int
+sc_MPI_Query_thread (int *provided)
+{
+  *provided = sc_MPI_THREAD_SINGLE;
+  return sc_MPI_SUCCESS;
+}
+
 #endif /* !SC_ENABLE_MPITHREAD */
 #endif /* SC_ENABLE_MPI */
 
@@ -735,3 +816,247 @@ sc_mpi_comm_get_node_comms (sc_MPI_Comm comm,
   }
 #endif
 }
+
+int
+sc_mpi_thread_level (void)
+{
+  int                 provided = sc_MPI_THREAD_SINGLE;
+#if defined SC_ENABLE_MPI && defined SC_ENABLE_MPITHREAD
+  int                 mpiret, initialized, finalized;
+
+  mpiret = MPI_Initialized (&initialized);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Finalized (&finalized);
+  SC_CHECK_MPI (mpiret);
+  if (initialized && !finalized) {
+    mpiret = sc_MPI_Query_thread (&provided);
+    SC_CHECK_MPI (mpiret);
+  }
+#endif
+
+  return provided;
+}
+
+/** A registered progress hook. */
+typedef struct sc_mpi_progress_hook
+{
+  sc_mpi_progress_t   progress;
+  void               *user;
+  int                 id;
+}
+sc_mpi_progress_hook_t;
+
+static sc_array_t   sc_mpi_progress_hooks;
+static int          sc_mpi_progress_hooks_init = 0;
+static int          sc_mpi_progress_next_id = 0;
+
+#ifdef SC_ENABLE_PTHREAD
+static pthread_mutex_t sc_mpi_progress_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sc_mpi_progress_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t    sc_mpi_progress_thread;
+static int          sc_mpi_progress_threaded = 0;
+static int          sc_mpi_progress_stop = 0;
+static double       sc_mpi_progress_interval = 0.;
+#endif
+
+static void
+sc_mpi_progress_lock (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_mpi_progress_mutex);
+#endif
+}
+
+static void
+sc_mpi_progress_unlock (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_mpi_progress_mutex);
+#endif
+}
+
+/** Remove the hook at a given position, the lock must be held. */
+static void
+sc_mpi_progress_remove (size_t iz)
+{
+  sc_array_t         *hooks = &sc_mpi_progress_hooks;
+  size_t              nz = hooks->elem_count;
+
+  if (iz + 1 < nz) {
+    memmove (sc_array_index (hooks, iz), sc_array_index (hooks, iz + 1),
+             (nz - iz - 1) * sizeof (sc_mpi_progress_hook_t));
+  }
+  if (nz == 1) {
+    /* release the memory so that sc_finalize sees no leak */
+    sc_array_reset (hooks);
+  }
+  else {
+    sc_array_resize (hooks, nz - 1);
+  }
+}
+
+/** Run all hooks once and return how many remain, the lock must be held. */
+static int
+sc_mpi_progress_run_hooks (void)
+{
+  size_t              iz;
+  sc_mpi_progress_hook_t *hook;
+
+  if (!sc_mpi_progress_hooks_init) {
+    return 0;
+  }
+  for (iz = 0; iz < sc_mpi_progress_hooks.elem_count;) {
+    hook = (sc_mpi_progress_hook_t *)
+      sc_array_index (&sc_mpi_progress_hooks, iz);
+    if (hook->progress (hook->user)) {
+      sc_mpi_progress_remove (iz);
+    }
+    else {
+      ++iz;
+    }
+  }
+
+  return (int) sc_mpi_progress_hooks.elem_count;
+}
+
+int
+sc_mpi_progress_register (sc_mpi_progress_t progress, void *user)
+{
+  int                 id;
+  sc_mpi_progress_hook_t *hook;
+
+  SC_ASSERT (progress != NULL);
+
+  sc_mpi_progress_lock ();
+  if (!sc_mpi_progress_hooks_init) {
+    sc_array_init (&sc_mpi_progress_hooks, sizeof (sc_mpi_progress_hook_t));
+    sc_mpi_progress_hooks_init = 1;
+  }
+  id = sc_mpi_progress_next_id;
+  sc_mpi_progress_next_id = id < INT_MAX ? id + 1 : 0;
+  hook = (sc_mpi_progress_hook_t *) sc_array_push (&sc_mpi_progress_hooks);
+  hook->progress = progress;
+  hook->user = user;
+  hook->id = id;
+  sc_mpi_progress_unlock ();
+
+  return id;
+}
+
+void
+sc_mpi_progress_unregister (int id)
+{
+  size_t              iz;
+  sc_mpi_progress_hook_t *hook;
+
+  /* holding the lock guarantees that the hook is not running */
+  sc_mpi_progress_lock ();
+  if (sc_mpi_progress_hooks_init) {
+    for (iz = 0; iz < sc_mpi_progress_hooks.elem_count; ++iz) {
+      hook = (sc_mpi_progress_hook_t *)
+        sc_array_index (&sc_mpi_progress_hooks, iz);
+      if (hook->id == id) {
+        sc_mpi_progress_remove (iz);
+        break;
+      }
+    }
+  }
+  sc_mpi_progress_unlock ();
+}
+
+int
+sc_mpi_progress (void)
+{
+  int                 remaining;
+
+  sc_mpi_progress_lock ();
+  remaining = sc_mpi_progress_run_hooks ();
+  sc_mpi_progress_unlock ();
+
+  return remaining;
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+/** The background thread runs the hooks at regular intervals. */
+static void        *
+sc_mpi_progress_run (void *v)
+{
+  struct timespec     ts;
+  double              wakeup;
+
+  pthread_mutex_lock (&sc_mpi_progress_mutex);
+  while (!sc_mpi_progress_stop) {
+    sc_mpi_progress_run_hooks ();
+    if (sc_mpi_progress_interval > 0.) {
+#ifdef SC_HAVE_CLOCK_GETTIME
+      clock_gettime (CLOCK_REALTIME, &ts);
+      wakeup = ts.tv_sec + 1.e-9 * ts.tv_nsec + sc_mpi_progress_interval;
+#else
+      wakeup = (double) time (NULL) + SC_MAX (sc_mpi_progress_interval, 1.);
+#endif
+      ts.tv_sec = (time_t) wakeup;
+      ts.tv_nsec = (long) ((wakeup - (double) ts.tv_sec) * 1.e9);
+      pthread_cond_timedwait (&sc_mpi_progress_cond,
+                              &sc_mpi_progress_mutex, &ts);
+    }
+    else {
+      /* give waiting registrations a chance to take the lock */
+      pthread_mutex_unlock (&sc_mpi_progress_mutex);
+      sched_yield ();
+      pthread_mutex_lock (&sc_mpi_progress_mutex);
+    }
+  }
+  pthread_mutex_unlock (&sc_mpi_progress_mutex);
+
+  return v;
+}
+
+#endif /* SC_ENABLE_PTHREAD */
+
+int
+sc_mpi_progress_thread_start (double interval)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  if (sc_mpi_progress_threaded) {
+    return 1;
+  }
+#ifdef SC_ENABLE_MPI
+  if (sc_mpi_thread_level () < sc_MPI_THREAD_MULTIPLE) {
+    SC_GLOBAL_LDEBUG ("No progress thread without MPI_THREAD_MULTIPLE\n");
+    return 0;
+  }
+#endif
+  sc_mpi_progress_stop = 0;
+  sc_mpi_progress_interval = interval;
+  pth = pthread_create (&sc_mpi_progress_thread, NULL,
+                        sc_mpi_progress_run, NULL);
+  SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+  sc_mpi_progress_threaded = 1;
+
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+void
+sc_mpi_progress_thread_stop (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 retval;
+
+  if (!sc_mpi_progress_threaded) {
+    return;
+  }
+  pthread_mutex_lock (&sc_mpi_progress_mutex);
+  sc_mpi_progress_stop = 1;
+  pthread_cond_signal (&sc_mpi_progress_cond);
+  pthread_mutex_unlock (&sc_mpi_progress_mutex);
+  retval = pthread_join (sc_mpi_progress_thread, NULL);
+  SC_CHECK_ABORT (retval == 0, "Fail in pthread_join");
+  sc_mpi_progress_threaded = 0;
+#endif
+}
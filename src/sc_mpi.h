@@ -61,6 +61,12 @@ typedef enum
   SC_TAG_REDUCE = SC_TAG_NOTIFY_RECURSIVE + 32,
   SC_TAG_PSORT_LO,
   SC_TAG_PSORT_HI,
+  SC_TAG_EXCHANGE,
+  SC_TAG_EXCHANGE_SIZES,
+  SC_TAG_NOTIFY_NBX,
+  SC_TAG_NOTIFY_SIZES = SC_TAG_NOTIFY_NBX + 2,
+  SC_TAG_NOTIFY_PAYLOAD,
+  SC_TAG_AGGREGATE,
   SC_TAG_LAST
 }
 sc_tag_t;
@@ -175,6 +181,10 @@ sc_tag_t;
 #define sc_MPI_Irecv               MPI_Irecv
 #define sc_MPI_Send                MPI_Send
 #define sc_MPI_Isend               MPI_Isend
+#define sc_MPI_Recv_init           MPI_Recv_init
+#define sc_MPI_Send_init           MPI_Send_init
+#define sc_MPI_Startall            MPI_Startall
+#define sc_MPI_Request_free        MPI_Request_free
 #define sc_MPI_Probe               MPI_Probe
 #define sc_MPI_Iprobe              MPI_Iprobe
 #define sc_MPI_Get_count           MPI_Get_count
@@ -182,6 +192,8 @@ sc_tag_t;
 #define sc_MPI_Wait                MPI_Wait
 #define sc_MPI_Waitsome            MPI_Waitsome
 #define sc_MPI_Waitall             MPI_Waitall
+#define sc_MPI_Test                MPI_Test
+#define sc_MPI_Testall             MPI_Testall
 
 #else /* !SC_ENABLE_MPI */
 
@@ -336,6 +348,10 @@ int                 sc_MPI_Send (void *, int, sc_MPI_Datatype, int, int,
                                  sc_MPI_Comm);
 int                 sc_MPI_Isend (void *, int, sc_MPI_Datatype, int, int,
                                   sc_MPI_Comm, sc_MPI_Request *);
+int                 sc_MPI_Recv_init (void *, int, sc_MPI_Datatype, int,
+                                      int, sc_MPI_Comm, sc_MPI_Request *);
+int                 sc_MPI_Send_init (void *, int, sc_MPI_Datatype, int,
+                                      int, sc_MPI_Comm, sc_MPI_Request *);
 int                 sc_MPI_Probe (int, int, sc_MPI_Comm, sc_MPI_Status *);
 int                 sc_MPI_Iprobe (int, int, sc_MPI_Comm, int *,
                                    sc_MPI_Status *);
@@ -348,6 +364,11 @@ int                 sc_MPI_Wait (sc_MPI_Request *, sc_MPI_Status *);
 int                 sc_MPI_Waitsome (int, sc_MPI_Request *,
                                      int *, int *, sc_MPI_Status *);
 int                 sc_MPI_Waitall (int, sc_MPI_Request *, sc_MPI_Status *);
+int                 sc_MPI_Test (sc_MPI_Request *, int *, sc_MPI_Status *);
+int                 sc_MPI_Testall (int, sc_MPI_Request *, int *,
+                                    sc_MPI_Status *);
+int                 sc_MPI_Startall (int, sc_MPI_Request *);
+int                 sc_MPI_Request_free (sc_MPI_Request *);
 
 #endif /* !SC_ENABLE_MPI */
 
@@ -359,6 +380,7 @@ int                 sc_MPI_Waitall (int, sc_MPI_Request *, sc_MPI_Status *);
 #define sc_MPI_THREAD_MULTIPLE     MPI_THREAD_MULTIPLE
 
 #define sc_MPI_Init_thread         MPI_Init_thread
+#define sc_MPI_Query_thread        MPI_Query_thread
 
 #else
 
@@ -369,6 +391,7 @@ int                 sc_MPI_Waitall (int, sc_MPI_Request *, sc_MPI_Status *);
 
 int                 sc_MPI_Init_thread (int *argc, char ***argv,
                                         int required, int *provided);
+int                 sc_MPI_Query_thread (int *provided);
 
 #endif /* !(SC_ENABLE_MPI && SC_ENABLE_MPITHREAD) */
 
@@ -411,6 +434,63 @@ void                sc_mpi_comm_get_node_comms (sc_MPI_Comm comm,
                                                 sc_MPI_Comm * intranode,
                                                 sc_MPI_Comm * internode);
 
+/** Return the thread support level of the running MPI library.
+ * \return         One of the sc_MPI_THREAD_* constants.  If MPI is not
+ *                  initialized yet or not thread-enabled in this build,
+ *                  returns sc_MPI_THREAD_SINGLE.
+ */
+int                 sc_mpi_thread_level (void);
+
+/** Callback to drive outstanding nonblocking communication.
+ * A progress hook is typically a wrapper around sc_MPI_Testall.
+ * It is called with an internal lock held and must not register or
+ * unregister progress hooks itself.
+ * \param [in] user    The pointer passed to \ref sc_mpi_progress_register.
+ * \return             True if the operation is complete; the hook is then
+ *                      removed automatically.
+ */
+typedef int         (*sc_mpi_progress_t) (void *user);
+
+/** Register a hook to be called by \ref sc_mpi_progress and the progress
+ * thread until it reports completion or is unregistered.
+ * \param [in] progress    Callback, see \ref sc_mpi_progress_t.
+ * \param [in] user        Passed to the callback.
+ * \return                 Nonnegative identifier for unregistering.
+ */
+int                 sc_mpi_progress_register (sc_mpi_progress_t progress,
+                                              void *user);
+
+/** Remove a progress hook if it is still registered.
+ * On return the hook is not running and will not be called again, so the
+ * caller may proceed to complete or free the requests it tests.
+ * \param [in] id          Value returned by \ref sc_mpi_progress_register.
+ */
+void                sc_mpi_progress_unregister (int id);
+
+/** Call every registered progress hook once.
+ * Applications without a progress thread may call this function from
+ * inside long computations to overlap them with communication.
+ * \return                 The number of hooks that remain registered.
+ */
+int                 sc_mpi_progress (void);
+
+/** Start a background thread that calls \ref sc_mpi_progress regularly.
+ * The thread requires pthread support and, if MPI is enabled, the thread
+ * level sc_MPI_THREAD_MULTIPLE, for example by sc_MPI_Init_thread.
+ * Otherwise no thread is started and the application may call
+ * \ref sc_mpi_progress by itself.  \ref sc_finalize stops the thread.
+ * \param [in] interval    Seconds to sleep between calls.  If not positive,
+ *                          the thread polls continuously, which is only
+ *                          recommended when spare cores are available.
+ * \return                 True if the thread is running.
+ */
+int                 sc_mpi_progress_thread_start (double interval);
+
+/** Stop the progress thread if it is running.
+ * Hooks that are still registered remain so.
+ */
+void                sc_mpi_progress_thread_stop (void);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_MPI_H */
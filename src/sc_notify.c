@@ -432,3 +432,277 @@ sc_notify (int *receivers, int num_receivers,
 
   return sc_MPI_SUCCESS;
 }
+
+#if defined SC_ENABLE_MPI && defined MPI_VERSION && MPI_VERSION >= 3
+#define SC_NOTIFY_HAVE_NBX
+#endif
+
+/** Initialize dest as a copy of the payload src. */
+static void
+sc_notify_payload_copy (sc_array_t * dest, sc_array_t * src,
+                        size_t elem_size)
+{
+  sc_array_init_size (dest, elem_size, src->elem_count);
+  if (src->elem_count > 0) {
+    memcpy (dest->array, src->array, src->elem_count * elem_size);
+  }
+}
+
+int
+sc_notify_payloadv_rounds (sc_array_t * receivers, sc_array_t * payloads,
+                           sc_array_t * senders, sc_array_t * recv_payloads,
+                           size_t elem_size, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 i, rank, self;
+  int                 num_receivers, num_senders, num_requests;
+  int                *sizes;
+  sc_array_t         *payload, *recv;
+  sc_MPI_Request     *requests;
+
+  SC_ASSERT (receivers->elem_size == sizeof (int));
+  SC_ASSERT (payloads->elem_size == sizeof (sc_array_t));
+  SC_ASSERT (payloads->elem_count == receivers->elem_count);
+  SC_ASSERT (senders->elem_size == sizeof (int));
+  SC_ASSERT (recv_payloads->elem_size == sizeof (sc_array_t));
+  SC_ASSERT (elem_size > 0);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* the first round finds the senders */
+  num_receivers = (int) receivers->elem_count;
+  sc_array_resize (senders, (size_t) mpisize);
+  mpiret = sc_notify ((int *) receivers->array, num_receivers,
+                      (int *) senders->array, &num_senders, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_array_resize (senders, (size_t) num_senders);
+  sc_array_sort (senders, sc_int_compare);
+  sc_array_resize (recv_payloads, (size_t) num_senders);
+
+  /* the second round sends the sizes */
+  sizes = SC_ALLOC (int, num_senders + num_receivers);
+  requests = SC_ALLOC (sc_MPI_Request, num_senders + num_receivers);
+  num_requests = 0;
+  for (i = 0; i < num_senders; ++i) {
+    rank = *(int *) sc_array_index_int (senders, i);
+    if (rank != mpirank) {
+      mpiret = sc_MPI_Irecv (sizes + i, 1, sc_MPI_INT, rank,
+                             SC_TAG_NOTIFY_SIZES, mpicomm,
+                             requests + num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  self = -1;
+  for (i = 0; i < num_receivers; ++i) {
+    rank = *(int *) sc_array_index_int (receivers, i);
+    payload = (sc_array_t *) sc_array_index_int (payloads, i);
+    SC_ASSERT (payload->elem_size == elem_size);
+    SC_ASSERT (payload->elem_count * elem_size <= (size_t) INT_MAX);
+    sizes[num_senders + i] = (int) (payload->elem_count * elem_size);
+    if (rank == mpirank) {
+      self = i;
+      continue;
+    }
+    mpiret = sc_MPI_Isend (sizes + num_senders + i, 1, sc_MPI_INT, rank,
+                           SC_TAG_NOTIFY_SIZES, mpicomm,
+                           requests + num_requests++);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = sc_MPI_Waitall (num_requests, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* the third round sends the payloads */
+  num_requests = 0;
+  for (i = 0; i < num_senders; ++i) {
+    rank = *(int *) sc_array_index_int (senders, i);
+    recv = (sc_array_t *) sc_array_index_int (recv_payloads, i);
+    if (rank == mpirank) {
+      SC_ASSERT (self >= 0);
+      sc_notify_payload_copy
+        (recv, (sc_array_t *) sc_array_index_int (payloads, self),
+         elem_size);
+      continue;
+    }
+    SC_ASSERT (sizes[i] % elem_size == 0);
+    sc_array_init_size (recv, elem_size, sizes[i] / elem_size);
+    mpiret = sc_MPI_Irecv (recv->array, sizes[i], sc_MPI_BYTE, rank,
+                           SC_TAG_NOTIFY_PAYLOAD, mpicomm,
+                           requests + num_requests++);
+    SC_CHECK_MPI (mpiret);
+  }
+  for (i = 0; i < num_receivers; ++i) {
+    if (i != self) {
+      payload = (sc_array_t *) sc_array_index_int (payloads, i);
+      mpiret = sc_MPI_Isend (payload->array, sizes[num_senders + i],
+                             sc_MPI_BYTE,
+                             *(int *) sc_array_index_int (receivers, i),
+                             SC_TAG_NOTIFY_PAYLOAD, mpicomm,
+                             requests + num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  mpiret = sc_MPI_Waitall (num_requests, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  SC_FREE (requests);
+  SC_FREE (sizes);
+
+  return sc_MPI_SUCCESS;
+}
+
+#ifdef SC_NOTIFY_HAVE_NBX
+
+/** A received payload and its source. */
+typedef struct sc_notify_message
+{
+  int                 source;
+  sc_array_t          payload;
+}
+sc_notify_message_t;
+
+static int
+sc_notify_message_compare (const void *v1, const void *v2)
+{
+  return sc_int_compare (&((const sc_notify_message_t *) v1)->source,
+                         &((const sc_notify_message_t *) v2)->source);
+}
+
+static int          sc_notify_nbx_keyval = MPI_KEYVAL_INVALID;
+
+/** Alternate the tag between consecutive calls on a communicator.
+ * A process may leave the barrier and send the messages of the next call
+ * while another is still probing for those of the current call.  It
+ * cannot get two calls ahead, since it would need the other process to
+ * enter the barrier of the next call first.
+ * \return              The parity of the number of previous calls.
+ */
+static int
+sc_notify_nbx_epoch (sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 flag, epoch;
+  void               *value;
+
+  if (sc_notify_nbx_keyval == MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_create_keyval (MPI_COMM_NULL_COPY_FN,
+                                     MPI_COMM_NULL_DELETE_FN,
+                                     &sc_notify_nbx_keyval, NULL);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = MPI_Comm_get_attr (mpicomm, sc_notify_nbx_keyval, &value, &flag);
+  SC_CHECK_MPI (mpiret);
+  epoch = flag ? (int) (size_t) value : 0;
+  mpiret = MPI_Comm_set_attr (mpicomm, sc_notify_nbx_keyval,
+                             (void *) (size_t) (epoch ^ 1));
+  SC_CHECK_MPI (mpiret);
+
+  return epoch;
+}
+
+#endif /* SC_NOTIFY_HAVE_NBX */
+
+int
+sc_notify_payloadv (sc_array_t * receivers, sc_array_t * payloads,
+                    sc_array_t * senders, sc_array_t * recv_payloads,
+                    size_t elem_size, sc_MPI_Comm mpicomm)
+{
+#ifndef SC_NOTIFY_HAVE_NBX
+  return sc_notify_payloadv_rounds (receivers, payloads, senders,
+                                    recv_payloads, elem_size, mpicomm);
+#else
+  int                 mpiret;
+  int                 mpirank, tag;
+  int                 i, rank, count, flag;
+  int                 num_receivers, num_sends;
+  int                 barrier_active, done;
+  sc_array_t         *payload, messages;
+  sc_notify_message_t *msg;
+  MPI_Request        *requests, barrier;
+  MPI_Status          status;
+
+  SC_ASSERT (receivers->elem_size == sizeof (int));
+  SC_ASSERT (sc_array_is_sorted (receivers, sc_int_compare));
+  SC_ASSERT (payloads->elem_size == sizeof (sc_array_t));
+  SC_ASSERT (payloads->elem_count == receivers->elem_count);
+  SC_ASSERT (senders->elem_size == sizeof (int));
+  SC_ASSERT (recv_payloads->elem_size == sizeof (sc_array_t));
+  SC_ASSERT (elem_size > 0);
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  tag = SC_TAG_NOTIFY_NBX + sc_notify_nbx_epoch (mpicomm);
+
+  /* synchronous sends complete only once they are received */
+  sc_array_init (&messages, sizeof (sc_notify_message_t));
+  num_receivers = (int) receivers->elem_count;
+  requests = SC_ALLOC (MPI_Request, num_receivers);
+  num_sends = 0;
+  for (i = 0; i < num_receivers; ++i) {
+    rank = *(int *) sc_array_index_int (receivers, i);
+    payload = (sc_array_t *) sc_array_index_int (payloads, i);
+    SC_ASSERT (payload->elem_size == elem_size);
+    if (rank == mpirank) {
+      msg = (sc_notify_message_t *) sc_array_push (&messages);
+      msg->source = mpirank;
+      sc_notify_payload_copy (&msg->payload, payload, elem_size);
+      continue;
+    }
+    SC_ASSERT (payload->elem_count * elem_size <= (size_t) INT_MAX);
+    mpiret = MPI_Issend (payload->array,
+                         (int) (payload->elem_count * elem_size), MPI_BYTE,
+                         rank, tag, mpicomm, requests + num_sends++);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* receive until everybody's sends are complete */
+  barrier_active = done = 0;
+  while (!done) {
+    mpiret = MPI_Iprobe (MPI_ANY_SOURCE, tag, mpicomm, &flag, &status);
+    SC_CHECK_MPI (mpiret);
+    if (flag) {
+      mpiret = MPI_Get_count (&status, MPI_BYTE, &count);
+      SC_CHECK_MPI (mpiret);
+      SC_ASSERT (count % elem_size == 0);
+      msg = (sc_notify_message_t *) sc_array_push (&messages);
+      msg->source = status.MPI_SOURCE;
+      sc_array_init_size (&msg->payload, elem_size, count / elem_size);
+      mpiret = MPI_Recv (msg->payload.array, count, MPI_BYTE,
+                         status.MPI_SOURCE, tag, mpicomm,
+                         MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+    if (!barrier_active) {
+      mpiret = MPI_Testall (num_sends, requests, &flag,
+                            MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (flag) {
+        mpiret = MPI_Ibarrier (mpicomm, &barrier);
+        SC_CHECK_MPI (mpiret);
+        barrier_active = 1;
+      }
+    }
+    else {
+      mpiret = MPI_Test (&barrier, &done, MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  SC_FREE (requests);
+
+  /* return the payloads ordered by source */
+  sc_array_sort (&messages, sc_notify_message_compare);
+  sc_array_resize (senders, messages.elem_count);
+  sc_array_resize (recv_payloads, messages.elem_count);
+  for (i = 0; i < (int) messages.elem_count; ++i) {
+    msg = (sc_notify_message_t *) sc_array_index_int (&messages, i);
+    *(int *) sc_array_index_int (senders, i) = msg->source;
+    *(sc_array_t *) sc_array_index_int (recv_payloads, i) = msg->payload;
+  }
+  sc_array_reset (&messages);
+
+  return sc_MPI_SUCCESS;
+#endif
+}
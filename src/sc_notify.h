@@ -24,7 +24,7 @@
 #ifndef SC_NOTIFY_H
 #define SC_NOTIFY_H
 
-#include <sc.h>
+#include <sc_containers.h>
 
 SC_EXTERN_C_BEGIN;
 
@@ -56,6 +56,61 @@ int                 sc_notify (int *receivers, int num_receivers,
                                int *senders, int *num_senders,
                                sc_MPI_Comm mpicomm);
 
+/** Collective call to send variable-size payloads to a set of receivers.
+ * The receivers do not know in advance who sends to them, nor how much.
+ * If MPI 3 is available, this is done in one round of synchronous sends
+ * that are probed for by the receivers, together with a nonblocking
+ * barrier that is entered once all our sends have been received.  This
+ * is the nonblocking consensus (NBX) algorithm.  Otherwise we fall back
+ * to \ref sc_notify_payloadv_rounds.  The message to the own rank, if
+ * any, is copied without MPI.
+ * \param [in] receivers        Array of int with unique MPI ranks in
+ *                              ascending order, as the fallback requires.
+ * \param [in] payloads         Array of sc_array_t of the same count as
+ *                              receivers.  Each entry is the payload to
+ *                              the corresponding receiver.  All payloads
+ *                              must have element size elem_size.
+ * \param [in,out] senders      Array of int, resized to the ranks that
+ *                              sent to us in ascending order.
+ * \param [in,out] recv_payloads        Array of sc_array_t, resized to the
+ *                              number of senders.  Each entry is
+ *                              initialized and filled with the payload of
+ *                              the corresponding sender and must be reset
+ *                              by the caller.
+ * \param [in] elem_size        Element size of all payloads.
+ * \param [in] mpicomm          MPI communicator to use.  Calls on the
+ *                              same communicator must not be interleaved
+ *                              with other point-to-point messages that
+ *                              use the same tags.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_notify_payloadv (sc_array_t * receivers,
+                                        sc_array_t * payloads,
+                                        sc_array_t * senders,
+                                        sc_array_t * recv_payloads,
+                                        size_t elem_size,
+                                        sc_MPI_Comm mpicomm);
+
+/** Collective call to send variable-size payloads to a set of receivers.
+ * This version calls \ref sc_notify to find the senders and follows it
+ * with one round of messages for the sizes and one for the payloads.
+ * \see sc_notify_payloadv
+ * \param [in] receivers        Array of int with unique MPI ranks in
+ *                              ascending order.
+ * \param [in] payloads         Same as in \ref sc_notify_payloadv.
+ * \param [in,out] senders      Same as in \ref sc_notify_payloadv.
+ * \param [in,out] recv_payloads        Same as in \ref sc_notify_payloadv.
+ * \param [in] elem_size        Element size of all payloads.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_notify_payloadv_rounds (sc_array_t * receivers,
+                                               sc_array_t * payloads,
+                                               sc_array_t * senders,
+                                               sc_array_t * recv_payloads,
+                                               size_t elem_size,
+                                               sc_MPI_Comm mpicomm);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_NOTIFY_H */
@@ -0,0 +1,235 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_pqueue.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* assumed size of a cache line to separate the heaps */
+#define SC_PQUEUE_CACHE_LINE 64
+
+typedef struct sc_pqueue_heap
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_t     mutex;
+#endif
+  sc_array_t          heap;
+  void               *temp;
+  char                pad[SC_PQUEUE_CACHE_LINE];
+}
+sc_pqueue_heap_t;
+
+struct sc_pqueue
+{
+  size_t              elem_size;
+  int                 (*compar) (const void *, const void *);
+  int                 num_heaps;
+  int                 arity;
+  sc_pqueue_heap_t   *heaps;
+};
+
+static int
+sc_pqueue_random (unsigned *seed, int n)
+{
+  unsigned            x = *seed;
+
+  /* xorshift generator, which must not start at zero */
+  if (x == 0) {
+    x = 2463534242u;
+  }
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *seed = x;
+  return (int) (x % (unsigned) n);
+}
+
+static int
+sc_pqueue_trylock (sc_pqueue_heap_t * h)
+{
+#ifdef SC_ENABLE_PTHREAD
+  return pthread_mutex_trylock (&h->mutex) == 0;
+#else
+  return 1;
+#endif
+}
+
+static void
+sc_pqueue_lock (sc_pqueue_heap_t * h)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_lock (&h->mutex);
+  SC_CHECK_ABORT (pth == 0, "Fail in pthread_mutex_lock");
+#endif
+}
+
+static void
+sc_pqueue_unlock (sc_pqueue_heap_t * h)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_unlock (&h->mutex);
+  SC_CHECK_ABORT (pth == 0, "Fail in pthread_mutex_unlock");
+#endif
+}
+
+sc_pqueue_t        *
+sc_pqueue_new (size_t elem_size, int (*compar) (const void *, const void *),
+               int num_heaps, int arity)
+{
+  int                 i;
+  sc_pqueue_t        *pq;
+  sc_pqueue_heap_t   *h;
+
+  SC_ASSERT (elem_size > 0);
+  SC_ASSERT (compar != NULL);
+  SC_ASSERT (num_heaps > 0);
+  SC_ASSERT (arity >= 2);
+
+  pq = SC_ALLOC (sc_pqueue_t, 1);
+  pq->elem_size = elem_size;
+  pq->compar = compar;
+  pq->num_heaps = num_heaps;
+  pq->arity = arity;
+  pq->heaps = SC_ALLOC (sc_pqueue_heap_t, num_heaps);
+  for (i = 0; i < num_heaps; ++i) {
+    h = pq->heaps + i;
+#ifdef SC_ENABLE_PTHREAD
+    SC_CHECK_ABORT (pthread_mutex_init (&h->mutex, NULL) == 0,
+                    "Fail in pthread_mutex_init");
+#endif
+    sc_array_init (&h->heap, elem_size);
+    h->temp = SC_ALLOC (char, elem_size);
+  }
+
+  return pq;
+}
+
+void
+sc_pqueue_destroy (sc_pqueue_t * pq)
+{
+  int                 i;
+  sc_pqueue_heap_t   *h;
+
+  for (i = 0; i < pq->num_heaps; ++i) {
+    h = pq->heaps + i;
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_destroy (&h->mutex);
+#endif
+    sc_array_reset (&h->heap);
+    SC_FREE (h->temp);
+  }
+  SC_FREE (pq->heaps);
+  SC_FREE (pq);
+}
+
+size_t
+sc_pqueue_count (sc_pqueue_t * pq)
+{
+  int                 i;
+  size_t              count;
+  sc_pqueue_heap_t   *h;
+
+  count = 0;
+  for (i = 0; i < pq->num_heaps; ++i) {
+    h = pq->heaps + i;
+    sc_pqueue_lock (h);
+    count += h->heap.elem_count;
+    sc_pqueue_unlock (h);
+  }
+  return count;
+}
+
+void
+sc_pqueue_push (sc_pqueue_t * pq, const void *elem, unsigned *seed)
+{
+  int                 attempt;
+  sc_pqueue_heap_t   *h;
+
+  /* find an unlocked heap, and wait for one after too many attempts */
+  attempt = 0;
+  for (;;) {
+    h = pq->heaps + sc_pqueue_random (seed, pq->num_heaps);
+    if (++attempt > pq->num_heaps) {
+      sc_pqueue_lock (h);
+      break;
+    }
+    if (sc_pqueue_trylock (h)) {
+      break;
+    }
+  }
+
+  memcpy (sc_array_push (&h->heap), elem, pq->elem_size);
+  sc_array_pqueue_add_arity (&h->heap, h->temp, pq->compar, pq->arity);
+  sc_pqueue_unlock (h);
+}
+
+int
+sc_pqueue_pop (sc_pqueue_t * pq, void *result, unsigned *seed)
+{
+  int                 i, attempt;
+  sc_pqueue_heap_t   *h, *h2;
+
+  /* of two random heaps, pop from the one with the smaller top element */
+  for (attempt = 0; attempt < 2 * pq->num_heaps; ++attempt) {
+    h = pq->heaps + sc_pqueue_random (seed, pq->num_heaps);
+    if (!sc_pqueue_trylock (h)) {
+      continue;
+    }
+    h2 = pq->heaps + sc_pqueue_random (seed, pq->num_heaps);
+    if (h2 != h && sc_pqueue_trylock (h2)) {
+      if (h2->heap.elem_count > 0 &&
+          (h->heap.elem_count == 0 ||
+           pq->compar (h2->heap.array, h->heap.array) < 0)) {
+        sc_pqueue_unlock (h);
+        h = h2;
+      }
+      else {
+        sc_pqueue_unlock (h2);
+      }
+    }
+    if (h->heap.elem_count > 0) {
+      sc_array_pqueue_pop_arity (&h->heap, result, pq->compar, pq->arity);
+      sc_pqueue_unlock (h);
+      return 1;
+    }
+    sc_pqueue_unlock (h);
+  }
+
+  /* the sampled heaps were empty or busy, so we look at every heap */
+  for (i = 0; i < pq->num_heaps; ++i) {
+    h = pq->heaps + i;
+    sc_pqueue_lock (h);
+    if (h->heap.elem_count > 0) {
+      sc_array_pqueue_pop_arity (&h->heap, result, pq->compar, pq->arity);
+      sc_pqueue_unlock (h);
+      return 1;
+    }
+    sc_pqueue_unlock (h);
+  }
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_pqueue.h
+ * Relaxed priority queue for concurrent use by many threads.
+ *
+ * The queue consists of several heaps, each protected by a lock of its
+ * own.  An element is pushed to a randomly chosen heap that is not locked
+ * by another thread.  A pop samples two random heaps and removes the
+ * smaller of their two top elements.  Thus a pop does not necessarily
+ * return the smallest element of the queue, but one of the smallest few
+ * with high probability, while the threads rarely wait for each other.
+ * With a single heap the queue is exact and behaves like the functions
+ * \ref sc_array_pqueue_add_arity and \ref sc_array_pqueue_pop_arity.
+ *
+ * The elements are ordered by a comparison function in the convention of
+ * the sc_array_pqueue functions, such that the smallest element has the
+ * highest priority.  The random choices use a state owned by the calling
+ * thread, for example a seed initialized with the thread number.
+ * The locks are only used if libsc is configured with pthreads.
+ */
+
+#ifndef SC_PQUEUE_H
+#define SC_PQUEUE_H
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** The opaque relaxed priority queue. */
+typedef struct sc_pqueue sc_pqueue_t;
+
+/** Create a new, empty queue.
+ * \param [in] elem_size        Size of one element in bytes.
+ * \param [in] compar   The comparison function of two elements.
+ * \param [in] num_heaps        Number of heaps, at least one.  Twice the
+ *                      number of threads is a good choice.
+ * \param [in] arity    Number of children per node in each heap,
+ *                      at least two.
+ * \return              The queue, to be destroyed by
+ *                      \ref sc_pqueue_destroy.
+ */
+sc_pqueue_t        *sc_pqueue_new (size_t elem_size,
+                                   int (*compar) (const void *,
+                                                  const void *),
+                                   int num_heaps, int arity);
+
+/** Destroy a queue and all elements that it contains.
+ * \param [in,out] pq   Its memory is freed.
+ */
+void                sc_pqueue_destroy (sc_pqueue_t * pq);
+
+/** Return the number of elements in a queue.
+ * While other threads push or pop, the result is approximate.
+ * \param [in] pq       The queue.
+ * \return              The sum of the element counts of all heaps.
+ */
+size_t              sc_pqueue_count (sc_pqueue_t * pq);
+
+/** Add an element to a queue.  This function is thread safe.
+ * \param [in,out] pq   The queue.
+ * \param [in] elem     Pointer to the element, which is copied.
+ * \param [in,out] seed State of the random choices owned by the calling
+ *                      thread.  It may be initialized to any value.
+ */
+void                sc_pqueue_push (sc_pqueue_t * pq, const void *elem,
+                                    unsigned *seed);
+
+/** Remove one of the smallest elements from a queue.
+ * This function is thread safe.
+ * \param [in,out] pq   The queue.
+ * \param [out] result  Pointer to memory of elem_size for the element.
+ * \param [in,out] seed State of the random choices owned by the calling
+ *                      thread.
+ * \return              True if an element was removed, false if all heaps
+ *                      were found empty.
+ */
+int                 sc_pqueue_pop (sc_pqueue_t * pq, void *result,
+                                   unsigned *seed);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_PQUEUE_H */
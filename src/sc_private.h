@@ -44,6 +44,15 @@ SC_EXTERN_C_BEGIN;
  */
 void                sc_package_rc_count_add (int package_id, int toadd);
 
+/** True if sc_trace_open has been called with log events enabled. */
+extern int          sc_trace_logging;
+
+/** Record a written log message as an event of the trace stream.
+ * Called by sc_log for each message it passes to a log handler.
+ */
+void                sc_trace_log (const char *filename, int lineno,
+                                  int package, int category, int priority);
+
 SC_EXTERN_C_END;
 
 #endif /* SC_PRIVATE_H */
@@ -0,0 +1,454 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_profile.h>
+#ifdef SC_HAVE_TIME_H
+#include <time.h>
+#endif
+
+/** Separator of the region names in a path.  It sorts before any printable
+ * character, which makes the lexicographic order of the paths depth first.
+ */
+#define SC_PROFILE_SEP '\001'
+
+uint64_t
+sc_profile_clock_ns (void)
+{
+#if defined SC_HAVE_CLOCK_GETTIME && defined CLOCK_MONOTONIC
+  struct timespec     ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#else
+  return (uint64_t) (sc_MPI_Wtime () * 1.e9);
+#endif
+}
+
+sc_profile_t       *
+sc_profile_new (sc_MPI_Comm mpicomm, int num_threads, int max_regions)
+{
+  int                 i;
+  sc_profile_t       *prof;
+  sc_profile_thread_t *th;
+
+  SC_ASSERT (num_threads >= 1 && max_regions >= 1);
+
+  prof = SC_ALLOC (sc_profile_t, 1);
+  prof->mpicomm = mpicomm;
+  prof->num_threads = num_threads;
+  prof->max_regions = max_regions;
+  prof->threads = SC_ALLOC (sc_profile_thread_t, num_threads);
+  for (i = 0; i < num_threads; ++i) {
+    th = prof->threads + i;
+    th->num_nodes = 1;
+    th->current = 0;
+    th->nodes = SC_ALLOC_ZERO (sc_profile_node_t, max_regions + 1);
+    th->nodes[0].parent = -1;
+    th->nodes[0].child = -1;
+    th->nodes[0].sibling = -1;
+  }
+  prof->regions = sc_array_new (sizeof (sc_profile_region_t));
+  prof->stats = NULL;
+
+  return prof;
+}
+
+/** Remove the results of a previous sc_profile_compute. */
+static void
+sc_profile_reset_results (sc_profile_t * prof)
+{
+  size_t              zz;
+  sc_profile_region_t *reg;
+
+  for (zz = 0; zz < prof->regions->elem_count; ++zz) {
+    reg = (sc_profile_region_t *) sc_array_index (prof->regions, zz);
+    SC_FREE (reg->path);
+  }
+  sc_array_reset (prof->regions);
+  SC_FREE (prof->stats);
+  prof->stats = NULL;
+}
+
+void
+sc_profile_destroy (sc_profile_t * prof)
+{
+  int                 i;
+
+  sc_profile_reset_results (prof);
+  sc_array_destroy (prof->regions);
+  for (i = 0; i < prof->num_threads; ++i) {
+    SC_FREE (prof->threads[i].nodes);
+  }
+  SC_FREE (prof->threads);
+
+  SC_FREE (prof);
+}
+
+void
+sc_profile_push (sc_profile_t * prof, int thread, const char *name)
+{
+  int                 i, last;
+  sc_profile_thread_t *th;
+  sc_profile_node_t  *node;
+
+  if (prof == NULL) {
+    return;
+  }
+  SC_ASSERT (0 <= thread && thread < prof->num_threads);
+  SC_ASSERT (name != NULL);
+
+  /* look for the region among the subregions of the current one */
+  th = prof->threads + thread;
+  last = -1;
+  for (i = th->nodes[th->current].child; i >= 0; i = node->sibling) {
+    node = th->nodes + i;
+    if (node->name == name || !strcmp (node->name, name)) {
+      break;
+    }
+    last = i;
+  }
+  if (i < 0) {
+    SC_CHECK_ABORT (th->num_nodes <= prof->max_regions,
+                    "sc_profile: too many regions");
+    i = th->num_nodes++;
+    node = th->nodes + i;
+    node->name = name;
+    node->parent = th->current;
+    node->child = -1;
+    node->sibling = -1;
+    node->count = 0;
+    node->total = 0;
+    if (last >= 0) {
+      th->nodes[last].sibling = i;
+    }
+    else {
+      th->nodes[th->current].child = i;
+    }
+  }
+
+  th->current = i;
+  th->nodes[i].start = sc_profile_clock_ns ();
+}
+
+void
+sc_profile_pop (sc_profile_t * prof, int thread)
+{
+  uint64_t            now;
+  sc_profile_thread_t *th;
+  sc_profile_node_t  *node;
+
+  if (prof == NULL) {
+    return;
+  }
+  now = sc_profile_clock_ns ();
+  SC_ASSERT (0 <= thread && thread < prof->num_threads);
+
+  th = prof->threads + thread;
+  SC_ASSERT (th->current > 0);
+  node = th->nodes + th->current;
+  node->total += now - node->start;
+  ++node->count;
+  th->current = node->parent;
+}
+
+/** The local contribution of one thread to one region. */
+typedef struct sc_profile_entry
+{
+  char               *path;
+  double              seconds;
+  long                count;
+}
+sc_profile_entry_t;
+
+static int
+sc_profile_entry_compare (const void *v1, const void *v2)
+{
+  return strcmp (((const sc_profile_entry_t *) v1)->path,
+                 ((const sc_profile_entry_t *) v2)->path);
+}
+
+static int
+sc_profile_string_compare (const void *v1, const void *v2)
+{
+  return strcmp (*(char *const *) v1, *(char *const *) v2);
+}
+
+/** Build the path of a node by following its parents. */
+static char        *
+sc_profile_node_path (sc_profile_thread_t * th, int i)
+{
+  int                 j;
+  size_t              len, pos;
+  char               *path;
+
+  len = 0;
+  for (j = i; j > 0; j = th->nodes[j].parent) {
+    len += strlen (th->nodes[j].name) + 1;
+  }
+  path = SC_ALLOC (char, len);
+  pos = len - 1;
+  path[pos] = '\0';
+  for (j = i; j > 0; j = th->nodes[j].parent) {
+    len = strlen (th->nodes[j].name);
+    pos -= len;
+    memcpy (path + pos, th->nodes[j].name, len);
+    if (pos > 0) {
+      path[--pos] = SC_PROFILE_SEP;
+    }
+  }
+  SC_ASSERT (pos == 0);
+
+  return path;
+}
+
+void
+sc_profile_compute (sc_profile_t * prof)
+{
+  int                 mpiret;
+  int                 num_procs, p, i, j, num_regions, depth;
+  int                *lengths, *offsets;
+  size_t              zz, local_len, total_len;
+  char               *local_buf, *global_buf, *s, **paths;
+  sc_array_t         *entries;
+  sc_profile_thread_t *th;
+  sc_profile_entry_t *entry;
+  sc_profile_region_t *reg;
+  sc_statinfo_t      *st;
+
+  sc_profile_reset_results (prof);
+
+  /* collect the contributions of all threads, sorted by path */
+  entries = sc_array_new (sizeof (sc_profile_entry_t));
+  for (i = 0; i < prof->num_threads; ++i) {
+    th = prof->threads + i;
+    SC_CHECK_ABORT (th->current == 0, "sc_profile: regions still open");
+    for (j = 1; j < th->num_nodes; ++j) {
+      entry = (sc_profile_entry_t *) sc_array_push (entries);
+      entry->path = sc_profile_node_path (th, j);
+      entry->seconds = th->nodes[j].total * 1.e-9;
+      entry->count = th->nodes[j].count;
+    }
+  }
+  sc_array_sort (entries, sc_profile_entry_compare);
+
+  /* concatenate the distinct local paths */
+  local_len = 0;
+  for (zz = 0; zz < entries->elem_count; ++zz) {
+    entry = (sc_profile_entry_t *) sc_array_index (entries, zz);
+    if (zz == 0 || strcmp (entry->path, entry[-1].path)) {
+      local_len += strlen (entry->path) + 1;
+    }
+  }
+  local_buf = SC_ALLOC (char, SC_MAX (local_len, 1));
+  local_len = 0;
+  for (zz = 0; zz < entries->elem_count; ++zz) {
+    entry = (sc_profile_entry_t *) sc_array_index (entries, zz);
+    if (zz == 0 || strcmp (entry->path, entry[-1].path)) {
+      strcpy (local_buf + local_len, entry->path);
+      local_len += strlen (entry->path) + 1;
+    }
+  }
+
+  /* the union of the paths of all processes defines the regions */
+  mpiret = sc_MPI_Comm_size (prof->mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  lengths = SC_ALLOC (int, num_procs);
+  offsets = SC_ALLOC (int, num_procs + 1);
+  i = (int) local_len;
+  mpiret = sc_MPI_Allgather (&i, 1, sc_MPI_INT, lengths, 1, sc_MPI_INT,
+                             prof->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  offsets[0] = 0;
+  for (p = 0; p < num_procs; ++p) {
+    offsets[p + 1] = offsets[p] + lengths[p];
+  }
+  total_len = (size_t) offsets[num_procs];
+  global_buf = SC_ALLOC (char, SC_MAX (total_len, 1));
+  mpiret = sc_MPI_Allgatherv (local_buf, (int) local_len, sc_MPI_CHAR,
+                              global_buf, lengths, offsets, sc_MPI_CHAR,
+                              prof->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (lengths);
+  SC_FREE (offsets);
+  SC_FREE (local_buf);
+
+  num_regions = 0;
+  for (zz = 0; zz < total_len; zz += strlen (global_buf + zz) + 1) {
+    ++num_regions;
+  }
+  paths = SC_ALLOC (char *, SC_MAX (num_regions, 1));
+  i = 0;
+  for (zz = 0; zz < total_len; zz += strlen (global_buf + zz) + 1) {
+    paths[i++] = global_buf + zz;
+  }
+  qsort (paths, (size_t) num_regions, sizeof (char *),
+         sc_profile_string_compare);
+  for (i = 0; i < num_regions; ++i) {
+    if (i > 0 && !strcmp (paths[i], paths[i - 1])) {
+      continue;
+    }
+    reg = (sc_profile_region_t *) sc_array_push (prof->regions);
+    reg->path = SC_STRDUP (paths[i]);
+    reg->name = reg->path;
+    reg->depth = 0;
+    for (s = reg->path; *s != '\0'; ++s) {
+      if (*s == SC_PROFILE_SEP) {
+        reg->name = s + 1;
+        ++reg->depth;
+      }
+    }
+  }
+  SC_FREE (paths);
+  SC_FREE (global_buf);
+
+  /* match the local entries with the regions, both are sorted */
+  num_regions = (int) prof->regions->elem_count;
+  prof->stats = SC_ALLOC (sc_statinfo_t, 2 * SC_MAX (num_regions, 1));
+  zz = 0;
+  for (i = 0; i < num_regions; ++i) {
+    reg = (sc_profile_region_t *) sc_array_index_int (prof->regions, i);
+    st = prof->stats + 2 * i;
+    sc_stats_init (st, reg->name);
+    sc_stats_init (st + 1, reg->name);
+    for (; zz < entries->elem_count; ++zz) {
+      entry = (sc_profile_entry_t *) sc_array_index (entries, zz);
+      if (strcmp (entry->path, reg->path)) {
+        break;
+      }
+      sc_stats_accumulate (st, entry->seconds);
+      st[1].sum_values += (double) entry->count;
+    }
+    if (st->count > 0) {
+      /* one sample of the call count per process */
+      sc_stats_set1 (st + 1, st[1].sum_values, reg->name);
+    }
+  }
+  SC_ASSERT (zz == entries->elem_count);
+  sc_stats_compute (prof->mpicomm, 2 * num_regions, prof->stats);
+
+  for (zz = 0; zz < entries->elem_count; ++zz) {
+    entry = (sc_profile_entry_t *) sc_array_index (entries, zz);
+    SC_FREE (entry->path);
+  }
+  sc_array_destroy (entries);
+
+  depth = 0;
+  for (i = 0; i < num_regions; ++i) {
+    reg = (sc_profile_region_t *) sc_array_index_int (prof->regions, i);
+    depth = SC_MAX (depth, reg->depth);
+  }
+  SC_GLOBAL_LDEBUGF ("Profile has %d regions of depth %d\n",
+                     num_regions, depth + 1);
+}
+
+void
+sc_profile_print (sc_profile_t * prof, int package_id, int log_priority)
+{
+  int                 i, width;
+  sc_profile_region_t *reg;
+  sc_statinfo_t      *st;
+
+  SC_ASSERT (prof->stats != NULL);
+
+  width = 6;
+  for (i = 0; i < (int) prof->regions->elem_count; ++i) {
+    reg = (sc_profile_region_t *) sc_array_index_int (prof->regions, i);
+    width = SC_MAX (width, 2 * reg->depth + (int) strlen (reg->name));
+  }
+
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, log_priority,
+               "%-*s %10s %12s %12s %12s %6s\n", width, "Region",
+               "Calls", "Min", "Avg", "Max", "MaxAt");
+  for (i = 0; i < (int) prof->regions->elem_count; ++i) {
+    reg = (sc_profile_region_t *) sc_array_index_int (prof->regions, i);
+    st = prof->stats + 2 * i;
+    SC_GEN_LOGF (package_id, SC_LC_GLOBAL, log_priority,
+                 "%*s%-*s %10.0f %12.6g %12.6g %12.6g %6d\n",
+                 2 * reg->depth, "", width - 2 * reg->depth, reg->name,
+                 st[1].sum_values, st->min, st->average, st->max,
+                 st->max_at_rank);
+  }
+}
+
+/** Write a string with JSON escapes. */
+static void
+sc_profile_json_string (FILE * file, const char *s)
+{
+  fputc ('"', file);
+  for (; *s != '\0'; ++s) {
+    if (*s == '"' || *s == '\\') {
+      fprintf (file, "\\%c", *s);
+    }
+    else if ((unsigned char) *s < 0x20) {
+      fprintf (file, "\\u%04x", (unsigned) (unsigned char) *s);
+    }
+    else {
+      fputc (*s, file);
+    }
+  }
+  fputc ('"', file);
+}
+
+int
+sc_profile_write_json (sc_profile_t * prof, FILE * file)
+{
+  int                 i, depth, next;
+  const int           num_regions = (int) prof->regions->elem_count;
+  sc_profile_region_t *reg;
+  sc_statinfo_t      *st;
+
+  SC_ASSERT (prof->stats != NULL);
+
+  /* the regions are sorted depth first, so we close a list of children
+     whenever the next region is less deeply nested */
+  fprintf (file, "{\"regions\": [");
+  for (i = 0; i < num_regions; ++i) {
+    reg = (sc_profile_region_t *) sc_array_index_int (prof->regions, i);
+    st = prof->stats + 2 * i;
+    depth = reg->depth;
+    next = i + 1 < num_regions ?
+      ((sc_profile_region_t *)
+       sc_array_index_int (prof->regions, i + 1))->depth : 0;
+    SC_ASSERT (next <= depth + 1);
+
+    fprintf (file, "\n%*s{\"name\": ", 2 * depth + 2, "");
+    sc_profile_json_string (file, reg->name);
+    fprintf (file, ", \"calls\": %.0f, \"samples\": %ld, \"min\": %.9g, "
+             "\"avg\": %.9g, \"max\": %.9g, \"max_at_rank\": %d, "
+             "\"children\": [", st[1].sum_values, st->count, st->min,
+             st->average, st->max, st->max_at_rank);
+    if (next > depth) {
+      continue;
+    }
+    fprintf (file, "]}");
+    for (; depth > next; --depth) {
+      fprintf (file, "]}");
+    }
+    if (i + 1 < num_regions) {
+      fputc (',', file);
+    }
+  }
+  fprintf (file, "]}\n");
+
+  return ferror (file);
+}
@@ -0,0 +1,158 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_profile.h
+ * Hierarchical region profiler.
+ *
+ * Regions are opened with \ref sc_profile_push and closed with
+ * \ref sc_profile_pop.  Nested regions form a tree per thread, in which
+ * we count the calls and accumulate the time with a nanosecond clock.
+ * Every thread writes only to its own preallocated buffer, so no locks
+ * are needed.  In the end, \ref sc_profile_compute merges the trees of
+ * all threads and processes and \ref sc_profile_print or
+ * \ref sc_profile_write_json report the results.
+ */
+
+#ifndef SC_PROFILE_H
+#define SC_PROFILE_H
+
+#include <sc_statistics.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** One region in the tree of a single thread. */
+typedef struct sc_profile_node
+{
+  const char         *name;     /* region name, borrowed */
+  int                 parent;   /* index of the enclosing region */
+  int                 child;    /* index of the first subregion or -1 */
+  int                 sibling;  /* index of the next region or -1 */
+  long                count;    /* number of completed calls */
+  uint64_t            start;    /* clock at the most recent push */
+  uint64_t            total;    /* accumulated nanoseconds */
+}
+sc_profile_node_t;
+
+/** The region tree of one thread.  Node 0 is an unnamed root. */
+typedef struct sc_profile_thread
+{
+  int                 num_nodes;
+  int                 current;  /* index of the innermost open region */
+  sc_profile_node_t  *nodes;
+  char                padding[64];      /* avoid false sharing */
+}
+sc_profile_thread_t;
+
+/** A region merged over all threads and processes. */
+typedef struct sc_profile_region
+{
+  char               *path;     /* names from the root joined by '\001' */
+  const char         *name;     /* last name in the path */
+  int                 depth;    /* number of enclosing regions */
+}
+sc_profile_region_t;
+
+typedef struct sc_profile
+{
+  sc_MPI_Comm         mpicomm;
+  int                 num_threads;
+  int                 max_regions;
+  sc_profile_thread_t *threads;
+
+  /* results of sc_profile_compute */
+  sc_array_t         *regions;  /* sc_profile_region_t, depth first */
+  sc_statinfo_t      *stats;    /* time and calls for each region */
+}
+sc_profile_t;
+
+/** Read a monotonic clock.
+ * \return          Nanoseconds since an arbitrary point in the past.
+ */
+uint64_t            sc_profile_clock_ns (void);
+
+/** Create a new profiler.
+ * \param [in] mpicomm      Communicator for \ref sc_profile_compute.
+ * \param [in] num_threads  Number of threads that may record regions.
+ * \param [in] max_regions  Maximum number of distinct regions in the tree
+ *                          of each thread.  The buffers are allocated here
+ *                          and never grow, which makes pushing and popping
+ *                          safe inside of parallel regions.
+ * \return                  Profiler with an empty tree for every thread.
+ */
+sc_profile_t       *sc_profile_new (sc_MPI_Comm mpicomm,
+                                    int num_threads, int max_regions);
+
+/** Destroy a profiler.
+ */
+void                sc_profile_destroy (sc_profile_t * prof);
+
+/** Open a region nested in the currently open region of a thread.
+ * Regions are identified by their name and position in the tree.
+ * \param [in,out] prof     Profiler.  If NULL, this function does nothing.
+ * \param [in] thread       Number of the calling thread, 0 <= thread <
+ *                          num_threads.  Each thread must use its own.
+ * \param [in] name         Region name.  The string is not copied and
+ *                          must stay valid until the profiler is destroyed.
+ */
+void                sc_profile_push (sc_profile_t * prof, int thread,
+                                     const char *name);
+
+/** Close the innermost open region of a thread.
+ * \param [in,out] prof     Profiler.  If NULL, this function does nothing.
+ * \param [in] thread       Number of the calling thread.
+ */
+void                sc_profile_pop (sc_profile_t * prof, int thread);
+
+/** Merge the region trees over all threads and processes.
+ * This function is collective over the communicator of the profiler and
+ * must be called outside of any parallel region.  A region that occurs on
+ * only some threads or processes is counted on those only.
+ * The time of every thread that completed a region is one sample for
+ * minimum, average and maximum.  The call counts are summed.
+ * All regions must be closed.
+ * \param [in,out] prof     The results are stored in the profiler.
+ */
+void                sc_profile_compute (sc_profile_t * prof);
+
+/** Print the merged regions as an indented table.
+ * Must be called after \ref sc_profile_compute.
+ * This function uses the SC_LC_GLOBAL log category.
+ * \param [in] prof         Profiler.
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] log_priority Log priority for output according to sc.h.
+ */
+void                sc_profile_print (sc_profile_t * prof,
+                                      int package_id, int log_priority);
+
+/** Write the merged regions as a tree in JSON format.
+ * Must be called after \ref sc_profile_compute.  It is up to the caller
+ * to call this function on one process only, usually rank 0.
+ * \param [in] prof         Profiler.
+ * \param [in] file         Open file to write to.
+ * \return                  0 on success, nonzero on a write error.
+ */
+int                 sc_profile_write_json (sc_profile_t * prof, FILE * file);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_PROFILE_H */
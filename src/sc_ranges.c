@@ -22,14 +22,55 @@
 */
 
 #include <sc_ranges.h>
+#include <sc_notify.h>
 #include <sc_statistics.h>
 
+/** An empty range between peers and its slot in sc_ranges_compute. */
+typedef struct sc_ranges_gap
+{
+  int                 begin, end;
+  int                 slot;
+}
+sc_ranges_gap_t;
+
 static int
 sc_ranges_compare (const void *v1, const void *v2)
 {
   return *(int *) v1 - *(int *) v2;
 }
 
+/** Order gaps by length, and gaps of equal length by slot. */
+static int
+sc_ranges_gap_compare (const void *v1, const void *v2)
+{
+  const sc_ranges_gap_t *g1 = (const sc_ranges_gap_t *) v1;
+  const sc_ranges_gap_t *g2 = (const sc_ranges_gap_t *) v2;
+  const int           l1 = g1->end - g1->begin;
+  const int           l2 = g2->end - g2->begin;
+
+  if (l1 != l2) {
+    return l1 < l2 ? -1 : 1;
+  }
+  return g1->slot - g2->slot;
+}
+
+/** Turn nwin sorted empty ranges into the ranges between them.
+ * \return             The number of ranges.
+ */
+static int
+sc_ranges_invert (int nwin, int first_peer, int last_peer, int *ranges)
+{
+  int                 i;
+
+  ranges[2 * nwin + 1] = last_peer;
+  for (i = nwin; i > 0; --i) {
+    ranges[2 * i] = ranges[2 * i - 1] + 1;
+    ranges[2 * i - 1] = ranges[2 * (i - 1)] - 1;
+  }
+  ranges[0] = first_peer;
+  return nwin + 1;
+}
+
 int
 sc_ranges_compute (int package_id, int num_procs, const int *procs,
                    int rank, int first_peer, int last_peer,
@@ -143,13 +184,7 @@ sc_ranges_compute (int package_id, int num_procs, const int *procs,
 #endif
 
   /* compute real ranges from empty ranges */
-  ranges[2 * nwin + 1] = last_peer;
-  for (i = nwin; i > 0; --i) {
-    ranges[2 * i] = ranges[2 * i - 1] + 1;
-    ranges[2 * i - 1] = ranges[2 * (i - 1)] - 1;
-  }
-  ranges[0] = first_peer;
-  ++nwin;
+  nwin = sc_ranges_invert (nwin, first_peer, last_peer, ranges);
 
 #ifdef SC_DEBUG
   for (i = 0; i < nwin; ++i) {
@@ -177,6 +212,124 @@ sc_ranges_compute (int package_id, int num_procs, const int *procs,
   return nwin;
 }
 
+int
+sc_ranges_compute_sparse (int package_id, int num_procs, int num_peers,
+                          const int *peers, int rank,
+                          int num_ranges, int *ranges)
+{
+  int                 i, j, prev, first_peer, nwin;
+  sc_ranges_gap_t     gap, evicted, *g;
+  sc_array_t          heap;
+
+  SC_ASSERT (rank >= 0 && rank < num_procs);
+  SC_ASSERT (num_ranges >= 1);
+
+  for (i = 0; i < num_ranges; ++i) {
+    ranges[2 * i] = -1;
+    ranges[2 * i + 1] = -2;
+  }
+
+  /* keep the num_ranges - 1 longest empty ranges in a heap, evicting
+     the same range on ties as the linear search of sc_ranges_compute */
+  sc_array_init (&heap, sizeof (sc_ranges_gap_t));
+  first_peer = prev = -1;
+  for (i = 0; i < num_peers; ++i) {
+    j = peers[i];
+    SC_ASSERT (0 <= j && j < num_procs);
+    SC_ASSERT (i == 0 || peers[i - 1] < j);
+    if (j == rank) {
+      continue;
+    }
+    if (prev == -1) {
+      first_peer = prev = j;
+      continue;
+    }
+    if (prev < j - 1) {
+      gap.begin = prev + 1;
+      gap.end = j - 1;
+      if ((int) heap.elem_count < num_ranges - 1) {
+        gap.slot = (int) heap.elem_count;
+        *(sc_ranges_gap_t *) sc_array_push (&heap) = gap;
+        sc_array_pqueue_add (&heap, &evicted, sc_ranges_gap_compare);
+      }
+      else if (heap.elem_count > 0) {
+        /* the new range enters the last slot and is evicted itself
+           only if it is strictly shorter than all others */
+        g = (sc_ranges_gap_t *) heap.array;
+        if (gap.end - gap.begin >= g->end - g->begin) {
+          gap.slot = g->slot;
+          sc_array_pqueue_pop (&heap, &evicted, sc_ranges_gap_compare);
+          *(sc_ranges_gap_t *) sc_array_push (&heap) = gap;
+          sc_array_pqueue_add (&heap, &evicted, sc_ranges_gap_compare);
+        }
+      }
+    }
+    prev = j;
+  }
+
+  /* if no peers are present there are no ranges */
+  if (prev == -1) {
+    sc_array_reset (&heap);
+    return 0;
+  }
+
+  /* sort empty ranges by start rank */
+  nwin = (int) heap.elem_count;
+  for (i = 0; i < nwin; ++i) {
+    g = (sc_ranges_gap_t *) sc_array_index_int (&heap, i);
+    ranges[2 * i] = g->begin;
+    ranges[2 * i + 1] = g->end;
+  }
+  sc_array_reset (&heap);
+  qsort (ranges, (size_t) nwin, 2 * sizeof (int), sc_ranges_compare);
+
+  nwin = sc_ranges_invert (nwin, first_peer, prev, ranges);
+#ifdef SC_DEBUG
+  for (i = 0; i < nwin; ++i) {
+    SC_GEN_LOGF (package_id, SC_LC_NORMAL, SC_LP_DEBUG,
+                 "range %d from %d to %d\n", i,
+                 ranges[2 * i], ranges[2 * i + 1]);
+  }
+#endif
+  return nwin;
+}
+
+int
+sc_ranges_compute_bitmap (int package_id, int num_procs,
+                          const uint64_t * bitmap, int rank,
+                          int num_ranges, int *ranges)
+{
+  int                 w, nwin;
+  uint64_t            bits;
+  sc_array_t          peers;
+
+  /* extract the set bits a word at a time */
+  sc_array_init (&peers, sizeof (int));
+  for (w = 0; w < (num_procs + 63) / 64; ++w) {
+    for (bits = bitmap[w]; bits != 0; bits &= bits - 1) {
+#if defined __GNUC__ || defined __clang__
+      *(int *) sc_array_push (&peers) =
+        64 * w + __builtin_ctzll ((unsigned long long) bits);
+#else
+      int                 b;
+
+      for (b = 0; !((bits >> b) & 1); ++b);
+      *(int *) sc_array_push (&peers) = 64 * w + b;
+#endif
+    }
+  }
+  SC_ASSERT (peers.elem_count == 0 ||
+             *(int *) sc_array_index (&peers, peers.elem_count - 1) <
+             num_procs);
+
+  nwin = sc_ranges_compute_sparse (package_id, num_procs,
+                                   (int) peers.elem_count,
+                                   (const int *) peers.array, rank,
+                                   num_ranges, ranges);
+  sc_array_reset (&peers);
+  return nwin;
+}
+
 int
 sc_ranges_adaptive (int package_id, sc_MPI_Comm mpicomm,
                     const int *procs, int *inout1, int *inout2,
@@ -226,6 +379,48 @@ sc_ranges_adaptive (int package_id, sc_MPI_Comm mpicomm,
   return nwin;
 }
 
+int
+sc_ranges_adaptive_sparse (int package_id, sc_MPI_Comm mpicomm,
+                           int num_peers, const int *peers,
+                           int num_ranges, int *ranges,
+                           sc_array_t * receivers, sc_array_t * senders)
+{
+  int                 mpiret;
+  int                 i, j, num_procs, rank;
+  int                 nwin, num_senders;
+
+  SC_ASSERT (receivers != NULL && receivers->elem_size == sizeof (int));
+  SC_ASSERT (senders != NULL && senders->elem_size == sizeof (int));
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  nwin = sc_ranges_compute_sparse (package_id, num_procs, num_peers, peers,
+                                   rank, num_ranges, ranges);
+
+  /* everybody in the ranges is a receiver as in sc_ranges_decode */
+  sc_array_truncate (receivers);
+  for (i = 0; i < nwin; ++i) {
+    for (j = ranges[2 * i]; j <= ranges[2 * i + 1]; ++j) {
+      if (j != rank) {
+        *(int *) sc_array_push (receivers) = j;
+      }
+    }
+  }
+
+  /* the receivers learn about their senders */
+  sc_array_resize (senders, (size_t) num_procs);
+  mpiret = sc_notify ((int *) receivers->array, (int) receivers->elem_count,
+                      (int *) senders->array, &num_senders, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_array_resize (senders, (size_t) num_senders);
+  sc_array_sort (senders, sc_int_compare);
+
+  return nwin;
+}
+
 void
 sc_ranges_decode (int num_procs, int rank,
                   int max_ranges, const int *global_ranges,
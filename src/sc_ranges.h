@@ -24,7 +24,7 @@
 #ifndef SC_RANGES_H
 #define SC_RANGES_H
 
-#include <sc.h>
+#include <sc_containers.h>
 
 SC_EXTERN_C_BEGIN;
 
@@ -50,6 +50,50 @@ int                 sc_ranges_compute (int package_id, int num_procs,
                                        int first_peer, int last_peer,
                                        int num_ranges, int *ranges);
 
+/** Compute the same ranges as sc_ranges_compute from a list of peers.
+ * Instead of scanning an array of all processors and searching the
+ * shortest empty range for every gap, we keep the longest empty ranges
+ * in a heap.  This takes O(num_peers log num_ranges) time and does not
+ * depend on the number of processors.
+ *
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] num_procs    Number of processors.
+ * \param [in] num_peers    Number of entries in peers.
+ * \param [in] peers        Sorted array [num_peers] of unique processors
+ *                          that need to be talked to.  It may contain rank.
+ * \param [in] rank         The id of the calling process.
+ *                          Will be excluded from the ranges.
+ * \param [in] num_ranges   The maximum number of ranges to fill.
+ * \param [in,out] ranges   Array [2 * num_ranges] filled as in
+ *                          sc_ranges_compute.
+ * \return                  Returns the number of filled ranges.
+ */
+int                 sc_ranges_compute_sparse (int package_id, int num_procs,
+                                              int num_peers,
+                                              const int *peers, int rank,
+                                              int num_ranges, int *ranges);
+
+/** Compute the same ranges as sc_ranges_compute from a packed bitmap.
+ * We skip zero words and call sc_ranges_compute_sparse on the set bits.
+ *
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] num_procs    Number of processors.
+ * \param [in] bitmap       Array [(num_procs + 63) / 64] where bit j % 64
+ *                          of word j / 64 is set for the processors j
+ *                          that need to be talked to.  It may contain rank,
+ *                          and the bits from num_procs onwards must be zero.
+ * \param [in] rank         The id of the calling process.
+ *                          Will be excluded from the ranges.
+ * \param [in] num_ranges   The maximum number of ranges to fill.
+ * \param [in,out] ranges   Array [2 * num_ranges] filled as in
+ *                          sc_ranges_compute.
+ * \return                  Returns the number of filled ranges.
+ */
+int                 sc_ranges_compute_bitmap (int package_id, int num_procs,
+                                              const uint64_t * bitmap,
+                                              int rank, int num_ranges,
+                                              int *ranges);
+
 /** Compute the globally optimal ranges of processors.
  *
  * \param [in] package_id   Registered package id or -1.
@@ -77,6 +121,34 @@ int                 sc_ranges_adaptive (int package_id, sc_MPI_Comm mpicomm,
                                         int num_ranges, int *ranges,
                                         int **global_ranges);
 
+/** Compute the local ranges and exchange them sparsely.
+ * This replaces sc_ranges_adaptive followed by sc_ranges_decode.  Instead
+ * of an Allreduce and an Allgather of everybody's ranges, the processors
+ * in the local ranges are notified with sc_notify.  The memory and the
+ * communication volume do not grow with the number of processors times
+ * the number of ranges.
+ *
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] mpicomm      MPI Communicator for sc_notify.
+ * \param [in] num_peers    Number of entries in peers.
+ * \param [in] peers        Same as in sc_ranges_compute_sparse.
+ * \param [in] num_ranges   The maximum number of ranges to fill.
+ * \param [in,out] ranges   Array [2 * num_ranges] filled as in
+ *                          sc_ranges_compute.
+ * \param [in,out] receivers    Array of int, resized to the ranks in the
+ *                              local ranges except rank in ascending order.
+ * \param [in,out] senders      Array of int, resized to the ranks whose
+ *                              ranges contain rank in ascending order.
+ * \return                  Returns the number of locally filled ranges.
+ */
+int                 sc_ranges_adaptive_sparse (int package_id,
+                                               sc_MPI_Comm mpicomm,
+                                               int num_peers,
+                                               const int *peers,
+                                               int num_ranges, int *ranges,
+                                               sc_array_t * receivers,
+                                               sc_array_t * senders);
+
 /** Determine an array of receivers and an array of senders from ranges.
  * This function is intended for compatibility and debugging only.
  * In particular, sc_ranges_adaptive may include non-receiving processors.
@@ -23,6 +23,11 @@
 
 #include <sc_private.h>
 #include <sc_refcount.h>
+#if !defined SC_HAVE_ATOMIC_BUILTINS && defined SC_ENABLE_PTHREAD
+#include <pthread.h>
+
+static pthread_mutex_t sc_refcount_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 void
 sc_refcount_init_invalid (sc_refcount_t * rc)
@@ -93,12 +98,81 @@ sc_refcount_unref (sc_refcount_t * rc)
   }
 }
 
+void
+sc_refcount_ref_atomic (sc_refcount_t * rc)
+{
+#if defined SC_HAVE_ATOMIC_BUILTINS && defined SC_ENABLE_DEBUG
+  int                 old;
+#endif
+
+  SC_ASSERT (rc != NULL);
+
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+#ifdef SC_ENABLE_DEBUG
+  old = __atomic_fetch_add (&rc->refcount, 1, __ATOMIC_RELAXED);
+  SC_ASSERT (old > 0);
+#else
+  (void) __atomic_fetch_add (&rc->refcount, 1, __ATOMIC_RELAXED);
+#endif
+#else
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_refcount_mutex);
+#endif
+  SC_ASSERT (rc->refcount > 0);
+  ++rc->refcount;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_refcount_mutex);
+#endif
+#endif
+}
+
+int
+sc_refcount_unref_atomic (sc_refcount_t * rc)
+{
+  int                 old;
+
+  SC_ASSERT (rc != NULL);
+
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  /* publish our writes to the object before giving up the reference */
+  old = __atomic_fetch_sub (&rc->refcount, 1, __ATOMIC_RELEASE);
+  SC_ASSERT (old > 0);
+  if (old == 1) {
+    /* see the writes of all threads that released before us */
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  }
+#else
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_refcount_mutex);
+#endif
+  SC_ASSERT (rc->refcount > 0);
+  old = rc->refcount--;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_refcount_mutex);
+#endif
+#endif
+
+  if (old == 1) {
+#ifdef SC_ENABLE_DEBUG
+    sc_package_rc_count_add (rc->package_id, -1);
+#endif
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
+
 int
 sc_refcount_is_active (const sc_refcount_t * rc)
 {
   SC_ASSERT (rc != NULL);
 
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  return __atomic_load_n (&rc->refcount, __ATOMIC_ACQUIRE) > 0;
+#else
   return rc->refcount > 0;
+#endif
 }
 
 int
@@ -106,5 +180,9 @@ sc_refcount_is_last (const sc_refcount_t * rc)
 {
   SC_ASSERT (rc != NULL);
 
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  return __atomic_load_n (&rc->refcount, __ATOMIC_ACQUIRE) == 1;
+#else
   return rc->refcount == 1;
+#endif
 }
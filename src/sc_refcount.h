@@ -27,6 +27,12 @@
  * The functions in this file can be used for multiple purposes.
  * The current setup is not so much targeted at garbage collection but rather
  * intended for debugging and verification.
+ *
+ * The functions \ref sc_refcount_ref and \ref sc_refcount_unref are not
+ * thread-safe.  To share an object between threads, use the variants
+ * \ref sc_refcount_ref_atomic and \ref sc_refcount_unref_atomic for all
+ * changes of its counter.  They use atomic operations if the compiler
+ * provides them and a global mutex otherwise.
  */
 
 #ifndef SC_REFCOUNT_H
@@ -101,6 +107,24 @@ void                sc_refcount_ref (sc_refcount_t * rc);
  */
 int                 sc_refcount_unref (sc_refcount_t * rc);
 
+/** Increase a reference counter that may be changed by other threads.
+ * The caller must already hold a reference, so no memory ordering is
+ * implied.
+ * \param [in,out] rc       This reference counter must be valid (greater zero).
+ *                          Its count is increased by one atomically.
+ */
+void                sc_refcount_ref_atomic (sc_refcount_t * rc);
+
+/** Decrease a reference counter that may be changed by other threads.
+ * All writes to the shared object by any thread before its unref are
+ * visible to the thread that sees the count reach zero, which may thus
+ * destroy the object safely.
+ * \param [in,out] rc       This reference counter must be valid (greater zero).
+ *                          Its count is decreased by one atomically.
+ * \return          True if the count has reached zero, false otherwise.
+ */
+int                 sc_refcount_unref_atomic (sc_refcount_t * rc);
+
 /** Check whether a reference counter has a positive value.
  * This means that the reference counter is in use and corresponds to a live object.
  * \param [in] rc   A reference counter.
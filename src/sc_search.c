@@ -23,6 +23,12 @@
 
 #include <sc_search.h>
 
+#if defined __GNUC__ || defined __clang__
+#define SC_SEARCH_PREFETCH(p) __builtin_prefetch ((const void *) (p))
+#else
+#define SC_SEARCH_PREFETCH(p) SC_NOOP ()
+#endif
+
 int
 sc_search_bias (int maxlevel, int level, int interval, int target)
 {
@@ -141,3 +147,248 @@ sc_bsearch_range (const void *key, const void *base, size_t nmemb,
   SC_ASSERT (compar (ckey, cbase + (guess + 1) * size) < 0);
   return guess;
 }
+
+/* The branchless lower bound keeps the first candidate in base and halves
+ * the number n of remaining candidates per step.  The conditional move is
+ * compiled without a branch, and we prefetch the middle entries of both
+ * halves that the next step may look at. */
+#define SC_SEARCH_LOWER_BOUND(type,target,array,nmemb) do {             \
+  const type         *base = (array);                                   \
+  size_t              n = (nmemb), half;                                \
+                                                                        \
+  if (n == 0) {                                                         \
+    return 0;                                                           \
+  }                                                                     \
+  while (n > 1) {                                                       \
+    half = n / 2;                                                       \
+    SC_SEARCH_PREFETCH (base + half / 2);                               \
+    SC_SEARCH_PREFETCH (base + half + half / 2);                        \
+    base = (base[half] < (target)) ? base + half : base;                \
+    n -= half;                                                          \
+  }                                                                     \
+  return (size_t) (base - (array)) + (*base < (target));                \
+} while (0)
+
+size_t
+sc_search_lower_bound_int32 (int32_t target, const int32_t * array,
+                             size_t nmemb)
+{
+  SC_SEARCH_LOWER_BOUND (int32_t, target, array, nmemb);
+}
+
+size_t
+sc_search_lower_bound_int64 (int64_t target, const int64_t * array,
+                             size_t nmemb)
+{
+  SC_SEARCH_LOWER_BOUND (int64_t, target, array, nmemb);
+}
+
+size_t
+sc_search_lower_bound_double (double target, const double *array,
+                              size_t nmemb)
+{
+  SC_SEARCH_LOWER_BOUND (double, target, array, nmemb);
+}
+
+void
+sc_search_lower_bound_int64_batch (const int64_t * array, size_t nmemb,
+                                   const int64_t * targets,
+                                   size_t num_targets, size_t * bounds)
+{
+  size_t              i, lo, hi, step;
+  int64_t             target;
+
+  lo = 0;
+  for (i = 0; i < num_targets; ++i) {
+    target = targets[i];
+    SC_ASSERT (i == 0 || targets[i - 1] <= target);
+
+    /* all entries below lo are less than the target */
+    step = 1;
+    hi = lo;
+    while (hi < nmemb && array[hi] < target) {
+      lo = hi + 1;
+      hi += step;
+      step *= 2;
+    }
+    hi = SC_MIN (hi, nmemb);
+
+    /* the bound is in [lo, hi] since array[hi] >= target or hi == nmemb */
+    lo += sc_search_lower_bound_int64 (target, array + lo, hi - lo);
+    bounds[i] = lo;
+  }
+}
+
+/** Fill the tree of a search index by an in order traversal. */
+static void
+sc_search_index_fill (sc_search_index_t * index, const int64_t * array,
+                      size_t k, size_t * i)
+{
+  if (k <= index->nmemb) {
+    sc_search_index_fill (index, array, 2 * k, i);
+    index->tree[k] = array[*i];
+    index->position[k] = (*i)++;
+    sc_search_index_fill (index, array, 2 * k + 1, i);
+  }
+}
+
+sc_search_index_t  *
+sc_search_index_new (const int64_t * array, size_t nmemb)
+{
+  size_t              i;
+  sc_search_index_t  *index;
+
+  index = SC_ALLOC (sc_search_index_t, 1);
+  index->nmemb = nmemb;
+  index->tree = SC_ALLOC (int64_t, nmemb + 1);
+  index->position = SC_ALLOC (size_t, nmemb + 1);
+  index->tree[0] = 0;
+  index->position[0] = nmemb;
+
+  i = 0;
+  sc_search_index_fill (index, array, 1, &i);
+  SC_ASSERT (i == nmemb);
+
+  return index;
+}
+
+void
+sc_search_index_destroy (sc_search_index_t * index)
+{
+  SC_FREE (index->tree);
+  SC_FREE (index->position);
+  SC_FREE (index);
+}
+
+size_t
+sc_search_index_lower_bound (const sc_search_index_t * index, int64_t target)
+{
+  const int64_t      *tree = index->tree;
+  size_t              k;
+
+  /* descend to a leaf, going right whenever the entry is too small;
+   * the sixteen descendants four levels below occupy two cache lines */
+  k = 1;
+  while (k <= index->nmemb) {
+    SC_SEARCH_PREFETCH (tree + 16 * k);
+    k = 2 * k + (tree[k] < target);
+  }
+
+  /* undo the right turns at the end and the left turn before them */
+#if defined __GNUC__ || defined __clang__
+  k >>= __builtin_ctzll (~(unsigned long long) k) + 1;
+#else
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+#endif
+
+  /* the node 0 stands for no entry and maps to nmemb */
+  return index->position[k];
+}
+
+sc_search_partition_t *
+sc_search_partition_new (const int64_t * offsets, int num_procs)
+{
+  int                 p, span;
+  size_t              b;
+  uint64_t            total;
+  int64_t             start;
+  sc_search_partition_t *part;
+
+  SC_ASSERT (offsets != NULL);
+  SC_ASSERT (num_procs > 0);
+  SC_ASSERT (offsets[0] <= offsets[num_procs]);
+
+  part = SC_ALLOC (sc_search_partition_t, 1);
+  part->num_procs = num_procs;
+  part->offsets = offsets;
+  part->first = offsets[0];
+  part->shift = 0;
+  part->max_span = 0;
+
+  /* choose the bucket width such that there are at most two per process */
+  total = (uint64_t) (offsets[num_procs] - offsets[0]);
+  if (total == 0) {
+    part->num_buckets = 0;
+    part->bucket = SC_ALLOC_ZERO (int, 1);
+    return part;
+  }
+  while (((total - 1) >> part->shift) >= 2 * (uint64_t) num_procs) {
+    ++part->shift;
+  }
+  part->num_buckets = (size_t) ((total - 1) >> part->shift) + 1;
+  part->bucket = SC_ALLOC (int, part->num_buckets + 1);
+
+  /* the bucket starts are increasing, so is their owner */
+  p = 0;
+  for (b = 0; b < part->num_buckets; ++b) {
+    start = part->first + (int64_t) ((uint64_t) b << part->shift);
+    while (offsets[p + 1] <= start) {
+      ++p;
+    }
+    SC_ASSERT (p < num_procs);
+    part->bucket[b] = p;
+  }
+
+  /* the owner of the last position closes the last bucket */
+  start = offsets[num_procs] - 1;
+  while (offsets[p + 1] <= start) {
+    ++p;
+  }
+  part->bucket[b] = p;
+
+  /* record the skew of the partition */
+  for (b = 0; b < part->num_buckets; ++b) {
+    span = part->bucket[b + 1] - part->bucket[b];
+    part->max_span = SC_MAX (part->max_span, span);
+  }
+
+  return part;
+}
+
+void
+sc_search_partition_destroy (sc_search_partition_t * part)
+{
+  SC_FREE (part->bucket);
+  SC_FREE (part);
+}
+
+int
+sc_search_partition_owner (const sc_search_partition_t * part,
+                           int64_t global)
+{
+  size_t              b;
+  int                 lo, hi;
+
+  SC_ASSERT (part->first <= global);
+  SC_ASSERT (global < part->offsets[part->num_procs]);
+
+  b = (size_t) ((uint64_t) (global - part->first) >> part->shift);
+  SC_ASSERT (b < part->num_buckets);
+  lo = part->bucket[b];
+  hi = part->bucket[b + 1];
+
+  /* count the offsets of the processes lo + 1 to hi not beyond global */
+  return lo + (int) sc_search_lower_bound_int64
+    (global + 1, part->offsets + lo + 1, (size_t) (hi - lo));
+}
+
+void
+sc_search_partition_owners (const sc_search_partition_t * part,
+                            const int64_t * globals, size_t num_globals,
+                            int *owners)
+{
+  const size_t        ahead = 8;
+  size_t              i;
+
+  for (i = 0; i < num_globals; ++i) {
+    if (i + ahead < num_globals) {
+      SC_SEARCH_PREFETCH (part->bucket +
+                          ((uint64_t) (globals[i + ahead] - part->first) >>
+                           part->shift));
+    }
+    owners[i] = sc_search_partition_owner (part, globals[i]);
+  }
+}
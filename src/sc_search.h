@@ -67,6 +67,157 @@ size_t              sc_bsearch_range (const void *key, const void *base,
                                       int (*compar) (const void *,
                                                      const void *));
 
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * The search runs without data dependent branches and prefetches both
+ * candidates of the next step, which makes its run time nearly
+ * independent of the target and faster than a bisection for large arrays.
+ * \param [in]  target  The target lower bound to search for.
+ * \param [in]  array   The array sorted in ascending order.
+ * \param [in]  nmemb   The number of entries in the array.
+ * \return              The lowest position k with array[k] >= target,
+ *                      or nmemb if array[nmemb - 1] < target or nmemb == 0.
+ */
+size_t              sc_search_lower_bound_int32 (int32_t target,
+                                                 const int32_t * array,
+                                                 size_t nmemb);
+
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * \see sc_search_lower_bound_int32.
+ */
+size_t              sc_search_lower_bound_int64 (int64_t target,
+                                                 const int64_t * array,
+                                                 size_t nmemb);
+
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * The array must not contain NaN values.
+ * \see sc_search_lower_bound_int32.
+ */
+size_t              sc_search_lower_bound_double (double target,
+                                                  const double *array,
+                                                  size_t nmemb);
+
+/** Find the lower bounds of many sorted targets in one pass.
+ * Starting at the bound of the previous target, we locate the bound of
+ * the next one by an exponential search, such that the cost grows with
+ * the logarithm of the distance between consecutive bounds.
+ * \param [in]  array       The array sorted in ascending order.
+ * \param [in]  nmemb       The number of entries in the array.
+ * \param [in]  targets     The targets sorted in ascending order.
+ * \param [in]  num_targets The number of targets.
+ * \param [out] bounds      For each target the result of
+ *                          \ref sc_search_lower_bound_int64.
+ */
+void                sc_search_lower_bound_int64_batch (const int64_t * array,
+                                                       size_t nmemb,
+                                                       const int64_t *
+                                                       targets,
+                                                       size_t num_targets,
+                                                       size_t * bounds);
+
+/** A search index in Eytzinger layout over a sorted int64_t array.
+ * The entries are stored in the order of a breadth first traversal of
+ * the implicit binary search tree.  The first levels of the tree share
+ * few cache lines and the children of a node are adjacent in memory,
+ * which allows to prefetch several levels ahead.
+ */
+typedef struct sc_search_index
+{
+  size_t              nmemb;    /**< Number of entries. */
+  int64_t            *tree;     /**< Entries 1 to nmemb in tree order. */
+  size_t             *position; /**< Array position of each tree entry. */
+}
+sc_search_index_t;
+
+/** Build a search index over a sorted array.
+ * \param [in]  array   The array sorted in ascending order.
+ *                      It is copied and may be changed afterwards.
+ * \param [in]  nmemb   The number of entries in the array.
+ * \return              The index, to be destroyed by
+ *                      \ref sc_search_index_destroy.
+ */
+sc_search_index_t  *sc_search_index_new (const int64_t * array, size_t nmemb);
+
+/** Destroy a search index.
+ * \param [in,out] index        Its memory is freed.
+ */
+void                sc_search_index_destroy (sc_search_index_t * index);
+
+/** Find lowest position k in the indexed array with array[k] >= target.
+ * \param [in]  index   Built by \ref sc_search_index_new.
+ * \param [in]  target  The target lower bound to search for.
+ * \return              The same result as \ref sc_search_lower_bound_int64.
+ */
+size_t              sc_search_index_lower_bound (const sc_search_index_t *
+                                                 index, int64_t target);
+
+/** An index to find the owner of a global position in a partition.
+ * The partition is given by cumulative offsets of size num_procs + 1,
+ * where process p owns the positions offsets[p] <= g < offsets[p + 1].
+ * We divide the range of positions into a power of two many buckets of
+ * equal width and store the owner of the first position in each bucket.
+ * A query computes its bucket by a shift and bisects only the offsets
+ * between the owners of this and the next bucket.  For a balanced
+ * partition this range contains one or two processes.  A skewed partition
+ * with many small processes in one bucket falls back to a bisection over
+ * these processes.
+ */
+typedef struct sc_search_partition
+{
+  int                 num_procs;        /**< Number of processes. */
+  const int64_t      *offsets;  /**< The cumulative offsets. */
+  int64_t             first;    /**< The first position offsets[0]. */
+  int                 shift;    /**< Logarithm of the bucket width. */
+  size_t              num_buckets;      /**< Number of buckets. */
+  int                *bucket;   /**< The owners of the first position of
+                                     each bucket, followed by the owner
+                                     of the last position. */
+  int                 max_span; /**< The maximum number of processes
+                                     searched by bisection in a query. */
+}
+sc_search_partition_t;
+
+/** Build an owner index for a partition.
+ * Building takes O(num_procs) time and memory.
+ * \param [in] offsets  Array of num_procs + 1 non-decreasing offsets.
+ *                      It is not copied and must stay unchanged
+ *                      while the index is in use.
+ * \param [in] num_procs        The number of processes, at least one.
+ * \return              The index, to be destroyed by
+ *                      \ref sc_search_partition_destroy.
+ */
+sc_search_partition_t *sc_search_partition_new (const int64_t * offsets,
+                                                int num_procs);
+
+/** Destroy an owner index.
+ * \param [in,out] part         Its memory is freed.
+ */
+void                sc_search_partition_destroy (sc_search_partition_t *
+                                                 part);
+
+/** Find the owner of a global position.
+ * \param [in] part     The index built by \ref sc_search_partition_new.
+ * \param [in] global   Position with offsets[0] <= global and
+ *                      global < offsets[num_procs].
+ * \return              The unique process p with nonzero count that
+ *                      satisfies offsets[p] <= global < offsets[p + 1].
+ */
+int                 sc_search_partition_owner (const sc_search_partition_t *
+                                               part, int64_t global);
+
+/** Find the owners of many global positions.
+ * The positions need not be sorted.  We prefetch the buckets of upcoming
+ * positions to overlap their memory accesses.
+ * \param [in] part     The index built by \ref sc_search_partition_new.
+ * \param [in] globals  Array of positions, each valid for
+ *                      \ref sc_search_partition_owner.
+ * \param [in] num_globals      The number of positions.
+ * \param [out] owners  Array of num_globals owner processes.
+ */
+void                sc_search_partition_owners (const sc_search_partition_t *
+                                                part, const int64_t * globals,
+                                                size_t num_globals,
+                                                int *owners);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_SEARCH_H */
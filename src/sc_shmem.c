@@ -926,3 +926,51 @@ sc_shmem_prefix (void *sendbuf, void *recvbuf, int count,
     SC_ABORT_NOT_REACHED ();
   }
 }
+
+/** The communicator is stored next to the allocator it belongs to. */
+typedef struct sc_shmem_allocator
+{
+  sc_allocator_t      allocator;
+  sc_MPI_Comm         comm;
+}
+sc_shmem_allocator_t;
+
+static void        *
+sc_shmem_allocator_realloc (sc_allocator_t * allocator, void *ptr,
+                            size_t old_size, size_t new_size)
+{
+  sc_shmem_allocator_t *sa = (sc_shmem_allocator_t *) allocator->user;
+  void               *p = NULL;
+
+  /* shmem arrays cannot grow in place, so we allocate and copy */
+  if (new_size > 0) {
+    p = sc_shmem_malloc (sc_package_id, 1, new_size, sa->comm);
+    if (ptr != NULL) {
+      sc_shmem_memcpy (p, ptr, SC_MIN (old_size, new_size), sa->comm);
+    }
+  }
+  if (ptr != NULL) {
+    sc_shmem_free (sc_package_id, ptr, sa->comm);
+  }
+  return p;
+}
+
+sc_allocator_t     *
+sc_shmem_allocator_new (sc_MPI_Comm comm)
+{
+  sc_shmem_allocator_t *sa;
+
+  sa = SC_ALLOC_ZERO (sc_shmem_allocator_t, 1);
+  sa->allocator.realloc_fn = sc_shmem_allocator_realloc;
+  sa->allocator.user = sa;
+  sa->allocator.shared = 1;
+  sa->comm = comm;
+
+  return &sa->allocator;
+}
+
+void
+sc_shmem_allocator_destroy (sc_allocator_t * allocator)
+{
+  SC_FREE (allocator->user);
+}
@@ -26,6 +26,7 @@
 
 #include <sc.h>
 #include <sc_mpi.h>
+#include <sc_containers.h>
 
 SC_EXTERN_C_BEGIN;
 
@@ -164,6 +165,26 @@ void                sc_shmem_allgather (void *sendbuf, int sendcount,
 void                sc_shmem_prefix (void *sendbuf, void *recvbuf,
                                      int count, sc_MPI_Datatype type,
                                      sc_MPI_Op op, sc_MPI_Comm comm);
+
+/** Create an allocator that provides shmem arrays on a communicator.
+ * An sc_array_t initialized with it by \ref sc_array_init_allocator
+ * keeps its data in shared memory of the type set for \a comm.
+ * Every resize of such an array is collective on \a comm and must request
+ * the same size on all processes.  The contents may only be written
+ * between \ref sc_shmem_write_start and \ref sc_shmem_write_end.
+ *
+ * \param[in] comm            the mpi communicator
+ * \return                    an allocator with the shared flag set
+ */
+sc_allocator_t     *sc_shmem_allocator_new (sc_MPI_Comm comm);
+
+/** Destroy an allocator created by \ref sc_shmem_allocator_new.
+ * All arrays using it must have been reset or destroyed before.
+ *
+ * \param[in] allocator       the allocator to be destroyed
+ */
+void                sc_shmem_allocator_destroy (sc_allocator_t * allocator);
+
 SC_EXTERN_C_END;
 
 #endif /* SC_SHMEM_H */
@@ -34,6 +34,14 @@ sc_stats_mpifunc (void *invec, void *inoutvec, int *len,
   double             *inout = (double *) inoutvec;
 
   for (i = 0; i < *len; ++i) {
+    /* take over all statistics if there is no count yet */
+    if (!inout[0]) {
+      memcpy (inout, in, 7 * sizeof (double));
+      in += 7;
+      inout += 7;
+      continue;
+    }
+
     /* sum count, values and their squares */
     inout[0] += in[0];
     if (in[0]) {                /* ignore statistics when no count */
@@ -319,7 +327,7 @@ sc_statistics_new (sc_MPI_Comm mpicomm)
 
   stats = SC_ALLOC (sc_statistics_t, 1);
   stats->mpicomm = mpicomm;
-  stats->kv = sc_keyvalue_new ();
+  stats->kv = sc_keyvalue_new_storage (SC_KEYVALUE_STORAGE_FLAT);
   stats->sarray = sc_array_new (sizeof (sc_statinfo_t));
 
   return stats;
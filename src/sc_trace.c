@@ -0,0 +1,559 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_trace.h>
+#include <sc_private.h>
+#include <sc_profile.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+/** The records of one thread that have not been written yet. */
+typedef struct sc_trace_buffer
+{
+  size_t              used;
+  int                 thread;
+  sc_trace_record_t  *records;
+  struct sc_trace_buffer *next;
+}
+sc_trace_buffer_t;
+
+/** A log statement that has been assigned an event id. */
+typedef struct sc_trace_site
+{
+  const char         *filename;
+  int                 lineno;
+  int                 event;
+}
+sc_trace_site_t;
+
+int                 sc_trace_active = 0;
+int                 sc_trace_logging = 0;
+
+static FILE        *sc_trace_stream = NULL;
+static size_t       sc_trace_size = 0;
+static int          sc_trace_num_threads = 0;
+static sc_trace_buffer_t *sc_trace_buffers = NULL;
+static sc_array_t  *sc_trace_names = NULL;
+
+/* open addressing table of the log statements seen so far */
+static size_t       sc_trace_num_sites = 0;
+static size_t       sc_trace_sites_alloc = 0;
+static sc_trace_site_t *sc_trace_sites = NULL;
+
+#ifdef SC_ENABLE_PTHREAD
+/* the trace mutex protects the stream, the buffer list and the names */
+static pthread_mutex_t sc_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t sc_trace_key;
+#endif
+
+static void
+sc_trace_lock (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_trace_mutex);
+#endif
+}
+
+static void
+sc_trace_unlock (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_trace_mutex);
+#endif
+}
+
+/** Write the records of a buffer and empty it. */
+static void
+sc_trace_write (sc_trace_buffer_t * buf)
+{
+  size_t              written;
+
+  if (buf->used > 0) {
+    sc_trace_lock ();
+    written = fwrite (buf->records, sizeof (sc_trace_record_t),
+                      buf->used, sc_trace_stream);
+    sc_trace_unlock ();
+    SC_CHECK_ABORT (written == buf->used, "Trace file write");
+    buf->used = 0;
+  }
+}
+
+/** Return the buffer of the calling thread, creating it if necessary. */
+static sc_trace_buffer_t *
+sc_trace_buffer (void)
+{
+  sc_trace_buffer_t  *buf;
+
+#ifdef SC_ENABLE_PTHREAD
+  buf = (sc_trace_buffer_t *) pthread_getspecific (sc_trace_key);
+#else
+  buf = sc_trace_buffers;
+#endif
+  if (buf == NULL) {
+    buf = SC_ALLOC (sc_trace_buffer_t, 1);
+    buf->used = 0;
+    buf->records = SC_ALLOC (sc_trace_record_t, sc_trace_size);
+#ifdef SC_ENABLE_PTHREAD
+    pthread_setspecific (sc_trace_key, buf);
+#endif
+    sc_trace_lock ();
+    buf->thread = sc_trace_num_threads++;
+    buf->next = sc_trace_buffers;
+    sc_trace_buffers = buf;
+    sc_trace_unlock ();
+  }
+
+  return buf;
+}
+
+void
+sc_trace_open (const char *prefix, sc_MPI_Comm mpicomm,
+               size_t buffer_size, int log_events)
+{
+  int                 mpiret;
+  int                 rank;
+  size_t              written;
+  char                buffer[BUFSIZ];
+  sc_trace_header_t   header;
+
+  SC_CHECK_ABORT (!sc_trace_active, "Trace already open");
+
+  rank = 0;
+  if (mpicomm != sc_MPI_COMM_NULL) {
+    mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+    SC_CHECK_MPI (mpiret);
+    snprintf (buffer, BUFSIZ, "%s.%d.sctrace", prefix, rank);
+  }
+  else {
+    snprintf (buffer, BUFSIZ, "%s.sctrace", prefix);
+  }
+  sc_trace_stream = fopen (buffer, "wb");
+  SC_CHECK_ABORTF (sc_trace_stream != NULL, "Trace file open %s", buffer);
+
+  memset (&header, 0, sizeof (sc_trace_header_t));
+  strncpy (header.magic, SC_TRACE_MAGIC, 8);
+  header.version = SC_TRACE_VERSION;
+  header.rank = (int32_t) rank;
+  written = fwrite (&header, sizeof (sc_trace_header_t), 1, sc_trace_stream);
+  SC_CHECK_ABORT (written == 1, "Trace file write");
+
+  sc_trace_size = buffer_size > 0 ? buffer_size : 4096;
+  sc_trace_num_threads = 0;
+  sc_trace_buffers = NULL;
+  sc_trace_names = sc_array_new (sizeof (char *));
+#ifdef SC_ENABLE_PTHREAD
+  mpiret = pthread_key_create (&sc_trace_key, NULL);
+  SC_CHECK_ABORT (mpiret == 0, "Fail in pthread_key_create");
+#endif
+
+  sc_trace_logging = log_events;
+  sc_trace_active = 1;
+}
+
+void
+sc_trace_close (void)
+{
+  int                 retval;
+  size_t              zz, written;
+  int32_t             id_len[2];
+  char              **name;
+  sc_trace_buffer_t  *buf;
+  sc_trace_record_t   end;
+
+  if (!sc_trace_active) {
+    return;
+  }
+  sc_trace_active = 0;
+  sc_trace_logging = 0;
+
+  while ((buf = sc_trace_buffers) != NULL) {
+    sc_trace_write (buf);
+    sc_trace_buffers = buf->next;
+    SC_FREE (buf->records);
+    SC_FREE (buf);
+  }
+#ifdef SC_ENABLE_PTHREAD
+  retval = pthread_key_delete (sc_trace_key);
+  SC_CHECK_ABORT (retval == 0, "Fail in pthread_key_delete");
+#endif
+
+  /* the end record is followed by the event names */
+  memset (&end, 0, sizeof (sc_trace_record_t));
+  end.type = SC_TRACE_NAMES;
+  end.event = (int32_t) sc_trace_names->elem_count;
+  written = fwrite (&end, sizeof (sc_trace_record_t), 1, sc_trace_stream);
+  SC_CHECK_ABORT (written == 1, "Trace file write");
+  for (zz = 0; zz < sc_trace_names->elem_count; ++zz) {
+    name = (char **) sc_array_index (sc_trace_names, zz);
+    id_len[0] = (int32_t) zz;
+    id_len[1] = (int32_t) strlen (*name);
+    written = fwrite (id_len, sizeof (int32_t), 2, sc_trace_stream);
+    SC_CHECK_ABORT (written == 2, "Trace file write");
+    written = fwrite (*name, 1, (size_t) id_len[1], sc_trace_stream);
+    SC_CHECK_ABORT (written == (size_t) id_len[1], "Trace file write");
+    SC_FREE (*name);
+  }
+  sc_array_destroy (sc_trace_names);
+  sc_trace_names = NULL;
+
+  SC_FREE (sc_trace_sites);
+  sc_trace_sites = NULL;
+  sc_trace_num_sites = sc_trace_sites_alloc = 0;
+
+  retval = fclose (sc_trace_stream);
+  SC_CHECK_ABORT (!retval, "Trace file close");
+  sc_trace_stream = NULL;
+}
+
+/** Append a name to the event table.  The caller holds the lock. */
+static int
+sc_trace_event_add (const char *name)
+{
+  *(char **) sc_array_push (sc_trace_names) = SC_STRDUP (name);
+  return (int) sc_trace_names->elem_count - 1;
+}
+
+int
+sc_trace_event (const char *name)
+{
+  int                 event;
+  size_t              zz;
+
+  if (!sc_trace_active) {
+    return -1;
+  }
+
+  sc_trace_lock ();
+  event = -1;
+  for (zz = 0; zz < sc_trace_names->elem_count; ++zz) {
+    if (!strcmp (*(char **) sc_array_index (sc_trace_names, zz), name)) {
+      event = (int) zz;
+      break;
+    }
+  }
+  if (event == -1) {
+    event = sc_trace_event_add (name);
+  }
+  sc_trace_unlock ();
+
+  return event;
+}
+
+void
+sc_trace_record (int package, int event, int type, double value)
+{
+  sc_trace_buffer_t  *buf;
+  sc_trace_record_t  *rec;
+
+  if (!sc_trace_active) {
+    return;
+  }
+
+  buf = sc_trace_buffer ();
+  if (buf->used == sc_trace_size) {
+    sc_trace_write (buf);
+  }
+  rec = buf->records + buf->used++;
+  rec->time = sc_profile_clock_ns ();
+  rec->value = value;
+  rec->package = (int32_t) package;
+  rec->event = (int32_t) event;
+  rec->thread = (int32_t) buf->thread;
+  rec->type = (int32_t) type;
+}
+
+void
+sc_trace_flops (int package, int event, const sc_flopinfo_t * snapshot)
+{
+  sc_trace_buffer_t  *buf;
+  sc_trace_record_t  *rec;
+  uint64_t            now;
+
+  if (!sc_trace_active) {
+    return;
+  }
+
+  buf = sc_trace_buffer ();
+  if (buf->used + 2 > sc_trace_size) {
+    sc_trace_write (buf);
+  }
+  now = sc_profile_clock_ns ();
+
+  /* the region begins at the time of the previous snapshot */
+  rec = buf->records + buf->used++;
+  rec->time = now - (uint64_t) (snapshot->iwtime * 1.e9);
+  rec->value = snapshot->iwtime;
+  rec->package = (int32_t) package;
+  rec->event = (int32_t) event;
+  rec->thread = (int32_t) buf->thread;
+  rec->type = SC_TRACE_COMPLETE;
+
+  rec = buf->records + buf->used++;
+  rec->time = now;
+  rec->value = snapshot->mflops;
+  rec->package = (int32_t) package;
+  rec->event = (int32_t) event;
+  rec->thread = (int32_t) buf->thread;
+  rec->type = SC_TRACE_COUNTER;
+}
+
+/** Hash a log statement into the open addressing table. */
+static size_t
+sc_trace_site_hash (const char *filename, int lineno)
+{
+  return (((size_t) filename >> 3) ^ ((size_t) lineno * 2654435761U)) &
+    (sc_trace_sites_alloc - 1);
+}
+
+void
+sc_trace_log (const char *filename, int lineno,
+              int package, int category, int priority)
+{
+  int                 event;
+  size_t              zz, h, old_alloc;
+  char                buffer[BUFSIZ];
+  sc_trace_site_t    *site, *old_sites;
+
+  if (!sc_trace_logging) {
+    return;
+  }
+
+  sc_trace_lock ();
+  if (2 * (sc_trace_num_sites + 1) > sc_trace_sites_alloc) {
+    /* keep the table at most half full */
+    old_sites = sc_trace_sites;
+    old_alloc = sc_trace_sites_alloc;
+    sc_trace_sites_alloc = old_alloc > 0 ? 2 * old_alloc : 64;
+    sc_trace_sites = SC_ALLOC_ZERO (sc_trace_site_t, sc_trace_sites_alloc);
+    for (zz = 0; zz < old_alloc; ++zz) {
+      if (old_sites[zz].filename != NULL) {
+        h = sc_trace_site_hash (old_sites[zz].filename,
+                                old_sites[zz].lineno);
+        while (sc_trace_sites[h].filename != NULL) {
+          h = (h + 1) & (sc_trace_sites_alloc - 1);
+        }
+        sc_trace_sites[h] = old_sites[zz];
+      }
+    }
+    SC_FREE (old_sites);
+  }
+  h = sc_trace_site_hash (filename, lineno);
+  for (;;) {
+    site = sc_trace_sites + h;
+    if (site->filename == NULL) {
+      snprintf (buffer, BUFSIZ, "%s:%d", filename, lineno);
+      site->filename = filename;
+      site->lineno = lineno;
+      site->event = sc_trace_event_add (buffer);
+      ++sc_trace_num_sites;
+      break;
+    }
+    if (site->filename == filename && site->lineno == lineno) {
+      break;
+    }
+    h = (h + 1) & (sc_trace_sites_alloc - 1);
+  }
+  event = site->event;
+  sc_trace_unlock ();
+
+  sc_trace_record (package, event, SC_TRACE_INSTANT, (double) priority);
+}
+
+/** Write a string with the escapes required by JSON. */
+static void
+sc_trace_json_string (FILE * out, const char *s)
+{
+  fputc ('"', out);
+  for (; *s != '\0'; ++s) {
+    if (*s == '"' || *s == '\\') {
+      fputc ('\\', out);
+      fputc (*s, out);
+    }
+    else if ((unsigned char) *s < 0x20) {
+      fprintf (out, "\\u%04x", (unsigned) (unsigned char) *s);
+    }
+    else {
+      fputc (*s, out);
+    }
+  }
+  fputc ('"', out);
+}
+
+/** The contents of one trace file. */
+typedef struct sc_trace_file_data
+{
+  sc_trace_header_t   header;
+  sc_array_t         *records;
+  sc_array_t         *names;
+}
+sc_trace_file_data_t;
+
+/** Read a trace file.  Return 0 on success and -1 otherwise. */
+static int
+sc_trace_read (const char *filename, sc_trace_file_data_t * data)
+{
+  int                 i, retval;
+  int32_t             id_len[2];
+  char               *name;
+  FILE               *file;
+  sc_trace_record_t   rec;
+
+  data->records = sc_array_new (sizeof (sc_trace_record_t));
+  data->names = sc_array_new (sizeof (char *));
+  file = fopen (filename, "rb");
+  if (file == NULL) {
+    SC_LERRORF ("Trace file open %s\n", filename);
+    return -1;
+  }
+  retval = -1;
+  if (fread (&data->header, sizeof (sc_trace_header_t), 1, file) != 1 ||
+      strncmp (data->header.magic, SC_TRACE_MAGIC, 8) ||
+      data->header.version != SC_TRACE_VERSION) {
+    SC_LERRORF ("Not a trace file %s\n", filename);
+    goto sc_trace_read_end;
+  }
+  for (;;) {
+    if (fread (&rec, sizeof (sc_trace_record_t), 1, file) != 1) {
+      SC_LERRORF ("Trace file %s ends without names\n", filename);
+      goto sc_trace_read_end;
+    }
+    if (rec.type == SC_TRACE_NAMES) {
+      break;
+    }
+    *(sc_trace_record_t *) sc_array_push (data->records) = rec;
+  }
+  if (rec.event < 0) {
+    SC_LERRORF ("Trace file %s has invalid names\n", filename);
+    goto sc_trace_read_end;
+  }
+  sc_array_resize (data->names, (size_t) rec.event);
+  memset (data->names->array, 0, data->names->elem_count * sizeof (char *));
+  for (i = 0; i < rec.event; ++i) {
+    if (fread (id_len, sizeof (int32_t), 2, file) != 2 ||
+        id_len[0] < 0 || id_len[0] >= rec.event || id_len[1] < 0) {
+      SC_LERRORF ("Trace file %s has invalid names\n", filename);
+      goto sc_trace_read_end;
+    }
+    name = SC_ALLOC (char, id_len[1] + 1);
+    if (fread (name, 1, (size_t) id_len[1], file) != (size_t) id_len[1]) {
+      SC_FREE (name);
+      SC_LERRORF ("Trace file %s has invalid names\n", filename);
+      goto sc_trace_read_end;
+    }
+    name[id_len[1]] = '\0';
+    SC_FREE (*(char **) sc_array_index_int (data->names, id_len[0]));
+    *(char **) sc_array_index_int (data->names, id_len[0]) = name;
+  }
+  retval = 0;
+
+sc_trace_read_end:
+  fclose (file);
+  return retval;
+}
+
+int
+sc_trace_convert_json (int num_files, const char **filenames, FILE * out)
+{
+  int                 i, retval;
+  int                 first;
+  size_t              zz;
+  uint64_t            origin;
+  const char         *name;
+  sc_trace_file_data_t *data;
+  sc_trace_record_t  *rec;
+
+  data = SC_ALLOC (sc_trace_file_data_t, num_files);
+  retval = 0;
+  origin = 0;
+  first = 1;
+  for (i = 0; i < num_files; ++i) {
+    if (retval == 0) {
+      retval = sc_trace_read (filenames[i], data + i);
+    }
+    else {
+      data[i].records = sc_array_new (sizeof (sc_trace_record_t));
+      data[i].names = sc_array_new (sizeof (char *));
+    }
+    for (zz = 0; retval == 0 && zz < data[i].records->elem_count; ++zz) {
+      rec = (sc_trace_record_t *) sc_array_index (data[i].records, zz);
+      if (first || rec->time < origin) {
+        origin = rec->time;
+        first = 0;
+      }
+    }
+  }
+
+  if (retval == 0) {
+    fprintf (out, "{\"traceEvents\":[\n");
+    first = 1;
+    for (i = 0; i < num_files; ++i) {
+      fprintf (out, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+               "\"args\":{\"name\":\"rank %d\"}}", first ? "" : ",\n",
+               (int) data[i].header.rank, (int) data[i].header.rank);
+      first = 0;
+      for (zz = 0; zz < data[i].records->elem_count; ++zz) {
+        rec = (sc_trace_record_t *) sc_array_index (data[i].records, zz);
+        name = NULL;
+        if (rec->event >= 0 &&
+            (size_t) rec->event < data[i].names->elem_count) {
+          name = *(char **) sc_array_index_int (data[i].names, rec->event);
+        }
+        fprintf (out, ",\n{\"name\":");
+        sc_trace_json_string (out, name != NULL ? name : "unknown");
+        fprintf (out, ",\"cat\":\"package %d\",\"ph\":\"%c\","
+                 "\"ts\":%.3f,\"pid\":%d,\"tid\":%d",
+                 (int) rec->package, (char) rec->type,
+                 (rec->time - origin) * 1.e-3,
+                 (int) data[i].header.rank, (int) rec->thread);
+        switch (rec->type) {
+        case SC_TRACE_COMPLETE:
+          fprintf (out, ",\"dur\":%.3f", rec->value * 1.e6);
+          break;
+        case SC_TRACE_INSTANT:
+          fprintf (out, ",\"s\":\"t\",\"args\":{\"value\":%.17g}",
+                   rec->value);
+          break;
+        case SC_TRACE_COUNTER:
+          fprintf (out, ",\"args\":{\"value\":%.17g}", rec->value);
+          break;
+        default:
+          break;
+        }
+        fprintf (out, "}");
+      }
+    }
+    fprintf (out, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  }
+
+  for (i = 0; i < num_files; ++i) {
+    for (zz = 0; zz < data[i].names->elem_count; ++zz) {
+      SC_FREE (*(char **) sc_array_index (data[i].names, zz));
+    }
+    sc_array_destroy (data[i].names);
+    sc_array_destroy (data[i].records);
+  }
+  SC_FREE (data);
+
+  return retval;
+}
@@ -0,0 +1,169 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_trace.h
+ * Binary stream of timeline events.
+ *
+ * Between \ref sc_trace_open and \ref sc_trace_close, every process
+ * writes timestamped events to a binary file of its own.  An event is
+ * the begin or end of a region, an instant, a counter value or a
+ * complete region of known duration.  Each thread appends fixed size
+ * records to a buffer of its own, which is written to the file in one
+ * piece when it is full, so recording an event is cheap.  Events are
+ * identified by small integers obtained from \ref sc_trace_event.
+ * Optionally, every log message that is written produces an instant
+ * event named by its file and line.  \ref sc_trace_convert_json turns
+ * the files of all processes into the JSON trace event format that
+ * timeline viewers such as chrome://tracing and Perfetto understand.
+ *
+ * The file begins with a \ref sc_trace_header_t, followed by the
+ * records, an end record of type \ref SC_TRACE_NAMES whose event
+ * member is the number of event names, and the names.  Each name is
+ * stored as two int32_t, the event id and the string length, followed
+ * by the characters without a terminating zero.  All numbers are stored
+ * in the byte order of the writing machine.
+ */
+
+#ifndef SC_TRACE_H
+#define SC_TRACE_H
+
+#include <sc_flops.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** The magic string at the beginning of a trace file. */
+#define SC_TRACE_MAGIC "SCTRACE"
+#define SC_TRACE_VERSION 1
+
+/** Event types, chosen to match the phases of the JSON trace format. */
+#define SC_TRACE_NAMES     0    /**< end of the records */
+#define SC_TRACE_BEGIN   'B'    /**< begin of a region */
+#define SC_TRACE_END     'E'    /**< end of the innermost region */
+#define SC_TRACE_INSTANT 'i'    /**< an event without duration */
+#define SC_TRACE_COUNTER 'C'    /**< value of a counter */
+#define SC_TRACE_COMPLETE 'X'   /**< a region, value is its duration in s */
+
+/** The file header. */
+typedef struct sc_trace_header
+{
+  char                magic[8];
+  int32_t             version;
+  int32_t             rank;     /**< MPI rank or 0 without communicator */
+}
+sc_trace_header_t;
+
+/** One event of 32 bytes. */
+typedef struct sc_trace_record
+{
+  uint64_t            time;     /**< nanoseconds on a monotonic clock */
+  double              value;    /**< payload, depends on the type */
+  int32_t             package;  /**< id of the emitting package or -1 */
+  int32_t             event;    /**< id from sc_trace_event */
+  int32_t             thread;   /**< 0 for the first recording thread */
+  int32_t             type;     /**< one of the event types above */
+}
+sc_trace_record_t;
+
+/** True between \ref sc_trace_open and \ref sc_trace_close. */
+extern int          sc_trace_active;
+
+/** Begin writing trace events.
+ * May be called after sc_init and before any threads record events.
+ * \param [in] prefix       Each process writes to prefix.<rank>.sctrace,
+ *                          or prefix.sctrace if mpicomm is NULL.
+ * \param [in] mpicomm      Communicator that determines the rank.
+ * \param [in] buffer_size  Number of records buffered per thread,
+ *                          or 0 for a default of 4096.
+ * \param [in] log_events   If true, every log message written by
+ *                          sc_log adds an instant event whose name is
+ *                          the file and line of the log statement and
+ *                          whose value is its priority.
+ */
+void                sc_trace_open (const char *prefix, sc_MPI_Comm mpicomm,
+                                   size_t buffer_size, int log_events);
+
+/** Write all buffered events and the event names and close the file.
+ * No other thread may record events while this function is running.
+ * The event ids become invalid.  \ref sc_finalize calls this function.
+ * Does nothing if \ref sc_trace_open has not been called.
+ */
+void                sc_trace_close (void);
+
+/** Return the id of an event name, registering it if it is new.
+ * This function is thread safe.
+ * \param [in] name         Name of the event, is copied.
+ * \return                  Nonnegative id, or -1 if tracing is inactive.
+ */
+int                 sc_trace_event (const char *name);
+
+/** Append an event to the buffer of the calling thread.
+ * Does nothing if tracing is inactive.
+ * \param [in] package      Id of the recording package or -1.
+ * \param [in] event        Id returned by \ref sc_trace_event.
+ * \param [in] type         One of the event types above.
+ * \param [in] value        Payload of the event.
+ */
+void                sc_trace_record (int package, int event, int type,
+                                     double value);
+
+/** Record a complete region covering the last interval of a snapshot.
+ * The region ends now and lasts snapshot->iwtime seconds.  In addition,
+ * the interval MFlop/s rate is recorded as a counter of the same name.
+ * \param [in] package      Id of the recording package or -1.
+ * \param [in] event        Id returned by \ref sc_trace_event.
+ * \param [in] snapshot     Updated by \ref sc_flops_shot before.
+ */
+void                sc_trace_flops (int package, int event,
+                                    const sc_flopinfo_t * snapshot);
+
+/** Convert trace files into the JSON trace event format.
+ * The timestamps are shifted such that the earliest event is at zero.
+ * The process ids of the output are the ranks stored in the files and
+ * the thread ids are the thread numbers of the records.
+ * \param [in] num_files    Number of trace files.
+ * \param [in] filenames    Names of the trace files.
+ * \param [in,out] out      Stream to write the JSON document to.
+ * \return                  0 on success, -1 if a file cannot be read
+ *                          or is not a valid trace.
+ */
+int                 sc_trace_convert_json (int num_files,
+                                           const char **filenames,
+                                           FILE * out);
+
+/* convenience macros that check for activity before the call */
+#define SC_TRACE_REGION_BEGIN(p,e)                                      \
+  (sc_trace_active ? sc_trace_record ((p), (e), SC_TRACE_BEGIN, 0.) :   \
+   (void) 0)
+#define SC_TRACE_REGION_END(p,e)                                        \
+  (sc_trace_active ? sc_trace_record ((p), (e), SC_TRACE_END, 0.) :     \
+   (void) 0)
+#define SC_TRACE_INSTANT_EVENT(p,e,v)                                   \
+  (sc_trace_active ? sc_trace_record ((p), (e), SC_TRACE_INSTANT, (v)) : \
+   (void) 0)
+#define SC_TRACE_COUNTER_VALUE(p,e,v)                                   \
+  (sc_trace_active ? sc_trace_record ((p), (e), SC_TRACE_COUNTER, (v)) : \
+   (void) 0)
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_TRACE_H */
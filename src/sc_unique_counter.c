@@ -22,6 +22,11 @@
 */
 
 #include <sc_unique_counter.h>
+#if !defined SC_HAVE_ATOMIC_BUILTINS && defined SC_ENABLE_PTHREAD
+#include <pthread.h>
+
+static pthread_mutex_t sc_unique_counter_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 sc_unique_counter_t *
 sc_unique_counter_new (int start_value)
@@ -75,3 +80,243 @@ sc_unique_counter_release (sc_unique_counter_t * uc, int *counter)
 
   sc_mempool_free (uc->mempool, counter);
 }
+
+/* Without atomic builtins we serialize the operations by a global mutex
+ * and the following helpers reduce to plain memory accesses. */
+
+static inline void
+sc_unique_counter_lock (void)
+{
+#if !defined SC_HAVE_ATOMIC_BUILTINS && defined SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_unique_counter_mutex);
+#endif
+}
+
+static inline void
+sc_unique_counter_unlock (void)
+{
+#if !defined SC_HAVE_ATOMIC_BUILTINS && defined SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_unique_counter_mutex);
+#endif
+}
+
+static inline uint64_t
+sc_unique_counter_load (uint64_t * word)
+{
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  return __atomic_load_n (word, __ATOMIC_SEQ_CST);
+#else
+  return *word;
+#endif
+}
+
+static inline int
+sc_unique_counter_cas (uint64_t * word, uint64_t * expected,
+                       uint64_t desired)
+{
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  return __atomic_compare_exchange_n (word, expected, desired, 0,
+                                      __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+  SC_ASSERT (*word == *expected);
+  *word = desired;
+  return 1;
+#endif
+}
+
+static inline long
+sc_unique_counter_load_hint (sc_unique_counter_atomic_t * uc)
+{
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  return __atomic_load_n (&uc->hint, __ATOMIC_SEQ_CST);
+#else
+  return uc->hint;
+#endif
+}
+
+static inline int
+sc_unique_counter_cas_hint (sc_unique_counter_atomic_t * uc,
+                            long *expected, long desired)
+{
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  return __atomic_compare_exchange_n (&uc->hint, expected, desired, 0,
+                                      __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+  SC_ASSERT (uc->hint == *expected);
+  uc->hint = desired;
+  return 1;
+#endif
+}
+
+static inline int
+sc_unique_counter_ctz (uint64_t bits)
+{
+#if defined __GNUC__ || defined __clang__
+  return __builtin_ctzll ((unsigned long long) bits);
+#else
+  int                 b;
+
+  for (b = 0; !((bits >> b) & 1); ++b);
+  return b;
+#endif
+}
+
+/** Return a bitmap word and allocate its segment if necessary. */
+static uint64_t    *
+sc_unique_counter_word (sc_unique_counter_atomic_t * uc, long w)
+{
+  int                 s;
+  uint64_t           *segment;
+
+  SC_ASSERT (w >= 0);
+  s = SC_LOG2_32 ((uint32_t) (w + 1));
+  SC_CHECK_ABORT (s < SC_UNIQUE_COUNTER_SEGMENTS, "Unique counter overflow");
+
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+  segment = __atomic_load_n (&uc->segments[s], __ATOMIC_ACQUIRE);
+  if (segment == NULL) {
+    uint64_t           *expected = NULL;
+
+    segment = SC_ALLOC_ZERO (uint64_t, (size_t) 1 << s);
+    if (!__atomic_compare_exchange_n (&uc->segments[s], &expected, segment,
+                                      0, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_ACQUIRE)) {
+      /* another thread has installed the segment first */
+      SC_FREE (segment);
+      segment = expected;
+    }
+  }
+#else
+  segment = uc->segments[s];
+  if (segment == NULL) {
+    segment = uc->segments[s] = SC_ALLOC_ZERO (uint64_t, (size_t) 1 << s);
+  }
+#endif
+
+  return segment + (w + 1 - (1L << s));
+}
+
+/** Move the search hint down to a word that has a free bit. */
+static void
+sc_unique_counter_lower_hint (sc_unique_counter_atomic_t * uc, long w)
+{
+  long                hint;
+
+  hint = sc_unique_counter_load_hint (uc);
+  while (w < hint && !sc_unique_counter_cas_hint (uc, &hint, w));
+}
+
+sc_unique_counter_atomic_t *
+sc_unique_counter_atomic_new (int start_value)
+{
+  sc_unique_counter_atomic_t *uc;
+
+  uc = SC_ALLOC_ZERO (sc_unique_counter_atomic_t, 1);
+  uc->start_value = start_value;
+
+  return uc;
+}
+
+void
+sc_unique_counter_atomic_destroy (sc_unique_counter_atomic_t * uc)
+{
+  int                 s;
+#ifdef SC_ENABLE_DEBUG
+  size_t              iz;
+#endif
+
+  for (s = 0; s < SC_UNIQUE_COUNTER_SEGMENTS; ++s) {
+    if (uc->segments[s] != NULL) {
+#ifdef SC_ENABLE_DEBUG
+      for (iz = 0; iz < (size_t) 1 << s; ++iz) {
+        SC_ASSERT (uc->segments[s][iz] == 0);
+      }
+#endif
+      SC_FREE (uc->segments[s]);
+    }
+  }
+  SC_FREE (uc);
+}
+
+size_t
+sc_unique_counter_atomic_memory_used (sc_unique_counter_atomic_t * uc)
+{
+  int                 s;
+  size_t              size = sizeof (sc_unique_counter_atomic_t);
+
+  for (s = 0; s < SC_UNIQUE_COUNTER_SEGMENTS; ++s) {
+    if (uc->segments[s] != NULL) {
+      size += ((size_t) 1 << s) * sizeof (uint64_t);
+    }
+  }
+  return size;
+}
+
+int
+sc_unique_counter_atomic_add (sc_unique_counter_atomic_t * uc)
+{
+  int                 b;
+  long                w, hint, value;
+  uint64_t           *word, bits;
+
+  sc_unique_counter_lock ();
+  for (w = hint = sc_unique_counter_load_hint (uc);; ++w) {
+    word = sc_unique_counter_word (uc, w);
+    bits = sc_unique_counter_load (word);
+    while (~bits != 0) {
+      b = sc_unique_counter_ctz (~bits);
+      if (sc_unique_counter_cas (word, &bits, bits | ((uint64_t) 1 << b))) {
+        sc_unique_counter_unlock ();
+        value = 64 * w + b;
+        SC_CHECK_ABORT (value <= (long) INT_MAX - uc->start_value,
+                        "Unique counter overflow");
+        return uc->start_value + (int) value;
+      }
+      /* the failed swap has loaded the current bits */
+    }
+
+    /* the word is full; advance the hint past it unless it has moved */
+    if (w == hint && sc_unique_counter_cas_hint (uc, &hint, w + 1)) {
+      hint = w + 1;
+
+      /* a release that has missed our update must not be skipped */
+      if (~sc_unique_counter_load (word) != 0) {
+        sc_unique_counter_lower_hint (uc, w);
+      }
+    }
+  }
+}
+
+void
+sc_unique_counter_atomic_release (sc_unique_counter_atomic_t * uc,
+                                  int counter)
+{
+  long                value, w;
+  uint64_t           *word, bit;
+#ifdef SC_ENABLE_DEBUG
+  uint64_t            old;
+#endif
+
+  SC_ASSERT (counter >= uc->start_value);
+
+  value = (long) counter - uc->start_value;
+  w = value / 64;
+  bit = (uint64_t) 1 << (value % 64);
+
+  sc_unique_counter_lock ();
+  word = sc_unique_counter_word (uc, w);
+#ifdef SC_HAVE_ATOMIC_BUILTINS
+#ifdef SC_ENABLE_DEBUG
+  old =
+#endif
+    __atomic_fetch_and (word, ~bit, __ATOMIC_SEQ_CST);
+#else
+#ifdef SC_ENABLE_DEBUG
+  old = *word;
+#endif
+  *word &= ~bit;
+#endif
+  SC_ASSERT (old & bit);
+  sc_unique_counter_lower_hint (uc, w);
+  sc_unique_counter_unlock ();
+}
@@ -73,4 +73,63 @@ int                *sc_unique_counter_add (sc_unique_counter_t * uc);
 void                sc_unique_counter_release (sc_unique_counter_t * uc,
                                                int *counter);
 
+/** The number of bitmap segments of a concurrent counter factory.
+ * Segment s holds 2^s words of 64 bits, which covers all int values.
+ */
+#define SC_UNIQUE_COUNTER_SEGMENTS 26
+
+/** A factory for unique integers that may be used by many threads at once.
+ * The integers in use are bits in a segmented bitmap.  Each bit is taken
+ * and cleared by an atomic compare-and-swap, and segments are allocated
+ * when first needed and never moved, so no locks are required.  The next
+ * integer is the smallest free one at or above a shared search hint, which
+ * keeps the numbers dense.  The members should not be accessed directly.
+ */
+typedef struct sc_unique_counter_atomic
+{
+  int                 start_value;      /**< Value of the first counter. */
+  long                hint;             /**< No free bit in lower words. */
+  uint64_t           *segments[SC_UNIQUE_COUNTER_SEGMENTS];  /**< Bitmap. */
+}
+sc_unique_counter_atomic_t;
+
+/** Create a thread-safe factory for unique tag numbers.
+ * The first tag number created will be start_value.
+ * \param [in] start_value      Value of the first counter to be added.
+ * \return                      Fully initialized counter factory.
+ */
+sc_unique_counter_atomic_t *sc_unique_counter_atomic_new (int start_value);
+
+/** Destroy the thread-safe counter factory.
+ * All counters added must have been released before calling this function,
+ * and no other thread may use the factory concurrently.
+ * \param [in,out] uc           This memory will be released.
+ */
+void                sc_unique_counter_atomic_destroy
+  (sc_unique_counter_atomic_t * uc);
+
+/** Return the size in bytes allocated by this counter factory.
+ * \param [in] uc               Its total memory used will be counted.
+ */
+size_t              sc_unique_counter_atomic_memory_used
+  (sc_unique_counter_atomic_t * uc);
+
+/** Return a counter value that is not in use, from any thread.
+ * It is the smallest free value unless other threads add or release
+ * concurrently.
+ * \param [in,out] uc           The factory to return a unique counter.
+ * \return                      Unique value greater or equal start_value.
+ */
+int                 sc_unique_counter_atomic_add
+  (sc_unique_counter_atomic_t * uc);
+
+/** Release a counter value to the factory, from any thread.
+ * \param [in,out] uc           The factory that returned the value.
+ * \param [in] counter          A value previously obtained from
+ *                              sc_unique_counter_atomic_add and not since
+ *                              released.
+ */
+void                sc_unique_counter_atomic_release
+  (sc_unique_counter_atomic_t * uc, int counter);
+
 #endif /* !SC_UNIQUE_COUNTER */
@@ -0,0 +1,164 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_aggregate.h>
+
+#define TEST_AGGREGATE_ROUNDS 50
+
+typedef struct test_aggregate
+{
+  int                 mpisize, mpirank;
+  long               *received;         /**< Messages per source. */
+  long                checksum;
+}
+test_aggregate_t;
+
+/** The message from p to q in round r holds r % 7 copies of its tag. */
+static int
+test_aggregate_tag (int p, int q, int r)
+{
+  return 1000 * p + 10 * q + r % 10;
+}
+
+static void
+test_aggregate_handler (sc_aggregate_t * agg, int source, const void *data,
+                        size_t bytes, void *user)
+{
+  int                 k, count, r;
+  const int          *values = (const int *) data;
+  test_aggregate_t   *ta = (test_aggregate_t *) user;
+
+  SC_CHECK_ABORT (0 <= source && source < ta->mpisize, "Source");
+  SC_CHECK_ABORT (bytes % sizeof (int) == 0, "Size");
+  count = (int) (bytes / sizeof (int));
+  r = (int) ta->received[source]++;
+  SC_CHECK_ABORT (count == r % 7, "Count");
+  for (k = 0; k < count; ++k) {
+    SC_CHECK_ABORT (values[k] == test_aggregate_tag (source, ta->mpirank, r),
+                    "Value");
+  }
+}
+
+/** The reply handler sends a message back during the exchange. */
+static void
+test_aggregate_echo (sc_aggregate_t * agg, int source, const void *data,
+                     size_t bytes, void *user)
+{
+  test_aggregate_t   *ta = (test_aggregate_t *) user;
+
+  SC_CHECK_ABORT (bytes == sizeof (long), "Echo size");
+  ta->checksum += *(const long *) data;
+}
+
+static void
+test_aggregate_run (sc_MPI_Comm mpicomm, size_t flush_bytes,
+                    double flush_seconds, int route_nodes)
+{
+  int                 mpiret;
+  int                 q, r, k, id, echo_id;
+  int                 values[7];
+  long                value, total;
+  test_aggregate_t    ta;
+  sc_aggregate_t     *agg;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &ta.mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &ta.mpirank);
+  SC_CHECK_MPI (mpiret);
+  ta.received = SC_ALLOC_ZERO (long, ta.mpisize);
+  ta.checksum = 0;
+
+  agg = sc_aggregate_new (mpicomm, flush_bytes, flush_seconds, route_nodes);
+  id = sc_aggregate_register (agg, test_aggregate_handler, &ta);
+  echo_id = sc_aggregate_register (agg, test_aggregate_echo, &ta);
+
+  /* messages from one source to one destination arrive in order */
+  for (r = 0; r < TEST_AGGREGATE_ROUNDS; ++r) {
+    for (q = 0; q < ta.mpisize; ++q) {
+      for (k = 0; k < r % 7; ++k) {
+        values[k] = test_aggregate_tag (ta.mpirank, q, r);
+      }
+      sc_aggregate_send (agg, q, id, values, (r % 7) * sizeof (int));
+    }
+    value = ta.mpirank + r;
+    sc_aggregate_send (agg, (ta.mpirank + r) % ta.mpisize, echo_id,
+                       &value, sizeof (long));
+    if (r % 5 == 0) {
+      sc_aggregate_poll (agg);
+    }
+  }
+  sc_aggregate_complete (agg);
+
+  for (q = 0; q < ta.mpisize; ++q) {
+    SC_CHECK_ABORT (ta.received[q] == TEST_AGGREGATE_ROUNDS, "Received");
+  }
+  SC_CHECK_ABORT (agg->num_sent ==
+                  (long) (ta.mpisize + 1) * TEST_AGGREGATE_ROUNDS, "Sent");
+  mpiret = sc_MPI_Allreduce (&ta.checksum, &total, 1, sc_MPI_LONG,
+                             sc_MPI_SUM, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (total == (long) ta.mpisize * (ta.mpisize - 1) / 2 *
+                  TEST_AGGREGATE_ROUNDS + (long) ta.mpisize *
+                  TEST_AGGREGATE_ROUNDS * (TEST_AGGREGATE_ROUNDS - 1) / 2,
+                  "Echo checksum");
+  SC_GLOBAL_INFOF ("Aggregated %ld messages into %ld buffers,"
+                   " forwarded %ld\n", agg->num_sent, agg->num_buffers,
+                   agg->num_forwarded);
+
+  sc_aggregate_destroy (agg);
+  SC_FREE (ta.received);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, mpisize;
+  sc_MPI_Comm         mpicomm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_aggregate_run (sc_MPI_COMM_WORLD, 0, -1., 0);
+  test_aggregate_run (sc_MPI_COMM_WORLD, 256, -1., 0);
+  test_aggregate_run (sc_MPI_COMM_WORLD, 1 << 20, 0., 0);
+
+  /* pretend there are two processes per node to route messages */
+  mpiret = sc_MPI_Comm_dup (sc_MPI_COMM_WORLD, &mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_mpi_comm_detach_node_comms (mpicomm);
+  sc_mpi_comm_attach_node_comms (mpicomm, mpisize % 2 ? 1 : 2);
+  test_aggregate_run (mpicomm, 256, -1., 1);
+  sc_mpi_comm_detach_node_comms (mpicomm);
+  mpiret = sc_MPI_Comm_free (&mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
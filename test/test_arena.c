@@ -0,0 +1,206 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_arena.h>
+#if defined SC_ENABLE_OPENMP && defined SC_ENABLE_PTHREAD
+#include <omp.h>
+#define TEST_ARENA_THREADS
+#endif
+
+/** Check alignment, statistics and that a release makes room for reuse. */
+static void
+test_arena_mark (size_t chunk_size)
+{
+  int                 i, j;
+  size_t              alignment, used;
+  char               *first, *p, *q;
+  sc_arena_mark_t     mark;
+  sc_arena_t         *arena;
+
+  arena = sc_arena_new (chunk_size);
+
+  /* fill some data before the mark that must survive */
+  first = (char *) sc_arena_alloc (arena, 100);
+  memset (first, 'x', 100);
+  sc_arena_mark (arena, &mark);
+  used = arena->bytes_used;
+  SC_CHECK_ABORT (used >= 100 && arena->num_allocs == 1, "Arena counts");
+
+  for (j = 0; j < 3; ++j) {
+    q = NULL;
+    for (i = 0; i < 200; ++i) {
+      alignment = (size_t) 1 << (i % 13);
+      p = (char *) sc_arena_alloc_aligned (arena, (size_t) (i * 37 % 1000),
+                                           alignment);
+      SC_CHECK_ABORT (((uintptr_t) p & (alignment - 1)) == 0,
+                      "Arena alignment");
+      memset (p, 'y', (size_t) (i * 37 % 1000));
+      if (i == 0) {
+        q = p;
+      }
+    }
+    SC_CHECK_ABORT (arena->num_allocs == 201, "Arena allocations");
+    SC_CHECK_ABORT (arena->high_water >= arena->bytes_used, "High water");
+
+    /* after a release the same addresses are handed out again */
+    sc_arena_release (arena, &mark);
+    SC_CHECK_ABORT (arena->bytes_used == used && arena->num_allocs == 1,
+                    "Arena release");
+    p = (char *) sc_arena_alloc_aligned (arena, 0, 1);
+    SC_CHECK_ABORT (p == q, "Arena reuse");
+    sc_arena_release (arena, &mark);
+  }
+
+  for (i = 0; i < 100; ++i) {
+    SC_CHECK_ABORT (first[i] == 'x', "Arena data before mark");
+  }
+  SC_CHECK_ABORT (sc_arena_memory_used (arena) > sizeof (sc_arena_t),
+                  "Arena memory used");
+
+  sc_arena_clear (arena);
+  SC_CHECK_ABORT (arena->bytes_used == 0 && arena->num_allocs == 0 &&
+                  arena->high_water > 0, "Arena clear");
+  sc_arena_destroy (arena);
+}
+
+/** Grow arrays and a mempool whose memory comes from an arena. */
+static void
+test_arena_array (int count)
+{
+  int                 i;
+  sc_arena_mark_t     mark;
+  sc_arena_t         *arena;
+  sc_array_t          a, b;
+  sc_mempool_t       *mp;
+
+  arena = sc_arena_new (1 << 12);
+  sc_arena_mark (arena, &mark);
+
+  /* one array alone grows in place, two interleaved ones have to move */
+  sc_array_init_allocator (&a, sizeof (int), sc_arena_allocator (arena));
+  for (i = 0; i < count; ++i) {
+    *(int *) sc_array_push (&a) = i;
+  }
+  sc_array_init_allocator (&b, sizeof (int), sc_arena_allocator (arena));
+  for (i = 0; i < count; ++i) {
+    *(int *) sc_array_push (&a) = count + i;
+    *(int *) sc_array_push (&b) = -i;
+  }
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (*(int *) sc_array_index_int (&a, i) == i &&
+                    *(int *) sc_array_index_int (&a, count + i) == count + i &&
+                    *(int *) sc_array_index_int (&b, i) == -i,
+                    "Arena array");
+  }
+
+  sc_array_resize (&b, 0);
+  SC_CHECK_ABORT (b.allocator == sc_arena_allocator (arena), "Allocator");
+  sc_array_reset (&b);
+  SC_CHECK_ABORT (b.allocator == sc_arena_allocator (arena), "Allocator");
+  sc_array_reset (&a);
+
+  /* a mempool takes its chunks from the arena as well */
+  mp = sc_mempool_new_allocator (sizeof (int), sc_arena_allocator (arena));
+  for (i = 0; i < count; ++i) {
+    *(int *) sc_mempool_alloc (mp) = i;
+  }
+  SC_CHECK_ABORT (arena->num_allocs > 0, "Arena mempool");
+  sc_mempool_destroy (mp);
+
+  /* the array memory is given back all at once */
+  sc_arena_release (arena, &mark);
+  SC_CHECK_ABORT (arena->bytes_used == 0, "Arena array release");
+  sc_arena_destroy (arena);
+}
+
+/** Use the arena of every thread and check that they are private. */
+static void
+test_arena_threads (int count)
+{
+  int                 num_threads;
+  int                 num_errors = 0;
+
+#ifdef TEST_ARENA_THREADS
+  num_threads = omp_get_max_threads ();
+#else
+  num_threads = 1;
+#endif
+
+#ifdef TEST_ARENA_THREADS
+#pragma omp parallel num_threads (num_threads) reduction (+:num_errors)
+#endif
+  {
+    int                 i, id;
+    int               **values;
+    sc_arena_mark_t     mark;
+    sc_arena_t         *arena;
+
+#ifdef TEST_ARENA_THREADS
+    id = omp_get_thread_num ();
+#else
+    id = 0;
+#endif
+    arena = sc_arena_thread ();
+    SC_CHECK_ABORT (arena == sc_arena_thread (), "Thread arena");
+    sc_arena_mark (arena, &mark);
+
+    values = (int **) sc_arena_alloc (arena, count * sizeof (int *));
+    for (i = 0; i < count; ++i) {
+      values[i] = (int *) sc_arena_alloc (arena, sizeof (int));
+      *values[i] = id * count + i;
+    }
+#ifdef TEST_ARENA_THREADS
+#pragma omp barrier
+#endif
+    for (i = 0; i < count; ++i) {
+      num_errors += *values[i] != id * count + i;
+    }
+    sc_arena_release (arena, &mark);
+
+    /* thread pool threads outlive the parallel region */
+    sc_arena_thread_destroy ();
+  }
+  SC_CHECK_ABORT (num_errors == 0, "Thread arena private");
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_arena_mark (0);
+  test_arena_mark (1 << 10);
+  test_arena_array (10000);
+  test_arena_threads (1000);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -103,6 +103,134 @@ test_new_data (sc_array_t * a)
   sc_array_destroy (v);
 }
 
+/** Compare a slot array under random insertion and removal to a plain
+ * array of flags, then compact it along with a dependent array. */
+static void
+test_slot_array (int N)
+{
+  int                 k, last, *pe;
+  size_t              zi, zj, position, count;
+  char               *flags;
+  sc_array_t         *dep, *newindices;
+  sc_slot_array_t     sa;
+
+  sc_slot_array_init (&sa, sizeof (int));
+  flags = SC_ALLOC_ZERO (char, 4 * N);
+  for (k = 0; k < 4 * N; ++k) {
+    if (sa.elem_count > 0 && rand () % 3 == 0) {
+      /* remove a random live slot */
+      position = sc_slot_array_next (&sa, (size_t) rand () %
+                                     sa.a.elem_count);
+      if (position == sa.a.elem_count) {
+        position = sc_slot_array_next (&sa, 0);
+      }
+      pe = (int *) sc_slot_array_remove (&sa, position);
+      SC_CHECK_ABORT (*pe == (int) position, "Slot remove");
+      flags[position] = 0;
+    }
+    else {
+      /* the lowest free slot is reused */
+      for (zi = 0; zi < sa.a.elem_count && flags[zi]; ++zi);
+      pe = (int *) sc_slot_array_insert (&sa, &position);
+      SC_CHECK_ABORT (position == zi, "Slot insert");
+      *pe = (int) position;
+      flags[position] = 1;
+    }
+  }
+
+  /* iteration visits exactly the live slots */
+  count = 0;
+  zj = 0;
+  for (zi = sc_slot_array_next (&sa, 0); zi < sa.a.elem_count;
+       zi = sc_slot_array_next (&sa, zi + 1)) {
+    for (; zj < zi; ++zj) {
+      SC_CHECK_ABORT (!flags[zj] && !sc_slot_array_is_live (&sa, zj),
+                      "Slot skipped");
+    }
+    SC_CHECK_ABORT (flags[zi] && sc_slot_array_is_live (&sa, zi),
+                    "Slot live");
+    zj = zi + 1;
+    ++count;
+  }
+  SC_CHECK_ABORT (count == sa.elem_count, "Slot count");
+
+  /* a dependent array follows the compaction by the permutation */
+  dep = sc_array_new_size (sizeof (int), sa.a.elem_count);
+  for (zi = 0; zi < sa.a.elem_count; ++zi) {
+    *(int *) sc_array_index (dep, zi) = flags[zi] ? -(int) zi : 1;
+  }
+  newindices = sc_array_new (sizeof (size_t));
+  sc_slot_array_compact (&sa, newindices);
+  SC_CHECK_ABORT (sa.a.elem_count == count &&
+                  newindices->elem_count == dep->elem_count &&
+                  sc_array_is_permutation (newindices), "Slot compact");
+  sc_array_permute (dep, newindices, 0);
+  sc_array_resize (dep, count);
+  last = -1;
+  for (zi = 0; zi < count; ++zi) {
+    SC_CHECK_ABORT (sc_slot_array_is_live (&sa, zi), "Slot compact live");
+    pe = (int *) sc_array_index (&sa.a, zi);
+    SC_CHECK_ABORT (*pe > last, "Slot compact order");
+    SC_CHECK_ABORT (*(int *) sc_array_index (dep, zi) == -*pe,
+                    "Slot compact dependent");
+    last = *pe;
+  }
+  SC_CHECK_ABORT (sc_slot_array_next (&sa, 0) == (count ? 0 : count),
+                  "Slot next after compact");
+  sc_slot_array_insert (&sa, &position);
+  SC_CHECK_ABORT (position == count, "Slot insert after compact");
+
+  sc_array_destroy (newindices);
+  sc_array_destroy (dep);
+  SC_FREE (flags);
+  sc_slot_array_reset (&sa);
+}
+
+/** Grow an array across the huge page threshold and back, and fill a
+ * mempool whose chunks are huge pages. */
+static void
+test_allocator (int N)
+{
+  int                 i, **elems;
+  sc_array_t          a;
+  sc_mempool_t       *mp;
+  sc_allocator_t     *huge = sc_allocator_hugepage ();
+
+  sc_array_init_allocator (&a, sizeof (int), huge);
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_push (&a) = i;
+  }
+  SC_CHECK_ABORT (a.byte_alloc >= 1 << 21, "Huge page size");
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (*(int *) sc_array_index_int (&a, i) == i, "Huge push");
+  }
+  sc_array_resize (&a, 100);
+  for (i = 0; i < 100; ++i) {
+    SC_CHECK_ABORT (*(int *) sc_array_index_int (&a, i) == i, "Huge shrink");
+  }
+  sc_array_reset (&a);
+  SC_CHECK_ABORT (a.allocator == huge, "Allocator kept");
+
+  mp = sc_mempool_new_allocator (sizeof (int), huge);
+  elems = SC_ALLOC (int *, N);
+  for (i = 0; i < N; ++i) {
+    elems[i] = (int *) sc_mempool_alloc (mp);
+    *elems[i] = i;
+  }
+  for (i = 0; i < N; i += 2) {
+    sc_mempool_free (mp, elems[i]);
+  }
+  for (i = 1; i < N; i += 2) {
+    SC_CHECK_ABORT (*elems[i] == i, "Huge mempool");
+  }
+  sc_mempool_truncate (mp);
+  SC_CHECK_ABORT (mp->elem_count == 0 && mp->allocator == huge,
+                  "Huge mempool truncate");
+  *(int *) sc_mempool_alloc (mp) = 1;
+  SC_FREE (elems);
+  sc_mempool_destroy (mp);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -145,6 +273,8 @@ main (int argc, char **argv)
   test_new_size (a);
   test_new_view (a);
   test_new_data (a);
+  test_slot_array (1000);
+  test_allocator (1 << 20);
 
   for (i = 0; i < N; ++i) {
     pe = (int *) sc_array_index_int (a, i);
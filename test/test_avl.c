@@ -0,0 +1,195 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_avl.h>
+
+#define TEST_AVL_COUNT 3000
+
+static int
+test_avl_compare (const void *v1, const void *v2)
+{
+  const int           i1 = *(const int *) v1;
+  const int           i2 = *(const int *) v2;
+
+  return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
+}
+
+/** Return the number of significant bits as used for balancing. */
+static int
+test_avl_bits (unsigned u)
+{
+  int                 bits;
+
+  for (bits = 0; u > 0; u >>= 1) {
+    ++bits;
+  }
+  return bits;
+}
+
+/** Check parents, counts, order and balance of a subtree.
+ * \return              The number of nodes in the subtree.
+ */
+static unsigned
+test_avl_check_node (avl_node_t * node, avl_node_t * parent,
+                     avl_node_t ** prev)
+{
+  unsigned            l, r;
+  int                 bl;
+
+  if (node == NULL) {
+    return 0;
+  }
+  SC_CHECK_ABORT (node->parent == parent, "Parent");
+  l = test_avl_check_node (node->left, node, prev);
+  SC_CHECK_ABORT (node->prev == *prev, "Previous");
+  SC_CHECK_ABORT (*prev == NULL || ((*prev)->next == node &&
+                                    test_avl_compare ((*prev)->item,
+                                                      node->item) < 0),
+                  "Order");
+  *prev = node;
+  r = test_avl_check_node (node->right, node, prev);
+  SC_CHECK_ABORT (node->count == l + r + 1, "Count");
+  bl = test_avl_bits (l);
+  SC_CHECK_ABORT (bl < 2 || test_avl_bits (r) + 1 >= bl, "Left balance");
+  SC_CHECK_ABORT (test_avl_bits (r) <= bl + 1, "Right balance");
+  return node->count;
+}
+
+static void
+test_avl_check (avl_tree_t * tree, unsigned count)
+{
+  avl_node_t         *prev;
+
+  prev = NULL;
+  SC_CHECK_ABORT (test_avl_check_node (tree->top, NULL, &prev) == count,
+                  "Tree count");
+  SC_CHECK_ABORT (tree->tail == prev &&
+                  (prev == NULL || prev->next == NULL), "Tail");
+  SC_CHECK_ABORT (tree->head == NULL || tree->head->prev == NULL, "Head");
+  SC_CHECK_ABORT ((tree->head == NULL) == (count == 0), "Empty");
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 i, j, k, s;
+  int                 values[TEST_AVL_COUNT];
+  unsigned            counts[8];
+  avl_tree_t          tree, pieces[8];
+  sc_array_t         *items;
+  sc_mempool_t       *pool;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  /* nodes come from a memory pool */
+  pool = sc_mempool_new (sizeof (avl_node_t));
+  avl_init_tree (&tree, test_avl_compare, NULL);
+  avl_set_allocator (&tree, pool);
+
+  /* build from sorted arrays of all sizes up to a limit */
+  items = sc_array_new (sizeof (void *));
+  for (i = 0; i < TEST_AVL_COUNT; ++i) {
+    values[i] = 2 * i;
+    if (i < 100) {
+      avl_from_array (&tree, items);
+      test_avl_check (&tree, (unsigned) i);
+      avl_free_nodes (&tree);
+      SC_CHECK_ABORT (pool->elem_count == 0, "Pool empty");
+    }
+    *(void **) sc_array_push (items) = values + i;
+  }
+  avl_from_array (&tree, items);
+  test_avl_check (&tree, TEST_AVL_COUNT);
+  for (i = 0; i < TEST_AVL_COUNT; ++i) {
+    SC_CHECK_ABORT (avl_at (&tree, (unsigned) i)->item == values + i, "At");
+  }
+
+  /* split off pieces at random odd and even keys and join them again */
+  srand (3);
+  for (k = 0; k < 20; ++k) {
+    for (j = 7; j > 0; --j) {
+      s = rand () % (2 * TEST_AVL_COUNT + 2) - 1;
+      avl_split (&tree, &s, pieces + j);
+      counts[j] = avl_count (pieces + j);
+      test_avl_check (&tree, avl_count (&tree));
+      test_avl_check (pieces + j, counts[j]);
+      SC_CHECK_ABORT (tree.tail == NULL ||
+                      test_avl_compare (tree.tail->item, &s) < 0, "Split");
+      SC_CHECK_ABORT (pieces[j].head == NULL ||
+                      test_avl_compare (pieces[j].head->item, &s) >= 0,
+                      "Split right");
+    }
+
+    /* join from the left or from the right */
+    if (k % 2 == 0) {
+      for (j = 1; j < 8; ++j) {
+        avl_join (&tree, pieces + j);
+      }
+    }
+    else {
+      for (j = 6; j > 0; --j) {
+        avl_join (pieces + j, pieces + j + 1);
+        test_avl_check (pieces + j, counts[j] + counts[j + 1]);
+        counts[j] += counts[j + 1];
+      }
+      avl_join (&tree, pieces + 1);
+    }
+    test_avl_check (&tree, TEST_AVL_COUNT);
+  }
+
+  /* join single items to a large tree from both sides */
+  avl_split (&tree, values + 1, pieces + 1);
+  test_avl_check (&tree, 1);
+  test_avl_check (pieces + 1, TEST_AVL_COUNT - 1);
+  avl_join (&tree, pieces + 1);
+  test_avl_check (&tree, TEST_AVL_COUNT);
+  avl_split (&tree, values + TEST_AVL_COUNT - 1, pieces + 1);
+  avl_join (&tree, pieces + 1);
+  test_avl_check (&tree, TEST_AVL_COUNT);
+
+  /* delete and insert in random order */
+  for (i = 0; i < TEST_AVL_COUNT; ++i) {
+    j = rand () % TEST_AVL_COUNT;
+    if (avl_delete (&tree, values + j) == NULL) {
+      SC_CHECK_ABORT (avl_insert (&tree, values + j) != NULL, "Insert");
+    }
+  }
+  test_avl_check (&tree, avl_count (&tree));
+  SC_CHECK_ABORT (pool->elem_count == avl_count (&tree), "Pool count");
+
+  avl_free_nodes (&tree);
+  SC_CHECK_ABORT (pool->elem_count == 0, "Pool freed");
+  sc_mempool_destroy (pool);
+  sc_array_destroy (items);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_bptree.h>
+
+#define TEST_BPTREE_RANGE 5000
+
+static int
+test_bptree_compare (const void *v1, const void *v2)
+{
+  const int           i1 = *(const int *) v1;
+  const int           i2 = *(const int *) v2;
+
+  return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
+}
+
+static void
+test_bptree_next (void *item, void *data)
+{
+  int                *next = (int *) data;
+
+  /* store the item, or an invalid value once the order is wrong */
+  *next = (*next < *(int *) item) ? *(int *) item : TEST_BPTREE_RANGE;
+}
+
+/** Compare the tree with the membership flags of all values. */
+static void
+test_bptree_check (sc_bptree_t * tree, const int *values, const char *member)
+{
+  int                 v, c;
+  size_t              rank;
+  void               *found;
+  sc_array_t         *array;
+
+  SC_CHECK_ABORT (sc_bptree_is_valid (tree), "Tree structure");
+
+  rank = 0;
+  for (v = 0; v < TEST_BPTREE_RANGE; ++v) {
+    SC_CHECK_ABORT (sc_bptree_lookup (tree, values + v, &found) ==
+                    member[v], "Lookup");
+    c = sc_bptree_search_closest (tree, values + v, &found);
+    if (member[v]) {
+      SC_CHECK_ABORT (found == values + v && c == 0, "Closest equal");
+      SC_CHECK_ABORT (sc_bptree_index (tree, values + v) == (ssize_t) rank,
+                      "Index");
+      SC_CHECK_ABORT (sc_bptree_at (tree, rank) == values + v, "At");
+      ++rank;
+    }
+    else {
+      SC_CHECK_ABORT (sc_bptree_index (tree, values + v) == -1, "No index");
+      if (rank < tree->elem_count) {
+        SC_CHECK_ABORT (c == 1 && found == sc_bptree_at (tree, rank),
+                        "Closest greater");
+      }
+      else if (rank > 0) {
+        SC_CHECK_ABORT (c == -1 && found == sc_bptree_at (tree, rank - 1),
+                        "Closest smaller");
+      }
+      else {
+        SC_CHECK_ABORT (c == 0 && found == NULL, "Closest empty");
+      }
+    }
+  }
+  SC_CHECK_ABORT (rank == tree->elem_count, "Count");
+  SC_CHECK_ABORT (sc_bptree_at (tree, rank) == NULL, "At end");
+
+  v = -1;
+  sc_bptree_foreach (tree, test_bptree_next, &v);
+  SC_CHECK_ABORT (v < TEST_BPTREE_RANGE, "Foreach order");
+
+  array = sc_array_new (sizeof (void *));
+  sc_bptree_to_array (tree, array);
+  SC_CHECK_ABORT (array->elem_count == tree->elem_count, "Array count");
+  for (rank = 0; rank < array->elem_count; ++rank) {
+    SC_CHECK_ABORT (*(void **) sc_array_index (array, rank) ==
+                    sc_bptree_at (tree, rank), "Array item");
+  }
+  sc_array_destroy (array);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 i, v, round;
+  int                 values[TEST_BPTREE_RANGE];
+  char                member[TEST_BPTREE_RANGE];
+  void               *found;
+  sc_array_t         *items;
+  sc_bptree_t        *tree;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  for (v = 0; v < TEST_BPTREE_RANGE; ++v) {
+    values[v] = v;
+    member[v] = 0;
+  }
+
+  /* grow the tree by random insertions, then shrink it by removals */
+  srand (5);
+  tree = sc_bptree_new (test_bptree_compare);
+  test_bptree_check (tree, values, member);
+  for (round = 0; round < 4; ++round) {
+    for (i = 0; i < 3 * TEST_BPTREE_RANGE; ++i) {
+      v = rand () % TEST_BPTREE_RANGE;
+      if (round % 2 == 0) {
+        SC_CHECK_ABORT (sc_bptree_insert (tree, values + v, &found) ==
+                        !member[v], "Insert");
+        SC_CHECK_ABORT (!member[v] || found == values + v, "Insert found");
+        member[v] = 1;
+      }
+      else {
+        SC_CHECK_ABORT (sc_bptree_remove (tree, values + v, &found) ==
+                        member[v], "Remove");
+        SC_CHECK_ABORT (!member[v] || found == values + v, "Remove found");
+        member[v] = 0;
+      }
+      if (i % 997 == 0) {
+        SC_CHECK_ABORT (sc_bptree_is_valid (tree), "Tree structure");
+      }
+    }
+    test_bptree_check (tree, values, member);
+  }
+
+  /* remove the remaining items in order */
+  for (v = 0; v < TEST_BPTREE_RANGE; ++v) {
+    SC_CHECK_ABORT (sc_bptree_remove (tree, values + v, NULL) == member[v],
+                    "Remove all");
+    member[v] = 0;
+  }
+  test_bptree_check (tree, values, member);
+  SC_CHECK_ABORT (tree->elem_count == 0 && tree->height == 0, "Empty");
+  sc_bptree_destroy (tree);
+
+  /* bulk load every third value and insert the others */
+  items = sc_array_new (sizeof (void *));
+  for (v = 0; v < TEST_BPTREE_RANGE; v += 3) {
+    *(void **) sc_array_push (items) = values + v;
+    member[v] = 1;
+  }
+  tree = sc_bptree_new (test_bptree_compare);
+  sc_bptree_bulk_load (tree, items);
+  test_bptree_check (tree, values, member);
+  for (v = 0; v < TEST_BPTREE_RANGE; ++v) {
+    SC_CHECK_ABORT (sc_bptree_insert (tree, values + v, NULL) == !member[v],
+                    "Insert after bulk load");
+    member[v] = 1;
+  }
+  test_bptree_check (tree, values, member);
+  sc_bptree_destroy (tree);
+  sc_array_destroy (items);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,247 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_bspline.h>
+#ifdef SC_ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+#define TEST_BSPLINE_D 3
+#define TEST_BSPLINE_P 17
+#define TEST_BSPLINE_NUM_T 203
+
+/** Fill control points with random values. */
+static void
+test_bspline_random_points (sc_dmatrix_t * points)
+{
+  int                 i, k;
+
+  for (i = 0; i < points->m; ++i) {
+    for (k = 0; k < points->n; ++k) {
+      points->e[i][k] = rand () / (double) RAND_MAX;
+    }
+  }
+}
+
+/** Compute the maximum difference between two arrays. */
+static double
+test_bspline_diff (const double *r1, const double *r2, size_t num)
+{
+  size_t              zz;
+  double              diff = 0.;
+
+  for (zz = 0; zz < num; ++zz) {
+    diff = SC_MAX (diff, fabs (r1[zz] - r2[zz]));
+  }
+
+  return diff;
+}
+
+/** Compare the batch functions with pointwise evaluation. */
+static void
+test_bspline_batch (sc_bspline_t * bs, const double *t, size_t num_t)
+{
+  const int           d = bs->d;
+  int                 order;
+  size_t              zz;
+  double             *rbatch, *rpoint;
+
+  rbatch = SC_ALLOC (double, num_t * d);
+  rpoint = SC_ALLOC (double, num_t * d);
+
+  for (order = 0; order <= bs->n + 1; ++order) {
+    for (zz = 0; zz < num_t; ++zz) {
+      sc_bspline_derivative_n (bs, order, t[zz], rpoint + zz * d);
+    }
+    if (order == 0) {
+      sc_bspline_evaluate_batch (bs, num_t, t, rbatch);
+    }
+    else if (order == 1) {
+      sc_bspline_derivative_batch (bs, num_t, t, rbatch);
+    }
+    else {
+      sc_bspline_derivative_n_batch (bs, order, num_t, t, rbatch);
+    }
+    SC_CHECK_ABORTF (test_bspline_diff (rbatch, rpoint, num_t * d) <
+                     1e-8 * pow (10., order), "Batch mismatch order %d",
+                     order);
+  }
+
+  SC_FREE (rbatch);
+  SC_FREE (rpoint);
+}
+
+/** Compare the piecewise polynomial form with de Boor's algorithm. */
+static void
+test_bspline_poly (sc_bspline_t * bs, const double *t, size_t num_t)
+{
+  const int           d = bs->d;
+  int                 order;
+  size_t              zz;
+  double             *rpoly, *rbatch, *rpoint;
+  sc_bspline_poly_t  *poly;
+
+  rpoly = SC_ALLOC (double, num_t * d);
+  rbatch = SC_ALLOC (double, num_t * d);
+  rpoint = SC_ALLOC (double, num_t * d);
+
+  poly = sc_bspline_poly_new (bs);
+  for (order = 0; order <= bs->n + 1; ++order) {
+    for (zz = 0; zz < num_t; ++zz) {
+      sc_bspline_derivative_n (bs, order, t[zz], rpoint + zz * d);
+      sc_bspline_poly_derivative_n (poly, order, t[zz], rpoly + zz * d);
+    }
+    sc_bspline_poly_derivative_n_batch (poly, order, num_t, t, rbatch);
+    SC_CHECK_ABORTF (test_bspline_diff (rpoly, rpoint, num_t * d) <
+                     1e-8 * pow (10., order), "Poly mismatch order %d",
+                     order);
+    SC_CHECK_ABORTF (test_bspline_diff (rbatch, rpoly, num_t * d) == 0.,
+                     "Poly batch mismatch order %d", order);
+  }
+  sc_bspline_poly_destroy (poly);
+
+  SC_FREE (rpoly);
+  SC_FREE (rbatch);
+  SC_FREE (rpoint);
+}
+
+/** Evaluate one B-spline from all threads and compare with serial results. */
+static void
+test_bspline_threads (sc_bspline_t * bs, const double *t, size_t num_t)
+{
+  const int           d = bs->d;
+  int                 n_threads, i;
+  size_t              zz;
+  double             *rpoint, *rserial, *rbatch;
+  sc_bspline_eval_t **evs;
+
+#ifdef SC_ENABLE_OPENMP
+  n_threads = omp_get_max_threads ();
+#else
+  n_threads = 1;
+#endif
+
+  rpoint = SC_ALLOC (double, num_t * d);
+  rserial = SC_ALLOC (double, num_t * d);
+  rbatch = SC_ALLOC (double, num_t * d);
+  for (zz = 0; zz < num_t; ++zz) {
+    sc_bspline_evaluate (bs, t[zz], rserial + zz * d);
+  }
+
+  /* allocate outside of the parallel region */
+  evs = SC_ALLOC (sc_bspline_eval_t *, n_threads);
+  for (i = 0; i < n_threads; ++i) {
+    evs[i] = sc_bspline_eval_new (bs);
+  }
+
+#ifdef SC_ENABLE_OPENMP
+#pragma omp parallel num_threads (n_threads)
+#endif
+  {
+    int                 tid, j;
+    size_t              begin, end;
+
+#ifdef SC_ENABLE_OPENMP
+    tid = omp_get_thread_num ();
+#else
+    tid = 0;
+#endif
+
+    /* interleave the parameters to let the threads interfere maximally */
+#ifdef SC_ENABLE_OPENMP
+#pragma omp for schedule (static, 1)
+#endif
+    for (j = 0; j < (int) num_t; ++j) {
+      sc_bspline_evaluate_r (bs, evs[tid], t[j], rpoint + j * d);
+    }
+
+    /* split the parameters into contiguous batches */
+    begin = (num_t * tid) / n_threads;
+    end = (num_t * (tid + 1)) / n_threads;
+    sc_bspline_derivative_n_batch_r (bs, evs[tid], 0, end - begin,
+                                     t + begin, rbatch + begin * d);
+  }
+  SC_CHECK_ABORT (test_bspline_diff (rpoint, rserial, num_t * d) == 0.,
+                  "Threaded pointwise mismatch");
+  SC_CHECK_ABORT (test_bspline_diff (rbatch, rserial, num_t * d) < 1e-8,
+                  "Threaded batch mismatch");
+
+  for (i = 0; i < n_threads; ++i) {
+    sc_bspline_eval_destroy (evs[i]);
+  }
+  SC_FREE (evs);
+  SC_FREE (rpoint);
+  SC_FREE (rserial);
+  SC_FREE (rbatch);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 n;
+  size_t              zz;
+  double              t[TEST_BSPLINE_NUM_T];
+  sc_dmatrix_t       *points, *knots;
+  sc_bspline_t       *bs;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  srand (19);
+  points = sc_dmatrix_new (TEST_BSPLINE_P + 1, TEST_BSPLINE_D);
+  for (n = 0; n <= 5; ++n) {
+    test_bspline_random_points (points);
+    knots = n > 0 ? sc_bspline_knots_new_length (n, points) :
+      sc_bspline_knots_new (n, points);
+    bs = sc_bspline_new (n, points, knots, NULL);
+
+    /* sorted parameters including both ends of the range */
+    for (zz = 0; zz < TEST_BSPLINE_NUM_T; ++zz) {
+      t[zz] = zz / (double) (TEST_BSPLINE_NUM_T - 1);
+    }
+    test_bspline_batch (bs, t, TEST_BSPLINE_NUM_T);
+    test_bspline_poly (bs, t, TEST_BSPLINE_NUM_T);
+
+    /* unsorted parameters */
+    for (zz = 0; zz < TEST_BSPLINE_NUM_T; ++zz) {
+      t[zz] = rand () / (double) RAND_MAX;
+    }
+    test_bspline_batch (bs, t, TEST_BSPLINE_NUM_T);
+    test_bspline_poly (bs, t, TEST_BSPLINE_NUM_T);
+    test_bspline_threads (bs, t, TEST_BSPLINE_NUM_T);
+
+    sc_bspline_destroy (bs);
+    sc_dmatrix_destroy (knots);
+  }
+  sc_dmatrix_destroy (points);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
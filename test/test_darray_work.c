@@ -34,6 +34,7 @@ main (int argc, char **argv)
 #else
   const int           memalign_bytes = 32;
 #endif
+  const size_t        page_bytes = (size_t) sysconf (_SC_PAGESIZE);
   int                 mpiret;
   sc_darray_work_t   *work;
   double             *workd;
@@ -70,6 +71,44 @@ main (int argc, char **argv)
   /* destroy */
   sc_darray_work_destroy (work);
 
+  /* allocate workspace with per-thread pages */
+  work = sc_darray_work_new_numa (n_threads, n_blocks, n_entries,
+                                  memalign_bytes);
+  SC_CHECK_ABORTF (n_entries <= sc_darray_work_get_blocksize (work),
+                   "Insufficient number of entries per block %i, should be at least %i\n",
+                   sc_darray_work_get_blocksize (work), n_entries);
+
+  /* touch and write to all entries of workspace */
+  for (t = 0; t < n_threads; t++) {
+    sc_darray_work_first_touch (work, t);
+    for (b = 0; b < n_blocks; b++) {
+      workd = sc_darray_work_get (work, t, b);
+      SC_CHECK_ABORT (b > 0 || (uintptr_t) workd % page_bytes == 0,
+                      "Thread memory not aligned to page");
+      SC_CHECK_ABORT (((uintptr_t) workd) % memalign_bytes == 0,
+                      "Block not aligned");
+      for (i = 0; i < n_entries; i++) {
+        SC_CHECK_ABORT (workd[i] == 0., "Entry not zeroed by first touch");
+        workd[i] = (double) i;
+      }
+    }
+    SC_CHECK_ABORT (sc_darray_work_get_numa_node (work, t) >= -1,
+                    "Invalid NUMA node");
+  }
+
+  /* the last block of one thread must not share a page with the next */
+  for (t = 1; t < n_threads; t++) {
+    SC_CHECK_ABORT ((uintptr_t) sc_darray_work_get (work, t, 0) /
+                    page_bytes >
+                    (uintptr_t) (sc_darray_work_get (work, t - 1,
+                                                     n_blocks - 1) +
+                                 n_entries - 1) / page_bytes,
+                    "Threads share a page");
+  }
+
+  /* destroy */
+  sc_darray_work_destroy (work);
+
   /* finalize sc */
   sc_finalize ();
 
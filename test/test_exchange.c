@@ -0,0 +1,188 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_exchange.h>
+#include <sc_notify.h>
+
+/** The number of integers in the message from rank p to rank q. */
+static int
+test_exchange_count (int p, int q)
+{
+  return (p * 7 + q * 3) % 20;
+}
+
+static int
+test_exchange_value (int p, int q, int step, int k)
+{
+  return p * 100000 + q * 100 + step * 10 + k;
+}
+
+typedef struct test_exchange
+{
+  int                 mpirank;
+  int                 step;
+  int                 num_unpacked;
+}
+test_exchange_t;
+
+static void
+test_exchange_pack (void *buffer, size_t bytes, int index, int peer,
+                    void *user)
+{
+  int                 k, *values = (int *) buffer;
+  test_exchange_t    *te = (test_exchange_t *) user;
+
+  SC_CHECK_ABORT (bytes == sizeof (int) *
+                  test_exchange_count (te->mpirank, peer), "Pack size");
+  for (k = 0; k < test_exchange_count (te->mpirank, peer); ++k) {
+    values[k] = test_exchange_value (te->mpirank, peer, te->step, k);
+  }
+}
+
+static void
+test_exchange_unpack (const void *buffer, size_t bytes, int index,
+                      int peer, void *user)
+{
+  int                 k;
+  const int          *values = (const int *) buffer;
+  test_exchange_t    *te = (test_exchange_t *) user;
+
+  SC_CHECK_ABORT (bytes == sizeof (int) *
+                  test_exchange_count (peer, te->mpirank), "Unpack size");
+  for (k = 0; k < test_exchange_count (peer, te->mpirank); ++k) {
+    SC_CHECK_ABORT (values[k] ==
+                    test_exchange_value (peer, te->mpirank, te->step, k),
+                    "Unpack value");
+  }
+  ++te->num_unpacked;
+}
+
+static void
+test_exchange_run (sc_exchange_t * ex, test_exchange_t * te, int steps)
+{
+  int                 i;
+
+  for (te->step = 0; te->step < steps; ++te->step) {
+    te->num_unpacked = 0;
+    if (te->step % 2 == 0) {
+      sc_exchange_execute (ex, test_exchange_pack, test_exchange_unpack, te);
+    }
+    else {
+      /* fill and read the buffers directly */
+      for (i = 0; i < ex->num_receivers; ++i) {
+        test_exchange_pack (ex->send_buffer + ex->send_offsets[i],
+                            ex->send_offsets[i + 1] - ex->send_offsets[i],
+                            i, ex->receivers[i], te);
+      }
+      sc_exchange_begin (ex, NULL, NULL);
+      if (te->step % 4 == 3) {
+        /* drive the messages by hand until the hook reports completion */
+        while (sc_mpi_progress () > 0) {
+        }
+      }
+      sc_exchange_end (ex, NULL, NULL);
+      for (i = 0; i < ex->num_senders; ++i) {
+        test_exchange_unpack (ex->recv_buffer + ex->recv_offsets[i],
+                              ex->recv_offsets[i + 1] - ex->recv_offsets[i],
+                              i, ex->senders[i], te);
+      }
+    }
+    SC_CHECK_ABORT (te->num_unpacked == ex->num_senders, "Unpack count");
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 provided, threaded;
+  int                 i, q, num_receivers, num_senders;
+  int                 receivers[3], *senders;
+  size_t              send_sizes[3], *recv_sizes;
+  sc_exchange_method_t method;
+  sc_exchange_t      *ex;
+  test_exchange_t     te;
+
+  mpiret = sc_MPI_Init_thread (&argc, &argv, sc_MPI_THREAD_MULTIPLE,
+                               &provided);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+  SC_CHECK_ABORT (sc_mpi_thread_level () == provided, "Thread level");
+
+  /* send to ourselves and the next two ranks, in ascending order */
+  num_receivers = 0;
+  for (q = 0; q < mpisize; ++q) {
+    if ((q - mpirank + mpisize) % mpisize <= 2) {
+      receivers[num_receivers] = q;
+      send_sizes[num_receivers++] =
+        sizeof (int) * test_exchange_count (mpirank, q);
+    }
+  }
+  te.mpirank = mpirank;
+
+  for (method = SC_EXCHANGE_PERSISTENT; method < SC_EXCHANGE_METHOD_LAST;
+       ++method) {
+    ex = sc_exchange_new_notify (sc_MPI_COMM_WORLD, num_receivers,
+                                 receivers, send_sizes, method);
+    test_exchange_run (ex, &te, 4);
+    sc_exchange_destroy (ex);
+
+    /* the receive sizes may be given by the caller */
+    senders = SC_ALLOC (int, mpisize);
+    mpiret = sc_notify (receivers, num_receivers, senders, &num_senders,
+                        sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    recv_sizes = SC_ALLOC (size_t, num_senders);
+    for (i = 0; i < num_senders; ++i) {
+      recv_sizes[i] = sizeof (int) * test_exchange_count (senders[i],
+                                                          mpirank);
+    }
+    ex = sc_exchange_new (sc_MPI_COMM_WORLD, num_receivers, receivers,
+                          send_sizes, num_senders, senders, recv_sizes,
+                          method);
+    test_exchange_run (ex, &te, 3);
+
+    /* the progress thread runs if the thread level permits */
+    threaded = sc_mpi_progress_thread_start (1e-4);
+    SC_GLOBAL_INFOF ("Progress thread %s\n",
+                     threaded ? "running" : "not available");
+    test_exchange_run (ex, &te, 4);
+    sc_mpi_progress_thread_stop ();
+    SC_CHECK_ABORT (sc_mpi_progress () == 0, "Stale progress hooks");
+    sc_exchange_destroy (ex);
+    SC_FREE (recv_sizes);
+    SC_FREE (senders);
+  }
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -23,6 +23,75 @@
 
 #include <sc_keyvalue.h>
 
+#define TEST_KEYVALUE_MANY 1000
+
+/** Check the order of iteration through a flat container. */
+static int
+test_keyvalue_order (const char *key, const sc_keyvalue_entry_type_t type,
+                     void *entry, const void *u)
+{
+  int                *next = (int *) u;
+
+  /* the even keys have been removed */
+  if (type != SC_KEYVALUE_ENTRY_INT || *(int *) entry != *next) {
+    *next = -1;
+    return 0;
+  }
+  *next += 2;
+  return 1;
+}
+
+/** Insert, remove and iterate through many entries.
+ * \return             The number of failed tests.
+ */
+static int
+test_keyvalue_storage (sc_keyvalue_storage_t storage)
+{
+  int                 i, next;
+  int                 num_failed_tests = 0;
+  static char         names[TEST_KEYVALUE_MANY][16];
+  sc_keyvalue_t      *kv;
+
+  kv = sc_keyvalue_new_storage (storage);
+  for (i = 0; i < TEST_KEYVALUE_MANY; ++i) {
+    snprintf (names[i], 16, "key%d", i);
+    sc_keyvalue_set_int (kv, names[i], i);
+  }
+  for (i = 0; i < TEST_KEYVALUE_MANY; i += 2) {
+    if (sc_keyvalue_unset (kv, names[i]) != SC_KEYVALUE_ENTRY_INT) {
+      SC_VERBOSEF ("Test storage %d failure on unset %d\n", storage, i);
+      num_failed_tests++;
+    }
+  }
+  for (i = 0; i < TEST_KEYVALUE_MANY; ++i) {
+    if (sc_keyvalue_get_int (kv, names[i], -1) != (i % 2 ? i : -1)) {
+      SC_VERBOSEF ("Test storage %d failure on get %d\n", storage, i);
+      num_failed_tests++;
+    }
+  }
+  if (storage == SC_KEYVALUE_STORAGE_FLAT) {
+    next = 1;
+    sc_keyvalue_foreach (kv, test_keyvalue_order, &next);
+    if (next != TEST_KEYVALUE_MANY + 1) {
+      SC_VERBOSE ("Test storage failure on order\n");
+      num_failed_tests++;
+    }
+  }
+
+  /* removed keys may be inserted again with another type */
+  sc_keyvalue_set_double (kv, names[0], 0.5);
+  if (sc_keyvalue_get_double (kv, names[0], 0.) != 0.5) {
+    SC_VERBOSEF ("Test storage %d failure on reinsert\n", storage);
+    num_failed_tests++;
+  }
+  SC_GLOBAL_INFOF ("Storage %d with %d entries uses %llu bytes\n",
+                   storage, TEST_KEYVALUE_MANY / 2 + 1,
+                   (unsigned long long) sc_keyvalue_memory_used (kv));
+  sc_keyvalue_destroy (kv);
+
+  return num_failed_tests;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -42,6 +111,9 @@ main (int argc, char **argv)
   const char         *stringTest;
   void               *pointerTest;
 
+  char                keyname[BUFSIZ];
+  sc_keyvalue_key_t   intKey, doubleKey;
+
   /* Initialization stuff */
   mpiret = sc_MPI_Init (&argc, &argv);
   SC_CHECK_MPI (mpiret);
@@ -210,8 +282,40 @@ main (int argc, char **argv)
     num_failed_tests++;
   }
 
+  /* Test prehashed keys, one of them from a different string buffer */
+  snprintf (keyname, BUFSIZ, "intTest");
+  sc_keyvalue_key_init (&intKey, keyname);
+  sc_keyvalue_key_init (&doubleKey, "doubleTest");
+  sc_keyvalue_set_int (args2, "intTest", 5);
+  sc_keyvalue_set_double_key (args2, &doubleKey, 1.5);
+  if (sc_keyvalue_get_int_key (args2, &intKey, 0) != 5 ||
+      sc_keyvalue_exists_key (args2, &intKey) != SC_KEYVALUE_ENTRY_INT) {
+    SC_VERBOSE ("Test key failure on int\n");
+    num_failed_tests++;
+  }
+  sc_keyvalue_set_int_key (args2, &intKey, 6);
+  if (sc_keyvalue_get_int (args2, "intTest", 0) != 6) {
+    SC_VERBOSE ("Test key failure on int set\n");
+    num_failed_tests++;
+  }
+  if (sc_keyvalue_get_double (args2, "doubleTest", 0.) != 1.5 ||
+      sc_keyvalue_get_double_key (args2, &doubleKey, 0.) != 1.5) {
+    SC_VERBOSE ("Test key failure on double\n");
+    num_failed_tests++;
+  }
+  if (sc_keyvalue_unset_key (args2, &intKey) != SC_KEYVALUE_ENTRY_INT ||
+      sc_keyvalue_unset (args2, "doubleTest") != SC_KEYVALUE_ENTRY_DOUBLE ||
+      sc_keyvalue_exists_key (args2, &doubleKey) != SC_KEYVALUE_ENTRY_NONE ||
+      sc_keyvalue_get_int_key (args2, &intKey, 7) != 7) {
+    SC_VERBOSE ("Test key failure on unset\n");
+    num_failed_tests++;
+  }
+
   sc_keyvalue_destroy (args2);
 
+  num_failed_tests += test_keyvalue_storage (SC_KEYVALUE_STORAGE_HASH);
+  num_failed_tests += test_keyvalue_storage (SC_KEYVALUE_STORAGE_FLAT);
+
   /* Shutdown procedures */
   sc_finalize ();
 
@@ -102,6 +102,39 @@ test_shmem (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
   return 0;
 }
 
+int
+test_shmem_allocator (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
+{
+  int                 i, check;
+  long int           *pl;
+  sc_allocator_t     *allocator;
+  sc_array_t          a;
+
+  sc_shmem_set_type (comm, type);
+  allocator = sc_shmem_allocator_new (comm);
+
+  /* every resize is collective, the writing process fills in the data */
+  sc_array_init_allocator (&a, sizeof (long int), allocator);
+  for (i = 0; i < count; i++) {
+    pl = (long int *) sc_array_push (&a);
+    if (sc_shmem_write_start (a.array, comm)) {
+      *pl = 3 * i + 1;
+    }
+    sc_shmem_write_end (a.array, comm);
+  }
+  check = 0;
+  for (i = 0; i < count; i++) {
+    check += *(long int *) sc_array_index_int (&a, i) != 3 * i + 1;
+  }
+  sc_array_reset (&a);
+  sc_shmem_allocator_destroy (allocator);
+  if (check) {
+    SC_GLOBAL_LERROR ("sc_shmem_allocator mismatch\n");
+    return 1;
+  }
+  return 0;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -130,6 +163,8 @@ main (int argc, char **argv)
       SC_GLOBAL_PRODUCTIONF ("  count = %d\n", count);
       retval +=
         test_shmem (count, sc_MPI_COMM_WORLD, (sc_shmem_type_t) itype);
+      retval += test_shmem_allocator (100 * count, sc_MPI_COMM_WORLD,
+                                      (sc_shmem_type_t) itype);
       if (retval != retvalin) {
         SC_GLOBAL_PRODUCTION ("    unsuccessful\n");
       }
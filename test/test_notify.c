@@ -23,6 +23,69 @@
 
 #include <sc_notify.h>
 
+/** Check the payloads sent by sc_notify_payloadv and the rounds version.
+ * The payload from p to q has (p + q) % 5 entries of value 10 * p + q.
+ */
+static void
+test_notify_payloadv (sc_MPI_Comm mpicomm, int *receivers,
+                      int num_receivers, int *senders, int num_senders)
+{
+  int                 i, k, r, source;
+  int                 mpiret, mpirank;
+  sc_array_t          rarr, payloads, sarr, recv_payloads, *payload;
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_array_init_data (&rarr, receivers, sizeof (int), num_receivers);
+  sc_array_init_size (&payloads, sizeof (sc_array_t), num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    payload = (sc_array_t *) sc_array_index_int (&payloads, i);
+    sc_array_init_size (payload, sizeof (int),
+                        (mpirank + receivers[i]) % 5);
+    for (k = 0; k < (int) payload->elem_count; ++k) {
+      *(int *) sc_array_index_int (payload, k) = 10 * mpirank + receivers[i];
+    }
+  }
+  sc_array_init (&sarr, sizeof (int));
+  sc_array_init (&recv_payloads, sizeof (sc_array_t));
+
+  /* repeated calls must not mix up their messages */
+  for (r = 0; r < 4; ++r) {
+    if (r < 2) {
+      mpiret = sc_notify_payloadv (&rarr, &payloads, &sarr, &recv_payloads,
+                                   sizeof (int), mpicomm);
+    }
+    else {
+      mpiret = sc_notify_payloadv_rounds (&rarr, &payloads, &sarr,
+                                          &recv_payloads, sizeof (int),
+                                          mpicomm);
+    }
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORT (sarr.elem_count == (size_t) num_senders,
+                    "Payload sender count");
+    for (i = 0; i < num_senders; ++i) {
+      source = *(int *) sc_array_index_int (&sarr, i);
+      SC_CHECK_ABORT (source == senders[i], "Payload sender");
+      payload = (sc_array_t *) sc_array_index_int (&recv_payloads, i);
+      SC_CHECK_ABORT (payload->elem_count ==
+                      (size_t) ((source + mpirank) % 5), "Payload size");
+      for (k = 0; k < (int) payload->elem_count; ++k) {
+        SC_CHECK_ABORT (*(int *) sc_array_index_int (payload, k) ==
+                        10 * source + mpirank, "Payload value");
+      }
+      sc_array_reset (payload);
+    }
+  }
+
+  for (i = 0; i < num_receivers; ++i) {
+    sc_array_reset ((sc_array_t *) sc_array_index_int (&payloads, i));
+  }
+  sc_array_reset (&payloads);
+  sc_array_reset (&sarr);
+  sc_array_reset (&recv_payloads);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -75,6 +138,10 @@ main (int argc, char **argv)
     SC_CHECK_ABORTF (senders[i] == senders2[i], "Mismatched sender %d", i);
   }
 
+  SC_GLOBAL_INFO ("Testing sc_notify_payloadv\n");
+  test_notify_payloadv (mpicomm, receivers, num_receivers,
+                        senders, num_senders);
+
   SC_FREE (receivers);
   SC_FREE (senders);
   SC_FREE (senders2);
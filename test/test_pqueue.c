@@ -21,7 +21,11 @@
   02110-1301, USA.
 */
 
-#include <sc_containers.h>
+#include <sc_pqueue.h>
+#if defined SC_ENABLE_OPENMP && defined SC_ENABLE_PTHREAD
+#include <omp.h>
+#define TEST_PQUEUE_THREADS
+#endif
 
 /* #define THEBIGTEST */
 
@@ -34,6 +38,121 @@ compar (const void *p1, const void *p2)
   return i1 - i2;
 }
 
+/** Push and pop random elements with heaps of several arities.
+ * \param [in] count   Number of elements.
+ */
+static void
+test_pqueue_arity (int count)
+{
+  int                 arity, i, temp, value, last;
+  double              elapsed;
+  sc_array_t         *a;
+
+  a = sc_array_new_size (sizeof (int), (size_t) count);
+  for (arity = 2; arity <= 8; arity *= 2) {
+    srand (7);
+    sc_array_truncate (a);
+    elapsed = -sc_MPI_Wtime ();
+    for (i = 0; i < count; ++i) {
+      *(int *) sc_array_push (a) = rand () % count;
+      sc_array_pqueue_add_arity (a, &temp, compar, arity);
+    }
+    last = -1;
+    for (i = 0; i < count; ++i) {
+      sc_array_pqueue_pop_arity (a, &value, compar, arity);
+      SC_CHECK_ABORT (value >= last, "pqueue_pop_arity");
+      last = value;
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_CHECK_ABORT (a->elem_count == 0, "pqueue_pop_arity count");
+    SC_STATISTICSF ("Heap of arity %d: %g ns per push and pop\n", arity,
+                    1e9 * elapsed / count);
+  }
+  sc_array_destroy (a);
+}
+
+/** Push from all threads into a relaxed queue, then pop until it is empty.
+ * \param [in] count   Number of elements per thread.
+ */
+static void
+test_pqueue_concurrent (int count)
+{
+  int                 num_threads;
+  long long           pushed, popped, num_popped;
+  double              elapsed;
+  sc_pqueue_t        *pq;
+
+#ifdef TEST_PQUEUE_THREADS
+  num_threads = omp_get_max_threads ();
+#else
+  num_threads = 1;
+#endif
+  pq = sc_pqueue_new (sizeof (int), compar, 2 * num_threads, 4);
+  pushed = popped = num_popped = 0;
+
+  elapsed = -sc_MPI_Wtime ();
+#ifdef TEST_PQUEUE_THREADS
+#pragma omp parallel num_threads (num_threads) \
+  reduction (+:pushed, popped, num_popped)
+#endif
+  {
+    int                 i, value;
+    unsigned            seed;
+
+#ifdef TEST_PQUEUE_THREADS
+    seed = (unsigned) omp_get_thread_num () + 1;
+#else
+    seed = 1;
+#endif
+    for (i = 0; i < count; ++i) {
+      value = (int) (seed * 7919 + (unsigned) i) % count;
+      sc_pqueue_push (pq, &value, &seed);
+      pushed += value;
+    }
+#ifdef TEST_PQUEUE_THREADS
+#pragma omp barrier
+#endif
+    while (sc_pqueue_pop (pq, &value, &seed)) {
+      popped += value;
+      ++num_popped;
+    }
+  }
+  elapsed += sc_MPI_Wtime ();
+
+  SC_CHECK_ABORT (num_popped == (long long) count * num_threads &&
+                  popped == pushed, "Relaxed pqueue contents");
+  SC_CHECK_ABORT (sc_pqueue_count (pq) == 0, "Relaxed pqueue empty");
+  SC_STATISTICSF ("Relaxed queue with %d threads: %g ns per push and pop\n",
+                  num_threads, 1e9 * elapsed / (count * num_threads));
+  sc_pqueue_destroy (pq);
+}
+
+/** A relaxed queue with a single heap pops in exact order.
+ * \param [in] count   Number of elements.
+ */
+static void
+test_pqueue_exact (int count)
+{
+  int                 i, value, last;
+  unsigned            seed = 0;
+  sc_pqueue_t        *pq;
+
+  pq = sc_pqueue_new (sizeof (int), compar, 1, 3);
+  for (i = 0; i < count; ++i) {
+    value = (15 * i) % 172;
+    sc_pqueue_push (pq, &value, &seed);
+  }
+  SC_CHECK_ABORT (sc_pqueue_count (pq) == (size_t) count, "Exact count");
+  last = -1;
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (sc_pqueue_pop (pq, &value, &seed), "Exact pop");
+    SC_CHECK_ABORT (value >= last, "Exact order");
+    last = value;
+  }
+  SC_CHECK_ABORT (!sc_pqueue_pop (pq, &value, &seed), "Exact empty");
+  sc_pqueue_destroy (pq);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -147,6 +266,11 @@ main (int argc, char **argv)
                   elapsed_pqueue, 3. * elapsed_qsort);
 
   sc_array_destroy (a4);
+
+  test_pqueue_arity (10 * count);
+  test_pqueue_exact (count);
+  test_pqueue_concurrent (10 * count);
+
   sc_finalize ();
 
   mpiret = sc_MPI_Finalize ();
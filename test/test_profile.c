@@ -0,0 +1,147 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_profile.h>
+#ifdef SC_ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+#define TEST_PROFILE_OUTER 5
+#define TEST_PROFILE_INNER 3
+
+/** Record the same nested regions on every thread. */
+static void
+test_profile_record (sc_profile_t * prof, int thread, int rank)
+{
+  int                 i, j;
+  static char         inner[BUFSIZ];
+
+  /* a name in a different buffer must identify the same region */
+  snprintf (inner, BUFSIZ, "inner");
+
+  sc_profile_push (prof, thread, "outer");
+  for (i = 0; i < TEST_PROFILE_OUTER; ++i) {
+    sc_profile_push (prof, thread, "loop");
+    for (j = 0; j < TEST_PROFILE_INNER; ++j) {
+      sc_profile_push (prof, thread, i % 2 ? "inner" : inner);
+      sc_profile_pop (prof, thread);
+    }
+    sc_profile_pop (prof, thread);
+  }
+  if (rank == 0) {
+    /* this region is only known to one process */
+    sc_profile_push (prof, thread, "rank zero");
+    sc_profile_pop (prof, thread);
+  }
+  sc_profile_pop (prof, thread);
+  sc_profile_push (prof, thread, "after \"outer\"");
+  sc_profile_pop (prof, thread);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 rank, num_procs, num_threads;
+  int                 i;
+  sc_profile_t       *prof;
+  sc_profile_region_t *reg;
+  FILE               *file;
+  const char         *names[5] =
+    { "after \"outer\"", "outer", "loop", "inner", "rank zero" };
+  const int           depths[5] = { 0, 0, 1, 2, 1 };
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &rank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &num_procs);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+#ifdef SC_ENABLE_OPENMP
+  num_threads = omp_get_max_threads ();
+#else
+  num_threads = 1;
+#endif
+
+  /* a NULL profiler is ignored */
+  test_profile_record (NULL, 0, rank);
+
+  prof = sc_profile_new (sc_MPI_COMM_WORLD, num_threads, 8);
+#ifdef SC_ENABLE_OPENMP
+#pragma omp parallel num_threads (num_threads)
+  {
+    test_profile_record (prof, omp_get_thread_num (), rank);
+  }
+#else
+  test_profile_record (prof, 0, rank);
+#endif
+  sc_profile_compute (prof);
+
+  /* the regions are sorted depth first */
+  SC_CHECK_ABORT (prof->regions->elem_count == 5, "Region count");
+  for (i = 0; i < 5; ++i) {
+    reg = (sc_profile_region_t *) sc_array_index_int (prof->regions, i);
+    SC_CHECK_ABORTF (!strcmp (reg->name, names[i]) &&
+                     reg->depth == depths[i], "Region %d", i);
+  }
+  SC_CHECK_ABORT (prof->stats[2 * 1 + 1].sum_values ==
+                  (double) (num_procs * num_threads), "Outer calls");
+  SC_CHECK_ABORT (prof->stats[2 * 3 + 1].sum_values ==
+                  (double) (num_procs * num_threads *
+                            TEST_PROFILE_OUTER * TEST_PROFILE_INNER),
+                  "Inner calls");
+  SC_CHECK_ABORT (prof->stats[2 * 4].count == num_threads &&
+                  prof->stats[2 * 4 + 1].sum_values == num_threads,
+                  "Rank zero calls");
+  SC_CHECK_ABORT (prof->stats[2 * 1].count == num_procs * num_threads,
+                  "Outer samples");
+  SC_CHECK_ABORT (prof->stats[2 * 1].min <= prof->stats[2 * 1].max &&
+                  prof->stats[2 * 2].max <= prof->stats[2 * 1].max,
+                  "Outer times");
+
+  sc_profile_print (prof, sc_package_id, SC_LP_PRODUCTION);
+  if (rank == 0) {
+    file = tmpfile ();
+    SC_CHECK_ABORT (file != NULL, "Open temporary file");
+    SC_CHECK_ABORT (!sc_profile_write_json (prof, file), "Write JSON");
+    fclose (file);
+  }
+
+  /* the profiler may be continued and computed again */
+  test_profile_record (prof, 0, rank);
+  sc_profile_compute (prof);
+  SC_CHECK_ABORT (prof->regions->elem_count == 5, "Region count again");
+  SC_CHECK_ABORT (prof->stats[2 * 1 + 1].sum_values ==
+                  (double) (num_procs * (num_threads + 1)), "Outer again");
+
+  sc_profile_destroy (prof);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_ranges.h>
+
+#define TEST_RANGES_NUM_PROCS 300
+#define TEST_RANGES_MAX_RANGES 8
+
+/** Compare the sparse and bitmap ranges with sc_ranges_compute. */
+static void
+test_ranges_compute (int num_procs, int rank, int density)
+{
+  int                 i, j, num_ranges;
+  int                 first_peer, last_peer, num_peers;
+  int                 nwin, nwin_sparse, nwin_bitmap;
+  int                 procs[TEST_RANGES_NUM_PROCS];
+  int                 peers[TEST_RANGES_NUM_PROCS];
+  int                 ranges[2 * TEST_RANGES_MAX_RANGES];
+  int                 ranges_sparse[2 * TEST_RANGES_MAX_RANGES];
+  int                 ranges_bitmap[2 * TEST_RANGES_MAX_RANGES];
+  uint64_t            bitmap[(TEST_RANGES_NUM_PROCS + 63) / 64];
+
+  SC_ASSERT (num_procs <= TEST_RANGES_NUM_PROCS);
+
+  /* random peers with gaps of varying length */
+  memset (bitmap, 0, sizeof (bitmap));
+  first_peer = num_procs;
+  last_peer = -1;
+  num_peers = 0;
+  for (j = 0; j < num_procs; ++j) {
+    procs[j] = (rand () % 100 < density);
+    if (procs[j]) {
+      peers[num_peers++] = j;
+      bitmap[j / 64] |= (uint64_t) 1 << (j % 64);
+      if (j != rank) {
+        first_peer = SC_MIN (first_peer, j);
+        last_peer = SC_MAX (last_peer, j);
+      }
+    }
+  }
+
+  for (num_ranges = 1; num_ranges <= TEST_RANGES_MAX_RANGES; ++num_ranges) {
+    nwin = sc_ranges_compute (sc_package_id, num_procs, procs, rank,
+                              first_peer, last_peer, num_ranges, ranges);
+    nwin_sparse = sc_ranges_compute_sparse (sc_package_id, num_procs,
+                                            num_peers, peers, rank,
+                                            num_ranges, ranges_sparse);
+    nwin_bitmap = sc_ranges_compute_bitmap (sc_package_id, num_procs,
+                                            bitmap, rank,
+                                            num_ranges, ranges_bitmap);
+    SC_CHECK_ABORT (nwin == nwin_sparse && nwin == nwin_bitmap,
+                    "Number of ranges");
+    for (i = 0; i < 2 * num_ranges; ++i) {
+      SC_CHECK_ABORT (ranges[i] == ranges_sparse[i], "Sparse ranges");
+      SC_CHECK_ABORT (ranges[i] == ranges_bitmap[i], "Bitmap ranges");
+    }
+  }
+}
+
+/** Compare sc_ranges_adaptive_sparse with sc_ranges_decode. */
+static void
+test_ranges_adaptive (sc_MPI_Comm mpicomm, int num_ranges)
+{
+  int                 mpiret;
+  int                 j, num_procs, rank;
+  int                 first_peer, last_peer, num_peers;
+  int                 nwin, nwin_sparse, maxwin;
+  int                 num_receivers, num_senders;
+  int                *procs, *peers, *global_ranges;
+  int                *receiver_ranks, *sender_ranks;
+  int                 ranges[2 * TEST_RANGES_MAX_RANGES];
+  int                 ranges_sparse[2 * TEST_RANGES_MAX_RANGES];
+  sc_array_t         *receivers, *senders;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  procs = SC_ALLOC (int, num_procs);
+  peers = SC_ALLOC (int, num_procs);
+  first_peer = num_procs;
+  last_peer = -1;
+  num_peers = 0;
+  for (j = 0; j < num_procs; ++j) {
+    procs[j] = (j != rank && (j * 7 + rank * 3) % 5 < 2);
+    if (procs[j]) {
+      peers[num_peers++] = j;
+      first_peer = SC_MIN (first_peer, j);
+      last_peer = SC_MAX (last_peer, j);
+    }
+  }
+
+  /* the dense reference */
+  nwin = sc_ranges_adaptive (sc_package_id, mpicomm, procs,
+                             &first_peer, &last_peer, num_ranges,
+                             ranges, &global_ranges);
+  maxwin = last_peer;
+  receiver_ranks = SC_ALLOC (int, num_procs);
+  sender_ranks = SC_ALLOC (int, num_procs);
+  sc_ranges_decode (num_procs, rank, maxwin, global_ranges,
+                    &num_receivers, receiver_ranks,
+                    &num_senders, sender_ranks);
+
+  /* the sparse variant */
+  receivers = sc_array_new (sizeof (int));
+  senders = sc_array_new (sizeof (int));
+  nwin_sparse = sc_ranges_adaptive_sparse (sc_package_id, mpicomm,
+                                           num_peers, peers, num_ranges,
+                                           ranges_sparse, receivers, senders);
+  SC_CHECK_ABORT (nwin == nwin_sparse, "Number of adaptive ranges");
+  for (j = 0; j < 2 * num_ranges; ++j) {
+    SC_CHECK_ABORT (ranges[j] == ranges_sparse[j], "Adaptive ranges");
+  }
+  SC_CHECK_ABORT ((size_t) num_receivers == receivers->elem_count,
+                  "Number of receivers");
+  for (j = 0; j < num_receivers; ++j) {
+    SC_CHECK_ABORT (receiver_ranks[j] ==
+                    *(int *) sc_array_index_int (receivers, j), "Receivers");
+  }
+  SC_CHECK_ABORT ((size_t) num_senders == senders->elem_count,
+                  "Number of senders");
+  for (j = 0; j < num_senders; ++j) {
+    SC_CHECK_ABORT (sender_ranks[j] ==
+                    *(int *) sc_array_index_int (senders, j), "Senders");
+  }
+
+  sc_array_destroy (receivers);
+  sc_array_destroy (senders);
+  SC_FREE (receiver_ranks);
+  SC_FREE (sender_ranks);
+  SC_FREE (global_ranges);
+  SC_FREE (procs);
+  SC_FREE (peers);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 k, num_procs;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  srand (0);
+  for (k = 0; k < 200; ++k) {
+    num_procs = 1 + rand () % TEST_RANGES_NUM_PROCS;
+    test_ranges_compute (num_procs, rand () % num_procs, 1 + rand () % 60);
+  }
+  test_ranges_compute (TEST_RANGES_NUM_PROCS, 0, 0);
+  test_ranges_compute (TEST_RANGES_NUM_PROCS, 17, 100);
+
+  for (k = 1; k <= TEST_RANGES_MAX_RANGES; ++k) {
+    test_ranges_adaptive (sc_MPI_COMM_WORLD, k);
+  }
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
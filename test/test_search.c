@@ -23,6 +23,115 @@
 
 #include <sc_search.h>
 
+#define TEST_SEARCH_NMEMB 200
+
+/** Compare the lower bound functions with a linear search. */
+static void
+test_search_lower_bound (size_t nmemb)
+{
+  size_t              i, k, expected, num_targets;
+  int32_t             a32[TEST_SEARCH_NMEMB];
+  int64_t             a64[TEST_SEARCH_NMEMB];
+  double              ad[TEST_SEARCH_NMEMB];
+  int64_t             targets[3 * TEST_SEARCH_NMEMB + 3];
+  size_t              bounds[3 * TEST_SEARCH_NMEMB + 3];
+  ssize_t             old;
+  sc_search_index_t  *index;
+
+  SC_ASSERT (nmemb <= TEST_SEARCH_NMEMB);
+
+  /* sorted entries with repetitions and gaps */
+  for (i = 0; i < nmemb; ++i) {
+    a64[i] = (int64_t) (3 * (i / 2) + (i / 2) % 2);
+    a32[i] = (int32_t) a64[i];
+    ad[i] = (double) a64[i];
+  }
+  index = sc_search_index_new (a64, nmemb);
+
+  num_targets = 0;
+  for (k = 0; k < 3 * (nmemb / 2) + 3; ++k) {
+    targets[num_targets++] = (int64_t) k - 1;
+    for (expected = 0; expected < nmemb; ++expected) {
+      if (a64[expected] >= (int64_t) k - 1) {
+        break;
+      }
+    }
+    SC_CHECK_ABORT (sc_search_lower_bound_int32 ((int32_t) k - 1, a32,
+                                                 nmemb) == expected,
+                    "Lower bound int32");
+    SC_CHECK_ABORT (sc_search_lower_bound_int64 ((int64_t) k - 1, a64,
+                                                 nmemb) == expected,
+                    "Lower bound int64");
+    SC_CHECK_ABORT (sc_search_lower_bound_double ((double) k - 1.5, ad,
+                                                  nmemb) == expected,
+                    "Lower bound double");
+    SC_CHECK_ABORT (sc_search_index_lower_bound (index, (int64_t) k - 1) ==
+                    expected, "Lower bound index");
+    if (nmemb > 0) {
+      old = sc_search_lower_bound64 ((int64_t) k - 1, a64, nmemb, nmemb / 2);
+      SC_CHECK_ABORT (old == (expected == nmemb ? -1 : (ssize_t) expected),
+                      "Lower bound with guess");
+    }
+  }
+
+  sc_search_lower_bound_int64_batch (a64, nmemb, targets, num_targets,
+                                     bounds);
+  for (k = 0; k < num_targets; ++k) {
+    SC_CHECK_ABORT (bounds[k] ==
+                    sc_search_lower_bound_int64 (targets[k], a64, nmemb),
+                    "Lower bound batch");
+  }
+
+  sc_search_index_destroy (index);
+}
+
+/** Compare the partition owners with a linear search. */
+static void
+test_search_partition (int num_procs, int skewed)
+{
+  int                 p, owner;
+  int64_t             g;
+  int64_t             offsets[TEST_SEARCH_NMEMB + 1];
+  int64_t             globals[8 * TEST_SEARCH_NMEMB];
+  int                 owners[8 * TEST_SEARCH_NMEMB];
+  size_t              num_globals, k;
+  sc_search_partition_t *part;
+
+  SC_ASSERT (0 < num_procs && num_procs <= TEST_SEARCH_NMEMB);
+
+  /* counts with empty processes, or many small ones and a large one */
+  offsets[0] = 5;
+  for (p = 0; p < num_procs; ++p) {
+    offsets[p + 1] = offsets[p] + (skewed ? (p == num_procs / 2 ? 400 :
+                                             p % 2) : (p * 7) % 5);
+  }
+  part = sc_search_partition_new (offsets, num_procs);
+  SC_CHECK_ABORT (part->num_buckets <= 2 * (size_t) num_procs,
+                  "Partition buckets");
+
+  num_globals = 0;
+  owner = 0;
+  for (g = offsets[0]; g < offsets[num_procs]; ++g) {
+    while (offsets[owner + 1] <= g) {
+      ++owner;
+    }
+    SC_CHECK_ABORT (sc_search_partition_owner (part, g) == owner,
+                    "Partition owner");
+    if (num_globals < 8 * TEST_SEARCH_NMEMB) {
+      globals[num_globals++] = offsets[0] + offsets[num_procs] - 1 - g;
+    }
+  }
+
+  sc_search_partition_owners (part, globals, num_globals, owners);
+  for (k = 0; k < num_globals; ++k) {
+    SC_CHECK_ABORT (owners[k] ==
+                    sc_search_partition_owner (part, globals[k]),
+                    "Partition owners");
+  }
+
+  sc_search_partition_destroy (part);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -41,6 +150,16 @@ main (int argc, char **argv)
   mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
   SC_CHECK_MPI (mpiret);
 
+  test_search_lower_bound (0);
+  test_search_lower_bound (1);
+  test_search_lower_bound (2);
+  test_search_lower_bound (TEST_SEARCH_NMEMB - 1);
+  test_search_lower_bound (TEST_SEARCH_NMEMB);
+  test_search_partition (1, 0);
+  test_search_partition (3, 1);
+  test_search_partition (TEST_SEARCH_NMEMB, 0);
+  test_search_partition (TEST_SEARCH_NMEMB, 1);
+
   if (mpirank == 0) {
     maxlevel = 3;
     target = 3;
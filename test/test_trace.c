@@ -0,0 +1,148 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_trace.h>
+#if defined SC_ENABLE_OPENMP && defined SC_ENABLE_PTHREAD
+#include <omp.h>
+#define TEST_TRACE_THREADS
+#endif
+
+#define TEST_TRACE_ITERATIONS 100
+
+/** Record nested regions into the buffer of the calling thread. */
+static void
+test_trace_record (int outer, int inner)
+{
+  int                 i;
+
+  for (i = 0; i < TEST_TRACE_ITERATIONS; ++i) {
+    SC_TRACE_REGION_BEGIN (sc_package_id, outer);
+    SC_TRACE_REGION_BEGIN (sc_package_id, inner);
+    SC_TRACE_REGION_END (sc_package_id, inner);
+    SC_TRACE_REGION_END (sc_package_id, outer);
+  }
+}
+
+/** Count the occurrences of a string in a file. */
+static long
+test_trace_count (FILE * file, const char *pattern)
+{
+  long                count;
+  char                line[BUFSIZ];
+  const char         *s;
+
+  count = 0;
+  rewind (file);
+  while (fgets (line, BUFSIZ, file) != NULL) {
+    for (s = line; (s = strstr (s, pattern)) != NULL; ++s) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 rank, num_threads;
+  int                 outer, inner, flops;
+  char                filename[BUFSIZ];
+  const char         *filenames[1];
+  FILE               *file;
+  sc_flopinfo_t       fi, snapshot;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  /* nothing is recorded before the trace is opened */
+  SC_CHECK_ABORT (sc_trace_event ("outer") == -1, "Inactive event");
+  test_trace_record (0, 1);
+
+  /* a small buffer is written many times */
+  sc_trace_open ("sc_test_trace", sc_MPI_COMM_WORLD, 16, 1);
+  outer = sc_trace_event ("outer");
+  inner = sc_trace_event ("inner \"quoted\"");
+  flops = sc_trace_event ("flops");
+  SC_CHECK_ABORT (outer == 0 && inner == 1 && flops == 2, "Event ids");
+  SC_CHECK_ABORT (sc_trace_event ("outer") == outer, "Event lookup");
+
+#ifdef TEST_TRACE_THREADS
+  num_threads = omp_get_max_threads ();
+#pragma omp parallel num_threads (num_threads)
+  {
+    test_trace_record (outer, inner);
+  }
+#else
+  num_threads = 1;
+  test_trace_record (outer, inner);
+#endif
+
+  sc_flops_start (&fi);
+  sc_flops_snap (&fi, &snapshot);
+  sc_flops_shot (&fi, &snapshot);
+  sc_trace_flops (sc_package_id, flops, &snapshot);
+
+  /* a log message is recorded as an instant event */
+  SC_PRODUCTION ("Log message recorded in the trace\n");
+  sc_trace_close ();
+
+  snprintf (filename, BUFSIZ, "sc_test_trace.%d.sctrace", rank);
+  filenames[0] = filename;
+  file = tmpfile ();
+  SC_CHECK_ABORT (file != NULL, "Open temporary file");
+  SC_CHECK_ABORT (!sc_trace_convert_json (1, filenames, file), "Convert");
+  SC_CHECK_ABORT (test_trace_count (file, "\"ph\":\"B\"") ==
+                  2 * TEST_TRACE_ITERATIONS * num_threads, "Begin events");
+  SC_CHECK_ABORT (test_trace_count (file, "\"ph\":\"E\"") ==
+                  2 * TEST_TRACE_ITERATIONS * num_threads, "End events");
+  SC_CHECK_ABORT (test_trace_count (file, "inner \\\"quoted\\\"") ==
+                  2 * TEST_TRACE_ITERATIONS * num_threads, "Escaped name");
+  SC_CHECK_ABORT (test_trace_count (file, "\"ph\":\"X\"") == 1 &&
+                  test_trace_count (file, "\"ph\":\"C\"") == 1,
+                  "Flops events");
+  SC_CHECK_ABORT (test_trace_count (file, "\"ph\":\"i\"") == 1 &&
+                  test_trace_count (file, "test_trace.c:") == 1,
+                  "Log event");
+  fclose (file);
+  SC_CHECK_ABORT (!remove (filename), "Remove trace file");
+
+  /* a file that is not a trace is rejected */
+  filenames[0] = "sc_test_trace.missing.sctrace";
+  file = tmpfile ();
+  SC_CHECK_ABORT (file != NULL, "Open temporary file");
+  SC_CHECK_ABORT (sc_trace_convert_json (1, filenames, file) == -1,
+                  "Convert missing file");
+  fclose (file);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
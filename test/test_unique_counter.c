@@ -0,0 +1,174 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_unique_counter.h>
+#if defined SC_ENABLE_OPENMP && \
+  (defined SC_HAVE_ATOMIC_BUILTINS || defined SC_ENABLE_PTHREAD)
+#include <omp.h>
+#define TEST_UNIQUE_COUNTER_THREADS
+#endif
+
+/** Check that values are dense and released values are reused in order. */
+static void
+test_unique_counter_serial (int start_value, int count)
+{
+  int                 i, value;
+  int                *counter;
+  sc_array_t         *pointers;
+  sc_unique_counter_t *uc;
+  sc_unique_counter_atomic_t *ua;
+
+  /* the atomic factory counts forward like the original one */
+  uc = sc_unique_counter_new (start_value);
+  ua = sc_unique_counter_atomic_new (start_value);
+  pointers = sc_array_new_size (sizeof (int *), (size_t) count);
+  for (i = 0; i < count; ++i) {
+    counter = sc_unique_counter_add (uc);
+    *(int **) sc_array_index_int (pointers, i) = counter;
+    value = sc_unique_counter_atomic_add (ua);
+    SC_CHECK_ABORT (value == *counter && value == start_value + i,
+                    "Unique counter add");
+  }
+
+  /* released values come back smallest first */
+  for (i = count - 1; i >= 0; i -= 3) {
+    sc_unique_counter_atomic_release (ua, start_value + i);
+  }
+  for (i = (count - 1) % 3; i < count; i += 3) {
+    value = sc_unique_counter_atomic_add (ua);
+    SC_CHECK_ABORT (value == start_value + i, "Unique counter reuse");
+  }
+  SC_CHECK_ABORT (sc_unique_counter_atomic_add (ua) == start_value + count,
+                  "Unique counter dense");
+  SC_CHECK_ABORT (sc_unique_counter_atomic_memory_used (ua) >
+                  sizeof (sc_unique_counter_atomic_t), "Memory used");
+
+  for (i = 0; i <= count; ++i) {
+    sc_unique_counter_atomic_release (ua, start_value + i);
+  }
+  for (i = 0; i < count; ++i) {
+    sc_unique_counter_release (uc, *(int **)
+                               sc_array_index_int (pointers, i));
+  }
+  sc_array_destroy (pointers);
+  sc_unique_counter_atomic_destroy (ua);
+  sc_unique_counter_destroy (uc);
+}
+
+/** Add and release values from all threads and check they are unique.
+ * \param [in] batch    Number of values held by a thread at a time.
+ * \param [in] rounds   Number of times every thread refills its batch.
+ */
+static void
+test_unique_counter_threads (int batch, int rounds)
+{
+  int                 i, num_threads, num_owned;
+  char               *owned;
+  double              elapsed;
+  sc_unique_counter_atomic_t *ua;
+
+#ifdef TEST_UNIQUE_COUNTER_THREADS
+  num_threads = omp_get_max_threads ();
+#else
+  num_threads = 1;
+#endif
+  ua = sc_unique_counter_atomic_new (0);
+
+  /* concurrent releases may push values slightly above the live count */
+  num_owned = 4 * num_threads * batch + 64;
+  owned = SC_ALLOC_ZERO (char, num_owned);
+
+  elapsed = -sc_MPI_Wtime ();
+#ifdef TEST_UNIQUE_COUNTER_THREADS
+#pragma omp parallel num_threads (num_threads)
+#endif
+  {
+    int                 held, k, r, value, duplicate;
+    int                *values;
+
+    values = SC_ALLOC (int, batch);
+    held = 0;
+    for (r = 0; r <= rounds; ++r) {
+      /* refill the batch, then release a varying number of values */
+      while (r < rounds && held < batch) {
+        value = values[held++] = sc_unique_counter_atomic_add (ua);
+        SC_CHECK_ABORTF (0 <= value && value < num_owned,
+                         "Unique counter not dense: %d", value);
+#ifdef TEST_UNIQUE_COUNTER_THREADS
+#pragma omp critical
+#endif
+        {
+          duplicate = owned[value];
+          owned[value] = 1;
+        }
+        SC_CHECK_ABORTF (!duplicate, "Unique counter duplicate %d", value);
+      }
+      for (k = r < rounds ? 1 + (r * 7) % batch : held; k > 0; --k) {
+        value = values[--held];
+#ifdef TEST_UNIQUE_COUNTER_THREADS
+#pragma omp critical
+#endif
+        owned[value] = 0;
+        sc_unique_counter_atomic_release (ua, value);
+      }
+    }
+    SC_FREE (values);
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_STATISTICSF ("Unique counter with %d threads: %g ns per value\n",
+                  num_threads, 1e9 * elapsed /
+                  ((double) num_threads * batch * rounds));
+
+  /* with all values released the smallest ones are handed out again */
+  for (i = 0; i < num_owned; ++i) {
+    SC_CHECK_ABORT (!owned[i], "Unique counter ownership");
+    SC_CHECK_ABORT (sc_unique_counter_atomic_add (ua) == i,
+                    "Unique counter compact");
+  }
+  for (i = 0; i < num_owned; ++i) {
+    sc_unique_counter_atomic_release (ua, i);
+  }
+  SC_FREE (owned);
+  sc_unique_counter_atomic_destroy (ua);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_unique_counter_serial (0, 200);
+  test_unique_counter_serial (-17, 1000);
+  test_unique_counter_threads (100, 2000);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}